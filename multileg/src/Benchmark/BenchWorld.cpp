@@ -0,0 +1,186 @@
+#include "BenchWorld.h"
+#include <cfloat>
+#include <btBulletDynamicsCommon.h>
+#include "../winapp/ControllerComponent.h"
+#include "../winapp/ConstraintSystem.h"
+#include "../winapp/RigidBodySystem.h"
+#include "../winapp/RigidBodyComponent.h"
+#include "../winapp/TransformComponent.h"
+#include "../winapp/PhysicsWorldHandler.h"
+#include "../winapp/PhysWorldDefines.h"
+#include "../winapp/CollisionLayer.h"
+#include "../winapp/ControllerOptimizationSystem.h"
+#include "../winapp/ControllerMovementRecorderComponent.h"
+
+const double BenchWorld::fixedStep = 1.0 / 60.0;
+const double BenchWorld::physicsStep = 1.0 / 120.0;
+
+BenchWorld::OptimizationSetup::OptimizationSetup()
+{
+	m_simTicks = 800;
+	m_bestScore = FLT_MAX;
+	m_bestParams = NULL;
+	m_references = NULL;
+	m_evaluationCache = NULL;
+	m_candidateParams = NULL;
+}
+
+BenchWorld::BenchWorld(bool p_quadruped, int p_characters,
+	ControllerSystem::ExecutionLayout p_execLayout, int p_loopInvocs,
+	std::vector<float>* p_params, OptimizationSetup* p_optimization)
+{
+	m_quadruped = p_quadruped;
+	artemis::EntityManager * entityManager = initWorld(p_execLayout, p_loopInvocs, p_optimization);
+	CharacterFactory characterFactory(entityManager);
+	characterFactory.setLockPos(true, false);
+	for (int x = 0; x < p_characters; x++)
+	{
+		CharacterFactory::Character character = p_quadruped ? characterFactory.createQuadruped(x, 0.0f, false) :
+															  characterFactory.createBiped(x, 0.0f, false);
+		if (p_optimization != NULL)
+		{
+			ControllerMovementRecorderComponent* recComp = new ControllerMovementRecorderComponent();
+			recComp->setLowerLegLengths(character.m_lLegLens);
+			recComp->setUpperLegLengths(character.m_uLegLens);
+			std::vector<ReferenceLegMovementController>& references = *p_optimization->m_references;
+			for (unsigned int r = 0; r < character.m_controller->getLegFrameCount(); r++)
+			{
+				if (x == 0 && r >= (unsigned int)references.size())
+				{
+					references.push_back(ReferenceLegMovementController(character.m_controller, 
+						character.m_controller->getLegFrame(r), 2, character.m_kneeFlip[r]));
+				}
+				recComp->addLegReferenceController(references[r]);
+			}
+			character.m_controllerEntity->addComponent(recComp);
+		}
+		else if (p_params != NULL)
+			character.m_controller->setInitParams(*p_params);
+		character.m_controllerEntity->refresh();
+		m_characters.push_back(character);
+	}
+	if (m_optimizationSystem != NULL)
+		m_optimizationSystem->initSim(p_optimization->m_bestScore, p_optimization->m_bestParams);
+	// Dry run, so artemis have run before physics first step
+	update(0.0f);
+}
+
+BenchWorld::BenchWorld(const CrowdScenario& p_scenario,
+	ControllerSystem::ExecutionLayout p_execLayout, int p_loopInvocs)
+{
+	artemis::EntityManager * entityManager = initWorld(p_execLayout, p_loopInvocs, NULL);
+	CharacterFactory characterFactory(entityManager);
+	characterFactory.setLockPos(true, false);
+	if (characterFactory.createCrowd(p_scenario, false, m_characters))
+	{
+		for (unsigned int i = 0; i < m_characters.size(); i++)
+			m_characters[i].m_controllerEntity->refresh();
+	}
+	// The pod of the first character, for the benchmarks that look at one
+	m_quadruped = !m_characters.empty() && m_characters[0].m_controller->getLegFrameCount() > 1;
+	// Dry run, so artemis have run before physics first step
+	update(0.0f);
+}
+
+BenchWorld::~BenchWorld()
+{
+	m_constraintSystem->removeAllConstraints();
+	m_world.getEntityManager()->removeAllEntities();
+	m_world.getSystemManager()->getSystems().deleteData();
+	for (int bi = m_dynamicsWorld->getNumCollisionObjects() - 1; bi >= 0; bi--)
+	{
+		btCollisionObject* obj = m_dynamicsWorld->getCollisionObjectArray()[bi];
+		btRigidBody* body = btRigidBody::upcast(obj);
+		if (body && body->getMotionState())
+			delete body->getMotionState();
+		m_dynamicsWorld->removeCollisionObject(obj);
+		delete obj;
+	}
+	delete m_physicsWorldHandler;
+	delete m_broadphase;
+	delete m_collisionConfiguration;
+	delete m_dispatcher;
+	delete m_solver;
+	delete m_dynamicsWorld;
+}
+
+void BenchWorld::update(float p_dt)
+{
+	m_world.loopStart();
+	m_world.setDelta(p_dt);
+	m_rigidBodySystem->executeDeferredConstraintInits();
+	m_rigidBodySystem->process();
+	m_controllerSystem->process();
+	m_controllerSystem->buildCheck();
+	m_constraintSystem->process();
+	if (m_optimizationSystem != NULL)
+		m_optimizationSystem->process();
+	if (p_dt > 0.0f)
+		m_dynamicsWorld->stepSimulation((btScalar)p_dt, 1 + (int)(p_dt / physicsStep), (btScalar)physicsStep);
+}
+
+artemis::EntityManager* BenchWorld::initWorld(ControllerSystem::ExecutionLayout p_execLayout, int p_loopInvocs,
+	OptimizationSetup* p_optimization)
+{
+	m_broadphase = new btDbvtBroadphase();
+	m_collisionConfiguration = new btDefaultCollisionConfiguration();
+	m_dispatcher = new btCollisionDispatcher(m_collisionConfiguration);
+	m_solver = new btSequentialImpulseConstraintSolver;
+	m_dynamicsWorld = new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+	m_dynamicsWorld->setGravity(btVector3(0, WORLD_GRAVITY, 0));
+
+	artemis::SystemManager * sysManager = m_world.getSystemManager();
+	m_rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(m_dynamicsWorld));
+	m_controllerSystem = (ControllerSystem*)sysManager->setSystem(new ControllerSystem(p_execLayout, p_loopInvocs));
+	m_optimizationSystem = NULL;
+	if (p_optimization != NULL)
+	{
+		m_optimizationSystem = (ControllerOptimizationSystem*)sysManager->setSystem(new ControllerOptimizationSystem(p_optimization->m_simTicks));
+		m_optimizationSystem->setEvaluationCache(p_optimization->m_evaluationCache);
+		m_optimizationSystem->setCandidateParams(p_optimization->m_candidateParams);
+	}
+	m_constraintSystem = (ConstraintSystem*)sysManager->setSystem(new ConstraintSystem(m_dynamicsWorld));
+	sysManager->initializeAll();
+	m_physicsWorldHandler = new PhysicsWorldHandler(m_dynamicsWorld, m_controllerSystem);
+	m_physicsWorldHandler->addPreprocessSystem(m_rigidBodySystem);
+
+	artemis::EntityManager * entityManager = m_world.getEntityManager();
+	artemis::Entity & ground = entityManager->create();
+	ground.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(400.0f, 10.0f, 400.0f)), 0.0f,
+		CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT, CollisionLayer::COL_CHARACTER | CollisionLayer::COL_DEFAULT));
+	ground.addComponent(new TransformComponent(glm::vec3(0.0f, -10.0f, 0.0f),
+		glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+		glm::vec3(800.0f, 20.0f, 800.0f)));
+	ground.refresh();
+	return entityManager;
+}
+
+bool BenchWorld::isQuadruped() const
+{
+	return m_quadruped;
+}
+
+ControllerSystem* BenchWorld::getControllerSystem()
+{
+	return m_controllerSystem;
+}
+
+PhysicsWorldHandler* BenchWorld::getPhysicsWorldHandler()
+{
+	return m_physicsWorldHandler;
+}
+
+ControllerOptimizationSystem* BenchWorld::getOptimizationSystem()
+{
+	return m_optimizationSystem;
+}
+
+CharacterFactory::Character& BenchWorld::getCharacter(unsigned int p_idx)
+{
+	return m_characters[p_idx];
+}
+
+unsigned int BenchWorld::getCharacterCount() const
+{
+	return (unsigned int)m_characters.size();
+}
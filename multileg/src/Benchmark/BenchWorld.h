@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <Artemis.h>
+#include "../winapp/CharacterFactory.h"
+#include "../winapp/ControllerSystem.h"
+#include "../winapp/ReferenceLegMovementController.h"
+
+class RigidBodySystem;
+class ConstraintSystem;
+class PhysicsWorldHandler;
+class ControllerOptimizationSystem;
+class EvaluationCache;
+class btBroadphaseInterface;
+class btDefaultCollisionConfiguration;
+class btCollisionDispatcher;
+class btSequentialImpulseConstraintSolver;
+class btDiscreteDynamicsWorld;
+class CrowdScenario;
+
+// =======================================================================================
+//                                      BenchWorld
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Headless simulation world, the same systems and characters as the app
+///			but without window, renderer or toolbar. Used by the benchmarks.
+///
+/// # BenchWorld
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class BenchWorld
+{
+public:
+	static const double fixedStep;
+	static const double physicsStep;
+
+	// Optimization round, set up as in the app's optimization mode
+	struct OptimizationSetup
+	{
+		OptimizationSetup();
+		int m_simTicks;
+		double m_bestScore;
+		std::vector<float>* m_bestParams; // NULL on the first round
+		// The reference leg movement, taken from the first character of the
+		// first round and then kept, so every round measures against the same
+		std::vector<ReferenceLegMovementController>* m_references;
+		EvaluationCache* m_evaluationCache; // optional
+		// Optional, one list per character evaluated as it is, instead of perturbing the best
+		const std::vector<std::vector<float> >* m_candidateParams;
+	};
+
+	// p_params is an optional gait parameter list applied to every character
+	BenchWorld(bool p_quadruped, int p_characters,
+		ControllerSystem::ExecutionLayout p_execLayout = ControllerSystem::SERIAL, int p_loopInvocs = 1,
+		std::vector<float>* p_params = NULL, OptimizationSetup* p_optimization = NULL);
+	// The characters of a scenario, none if it could not be spawned
+	BenchWorld(const CrowdScenario& p_scenario,
+		ControllerSystem::ExecutionLayout p_execLayout = ControllerSystem::SERIAL, int p_loopInvocs = 1);
+	virtual ~BenchWorld();
+
+	// One app frame; artemis update followed by the physics step (which runs the controllers)
+	void update(float p_dt);
+
+	bool isQuadruped() const;
+	ControllerSystem* getControllerSystem();
+	PhysicsWorldHandler* getPhysicsWorldHandler();
+	// NULL unless built with an optimization setup
+	ControllerOptimizationSystem* getOptimizationSystem();
+	CharacterFactory::Character& getCharacter(unsigned int p_idx);
+	unsigned int getCharacterCount() const;
+private:
+	// Systems and ground, returns the factory's entity manager
+	artemis::EntityManager* initWorld(ControllerSystem::ExecutionLayout p_execLayout, int p_loopInvocs,
+		OptimizationSetup* p_optimization);
+
+	bool m_quadruped;
+	artemis::World m_world;
+	RigidBodySystem* m_rigidBodySystem;
+	ControllerSystem* m_controllerSystem;
+	ConstraintSystem* m_constraintSystem;
+	PhysicsWorldHandler* m_physicsWorldHandler;
+	ControllerOptimizationSystem* m_optimizationSystem;
+	std::vector<CharacterFactory::Character> m_characters;
+
+	btBroadphaseInterface* m_broadphase;
+	btDefaultCollisionConfiguration* m_collisionConfiguration;
+	btCollisionDispatcher* m_dispatcher;
+	btSequentialImpulseConstraintSolver* m_solver;
+	btDiscreteDynamicsWorld* m_dynamicsWorld;
+};
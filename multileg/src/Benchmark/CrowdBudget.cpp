@@ -0,0 +1,171 @@
+#include "CrowdBudget.h"
+#include <iostream>
+#include <fstream>
+#include <FileHandler.h>
+#include <GaitFile.h>
+#include <CurrentPathHelper.h>
+#include <LatencyHistogram.h>
+#include <SimCheckpoint.h>
+#include "BenchWorld.h"
+#include "../winapp/PhysicsWorldHandler.h"
+
+CrowdBudget::CrowdBudget()
+{
+	m_budgetMs = 1000.0 * BenchWorld::physicsStep;
+	m_maxCharacters = 100;
+	m_threadCounts.push_back(1);
+	m_biped = true;
+	m_quadruped = false;
+	m_serial = true;
+	m_parallel = false;
+	m_warmupTicks = 120;
+	m_measuredTicks = 800;
+}
+
+void CrowdBudget::setBudget(double p_budgetMs)
+{
+	m_budgetMs = p_budgetMs;
+}
+
+void CrowdBudget::setMaxCharacters(int p_maxCharacters)
+{
+	m_maxCharacters = max(1, p_maxCharacters);
+}
+
+void CrowdBudget::setThreadCounts(const std::vector<int>& p_counts)
+{
+	m_threadCounts = p_counts;
+}
+
+void CrowdBudget::setPods(bool p_biped, bool p_quadruped)
+{
+	m_biped = p_biped;
+	m_quadruped = p_quadruped;
+}
+
+void CrowdBudget::setExecLayouts(bool p_serial, bool p_parallel)
+{
+	m_serial = p_serial;
+	m_parallel = p_parallel;
+}
+
+void CrowdBudget::setTicks(int p_warmupTicks, int p_measuredTicks)
+{
+	m_warmupTicks = p_warmupTicks;
+	m_measuredTicks = max(1, p_measuredTicks);
+}
+
+void CrowdBudget::run()
+{
+	m_results.clear();
+	for (int pod = 0; pod < 2; pod++)
+	{
+		bool quadruped = pod == 1;
+		if ((quadruped && !m_quadruped) || (!quadruped && !m_biped)) continue;
+		std::vector<float> params;
+		std::string autoLoadPath = getAutoLoadFilenameSetting(quadruped ? "../autoloadQuadruped.txt" : "../autoloadBiped.txt");
+		ParamSchema layout;
+		ControllerComponent::describeLayout(quadruped, layout);
+		bool hasParams = autoLoadPath != "" && GaitFile::load("../output/sav/" + autoLoadPath, &params,
+			quadruped ? GaitFile::QUADRUPED : GaitFile::BIPED, layout.getSize(), layout.getLayoutHash());
+		if (autoLoadPath != "" && !hasParams)
+			std::cout << "Gait " << autoLoadPath << " is missing or does not match the parameter layout, using default params\n";
+
+		for (int layout = 0; layout < 2; layout++)
+		{
+			bool parallel = layout == 1;
+			if ((parallel && !m_parallel) || (!parallel && !m_serial)) continue;
+			unsigned int threadRuns = parallel ? (unsigned int)m_threadCounts.size() : 1;
+			for (unsigned int t = 0; t < threadRuns; t++)
+			{
+				Result result;
+				result.m_quadruped = quadruped;
+				result.m_execLayout = parallel ? ControllerSystem::PARALLEL : ControllerSystem::SERIAL;
+				result.m_threads = parallel ? m_threadCounts[t] : 1;
+				search(result, hasParams ? &params : NULL);
+				m_results.push_back(result);
+				std::cout << (quadruped ? "QUADRUPED" : "BIPED") << " " << (parallel ? "PARALLEL" : "SERIAL")
+					<< " t=" << result.m_threads << ": " << result.m_maxCharacters << " characters within "
+					<< m_budgetMs << " ms (p99 " << result.m_p99Ms << " ms)\n";
+			}
+		}
+	}
+}
+
+void CrowdBudget::search(Result& p_result, std::vector<float>* p_params)
+{
+	float dt = (float)BenchWorld::physicsStep;
+	BenchWorld world(p_result.m_quadruped, m_maxCharacters, p_result.m_execLayout, p_result.m_threads, p_params);
+	ControllerSystem* controllerSystem = world.getControllerSystem();
+	PhysicsWorldHandler* physicsWorldHandler = world.getPhysicsWorldHandler();
+	world.update(dt); // controllers are built on the first tick
+	// Every probe starts from this state, so no probe inherits the poses, gait
+	// phases or PD history that an earlier probe left on its characters
+	SimCheckpoint start;
+	physicsWorldHandler->saveCheckpoint(start);
+	int maxCount = min(m_maxCharacters, (int)controllerSystem->getControllerCount());
+
+	// Largest passing count in [lo,hi], zero characters always passes
+	int lo = 0, hi = maxCount;
+	p_result.m_p99Ms = 0.0;
+	p_result.m_probes = 0;
+	while (lo < hi)
+	{
+		int mid = (lo + hi + 1) / 2;
+		if (!physicsWorldHandler->restoreCheckpoint(start))
+		{
+			std::cout << "Could not restore the crowd for a budget probe\n";
+			break;
+		}
+		controllerSystem->setActiveControllerCount((unsigned int)mid);
+		// Let the characters settle before measuring
+		for (int i = 0; i < m_warmupTicks; i++)
+			world.update(dt);
+		LatencyHistogram tickHistogram;
+		for (int i = 0; i < m_measuredTicks; i++)
+		{
+			world.update(dt);
+			tickHistogram.record(physicsWorldHandler->getLatestTickTiming() * 1000.0);
+		}
+		double p99 = tickHistogram.getPercentile(99.0);
+		p_result.m_probes++;
+		if (p99 <= m_budgetMs)
+		{
+			lo = mid;
+			p_result.m_p99Ms = p99;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+	p_result.m_maxCharacters = lo;
+}
+
+const std::vector<CrowdBudget::Result>& CrowdBudget::getResults() const
+{
+	return m_results;
+}
+
+bool CrowdBudget::saveResultsGNUPLOT(const std::string& p_fileName)
+{
+	std::ofstream outFile;
+	std::string file = GetExecutablePathDirectory() + p_fileName + ".gnuplot.txt";
+	outFile.open(file);
+	if (!outFile.good())
+		return false;
+	outFile << "# " << p_fileName << "\n";
+	outFile << "# budget=" << m_budgetMs << "ms maxchars=" << m_maxCharacters
+		<< " warmup=" << m_warmupTicks << " ticks=" << m_measuredTicks << "\n";
+	outFile << "# pod - exec - threads - max characters - p99(ms) - budget(ms) - probes\n";
+	for (unsigned int i = 0; i < m_results.size(); i++)
+	{
+		const Result& res = m_results[i];
+		outFile << (res.m_quadruped ? "QUADRUPED" : "BIPED") << " "
+			<< (res.m_execLayout == ControllerSystem::PARALLEL ? "PARALLEL" : "SERIAL") << " "
+			<< res.m_threads << " " << res.m_maxCharacters << " " << res.m_p99Ms << " "
+			<< m_budgetMs << " " << res.m_probes << "\n";
+	}
+	outFile.close();
+	return true;
+}
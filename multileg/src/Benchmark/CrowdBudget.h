@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "../winapp/ControllerSystem.h"
+
+// =======================================================================================
+//                                      CrowdBudget
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Finds the largest crowd that still runs in real time. The world is built
+///			once with the maximum character count, the crowd size is then binary
+///			searched by activating and deactivating the prebuilt controllers. Each probe
+///			restores a checkpoint of the freshly built crowd first. A size
+///			passes when the p99 of the tick time (controllers and physics step) is
+///			within the budget. Run per pod, execution layout and thread count.
+///
+/// # CrowdBudget
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class CrowdBudget
+{
+public:
+	struct Result
+	{
+		bool m_quadruped;
+		ControllerSystem::ExecutionLayout m_execLayout;
+		int m_threads;
+		int m_maxCharacters;	// largest crowd within budget, 0 if not even one is
+		double m_p99Ms;			// p99 tick time at that crowd size
+		int m_probes;
+	};
+
+	CrowdBudget();
+	virtual ~CrowdBudget() {}
+
+	void setBudget(double p_budgetMs);
+	void setMaxCharacters(int p_maxCharacters);
+	void setThreadCounts(const std::vector<int>& p_counts);
+	void setPods(bool p_biped, bool p_quadruped);
+	void setExecLayouts(bool p_serial, bool p_parallel);
+	void setTicks(int p_warmupTicks, int p_measuredTicks);
+
+	void run();
+	const std::vector<Result>& getResults() const;
+	bool saveResultsGNUPLOT(const std::string& p_fileName);
+private:
+	void search(Result& p_result, std::vector<float>* p_params);
+
+	double m_budgetMs;
+	int m_maxCharacters;
+	std::vector<int> m_threadCounts;
+	bool m_biped, m_quadruped;
+	bool m_serial, m_parallel;
+	int m_warmupTicks;
+	int m_measuredTicks;
+	std::vector<Result> m_results;
+};
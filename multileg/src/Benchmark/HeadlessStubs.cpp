@@ -0,0 +1,51 @@
+#include "../winapp/Toolbar.h"
+#include "../winapp/DebugDrawBatch.h"
+#include "../winapp/RenderComponent.h"
+
+// The benchmark is a headless build. The simulation sources only talk to the
+// toolbar and debug drawer through null checked pointers, and only tag render
+// components, so these replace Toolbar.cpp, DebugDrawBatch.cpp and
+// RenderComponent.cpp and keep AntTweakBar and the renderer out of the link.
+
+// Toolbar
+// ==============================================================================
+Toolbar::Toolbar(void* p_device) : IContextProcessable() {}
+Toolbar::~Toolbar() {}
+void Toolbar::init() {}
+bool Toolbar::processEvent(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) { return false; }
+void Toolbar::setWindowSize(int p_width, int p_height) {}
+void Toolbar::draw() {}
+void Toolbar::defineBarParams(BarType p_type, const char* p_params) {}
+void Toolbar::defineBarParams(BarType p_type, const Color3f& p_color, const char* p_params) {}
+void Toolbar::defineBarParams(BarType p_type, float p_min, float p_max, float p_stepSz, const char* p_params) {}
+void Toolbar::defineBarParams(BarType p_type, int p_min, int p_max, const char* p_params) {}
+void Toolbar::addReadOnlyVariable(BarType p_barType, const char* p_name, VarType p_type, const void *p_var, const char* p_misc/*=""*/) {}
+void Toolbar::addReadWriteVariable(BarType p_barType, const char* p_name, VarType p_type, void *p_var, const char* p_misc/*=""*/) {}
+void Toolbar::addSeparator(BarType p_barType, const char* p_name, const char* p_misc/*=""*/) {}
+void Toolbar::addButton(BarType p_barType, const char* p_name, TwButtonCallback p_callback, void *p_inputData, const char* p_misc/*=""*/) {}
+void Toolbar::addLabel(BarType p_barType, const char* p_name, const char* p_misc/*=""*/) {}
+TwBar* Toolbar::getBar(BarType p_type) { return NULL; }
+void Toolbar::clearBar(BarType p_barType) {}
+void TW_CALL boolButton(void* p_bool) {}
+
+// DebugDrawBatch, never enabled so nothing is batched
+// ==============================================================================
+bool DebugDrawBatch::m_enabled = false;
+void DebugDrawBatch::drawLine(const glm::vec3& p_start, const glm::vec3& p_end, const Color4f& p_color) {}
+void DebugDrawBatch::drawLine(const glm::vec3& p_start, const glm::vec3& p_end, const Color3f& p_color) {}
+void DebugDrawBatch::drawLine(const glm::vec3& p_start, const glm::vec3& p_end, const Color3f& p_startColor, const Color3f& p_endColor) {}
+void DebugDrawBatch::drawLine(const glm::vec3& p_start, const glm::vec3& p_end, const Color4f& p_startColor, const Color4f& p_endColor) {}
+void DebugDrawBatch::drawSphere(const glm::vec3& p_pos, float p_rad, const Color4f& p_color) {}
+void DebugDrawBatch::drawSphere(const glm::vec3& p_pos, float p_rad, const Color3f& p_color) {}
+void DebugDrawBatch::clearLineList() { m_lineList.clear(); }
+void DebugDrawBatch::clearSphereList() { m_sphereList.clear(); }
+std::vector<DebugDrawBatch::Line>* DebugDrawBatch::getLineList() { return &m_lineList; }
+std::vector<DebugDrawBatch::Sphere>* DebugDrawBatch::getSphereList() { return &m_sphereList; }
+void DebugDrawBatch::clearDrawCalls() { clearLineList(); clearSphereList(); }
+
+// RenderComponent, only used as a tag here
+// ==============================================================================
+int RenderComponent::getInstanceIdx()
+{
+	return m_instanceIdx;
+}
@@ -0,0 +1,152 @@
+#include "OptimizationThroughput.h"
+#include <iostream>
+#include <fstream>
+#include <cfloat>
+#include <CurrentPathHelper.h>
+#include "BenchWorld.h"
+#include "../winapp/ControllerOptimizationSystem.h"
+#include "../winapp/Time.h"
+
+OptimizationThroughput::OptimizationThroughput()
+{
+	m_quadruped = false;
+	m_execLayout = ControllerSystem::SERIAL;
+	m_threads = 1;
+	m_candidates = 10; // as many as the app optimizes with
+	m_simTicks = 800; // settings default
+	m_roundCount = 5;
+	m_targetScore = -FLT_MAX;
+	m_totalSeconds = 0.0;
+	m_timeToTarget = -1.0;
+}
+
+void OptimizationThroughput::setPod(bool p_quadruped)
+{
+	m_quadruped = p_quadruped;
+}
+
+void OptimizationThroughput::setExecLayout(ControllerSystem::ExecutionLayout p_execLayout, int p_threads)
+{
+	m_execLayout = p_execLayout;
+	m_threads = max(1, p_threads);
+}
+
+void OptimizationThroughput::setCandidates(int p_candidates)
+{
+	m_candidates = max(1, p_candidates);
+}
+
+void OptimizationThroughput::setHorizon(int p_simTicks)
+{
+	m_simTicks = max(1, p_simTicks);
+}
+
+void OptimizationThroughput::setRounds(int p_rounds)
+{
+	m_roundCount = max(1, p_rounds);
+}
+
+void OptimizationThroughput::setTargetScore(double p_targetScore)
+{
+	m_targetScore = p_targetScore;
+}
+
+void OptimizationThroughput::run()
+{
+	m_rounds.clear();
+	m_totalSeconds = 0.0;
+	m_timeToTarget = -1.0;
+	ControllerOptimizationSystem::resetTestCount();
+	std::vector<ReferenceLegMovementController> references;
+	std::vector<float> bestParams;
+	double bestScore = FLT_MAX;
+	float dt = (float)BenchWorld::fixedStep;
+
+	double start = Time::getTimeSeconds();
+	for (int r = 0; r < m_roundCount; r++)
+	{
+		Round round;
+		double roundStart = Time::getTimeSeconds();
+		BenchWorld::OptimizationSetup setup;
+		setup.m_simTicks = m_simTicks;
+		setup.m_bestScore = bestScore;
+		setup.m_bestParams = bestParams.empty() ? NULL : &bestParams;
+		setup.m_references = &references;
+		BenchWorld* world = new BenchWorld(m_quadruped, m_candidates, m_execLayout, m_threads, NULL, &setup);
+		ControllerOptimizationSystem* optimizationSystem = world->getOptimizationSystem();
+		double simStart = Time::getTimeSeconds();
+
+		// Same stepping as the app when optimizing, one fixed step per sim tick
+		while (!optimizationSystem->isSimCompleted())
+		{
+			world->update(dt);
+			optimizationSystem->incSimTick();
+			optimizationSystem->stepTime((double)dt);
+		}
+		double scoreStart = Time::getTimeSeconds();
+
+		optimizationSystem->evaluateAll();
+		optimizationSystem->findCurrentBestCandidate();
+		bestScore = optimizationSystem->getWinnerScore();
+		bestParams = optimizationSystem->getWinnerParams();
+		double scoreEnd = Time::getTimeSeconds();
+
+		delete world;
+		double roundEnd = Time::getTimeSeconds();
+		// teardown is part of the rebuild between rounds
+		round.m_rebuildMs = ((simStart - roundStart) + (roundEnd - scoreEnd)) * 1000.0;
+		round.m_simulationMs = (scoreStart - simStart) * 1000.0;
+		round.m_scoringMs = (scoreEnd - scoreStart) * 1000.0;
+		round.m_bestScore = bestScore;
+		m_rounds.push_back(round);
+		if (m_timeToTarget < 0.0 && bestScore <= m_targetScore)
+			m_timeToTarget = roundEnd - start;
+		std::cout << "round " << r << ": best " << bestScore << ", rebuild " << round.m_rebuildMs
+			<< " ms, sim " << round.m_simulationMs << " ms, scoring " << round.m_scoringMs << " ms\n";
+	}
+	m_totalSeconds = Time::getTimeSeconds() - start;
+}
+
+double OptimizationThroughput::getEvaluationsPerSecond() const
+{
+	if (m_totalSeconds <= 0.0) return 0.0;
+	return (double)(m_candidates * (int)m_rounds.size()) / m_totalSeconds;
+}
+
+double OptimizationThroughput::getTimeToTarget() const
+{
+	return m_timeToTarget;
+}
+
+bool OptimizationThroughput::saveResultsGNUPLOT(const std::string& p_fileName)
+{
+	std::ofstream outFile;
+	std::string file = GetExecutablePathDirectory() + p_fileName + ".gnuplot.txt";
+	outFile.open(file);
+	if (!outFile.good())
+		return false;
+	double rebuild = 0.0, simulation = 0.0, scoring = 0.0;
+	for (unsigned int i = 0; i < m_rounds.size(); i++)
+	{
+		rebuild += m_rounds[i].m_rebuildMs;
+		simulation += m_rounds[i].m_simulationMs;
+		scoring += m_rounds[i].m_scoringMs;
+	}
+	double total = max(0.000001, rebuild + simulation + scoring);
+	outFile << "# " << p_fileName << "\n";
+	outFile << "# " << (m_quadruped ? "QUADRUPED" : "BIPED") << " "
+		<< (m_execLayout == ControllerSystem::PARALLEL ? "PARALLEL" : "SERIAL") << " t=" << m_threads
+		<< " candidates=" << m_candidates << " horizon=" << m_simTicks << " rounds=" << m_rounds.size() << "\n";
+	outFile << "# evals/s=" << getEvaluationsPerSecond() << " wall(s)=" << m_totalSeconds
+		<< " rebuild%=" << rebuild / total * 100.0 << " sim%=" << simulation / total * 100.0
+		<< " scoring%=" << scoring / total * 100.0 << " time-to-target(s)=" << m_timeToTarget << "\n";
+	outFile << "# round - rebuild(ms) - simulation(ms) - scoring(ms) - best score\n";
+	for (unsigned int i = 0; i < m_rounds.size(); i++)
+	{
+		const Round& round = m_rounds[i];
+		outFile << i << " " << round.m_rebuildMs << " " << round.m_simulationMs << " "
+			<< round.m_scoringMs << " " << round.m_bestScore << "\n";
+	}
+	outFile.close();
+	return true;
+}
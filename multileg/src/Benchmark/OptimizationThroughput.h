@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "../winapp/ControllerSystem.h"
+
+// =======================================================================================
+//                                      OptimizationThroughput
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Measures how fast the optimizer runs. A fixed number of optimization rounds
+///			is run headless the way the app runs them: rebuild the world with one
+///			character per candidate, simulate the horizon, score and pick the winner.
+///			Wall time is split into rebuild/reset, simulation and scoring, and the
+///			candidate evaluations per second and the time until the best score first
+///			reaches a target are reported.
+///
+/// # OptimizationThroughput
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class OptimizationThroughput
+{
+public:
+	struct Round
+	{
+		double m_rebuildMs;		// world teardown and rebuild, incl. the dry run
+		double m_simulationMs;	// the horizon
+		double m_scoringMs;		// evaluation and winner selection
+		double m_bestScore;		// after this round
+	};
+
+	OptimizationThroughput();
+	virtual ~OptimizationThroughput() {}
+
+	void setPod(bool p_quadruped);
+	void setExecLayout(ControllerSystem::ExecutionLayout p_execLayout, int p_threads);
+	void setCandidates(int p_candidates);
+	void setHorizon(int p_simTicks);
+	void setRounds(int p_rounds);
+	// Time-to-target is reported when the best score gets to or below this
+	void setTargetScore(double p_targetScore);
+
+	void run();
+	double getEvaluationsPerSecond() const;
+	// Seconds until the target score was reached, negative if it never was
+	double getTimeToTarget() const;
+	bool saveResultsGNUPLOT(const std::string& p_fileName);
+private:
+	bool m_quadruped;
+	ControllerSystem::ExecutionLayout m_execLayout;
+	int m_threads;
+	int m_candidates;
+	int m_simTicks;
+	int m_roundCount;
+	double m_targetScore;
+	double m_totalSeconds;
+	double m_timeToTarget;
+	std::vector<Round> m_rounds;
+};
@@ -0,0 +1,163 @@
+#include "ParamSweep.h"
+#include <iostream>
+#include <fstream>
+#include <CurrentPathHelper.h>
+#include <GaitFile.h>
+#include <ParamSchema.h>
+#include <ToString.h>
+#include "BenchWorld.h"
+#include "../winapp/ControllerComponent.h"
+#include "../winapp/ControllerOptimizationSystem.h"
+#include "../winapp/Time.h"
+
+ParamSweep::ParamSweep()
+{
+	m_execLayout = ControllerSystem::SERIAL;
+	m_threads = 1;
+	m_batchSize = 10; // as many as the app optimizes with
+	m_quadruped = false;
+	m_simTicks = 800;
+	m_totalSeconds = 0.0;
+}
+
+void ParamSweep::setExecLayout(ControllerSystem::ExecutionLayout p_execLayout, int p_threads)
+{
+	m_execLayout = p_execLayout;
+	m_threads = max(1, p_threads);
+}
+
+void ParamSweep::setBatchSize(int p_characters)
+{
+	m_batchSize = max(1, p_characters);
+}
+
+bool ParamSweep::run(SweepJobFile& p_jobs)
+{
+	m_results.clear();
+	m_error = "";
+	m_totalSeconds = 0.0;
+	m_quadruped = p_jobs.isQuadruped();
+	m_simTicks = p_jobs.getHorizon();
+	double start = Time::getTimeSeconds();
+
+	// Layout and built-in gait from a lone character
+	ParamSchema schema;
+	std::vector<float> base;
+	{
+		BenchWorld probe(m_quadruped, 1);
+		ControllerComponent* controller = probe.getCharacter(0).m_controller;
+		if (!schema.build(controller))
+		{
+			m_error = "parameter schema does not match parameter layout";
+			return false;
+		}
+		base = controller->getParams();
+	}
+	if (p_jobs.getBaseGait() != "" && !GaitFile::load("../output/sav/" + p_jobs.getBaseGait(), &base,
+		m_quadruped ? GaitFile::QUADRUPED : GaitFile::BIPED, schema.getSize(), schema.getLayoutHash()))
+	{
+		m_error = "could not load base gait " + p_jobs.getBaseGait();
+		return false;
+	}
+	std::vector<std::vector<float> > params;
+	if (!p_jobs.resolve(schema, base, params))
+	{
+		m_error = p_jobs.getError();
+		return false;
+	}
+
+	const std::vector<SweepJobFile::Job>& jobs = p_jobs.getJobs();
+	std::vector<ReferenceLegMovementController> references;
+	float dt = (float)BenchWorld::fixedStep;
+	unsigned int batch = 0;
+	for (unsigned int first = 0; first < jobs.size(); first += (unsigned int)m_batchSize, batch++)
+	{
+		unsigned int count = min((unsigned int)m_batchSize, (unsigned int)jobs.size() - first);
+		std::vector<std::vector<float> > candidates(params.begin() + first, params.begin() + first + count);
+		BenchWorld::OptimizationSetup setup;
+		setup.m_simTicks = m_simTicks;
+		setup.m_references = &references;
+		setup.m_candidateParams = &candidates;
+		BenchWorld* world = new BenchWorld(m_quadruped, (int)count, m_execLayout, m_threads, NULL, &setup);
+		ControllerOptimizationSystem* optimizationSystem = world->getOptimizationSystem();
+
+		// Same stepping as the app when optimizing, one fixed step per sim tick
+		while (!optimizationSystem->isSimCompleted())
+		{
+			world->update(dt);
+			if (optimizationSystem->hasCandidateError())
+			{
+				// Scores of other params than the job's would be reported as the job's
+				m_error = "batch " + ToString(batch) + " could not run its jobs' parameters";
+				delete world;
+				return false;
+			}
+			optimizationSystem->incSimTick();
+			optimizationSystem->stepTime((double)dt);
+		}
+		optimizationSystem->evaluateAll();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const EvaluationCache::Entry* breakdown = optimizationSystem->getBreakdownOf(i);
+			if (breakdown == NULL)
+				continue;
+			Result result;
+			result.m_job = jobs[first + i].m_name;
+			result.m_overrides = SweepJobFile::toString(jobs[first + i]);
+			result.m_batch = batch;
+			result.m_breakdown = *breakdown;
+			m_results.push_back(result);
+			std::cout << result.m_job << ": " << breakdown->m_score << " (fd " << breakdown->m_fd << ", fv "
+				<< breakdown->m_fv << ", fh " << breakdown->m_fh << ", fr " << breakdown->m_fr << ", fp "
+				<< breakdown->m_fp << ")\n";
+		}
+		delete world;
+	}
+	m_totalSeconds = Time::getTimeSeconds() - start;
+	return true;
+}
+
+const std::vector<ParamSweep::Result>& ParamSweep::getResults() const
+{
+	return m_results;
+}
+
+int ParamSweep::getBestResult() const
+{
+	int best = -1;
+	for (unsigned int i = 0; i < m_results.size(); i++)
+	{
+		if (best < 0 || m_results[i].m_breakdown.m_score < m_results[best].m_breakdown.m_score)
+			best = (int)i;
+	}
+	return best;
+}
+
+double ParamSweep::getEvaluationsPerSecond() const
+{
+	if (m_totalSeconds <= 0.0) return 0.0;
+	return (double)m_results.size() / m_totalSeconds;
+}
+
+const std::string& ParamSweep::getError() const
+{
+	return m_error;
+}
+
+bool ParamSweep::saveResultsCSV(const std::string& p_fileName)
+{
+	std::ofstream outFile;
+	outFile.open(GetExecutablePathDirectory() + p_fileName);
+	if (!outFile.good())
+		return false;
+	outFile << "job,batch,score,fd,fv,fh,fr,fp,overrides\n";
+	for (unsigned int i = 0; i < m_results.size(); i++)
+	{
+		const Result& r = m_results[i];
+		const EvaluationCache::Entry& b = r.m_breakdown;
+		outFile << r.m_job << "," << r.m_batch << "," << b.m_score << "," << b.m_fd << "," << b.m_fv << ","
+			<< b.m_fh << "," << b.m_fr << "," << b.m_fp << "," << r.m_overrides << "\n";
+	}
+	outFile.close();
+	return true;
+}
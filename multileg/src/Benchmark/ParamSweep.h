@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <EvaluationCache.h>
+#include <SweepJobFile.h>
+#include "../winapp/ControllerSystem.h"
+
+// =======================================================================================
+//                                      ParamSweep
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Evaluates the jobs of a SweepJobFile headless, instead of one app launch
+///			per parameter variation. The jobs are run as the optimizer runs its
+///			candidates, one character each in a world of up to a batch of them,
+///			simulated for the horizon and then scored by the movement recorder, but
+///			with the parameters as given. The objective terms of every job are kept
+///			and saved as CSV, one row per job.
+///
+/// # ParamSweep
+///
+/// 19-10-2026
+///---------------------------------------------------------------------------------------
+
+class ParamSweep
+{
+public:
+	struct Result
+	{
+		std::string m_job;
+		std::string m_overrides;
+		unsigned int m_batch;
+		EvaluationCache::Entry m_breakdown; // unweighted terms and the weighted score
+	};
+
+	ParamSweep();
+	virtual ~ParamSweep() {}
+
+	void setExecLayout(ControllerSystem::ExecutionLayout p_execLayout, int p_threads);
+	// Characters per world
+	void setBatchSize(int p_characters);
+
+	// Fails if the base gait can't be loaded or a job doesn't resolve, see getError
+	bool run(SweepJobFile& p_jobs);
+	const std::vector<Result>& getResults() const;
+	// Index of the lowest score, -1 without results
+	int getBestResult() const;
+	double getEvaluationsPerSecond() const;
+	const std::string& getError() const;
+	bool saveResultsCSV(const std::string& p_fileName);
+private:
+	ControllerSystem::ExecutionLayout m_execLayout;
+	int m_threads;
+	int m_batchSize;
+	bool m_quadruped;
+	int m_simTicks;
+	double m_totalSeconds;
+	std::vector<Result> m_results;
+	std::string m_error;
+};
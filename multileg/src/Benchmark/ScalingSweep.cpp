@@ -0,0 +1,267 @@
+#include "ScalingSweep.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+#include <FileHandler.h>
+#include <GaitFile.h>
+#include <CurrentPathHelper.h>
+#include <ToString.h>
+#include "BenchWorld.h"
+#include "../winapp/PhysicsWorldHandler.h"
+
+ScalingSweep::ScalingSweep()
+{
+	m_characterCounts.push_back(1);
+	m_threadCounts.push_back(1);
+	m_biped = true;
+	m_quadruped = false;
+	m_serial = true;
+	m_parallel = false;
+	m_warmupTicks = 120;
+	m_measuredTicks = 800;
+	m_repetitions = 3;
+	m_counters = false;
+}
+
+void ScalingSweep::setCharacterCounts(const std::vector<int>& p_counts)
+{
+	m_characterCounts = p_counts;
+}
+
+void ScalingSweep::setThreadCounts(const std::vector<int>& p_counts)
+{
+	m_threadCounts = p_counts;
+}
+
+void ScalingSweep::setPods(bool p_biped, bool p_quadruped)
+{
+	m_biped = p_biped;
+	m_quadruped = p_quadruped;
+}
+
+void ScalingSweep::setExecLayouts(bool p_serial, bool p_parallel)
+{
+	m_serial = p_serial;
+	m_parallel = p_parallel;
+}
+
+void ScalingSweep::setTicks(int p_warmupTicks, int p_measuredTicks, int p_repetitions)
+{
+	m_warmupTicks = p_warmupTicks;
+	m_measuredTicks = max(1, p_measuredTicks);
+	m_repetitions = max(1, p_repetitions);
+}
+
+void ScalingSweep::setCounters(bool p_counters)
+{
+	m_counters = p_counters;
+}
+
+std::vector<int> ScalingSweep::parseRange(const std::string& p_str)
+{
+	std::vector<int> res;
+	if (p_str.find(':') != std::string::npos)
+	{
+		int lo = 1, hi = 1, step = 1;
+		std::stringstream ss(p_str);
+		std::string part;
+		if (std::getline(ss, part, ':')) lo = atoi(part.c_str());
+		if (std::getline(ss, part, ':')) hi = atoi(part.c_str());
+		if (std::getline(ss, part, ':')) step = max(1, atoi(part.c_str()));
+		for (int i = lo; i <= hi; i += step)
+			res.push_back(i);
+	}
+	else
+	{
+		std::stringstream ss(p_str);
+		std::string part;
+		while (std::getline(ss, part, ','))
+		{
+			int val = atoi(part.c_str());
+			if (val > 0) res.push_back(val);
+		}
+	}
+	return res;
+}
+
+void ScalingSweep::run()
+{
+	m_results.clear();
+	for (int pod = 0; pod < 2; pod++)
+	{
+		bool quadruped = pod == 1;
+		if ((quadruped && !m_quadruped) || (!quadruped && !m_biped)) continue;
+		// Same gait as the app uses when measuring
+		std::vector<float> params;
+		std::string autoLoadPath = getAutoLoadFilenameSetting(quadruped ? "../autoloadQuadruped.txt" : "../autoloadBiped.txt");
+		ParamSchema layout;
+		ControllerComponent::describeLayout(quadruped, layout);
+		bool hasParams = autoLoadPath != "" && GaitFile::load("../output/sav/" + autoLoadPath, &params,
+			quadruped ? GaitFile::QUADRUPED : GaitFile::BIPED, layout.getSize(), layout.getLayoutHash());
+		if (autoLoadPath != "" && !hasParams)
+			std::cout << "Gait " << autoLoadPath << " is missing or does not match the parameter layout, using default params\n";
+
+		for (unsigned int c = 0; c < m_characterCounts.size(); c++)
+		{
+			for (int layout = 0; layout < 2; layout++)
+			{
+				bool parallel = layout == 1;
+				if ((parallel && !m_parallel) || (!parallel && !m_serial)) continue;
+				// thread count has no meaning for the serial layout
+				unsigned int threadRuns = parallel ? (unsigned int)m_threadCounts.size() : 1;
+				for (unsigned int t = 0; t < threadRuns; t++)
+				{
+					Result result;
+					result.m_config.m_quadruped = quadruped;
+					result.m_config.m_execLayout = parallel ? ControllerSystem::PARALLEL : ControllerSystem::SERIAL;
+					result.m_config.m_characters = m_characterCounts[c];
+					result.m_config.m_threads = parallel ? m_threadCounts[t] : 1;
+					result.m_speedup = 1.0;
+					result.m_efficiency = 1.0;
+					measure(result, hasParams ? &params : NULL);
+					m_results.push_back(result);
+					std::cout << (quadruped ? "QUADRUPED" : "BIPED") << " " << (parallel ? "PARALLEL" : "SERIAL")
+						<< " c=" << result.m_config.m_characters << " t=" << result.m_config.m_threads
+						<< ": " << result.m_msPerTick.getMean() << " ms\n";
+				}
+			}
+		}
+	}
+	calculateSpeedups();
+}
+
+void ScalingSweep::measure(Result& p_result, std::vector<float>* p_params)
+{
+	const Config& config = p_result.m_config;
+	float dt = (float)BenchWorld::physicsStep;
+	p_result.m_countedTicks = 0;
+	PerfCounters::setEnabled(m_counters);
+	for (int r = 0; r < m_repetitions; r++)
+	{
+		// Rebuilt each repetition, like the app restarts between measurement runs
+		BenchWorld world(config.m_quadruped, config.m_characters, config.m_execLayout, config.m_threads, p_params);
+		ControllerSystem* controllerSystem = world.getControllerSystem();
+		PhysicsWorldHandler* physicsWorldHandler = world.getPhysicsWorldHandler();
+		// Ticked at the physics rate, so each update is one controller tick
+		for (int i = 0; i < m_warmupTicks; i++)
+			world.update(dt);
+		RunningStat repetition;
+		for (int i = 0; i < m_measuredTicks; i++)
+		{
+			world.update(dt);
+			double ms = controllerSystem->getLatestTiming() * 1000.0;
+			repetition.add(ms);
+			p_result.m_msPerTick.add(ms);
+			p_result.m_tickHistogram.record(ms);
+			if (m_counters)
+			{
+				p_result.m_controllerCounters.add(controllerSystem->getLatestCounters());
+				p_result.m_physicsCounters.add(physicsWorldHandler->getLatestPhysicsCounters());
+				p_result.m_countedTicks++;
+			}
+		}
+		p_result.m_repetitionMs.add(repetition.getMean());
+	}
+}
+
+void ScalingSweep::calculateSpeedups()
+{
+	for (unsigned int i = 0; i < m_results.size(); i++)
+	{
+		Result& res = m_results[i];
+		// Baseline is the serial run, else the parallel run with fewest threads
+		const Result* baseline = NULL;
+		for (unsigned int n = 0; n < m_results.size(); n++)
+		{
+			const Result& other = m_results[n];
+			if (other.m_config.m_quadruped != res.m_config.m_quadruped ||
+				other.m_config.m_characters != res.m_config.m_characters)
+				continue;
+			if (other.m_config.m_execLayout == ControllerSystem::SERIAL)
+			{
+				baseline = &other;
+				break;
+			}
+			if (baseline == NULL || other.m_config.m_threads < baseline->m_config.m_threads)
+				baseline = &other;
+		}
+		double mean = res.m_msPerTick.getMean();
+		res.m_speedup = (baseline != NULL && mean > 0.0) ? baseline->m_msPerTick.getMean() / mean : 1.0;
+		// efficiency relative to the baseline's own thread count
+		int baseThreads = baseline != NULL ? baseline->m_config.m_threads : 1;
+		res.m_efficiency = res.m_speedup * (double)baseThreads / (double)res.m_config.m_threads;
+	}
+}
+
+void ScalingSweep::writeCounters(std::ostream& p_out, const PerfCounters::Sample& p_sample, const Result& p_result)
+{
+	double perCharTick = 1.0 / ((double)max(1u, p_result.m_countedTicks) * (double)p_result.m_config.m_characters);
+	if (PerfCounters::isAvailable(PerfCounters::CYCLES) && PerfCounters::isAvailable(PerfCounters::INSTRUCTIONS))
+		p_out << " " << p_sample.getIPC();
+	else
+		p_out << " NaN";
+	for (int c = 0; c < PerfCounters::COUNTER_COUNT; c++)
+	{
+		PerfCounters::Counter counter = (PerfCounters::Counter)c;
+		if (counter == PerfCounters::INSTRUCTIONS) continue;
+		if (PerfCounters::isAvailable(counter))
+			p_out << " " << (double)p_sample.m_values[c] * perCharTick;
+		else
+			p_out << " NaN";
+	}
+}
+
+const std::vector<ScalingSweep::Result>& ScalingSweep::getResults() const
+{
+	return m_results;
+}
+
+bool ScalingSweep::saveResultsGNUPLOT(const std::string& p_fileName)
+{
+	std::ofstream outFile;
+	std::string file = GetExecutablePathDirectory() + p_fileName + ".gnuplot.txt";
+	outFile.open(file);
+	if (!outFile.good())
+		return false;
+	outFile << "# " << p_fileName << "\n";
+	outFile << "# warmup=" << m_warmupTicks << " ticks=" << m_measuredTicks << " r=" << m_repetitions << "\n";
+	outFile << "# pod - exec - characters - threads - mean(ms) - standard deviation - repetition std - speedup - efficiency - " << LatencyHistogram::getSummaryNames();
+	if (m_counters)
+	{
+		// per character and tick, NaN if the counter isn't available
+		const char* sections[2] = { "controller", "physics" };
+		for (int s = 0; s < 2; s++)
+		{
+			outFile << " - " << sections[s] << " ipc";
+			for (int c = 0; c < PerfCounters::COUNTER_COUNT; c++)
+			{
+				if (c != PerfCounters::INSTRUCTIONS)
+					outFile << " - " << sections[s] << " " << PerfCounters::getName((PerfCounters::Counter)c) << "/char";
+			}
+		}
+	}
+	outFile << "\n";
+	for (unsigned int i = 0; i < m_results.size(); i++)
+	{
+		const Result& res = m_results[i];
+		outFile << (res.m_config.m_quadruped ? "QUADRUPED" : "BIPED") << " "
+			<< (res.m_config.m_execLayout == ControllerSystem::PARALLEL ? "PARALLEL" : "SERIAL") << " "
+			<< res.m_config.m_characters << " " << res.m_config.m_threads << " "
+			<< res.m_msPerTick.getMean() << " " << res.m_msPerTick.getSTD() << " " << res.m_repetitionMs.getSTD() << " "
+			<< res.m_speedup << " " << res.m_efficiency;
+		std::vector<float> percentiles;
+		res.m_tickHistogram.getSummary(percentiles);
+		for (unsigned int n = 0; n < percentiles.size(); n++)
+			outFile << " " << percentiles[n];
+		if (m_counters)
+		{
+			writeCounters(outFile, res.m_controllerCounters, res);
+			writeCounters(outFile, res.m_physicsCounters, res);
+		}
+		outFile << "\n";
+	}
+	outFile.close();
+	return true;
+}
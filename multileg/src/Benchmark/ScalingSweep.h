@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <iosfwd>
+#include <vector>
+#include <RunningStat.h>
+#include <LatencyHistogram.h>
+#include "../winapp/ControllerSystem.h"
+
+// =======================================================================================
+//                                      ScalingSweep
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Runs the controller scaling measurement over every combination of character
+///			count, thread count, pod and execution layout in one process, instead of
+///			editing settings.txt between app runs. Each combination is rebuilt per
+///			repetition, warmed up and then timed per physics tick. The results are
+///			written as one table with speedup and parallel efficiency relative to the
+///			serial run of the same pod and character count.
+///			With counters on, IPC and the hardware counters per character and tick
+///			of the controller phase and the physics step are appended.
+///
+/// # ScalingSweep
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class ScalingSweep
+{
+public:
+	struct Config
+	{
+		bool m_quadruped;
+		ControllerSystem::ExecutionLayout m_execLayout;
+		int m_characters;
+		int m_threads;
+	};
+
+	struct Result
+	{
+		Config m_config;
+		RunningStat m_msPerTick;	// controller system time, over all ticks and repetitions
+		RunningStat m_repetitionMs;	// mean of each repetition
+		LatencyHistogram m_tickHistogram; // tail of the per-tick times
+		PerfCounters::Sample m_controllerCounters; // summed over all measured ticks
+		PerfCounters::Sample m_physicsCounters;
+		unsigned int m_countedTicks;
+		double m_speedup;
+		double m_efficiency;
+	};
+
+	ScalingSweep();
+	virtual ~ScalingSweep() {}
+
+	void setCharacterCounts(const std::vector<int>& p_counts);
+	void setThreadCounts(const std::vector<int>& p_counts);
+	void setPods(bool p_biped, bool p_quadruped);
+	void setExecLayouts(bool p_serial, bool p_parallel);
+	void setTicks(int p_warmupTicks, int p_measuredTicks, int p_repetitions);
+	void setCounters(bool p_counters);
+
+	// Parses "1,2,4" or an inclusive "lo:hi:step" range
+	static std::vector<int> parseRange(const std::string& p_str);
+
+	void run();
+	const std::vector<Result>& getResults() const;
+	bool saveResultsGNUPLOT(const std::string& p_fileName);
+private:
+	void measure(Result& p_result, std::vector<float>* p_params);
+	void calculateSpeedups();
+	// IPC, then the other counters per character and tick
+	static void writeCounters(std::ostream& p_out, const PerfCounters::Sample& p_sample, const Result& p_result);
+
+	std::vector<int> m_characterCounts;
+	std::vector<int> m_threadCounts;
+	bool m_biped, m_quadruped;
+	bool m_serial, m_parallel;
+	int m_warmupTicks;
+	int m_measuredTicks;
+	int m_repetitions;
+	bool m_counters;
+	std::vector<Result> m_results;
+};
@@ -0,0 +1,802 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cfloat>
+#include <thread>
+#include <chrono>
+#include <glm\gtc\type_ptr.hpp>
+#include <glm\gtc\quaternion.hpp>
+#include <ToString.h>
+#include <RunningStat.h>
+#include <CurrentPathHelper.h>
+#include <TickTrace.h>
+#include <StateHash.h>
+#include <MotionRecorder.h>
+#include <AsyncLog.h>
+#include <SimCheckpoint.h>
+#include <CrowdScenario.h>
+#include <TelemetryFeed.h>
+#include <DebugPrint.h>
+#include "BenchWorld.h"
+#include "ScalingSweep.h"
+#include "CrowdBudget.h"
+#include "OptimizationThroughput.h"
+#include "ParamSweep.h"
+#include "../winapp/ControllerComponent.h"
+#include "../winapp/ControllerSystem.h"
+#include "../winapp/JacobianHelper.h"
+#include "../winapp/IK2Handler.h"
+#include "../winapp/PieceWiseLinear.h"
+#include "../winapp/StepCycle.h"
+#include "../winapp/PDn.h"
+#include "../winapp/Time.h"
+#include "../winapp/PhysicsWorldHandler.h"
+
+using namespace std;
+
+// =======================================================================================
+//                                      Kernel Benchmark
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Headless micro benchmark of the locomotion kernels. A biped and a quadruped
+///			world is set up without window or renderer and stepped a fixed number of
+///			ticks, the resulting joint state is then used as fixture while each kernel
+///			is timed in isolation. Results are written as CSV, one row per kernel and
+///			character type, with ns/op, ops/s and the variance over the samples.
+///
+///			Usage: Benchmark [-samples n] [-ops n] [-warmup ticks] [-out file]
+///
+///			With -sweep the controller scaling is measured instead, see ScalingSweep:
+///			Benchmark -sweep [-chars 1:100:10] [-threads 1,2,4] [-pods bq] [-exec sp]
+///					  [-warmup ticks] [-ticks n] [-reps n] [-counters] [-out file]
+///			-counters adds hardware counters per character, see PerfCounters.
+///
+///			With -determinism the same crowd is run serial and parallel and the state
+///			hash streams (see StateHashRecorder) are compared tick by tick:
+///			Benchmark -determinism [-chars n] [-threads n] [-pods b|q] [-ticks n]
+///
+///			With -budget the largest crowd within a tick budget is searched, see CrowdBudget:
+///			Benchmark -budget ms [-chars max] [-threads 1,2,4] [-pods bq] [-exec sp]
+///					  [-warmup ticks] [-ticks n] [-out file]
+///
+///			With -optimize a number of optimization rounds is run to measure the
+///			optimizer's throughput, see OptimizationThroughput:
+///			Benchmark -optimize [-candidates n] [-horizon ticks] [-rounds n] [-target score]
+///					  [-pods b|q] [-exec s|p] [-threads n] [-out file]
+///
+///			With -allocs a crowd is stepped with allocation tracking (see AllocTracker,
+///			build the Instrumented configuration) and every tick after the warmup is
+///			expected not to allocate:
+///			Benchmark -allocs [-chars n] [-threads n] [-pods b|q] [-exec s|p] [-warmup ticks]
+///					  [-ticks n] [-out file]
+///			The per tick zone counts are written to the out file. The first steady state
+///			tick that allocates aborts the run with its report, the exit code is 1 if
+///			allocations aren't tracked in this build.
+///
+///			With -record the cost of motion recording (see MotionRecorder) is measured,
+///			the same crowd is stepped without and with recording to the out file:
+///			Benchmark -record [-chars n] [-threads n] [-pods b|q] [-exec s|p] [-warmup ticks]
+///					  [-ticks n] [-out file]
+///
+///			With -logjitter the controller system timing is measured while one line per
+///			tick is logged, not at all, with DEBUGPRINT and with AsyncLog, and its
+///			standard deviation (jitter) is compared:
+///			Benchmark -logjitter [-chars n] [-threads n] [-pods b|q] [-exec s|p] [-warmup ticks]
+///					  [-ticks n]
+///
+///			With -fork a crowd is warmed up and checkpointed (see SimCheckpoint), then
+///			restored into new worlds that run on from it. The forks' state hash streams
+///			are compared, and the restore cost against re-simulating the warmup:
+///			Benchmark -fork [-forks n] [-chars n] [-threads n] [-pods b|q] [-exec s|p]
+///					  [-warmup ticks] [-ticks n] [-out file]
+///			The checkpoint is written to the out file.
+///
+///			With -scenario a mixed crowd is spawned from a scenario file (see CrowdScenario)
+///			and stepped, the build cost per character and the tick time are printed:
+///			Benchmark -scenario file [-threads n] [-exec s|p] [-warmup ticks] [-ticks n]
+///					  [-telemetry name]
+///			-telemetry publishes every tick to the named TelemetryFeed, which
+///			Benchmark -watch name follows from another process until the run ends.
+///
+///			With -jobs the gait variations of a job file (see SweepJobFile) are evaluated
+///			by the optimizer's objective, a batch of them per world, see ParamSweep:
+///			Benchmark -jobs file [-batch n] [-exec s|p] [-threads n] [-out file]
+///			The objective terms per job are written to the out file as CSV.
+///
+///			-trace file records the tick zones (see TickTrace) of either mode and
+///			writes them as Chrome trace JSON, the last RING_SIZE zones per thread.
+///			The zones are only compiled into the Instrumented configuration, the
+///			timed Debug and Release builds have no tracing overhead.
+///
+/// # main
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+namespace
+{
+	// sink for kernel results, so the optimizer can't remove the timed calls
+	volatile float g_sink = 0.0f;
+}
+
+struct KernelResult
+{
+	string m_kernel;
+	string m_pod;
+	unsigned int m_opsPerSample;
+	RunningStat m_nsPerOp;
+};
+
+// Runs p_kernel(i) p_ops times per sample, the first sample is discarded as warm-up
+template<class T>
+void measureKernel(KernelResult& p_result, unsigned int p_samples, unsigned int p_ops, T p_kernel)
+{
+	double secondsPerTick = Time::getSecondsPerTick();
+	p_result.m_opsPerSample = p_ops;
+	for (unsigned int s = 0; s < p_samples + 1; s++)
+	{
+		LARGE_INTEGER start = Time::getTimeStamp();
+		for (unsigned int i = 0; i < p_ops; i++)
+			p_kernel(i);
+		LARGE_INTEGER end = Time::getTimeStamp();
+		if (s == 0) continue;
+		double ns = (double)(end.QuadPart - start.QuadPart) * secondsPerTick * 1000000000.0;
+		p_result.m_nsPerOp.add(ns / (double)p_ops);
+	}
+}
+
+// Friend of the controller system, times its private steps on the frozen joint state
+class ControllerBenchmark
+{
+public:
+	ControllerBenchmark(BenchWorld* p_world, unsigned int p_samples, unsigned int p_ops)
+	{
+		m_bench = p_world;
+		m_system = p_world->getControllerSystem();
+		m_samples = p_samples;
+		m_ops = p_ops;
+		m_pod = p_world->isQuadruped() ? "QUADRUPED" : "BIPED";
+	}
+
+	void run(vector<KernelResult>& p_outResults)
+	{
+		ControllerSystem* sys = m_system;
+		ControllerComponent* controller = sys->m_controllers[0];
+		ControllerComponent::LegFrame* lf = controller->getLegFrame(0);
+		ControllerComponent::Leg* leg = &lf->m_legs[0];
+		ControllerComponent::VFChain* chain = leg->getVFChain(ControllerComponent::STANDARD_CHAIN);
+		unsigned int torqueIdxOffset = controller->getTorqueListOffset();
+		float dt = (float)BenchWorld::physicsStep;
+		CMatrix J(3, ControllerComponent::VFChain::getAbsoluteMaxJacobiRows());
+		glm::vec3 end = sys->getJointPos(chain->getEndJointIdx());
+		float phi = controller->m_player.getPhase();
+		{
+			KernelResult r = newResult("calculateVFChainJacobian");
+			measureKernel(r, m_samples, m_ops, [&](unsigned int i)
+			{
+				JacobianHelper::calculateVFChainJacobian(J, *chain, end, &sys->m_VFs,
+					&sys->m_jointWorldInnerEndpoints, &sys->m_jointWorldTransforms, chain->getSize());
+				g_sink += J(0, 0);
+			});
+			p_outResults.push_back(r);
+		}
+		{
+			// the torques are accumulated into a scratch list, so the fixture is left as is
+			vector<glm::vec3> torques(sys->m_jointTorques.size(), glm::vec3(0.0f));
+			KernelResult r = newResult("computeVFTorquesFromChain");
+			measureKernel(r, m_samples, m_ops, [&](unsigned int i)
+			{
+				sys->computeVFTorquesFromChain(&torques, chain, J, ControllerComponent::STANDARD_CHAIN, torqueIdxOffset, phi, dt);
+			});
+			g_sink += torques[0].x;
+			p_outResults.push_back(r);
+		}
+		{
+			PDn pd = lf->m_desiredLFTorquePD;
+			glm::quat current = glm::quat_cast(sys->m_jointWorldTransforms[lf->m_legFrameJointId]);
+			glm::quat goal = glm::quat(glm::vec3(0.1f, 0.2f, 0.0f));
+			KernelResult r = newResult("PDn::drive(quat)");
+			measureKernel(r, m_samples, m_ops, [&](unsigned int i)
+			{
+				g_sink += pd.drive(current, goal, dt).x;
+			});
+			p_outResults.push_back(r);
+		}
+		{
+			CharacterFactory::Character& character = m_bench->getCharacter(0);
+			IK2Handler ik = lf->m_legIK[0];
+			glm::vec3 foot = sys->getJointPos(leg->m_PDChain.getFootJointIdx());
+			glm::vec3 hip = sys->getJointPos(leg->m_PDChain.getUpperJointIdx());
+			float uLen = character.m_uLegLens[0], lLen = character.m_lLegLens[0];
+			KernelResult r = newResult("IK2Handler::solve");
+			measureKernel(r, m_samples, m_ops, [&](unsigned int i)
+			{
+				ik.solve(foot, hip, uLen, lLen, NULL);
+				g_sink += ik.getUpperLegAngle();
+			});
+			p_outResults.push_back(r);
+		}
+		{
+			const PieceWiseLinear& traj = lf->m_stepHeighTraj;
+			KernelResult r = newResult("PieceWiseLinear::lerpGet");
+			measureKernel(r, m_samples, m_ops, [&](unsigned int i)
+			{
+				g_sink += traj.lerpGet((float)(i & 1023) / 1024.0f);
+			});
+			p_outResults.push_back(r);
+		}
+		{
+			StepCycle& stepCycle = lf->m_stepCycles[0];
+			KernelResult r = newResult("StepCycle::isInStance");
+			measureKernel(r, m_samples, m_ops, [&](unsigned int i)
+			{
+				if (stepCycle.isInStance((float)(i & 1023) / 1024.0f)) g_sink += 1.0f;
+			});
+			p_outResults.push_back(r);
+		}
+		{
+			// Advances the controller state (phase, PD), but the joint state stays frozen.
+			// A whole update is much heavier, so fewer calls per sample.
+			unsigned int ops = max(1u, m_ops / 100);
+			KernelResult r = newResult("controllerUpdate");
+			measureKernel(r, m_samples, ops, [&](unsigned int i)
+			{
+				controller->m_enabled = true;
+				sys->controllerUpdate(0, dt);
+			});
+			g_sink += sys->m_jointTorques[torqueIdxOffset].x;
+			p_outResults.push_back(r);
+		}
+	}
+private:
+	KernelResult newResult(const string& p_kernel)
+	{
+		KernelResult r;
+		r.m_kernel = p_kernel;
+		r.m_pod = m_pod;
+		r.m_opsPerSample = 0;
+		return r;
+	}
+
+	BenchWorld* m_bench;
+	ControllerSystem* m_system;
+	unsigned int m_samples;
+	unsigned int m_ops;
+	string m_pod;
+};
+
+bool saveResultsCSV(const vector<KernelResult>& p_results, const string& p_fileName)
+{
+	ofstream outFile;
+	outFile.open(GetExecutablePathDirectory() + p_fileName);
+	if (!outFile.good())
+		return false;
+	outFile << "kernel,pod,samples,ops_per_sample,ns_per_op,ops_per_s,variance_ns2,std_ns\n";
+	for (unsigned int i = 0; i < p_results.size(); i++)
+	{
+		const KernelResult& r = p_results[i];
+		double ns = r.m_nsPerOp.getMean();
+		double opsPerSecond = ns > 0.0 ? 1000000000.0 / ns : 0.0;
+		outFile << r.m_kernel << "," << r.m_pod << "," << r.m_nsPerOp.getCount() << "," << r.m_opsPerSample << ","
+			<< ns << "," << opsPerSecond << "," << r.m_nsPerOp.getVariance() << "," << r.m_nsPerOp.getSTD() << "\n";
+	}
+	outFile.close();
+	return true;
+}
+
+int runKernelBenchmark(unsigned int p_samples, unsigned int p_ops, int p_warmupTicks, const string& p_outFile)
+{
+	vector<KernelResult> results;
+	for (int pod = 0; pod < 2; pod++)
+	{
+		BenchWorld world(pod == 1, 1);
+		// Step the fixture into a walking pose, fixed step so it's the same every run
+		for (int t = 0; t < p_warmupTicks; t++)
+			world.update((float)BenchWorld::fixedStep);
+		ControllerBenchmark bench(&world, p_samples, p_ops);
+		bench.run(results);
+	}
+
+	for (unsigned int i = 0; i < results.size(); i++)
+	{
+		cout << results[i].m_pod << " " << results[i].m_kernel << ": "
+			<< results[i].m_nsPerOp.getMean() << " ns/op (std " << results[i].m_nsPerOp.getSTD() << ")\n";
+	}
+	if (!saveResultsCSV(results, p_outFile))
+	{
+		cout << "Could not write " << p_outFile << "\n";
+		return 1;
+	}
+	return 0;
+}
+
+// The one crowd the checks below step, decoded once from the arguments
+struct CrowdSetup
+{
+	bool m_quadruped;
+	int m_characters;
+	bool m_parallel;
+	int m_threads;
+	int m_warmupTicks;
+	int m_ticks;
+
+	ControllerSystem::ExecutionLayout getExecLayout() const
+	{
+		return m_parallel ? ControllerSystem::PARALLEL : ControllerSystem::SERIAL;
+	}
+	// thread count has no meaning for the serial layout
+	int getLoopInvocs() const { return m_parallel ? m_threads : 1; }
+	const char* getPodName() const { return m_quadruped ? "QUADRUPED" : "BIPED"; }
+};
+
+void stepWorld(BenchWorld& p_world, int p_ticks)
+{
+	for (int i = 0; i < p_ticks; i++)
+		p_world.update((float)BenchWorld::physicsStep);
+}
+
+// Returns 0 if the serial and parallel runs hash equal for every tick
+int runDeterminismCheck(const CrowdSetup& p_crowd)
+{
+	StateHashRecorder stateHashes[2];
+	for (int layout = 0; layout < 2; layout++)
+	{
+		bool parallel = layout == 1;
+		BenchWorld world(p_crowd.m_quadruped, p_crowd.m_characters, parallel ? ControllerSystem::PARALLEL : ControllerSystem::SERIAL,
+			parallel ? p_crowd.m_threads : 1);
+		stateHashes[layout].activate();
+		world.getPhysicsWorldHandler()->setStateHashRecorder(&stateHashes[layout]);
+		stepWorld(world, p_crowd.m_ticks);
+		if (parallel)
+		{
+			// compared while the world is alive, to name the divergent body
+			StateHashRecorder::Divergence divergence = StateHashRecorder::compare(stateHashes[0], stateHashes[1]);
+			cout << p_crowd.getPodName() << " c=" << p_crowd.m_characters << " t=" << p_crowd.m_threads << " "
+				<< stateHashes[1].getTickCount() << " ticks: " << StateHashRecorder::toString(divergence);
+			if (divergence.m_entry >= 0)
+				cout << ", " << world.getPhysicsWorldHandler()->getStateHashEntryName(divergence.m_entry);
+			cout << "\n";
+			return divergence.m_diverged ? 1 : 0;
+		}
+	}
+	return 0;
+}
+
+// Returns 0 if no tick after the warmup allocated, aborts on the first one that does
+int runAllocationCheck(const CrowdSetup& p_crowd, const string& p_outFile)
+{
+	// Without the replaced operator new every tick would pass
+	if (!AllocTracker::isCompiledIn())
+	{
+		cout << "Allocation tracking is not compiled in, build the Instrumented configuration (ALLOC_TRACK)\n";
+		return 1;
+	}
+	BenchWorld world(p_crowd.m_quadruped, p_crowd.m_characters, p_crowd.getExecLayout(), p_crowd.getLoopInvocs());
+	// Thread buffers, caches and the like are allowed to be set up during the warmup
+	AllocTracker::setEnabled(true);
+	stepWorld(world, p_crowd.m_warmupTicks);
+	if (!AllocTracker::openReportFile(p_outFile))
+		cout << "Could not write " << p_outFile << "\n";
+	AllocTracker::expectNoAllocations(true, true);
+	stepWorld(world, p_crowd.m_ticks);
+	unsigned int violations = AllocTracker::getViolationCount();
+	AllocTracker::expectNoAllocations(false);
+	AllocTracker::closeReportFile();
+	AllocTracker::setEnabled(false);
+	cout << p_crowd.getPodName() << " c=" << p_crowd.m_characters << " " << p_crowd.m_ticks << " ticks: "
+		<< violations << " allocating ticks\n";
+	return violations > 0 ? 1 : 0;
+}
+
+// Returns 0 if the recording could be written
+int runRecordingOverhead(const CrowdSetup& p_crowd, const string& p_outFile)
+{
+	double tickMs[2] = { 0.0, 0.0 };
+	MotionRecorder recorder;
+	for (int run = 0; run < 2; run++)
+	{
+		bool record = run == 1;
+		BenchWorld world(p_crowd.m_quadruped, p_crowd.m_characters, p_crowd.getExecLayout(), p_crowd.getLoopInvocs());
+		stepWorld(world, p_crowd.m_warmupTicks);
+		if (record)
+		{
+			if (!recorder.open(p_outFile))
+			{
+				cout << "Could not write " << p_outFile << "\n";
+				return 1;
+			}
+			world.getPhysicsWorldHandler()->setMotionRecorder(&recorder);
+		}
+		double start = Time::getTimeSeconds();
+		stepWorld(world, p_crowd.m_ticks);
+		tickMs[run] = (Time::getTimeSeconds() - start) * 1000.0 / (double)p_crowd.m_ticks;
+		// waits for the writer, not part of the tick cost
+		recorder.close();
+	}
+	double overhead = tickMs[0] > 0.0 ? (tickMs[1] - tickMs[0]) / tickMs[0] * 100.0 : 0.0;
+	cout << p_crowd.getPodName() << " c=" << p_crowd.m_characters << ": " << tickMs[0] << " ms/tick, "
+		<< tickMs[1] << " ms/tick recording (" << overhead << "%), " << recorder.getRecordedTicks() << " ticks in "
+		<< recorder.getBytesWritten() << " bytes, " << recorder.getStallCount() << " stalls\n";
+	return 0;
+}
+
+// Returns 0 if no async record was dropped
+int runLogJitter(const CrowdSetup& p_crowd)
+{
+	const char* modeNames[3] = { "no log", "DEBUGPRINT", "AsyncLog" };
+	AsyncLog::start();
+	for (int mode = 0; mode < 3; mode++)
+	{
+		BenchWorld world(p_crowd.m_quadruped, p_crowd.m_characters, p_crowd.getExecLayout(), p_crowd.getLoopInvocs());
+		stepWorld(world, p_crowd.m_warmupTicks);
+		RunningStat controllerMs, tickMs;
+		for (int i = 0; i < p_crowd.m_ticks; i++)
+		{
+			double start = Time::getTimeSeconds();
+			world.update((float)BenchWorld::physicsStep);
+			double controllerSystemTimingMs = world.getControllerSystem()->getLatestTiming() * 1000.0;
+			// the same per tick print as the app in console mode
+			if (mode == 1)
+				DEBUGPRINT((("\nController System(ms): " + ToString(controllerSystemTimingMs)).c_str()));
+			else if (mode == 2)
+				LOG_DEBUG("\nController System(ms): %g", controllerSystemTimingMs);
+			controllerMs.add(controllerSystemTimingMs);
+			tickMs.add((Time::getTimeSeconds() - start) * 1000.0);
+		}
+		cout << p_crowd.getPodName() << " c=" << p_crowd.m_characters << " " << modeNames[mode]
+			<< ": controller system " << controllerMs.getMean() << " ms, jitter " << controllerMs.getSTD()
+			<< " ms; tick " << tickMs.getMean() << " ms, jitter " << tickMs.getSTD() << " ms\n";
+	}
+	AsyncLog::stop();
+	cout << AsyncLog::getPushedCount() << " async records, " << AsyncLog::getDroppedCount() << " dropped\n";
+	return AsyncLog::getDroppedCount() > 0 ? 1 : 0;
+}
+
+// Returns 0 if every fork restored and ran identically to the first
+int runForkCheck(const CrowdSetup& p_crowd, int p_forks, const string& p_outFile)
+{
+	SimCheckpoint checkpoint;
+	double warmupMs = 0.0;
+	{
+		double start = Time::getTimeSeconds();
+		BenchWorld world(p_crowd.m_quadruped, p_crowd.m_characters, p_crowd.getExecLayout(), p_crowd.getLoopInvocs());
+		stepWorld(world, p_crowd.m_warmupTicks);
+		warmupMs = (Time::getTimeSeconds() - start) * 1000.0;
+		world.getPhysicsWorldHandler()->saveCheckpoint(checkpoint);
+	}
+	if (!checkpoint.save(p_outFile))
+		cout << "Could not write " << p_outFile << "\n";
+	vector<StateHashRecorder> stateHashes(p_forks);
+	RunningStat restoreMs;
+	int failed = 0;
+	for (int fork = 0; fork < p_forks; fork++)
+	{
+		double start = Time::getTimeSeconds();
+		BenchWorld world(p_crowd.m_quadruped, p_crowd.m_characters, p_crowd.getExecLayout(), p_crowd.getLoopInvocs());
+		if (!world.getPhysicsWorldHandler()->restoreCheckpoint(checkpoint))
+		{
+			cout << "Fork " << fork << " could not be restored\n";
+			failed++;
+			continue;
+		}
+		restoreMs.add((Time::getTimeSeconds() - start) * 1000.0);
+		stateHashes[fork].activate();
+		world.getPhysicsWorldHandler()->setStateHashRecorder(&stateHashes[fork]);
+		stepWorld(world, p_crowd.m_ticks);
+		if (fork > 0)
+		{
+			StateHashRecorder::Divergence divergence = StateHashRecorder::compare(stateHashes[0], stateHashes[fork]);
+			if (divergence.m_diverged)
+			{
+				cout << "Fork " << fork << ": " << StateHashRecorder::toString(divergence);
+				if (divergence.m_entry >= 0)
+					cout << ", " << world.getPhysicsWorldHandler()->getStateHashEntryName(divergence.m_entry);
+				cout << "\n";
+				failed++;
+			}
+		}
+	}
+	cout << p_crowd.getPodName() << " c=" << p_crowd.m_characters << ": " << checkpoint.getSize()
+		<< " byte checkpoint at tick " << checkpoint.getTick() << ", warmup " << warmupMs << " ms, build and restore "
+		<< restoreMs.getMean() << " ms, " << p_forks - failed << "/" << p_forks << " forks identical over "
+		<< p_crowd.m_ticks << " ticks\n";
+	return failed > 0 ? 1 : 0;
+}
+
+// Returns 0 if the scenario could be spawned
+// The pod and character count come from the scenario, not from p_crowd
+int runScenario(const CrowdSetup& p_crowd, const string& p_scenarioFile, const string& p_telemetryName)
+{
+	CrowdScenario scenario;
+	double start = Time::getTimeSeconds();
+	if (!scenario.load(p_scenarioFile))
+	{
+		cout << "Could not load " << p_scenarioFile << ", " << scenario.getError() << "\n";
+		return 1;
+	}
+	double parseMs = (Time::getTimeSeconds() - start) * 1000.0;
+	start = Time::getTimeSeconds();
+	BenchWorld world(scenario, p_crowd.getExecLayout(), p_crowd.getLoopInvocs());
+	double buildMs = (Time::getTimeSeconds() - start) * 1000.0;
+	unsigned int characters = world.getCharacterCount();
+	if (characters == 0)
+	{
+		cout << "Could not spawn " << p_scenarioFile << "\n";
+		return 1;
+	}
+	TelemetryFeed telemetryFeed;
+	if (p_telemetryName != "")
+	{
+		if (telemetryFeed.create(p_telemetryName, characters))
+			world.getPhysicsWorldHandler()->setTelemetryFeed(&telemetryFeed);
+		else
+			cout << "Could not create the telemetry feed " << p_telemetryName << "\n";
+	}
+	stepWorld(world, p_crowd.m_warmupTicks);
+	RunningStat tickMs;
+	for (int i = 0; i < p_crowd.m_ticks; i++)
+	{
+		double tickStart = Time::getTimeSeconds();
+		world.update((float)BenchWorld::physicsStep);
+		tickMs.add((Time::getTimeSeconds() - tickStart) * 1000.0);
+	}
+	cout << p_scenarioFile << ": " << characters << " characters (" << scenario.getPodCount(CrowdScenario::BIPED)
+		<< " bipeds, " << scenario.getPodCount(CrowdScenario::QUADRUPED) << " quadrupeds) of "
+		<< scenario.getTemplates().size() << " templates, parse " << parseMs << " ms, build " << buildMs << " ms ("
+		<< buildMs * 1000.0 / (double)characters << " us/char), tick " << tickMs.getMean() << " ms, std "
+		<< tickMs.getSTD() << " ms\n";
+	return 0;
+}
+
+// Prints the latest snapshot of a telemetry feed twice a second, until nothing is published
+// for a while. Returns 0 if anything could be read.
+int runTelemetryWatch(const string& p_name)
+{
+	TelemetryFeed telemetryFeed;
+	for (int attempt = 0; attempt < 100 && !telemetryFeed.attach(p_name); attempt++)
+		this_thread::sleep_for(chrono::milliseconds(100));
+	if (!telemetryFeed.isOpen())
+	{
+		cout << "Could not attach to " << p_name << "\n";
+		return 1;
+	}
+	TelemetryFeed::Snapshot snapshot;
+	vector<TelemetryFeed::Character> characters;
+	unsigned int lastPublished = 0, snapshots = 0;
+	int idleChecks = 0;
+	while (idleChecks < 10)
+	{
+		this_thread::sleep_for(chrono::milliseconds(500));
+		unsigned int published = telemetryFeed.getPublishedCount();
+		if (published == lastPublished || !telemetryFeed.readLatest(snapshot, characters))
+		{
+			idleChecks++;
+			continue;
+		}
+		idleChecks = 0;
+		lastPublished = published;
+		snapshots++;
+		glm::vec3 meanPos(0.0f);
+		float meanSpeed = 0.0f;
+		unsigned int enabled = 0;
+		for (unsigned int i = 0; i < characters.size(); i++)
+		{
+			const TelemetryFeed::Character& character = characters[i];
+			meanPos += glm::vec3(character.m_position[0], character.m_position[1], character.m_position[2]);
+			meanSpeed += glm::length(glm::vec3(character.m_velocity[0], character.m_velocity[1], character.m_velocity[2]));
+			if (character.m_enabled != 0) enabled++;
+		}
+		float count = max(1.0f, (float)characters.size());
+		meanPos /= count;
+		cout << "tick " << snapshot.m_tick << ": " << enabled << "/" << characters.size() << " enabled, mean pos ("
+			<< meanPos.x << "," << meanPos.y << "," << meanPos.z << "), mean speed " << meanSpeed / count
+			<< " m/s, controllers " << snapshot.m_controllerMs << " ms, physics " << snapshot.m_physicsMs << " ms";
+		if (snapshot.m_optimizerScore < FLT_MAX)
+			cout << ", score " << snapshot.m_optimizerScore;
+		cout << "\n";
+	}
+	cout << p_name << ": " << lastPublished << " ticks published, " << snapshots << " shown\n";
+	return snapshots > 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	bool sweep = false;
+	bool determinism = false;
+	bool counters = false;
+	bool optimize = false;
+	bool allocs = false;
+	bool record = false;
+	bool logJitter = false;
+	bool fork = false;
+	int forks = 4;
+	int candidates = 10, horizon = 800, rounds = 5;
+	int batch = 10;
+	double targetScore = -FLT_MAX;
+	double budgetMs = -1.0;
+	unsigned int samples = 30;
+	unsigned int ops = 10000;
+	int warmupTicks = -1;
+	int ticks = 800;
+	int reps = 3;
+	string pods = "b", execModes = "s";
+	vector<int> charCounts(1, 1), threadCounts(1, 1);
+	string outFile, traceFile, scenarioFile, jobFile, telemetryName, watchName;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		bool hasValue = i < argc - 1;
+		if (arg == "-sweep") sweep = true;
+		else if (arg == "-determinism") determinism = true;
+		else if (arg == "-counters") counters = true;
+		else if (arg == "-optimize") optimize = true;
+		else if (arg == "-allocs") allocs = true;
+		else if (arg == "-record") record = true;
+		else if (arg == "-logjitter") logJitter = true;
+		else if (arg == "-fork") fork = true;
+		else if (!hasValue) break;
+		else if (arg == "-samples") samples = (unsigned int)atoi(argv[++i]);
+		else if (arg == "-ops") ops = (unsigned int)atoi(argv[++i]);
+		else if (arg == "-warmup") warmupTicks = atoi(argv[++i]);
+		else if (arg == "-ticks") ticks = atoi(argv[++i]);
+		else if (arg == "-reps") reps = atoi(argv[++i]);
+		else if (arg == "-chars") charCounts = ScalingSweep::parseRange(argv[++i]);
+		else if (arg == "-threads") threadCounts = ScalingSweep::parseRange(argv[++i]);
+		else if (arg == "-pods") pods = argv[++i];
+		else if (arg == "-exec") execModes = argv[++i];
+		else if (arg == "-out") outFile = argv[++i];
+		else if (arg == "-trace") traceFile = argv[++i];
+		else if (arg == "-budget") budgetMs = atof(argv[++i]);
+		else if (arg == "-candidates") candidates = atoi(argv[++i]);
+		else if (arg == "-horizon") horizon = atoi(argv[++i]);
+		else if (arg == "-rounds") rounds = atoi(argv[++i]);
+		else if (arg == "-target") targetScore = atof(argv[++i]);
+		else if (arg == "-forks") forks = atoi(argv[++i]);
+		else if (arg == "-scenario") scenarioFile = argv[++i];
+		else if (arg == "-jobs") jobFile = argv[++i];
+		else if (arg == "-batch") batch = atoi(argv[++i]);
+		else if (arg == "-telemetry") telemetryName = argv[++i];
+		else if (arg == "-watch") watchName = argv[++i];
+	}
+#if !defined(TICK_TRACE) && !defined(ALLOC_TRACK)
+	// An empty trace would look like a tick without any work
+	if (traceFile != "")
+	{
+		cout << "Trace zones are not compiled in, build the Instrumented configuration (TICK_TRACE)\n";
+		return 1;
+	}
+#endif
+	TickTrace::setEnabled(traceFile != "");
+
+	// The single crowd modes run the last of the given counts, a quadruped only if asked for alone
+	CrowdSetup crowd;
+	crowd.m_quadruped = pods.find('q') != string::npos && pods.find('b') == string::npos;
+	crowd.m_characters = charCounts.empty() ? 1 : charCounts.back();
+	crowd.m_parallel = execModes.find('p') != string::npos;
+	crowd.m_threads = threadCounts.empty() ? 1 : threadCounts.back();
+	crowd.m_warmupTicks = warmupTicks < 0 ? 120 : warmupTicks;
+	crowd.m_ticks = ticks;
+
+	if (watchName != "")
+		return runTelemetryWatch(watchName);
+
+	if (determinism)
+		return runDeterminismCheck(crowd);
+
+	if (allocs)
+		return runAllocationCheck(crowd, outFile != "" ? outFile : "../output/graphs/allocations.txt");
+
+	if (record)
+		return runRecordingOverhead(crowd, outFile != "" ? outFile : "../output/sav/motionbench.mrec");
+
+	if (logJitter)
+		return runLogJitter(crowd);
+
+	if (fork)
+		return runForkCheck(crowd, forks > 0 ? forks : 1, outFile != "" ? outFile : "../output/sav/forkbench.schk");
+
+	if (scenarioFile != "")
+		return runScenario(crowd, scenarioFile, telemetryName);
+
+	if (jobFile != "")
+	{
+		SweepJobFile jobs;
+		if (!jobs.load(jobFile))
+		{
+			cout << "Could not load " << jobFile << ", " << jobs.getError() << "\n";
+			return 1;
+		}
+		ParamSweep paramSweep;
+		paramSweep.setExecLayout(crowd.getExecLayout(), crowd.getLoopInvocs());
+		paramSweep.setBatchSize(batch);
+		if (!paramSweep.run(jobs))
+		{
+			cout << "Could not run " << jobFile << ", " << paramSweep.getError() << "\n";
+			return 1;
+		}
+		int best = paramSweep.getBestResult();
+		cout << paramSweep.getResults().size() << " jobs, " << paramSweep.getEvaluationsPerSecond() << " evals/s";
+		if (best >= 0)
+			cout << ", best " << paramSweep.getResults()[best].m_job << " " << paramSweep.getResults()[best].m_breakdown.m_score;
+		cout << "\n";
+		if (outFile == "") outFile = "../output/graphs/paramsweep.csv";
+		if (!paramSweep.saveResultsCSV(outFile))
+		{
+			cout << "Could not write " << outFile << "\n";
+			return 1;
+		}
+		return 0;
+	}
+
+	if (optimize)
+	{
+		OptimizationThroughput throughput;
+		throughput.setPod(crowd.m_quadruped);
+		throughput.setExecLayout(crowd.getExecLayout(), crowd.getLoopInvocs());
+		throughput.setCandidates(candidates);
+		throughput.setHorizon(horizon);
+		throughput.setRounds(rounds);
+		throughput.setTargetScore(targetScore);
+		throughput.run();
+		cout << throughput.getEvaluationsPerSecond() << " evals/s, time-to-target " << throughput.getTimeToTarget() << " s\n";
+		if (outFile == "") outFile = "../output/graphs/OptimizationThroughput";
+		if (!throughput.saveResultsGNUPLOT(outFile))
+		{
+			cout << "Could not write " << outFile << "\n";
+			return 1;
+		}
+		return 0;
+	}
+
+	if (budgetMs > 0.0)
+	{
+		CrowdBudget crowdBudget;
+		crowdBudget.setBudget(budgetMs);
+		crowdBudget.setMaxCharacters(crowd.m_characters);
+		crowdBudget.setThreadCounts(threadCounts);
+		crowdBudget.setPods(pods.find('b') != string::npos, pods.find('q') != string::npos);
+		crowdBudget.setExecLayouts(execModes.find('s') != string::npos, execModes.find('p') != string::npos);
+		crowdBudget.setTicks(crowd.m_warmupTicks, crowd.m_ticks);
+		crowdBudget.run();
+		if (outFile == "") outFile = "../output/graphs/CrowdBudget";
+		if (!crowdBudget.saveResultsGNUPLOT(outFile))
+		{
+			cout << "Could not write " << outFile << "\n";
+			return 1;
+		}
+		return 0;
+	}
+
+	if (!sweep)
+	{
+		int res = runKernelBenchmark(samples, ops, warmupTicks < 0 ? 60 : warmupTicks,
+			outFile != "" ? outFile : "../output/graphs/kernelbench.csv");
+		if (traceFile != "" && !TickTrace::saveChromeTrace(traceFile))
+			cout << "Could not write " << traceFile << "\n";
+		return res;
+	}
+
+	ScalingSweep scalingSweep;
+	scalingSweep.setCharacterCounts(charCounts);
+	scalingSweep.setThreadCounts(threadCounts);
+	scalingSweep.setPods(pods.find('b') != string::npos, pods.find('q') != string::npos);
+	scalingSweep.setExecLayouts(execModes.find('s') != string::npos, execModes.find('p') != string::npos);
+	scalingSweep.setTicks(crowd.m_warmupTicks, crowd.m_ticks, reps);
+	scalingSweep.setCounters(counters);
+	scalingSweep.run();
+	if (outFile == "") outFile = "../output/graphs/ScalingSweep";
+	if (!scalingSweep.saveResultsGNUPLOT(outFile))
+	{
+		cout << "Could not write " << outFile << "\n";
+		return 1;
+	}
+	if (traceFile != "" && !TickTrace::saveChromeTrace(traceFile))
+	{
+		cout << "Could not write " << traceFile << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -1,102 +1,422 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
 #include <btBulletDynamicsCommon.h>
-#include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
-#include <vld.h> 
+#include <LinearMath/btQuickprof.h>
+#include <LinearMath/btAlignedAllocator.h>
+#ifdef BULLET_MULTITHREADED
+#include <BulletMultiThreaded/btParallelConstraintSolver.h>
+#include <BulletMultiThreaded/Win32ThreadSupport.h>
+#endif
+#include <Artemis.h>
+#include <CurrentPathHelper.h>
+#include "../winapp/CharacterFactory.h"
+#include "../winapp/RigidBodySystem.h"
+#include "../winapp/ConstraintSystem.h"
+#include "../winapp/RigidBodyComponent.h"
+#include "../winapp/TransformComponent.h"
+#include "../winapp/PhysWorldDefines.h"
+#include "../winapp/CollisionLayer.h"
+#include "../winapp/Time.h"
+#include <Psapi.h>
 
-int main()
+using namespace std;
+
+// =======================================================================================
+//                                      Physics Benchmark
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Physics only throughput benchmark. N biped or quadruped ragdolls are built
+///			with the character factory, so segment sizes, masses and 6-DOF limits are
+///			the ones the app uses, but without any controller. They are stepped at the
+///			app's physics rate for a fixed number of ticks, and the steps/s, the time
+///			of each Bullet phase (from Bullet's own profiler) and the memory Bullet
+///			allocates are reported. This is the physics part of the scaling, without
+///			the controllers.
+///
+///			Usage: BulletPhysicsTest [-chars 1,10,50] [-pods bq] [-ticks n] [-warmup n]
+///					 [-broadphase dbvt|sap|simple] [-iterations n] [-mt threads]
+///					 [-spacing x] [-out file]
+///
+///			-mt uses Bullet's parallel constraint solver, it needs a build with
+///			BULLET_MULTITHREADED defined and BulletMultiThreaded linked.
+///
+/// # main
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+namespace
 {
-	std::cout << "Hello World!" << std::endl;
+	const double physicsStep = 1.0 / 120.0;
 
-	// Broadphase object
-	btBroadphaseInterface* broadphase = new btDbvtBroadphase();
+	// Everything Bullet allocates goes through btAlignedAlloc, counted here
+	struct BulletMemory
+	{
+		volatile LONGLONG m_liveBytes;
+		volatile LONGLONG m_peakBytes;
+		volatile LONGLONG m_allocations;
+	};
+	BulletMemory g_bulletMemory = { 0, 0, 0 };
 
-	// Collision dispatcher with default config
-	btDefaultCollisionConfiguration* collisionConfiguration = new btDefaultCollisionConfiguration();
-	btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
+	void* countingAlloc(size_t p_size)
+	{
+		// the size is kept in front of the block for the free
+		size_t* block = (size_t*)malloc(p_size + 2 * sizeof(size_t));
+		if (block == NULL) return NULL;
+		block[0] = p_size;
+		LONGLONG live = InterlockedExchangeAdd64(&g_bulletMemory.m_liveBytes, (LONGLONG)p_size) + (LONGLONG)p_size;
+		InterlockedIncrement64(&g_bulletMemory.m_allocations);
+		if (live > g_bulletMemory.m_peakBytes) g_bulletMemory.m_peakBytes = live; // approximate under threads
+		return block + 2;
+	}
 
-	// Register collision algorithm (needed for mesh collisions)
-	// btGImpactCollisionAlgorithm::registerAlgorithm(dispatcher);
+	void countingFree(void* p_ptr)
+	{
+		if (p_ptr == NULL) return;
+		size_t* block = (size_t*)p_ptr - 2;
+		InterlockedExchangeAdd64(&g_bulletMemory.m_liveBytes, -(LONGLONG)block[0]);
+		free(block);
+	}
 
-	// Register physics solver
-	// (Single threaded)
-	btSequentialImpulseConstraintSolver* solver = new btSequentialImpulseConstraintSolver;
+	size_t getWorkingSetBytes(bool p_peak)
+	{
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+		return p_peak ? counters.PeakWorkingSetSize : counters.WorkingSetSize;
+	}
 
-	// ==================================
-	// Create the physics world
-	// ==================================
-	btDiscreteDynamicsWorld* dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
-	dynamicsWorld->setGravity(btVector3(0, -10, 0));
-	// -----------
-	// Objects
-	// -----------
-	// Create shapes
-	btCollisionShape* groundShape = new btStaticPlaneShape(btVector3(0, 1, 0), 1);
-	btCollisionShape* fallShape = new btSphereShape(1);
-	// Create motion state for ground
-	// http://bulletphysics.org/mediawiki-1.5.8/index.php/MotionStates#MotionStates
-	// Are used to retreive the calculated transform data from bullet
-	btDefaultMotionState* groundMotionState = new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), 
-																				   btVector3(0, -1, 0)));
-	// Create rigidbody for ground
-	// Bullet considers passing a mass of zero equivalent to making a body with infinite mass - it is immovable.
-	btRigidBody::btRigidBodyConstructionInfo groundRigidBodyCI(0, groundMotionState, groundShape, btVector3(0, 0, 0));
-	btRigidBody* groundRigidBody = new btRigidBody(groundRigidBodyCI);
-	// Add ground to world
-	dynamicsWorld->addRigidBody(groundRigidBody);
-
-	// Same procedure for sphere
-	// Create rigidbody for sphere (with motion state 50m above ground)
-	btDefaultMotionState* fallMotionState =
-		new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), btVector3(0, 50, 0)));
-	btScalar mass = 1; // 1kg
-	btVector3 fallInertia(0, 0, 0);
-	fallShape->calculateLocalInertia(mass, fallInertia); // sphere inertia
-	// And the rigidbody
-	btRigidBody::btRigidBodyConstructionInfo fallRigidBodyCI(mass, fallMotionState, fallShape, fallInertia);
-	btRigidBody* fallRigidBody = new btRigidBody(fallRigidBodyCI);
-	dynamicsWorld->addRigidBody(fallRigidBody);
-
-
-	// ==================================
-	// ==================================
-	//               MAIN
-	// ==================================
-	// ==================================
-
-	// Simulate for 300 iterations
-	for (int i = 0; i<300; i++) 
-	{
-		dynamicsWorld->stepSimulation(1 / 60.f, 10); // 60hz
-
-		btTransform trans;
-		fallRigidBody->getMotionState()->getWorldTransform(trans);
-
-		std::cout << "sphere height: " << trans.getOrigin().getY() << std::endl;
+	vector<int> parseList(const string& p_str)
+	{
+		vector<int> res;
+		stringstream ss(p_str);
+		string part;
+		while (getline(ss, part, ','))
+		{
+			int val = atoi(part.c_str());
+			if (val > 0) res.push_back(val);
+		}
+		return res;
 	}
+}
 
+enum BroadphaseType
+{
+	DBVT, SAP, SIMPLE
+};
 
-	// ==================================
-	// ==================================
+struct BenchOptions
+{
+	bool m_quadruped;
+	int m_characters;
+	int m_ticks;
+	int m_warmupTicks;
+	BroadphaseType m_broadphase;
+	int m_solverIterations;
+	int m_threads; // parallel solver threads, 0 for the sequential solver
+	float m_spacing;
+};
 
-	// Bullet has a policy of "whoever allocates, also deletes" memory
-	dynamicsWorld->removeRigidBody(fallRigidBody);
-	delete fallRigidBody->getMotionState();
-	delete fallRigidBody;
+struct PhaseTime
+{
+	string m_name;
+	int m_depth;
+	float m_totalMs;
+	int m_calls;
+};
 
-	dynamicsWorld->removeRigidBody(groundRigidBody);
-	delete groundRigidBody->getMotionState();
-	delete groundRigidBody;
+struct BenchResult
+{
+	BenchOptions m_options;
+	int m_bodies;
+	int m_constraints;
+	double m_stepsPerSecond;
+	double m_msPerStep;
+	LONGLONG m_worldBytes;			// allocated by Bullet after the build
+	LONGLONG m_peakBytes;			// during stepping
+	double m_allocationsPerStep;
+	size_t m_peakWorkingSetBytes;
+	vector<PhaseTime> m_phases;
+};
 
-	delete groundShape;
-	delete fallShape;
+const char* getBroadphaseName(BroadphaseType p_type)
+{
+	switch (p_type)
+	{
+	case SAP:		return "sap";
+	case SIMPLE:	return "simple";
+	default:		return "dbvt";
+	}
+}
 
+// Depth first over Bullet's profile tree, totals since the last reset
+void collectPhases(CProfileIterator* p_it, int p_depth, vector<PhaseTime>& p_outPhases)
+{
+	int children = 0;
+	for (p_it->First(); !p_it->Is_Done(); p_it->Next()) children++;
+	for (int i = 0; i < children; i++)
+	{
+		p_it->First();
+		for (int n = 0; n < i; n++) p_it->Next();
+		PhaseTime phase;
+		phase.m_name = p_it->Get_Current_Name();
+		phase.m_depth = p_depth;
+		phase.m_totalMs = p_it->Get_Current_Total_Time();
+		phase.m_calls = p_it->Get_Current_Total_Calls();
+		p_outPhases.push_back(phase);
+		p_it->Enter_Child(i);
+		collectPhases(p_it, p_depth + 1, p_outPhases);
+		p_it->Enter_Parent();
+	}
+}
+
+bool runPhysicsBenchmark(const BenchOptions& p_options, BenchResult& p_outResult)
+{
+	p_outResult.m_options = p_options;
+	LONGLONG bytesBefore = g_bulletMemory.m_liveBytes;
+
+	btBroadphaseInterface* broadphase = NULL;
+	if (p_options.m_broadphase == SAP)
+		broadphase = new btAxisSweep3(btVector3(-1000.0f, -100.0f, -1000.0f), btVector3(1000.0f, 100.0f, 1000.0f));
+	else if (p_options.m_broadphase == SIMPLE)
+		broadphase = new btSimpleBroadphase();
+	else
+		broadphase = new btDbvtBroadphase();
+	btDefaultCollisionConfiguration* collisionConfiguration = new btDefaultCollisionConfiguration();
+	btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
+	btConstraintSolver* solver = NULL;
+#ifdef BULLET_MULTITHREADED
+	Win32ThreadSupport* threadSupport = NULL;
+	if (p_options.m_threads > 0)
+	{
+		threadSupport = new Win32ThreadSupport(Win32ThreadSupport::Win32ThreadConstructionInfo(
+			"solverThreads", SolverThreadFunc, SolverlsMemoryFunc, p_options.m_threads));
+		solver = new btParallelConstraintSolver(threadSupport);
+	}
+#else
+	if (p_options.m_threads > 0)
+	{
+		cout << "Built without BULLET_MULTITHREADED, no parallel solver\n";
+		delete dispatcher;
+		delete collisionConfiguration;
+		delete broadphase;
+		return false;
+	}
+#endif
+	if (solver == NULL)
+		solver = new btSequentialImpulseConstraintSolver;
+	btDiscreteDynamicsWorld* dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+	dynamicsWorld->setGravity(btVector3(0, WORLD_GRAVITY, 0));
+	dynamicsWorld->getSolverInfo().m_numIterations = p_options.m_solverIterations;
+	// the parallel solver works on the whole batch of constraints
+	if (p_options.m_threads > 0)
+		dynamicsWorld->getSimulationIslandManager()->setSplitIslands(false);
+
+	// Same construction as the app, but no controller system
+	{
+		artemis::World world;
+		artemis::SystemManager * sysManager = world.getSystemManager();
+		RigidBodySystem* rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(dynamicsWorld));
+		ConstraintSystem* constraintSystem = (ConstraintSystem*)sysManager->setSystem(new ConstraintSystem(dynamicsWorld));
+		sysManager->initializeAll();
+
+		artemis::EntityManager * entityManager = world.getEntityManager();
+		artemis::Entity & ground = entityManager->create();
+		ground.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(400.0f, 10.0f, 400.0f)), 0.0f,
+			CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT, CollisionLayer::COL_CHARACTER | CollisionLayer::COL_DEFAULT));
+		ground.addComponent(new TransformComponent(glm::vec3(0.0f, -10.0f, 0.0f),
+			glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+			glm::vec3(800.0f, 20.0f, 800.0f)));
+		ground.refresh();
+
+		CharacterFactory characterFactory(entityManager);
+		characterFactory.setLockPos(true, false);
+		for (int x = 0; x < p_options.m_characters; x++)
+		{
+			CharacterFactory::Character character = p_options.m_quadruped ?
+				characterFactory.createQuadruped(x, p_options.m_spacing, false) :
+				characterFactory.createBiped(x, p_options.m_spacing, false);
+			character.m_controllerEntity->refresh();
+		}
+
+		// The artemis systems only add bodies and constraints, so they run
+		// every tick but only the bullet step is timed
+		float dt = (float)physicsStep;
+		double secondsPerTick = Time::getSecondsPerTick();
+		LONGLONG stepTicks = 0;
+		LONGLONG allocationsStart = 0;
+		for (int i = 0; i < p_options.m_warmupTicks + p_options.m_ticks; i++)
+		{
+			world.loopStart();
+			world.setDelta(dt);
+			rigidBodySystem->executeDeferredConstraintInits();
+			rigidBodySystem->process();
+			constraintSystem->process();
+			if (i == p_options.m_warmupTicks)
+			{
+				CProfileManager::Reset();
+				p_outResult.m_worldBytes = g_bulletMemory.m_liveBytes - bytesBefore;
+				g_bulletMemory.m_peakBytes = g_bulletMemory.m_liveBytes;
+				allocationsStart = g_bulletMemory.m_allocations;
+			}
+			LARGE_INTEGER start = Time::getTimeStamp();
+			dynamicsWorld->stepSimulation((btScalar)dt, 1, (btScalar)physicsStep);
+			LARGE_INTEGER end = Time::getTimeStamp();
+			if (i >= p_options.m_warmupTicks)
+				stepTicks += end.QuadPart - start.QuadPart;
+			CProfileManager::Increment_Frame_Counter();
+		}
+		double seconds = (double)stepTicks * secondsPerTick;
+		p_outResult.m_stepsPerSecond = seconds > 0.0 ? (double)p_options.m_ticks / seconds : 0.0;
+		p_outResult.m_msPerStep = seconds * 1000.0 / (double)max(1, p_options.m_ticks);
+		p_outResult.m_peakBytes = g_bulletMemory.m_peakBytes - bytesBefore;
+		p_outResult.m_allocationsPerStep = (double)(g_bulletMemory.m_allocations - allocationsStart) / (double)max(1, p_options.m_ticks);
+		p_outResult.m_peakWorkingSetBytes = getWorkingSetBytes(true);
+		p_outResult.m_bodies = dynamicsWorld->getNumCollisionObjects();
+		p_outResult.m_constraints = dynamicsWorld->getNumConstraints();
+
+		CProfileIterator* profileIterator = CProfileManager::Get_Iterator();
+		collectPhases(profileIterator, 0, p_outResult.m_phases);
+		CProfileManager::Release_Iterator(profileIterator);
+
+		constraintSystem->removeAllConstraints();
+		entityManager->removeAllEntities();
+		sysManager->getSystems().deleteData();
+	}
+
+	// Bullet has a policy of "whoever allocates, also deletes" memory
+	for (int bi = dynamicsWorld->getNumCollisionObjects() - 1; bi >= 0; bi--)
+	{
+		btCollisionObject* obj = dynamicsWorld->getCollisionObjectArray()[bi];
+		btRigidBody* body = btRigidBody::upcast(obj);
+		if (body && body->getMotionState())
+			delete body->getMotionState();
+		dynamicsWorld->removeCollisionObject(obj);
+		delete obj;
+	}
 	delete dynamicsWorld;
 	delete solver;
+#ifdef BULLET_MULTITHREADED
+	delete threadSupport;
+#endif
 	delete dispatcher;
 	delete collisionConfiguration;
 	delete broadphase;
+	return true;
+}
+
+bool saveResultsGNUPLOT(const vector<BenchResult>& p_results, const string& p_fileName)
+{
+	ofstream outFile;
+	outFile.open(GetExecutablePathDirectory() + p_fileName + ".gnuplot.txt");
+	if (!outFile.good())
+		return false;
+	outFile << "# " << p_fileName << "\n";
+	outFile << "# pod - characters - broadphase - iterations - threads - bodies - constraints - steps/s - ms/step"
+		<< " - world KB - peak KB - allocations/step - peak working set MB\n";
+	for (unsigned int i = 0; i < p_results.size(); i++)
+	{
+		const BenchResult& res = p_results[i];
+		const BenchOptions& opt = res.m_options;
+		outFile << (opt.m_quadruped ? "QUADRUPED" : "BIPED") << " " << opt.m_characters << " "
+			<< getBroadphaseName(opt.m_broadphase) << " " << opt.m_solverIterations << " " << opt.m_threads << " "
+			<< res.m_bodies << " " << res.m_constraints << " " << res.m_stepsPerSecond << " " << res.m_msPerStep << " "
+			<< (double)res.m_worldBytes / 1024.0 << " " << (double)res.m_peakBytes / 1024.0 << " "
+			<< res.m_allocationsPerStep << " " << (double)res.m_peakWorkingSetBytes / (1024.0 * 1024.0) << "\n";
+	}
+	outFile.close();
 
+	// Phases per run, ms per step
+	outFile.open(GetExecutablePathDirectory() + p_fileName + "_phases.gnuplot.txt");
+	if (!outFile.good())
+		return false;
+	outFile << "# " << p_fileName << " phases\n";
+	outFile << "# pod - characters - phase - depth - ms/step - calls/step\n";
+	for (unsigned int i = 0; i < p_results.size(); i++)
+	{
+		const BenchResult& res = p_results[i];
+		double perStep = 1.0 / (double)max(1, res.m_options.m_ticks);
+		for (unsigned int n = 0; n < res.m_phases.size(); n++)
+		{
+			const PhaseTime& phase = res.m_phases[n];
+			outFile << (res.m_options.m_quadruped ? "QUADRUPED" : "BIPED") << " " << res.m_options.m_characters << " "
+				<< phase.m_name << " " << phase.m_depth << " " << (double)phase.m_totalMs * perStep << " "
+				<< (double)phase.m_calls * perStep << "\n";
+		}
+	}
+	outFile.close();
+	return true;
+}
 
+int main(int argc, char* argv[])
+{
+	// Before anything in Bullet allocates
+	btAlignedAllocSetCustom(countingAlloc, countingFree);
 
+	BenchOptions options;
+	options.m_quadruped = false;
+	options.m_characters = 1;
+	options.m_ticks = 1200;
+	options.m_warmupTicks = 120;
+	options.m_broadphase = DBVT;
+	options.m_solverIterations = 10; // bullet default, which the app uses
+	options.m_threads = 0;
+	options.m_spacing = 0.0f;
+	string pods = "b";
+	vector<int> charCounts(1, 1);
+	string outFile = "../output/graphs/physicsbench";
+	for (int i = 1; i < argc - 1; i++)
+	{
+		string arg = argv[i];
+		if (arg == "-chars") charCounts = parseList(argv[++i]);
+		else if (arg == "-pods") pods = argv[++i];
+		else if (arg == "-ticks") options.m_ticks = max(1, atoi(argv[++i]));
+		else if (arg == "-warmup") options.m_warmupTicks = max(0, atoi(argv[++i]));
+		else if (arg == "-iterations") options.m_solverIterations = max(1, atoi(argv[++i]));
+		else if (arg == "-mt") options.m_threads = max(0, atoi(argv[++i]));
+		else if (arg == "-spacing") options.m_spacing = (float)atof(argv[++i]);
+		else if (arg == "-out") outFile = argv[++i];
+		else if (arg == "-broadphase")
+		{
+			string type = argv[++i];
+			options.m_broadphase = type == "sap" ? SAP : (type == "simple" ? SIMPLE : DBVT);
+		}
+	}
+
+	vector<BenchResult> results;
+	for (int pod = 0; pod < 2; pod++)
+	{
+		options.m_quadruped = pod == 1;
+		if (pods.find(options.m_quadruped ? 'q' : 'b') == string::npos) continue;
+		for (unsigned int c = 0; c < charCounts.size(); c++)
+		{
+			options.m_characters = charCounts[c];
+			BenchResult result;
+			if (!runPhysicsBenchmark(options, result))
+				return 1;
+			results.push_back(result);
+			cout << (options.m_quadruped ? "QUADRUPED" : "BIPED") << " c=" << options.m_characters
+				<< " " << getBroadphaseName(options.m_broadphase) << " it=" << options.m_solverIterations
+				<< " mt=" << options.m_threads << ": " << result.m_stepsPerSecond << " steps/s, "
+				<< result.m_msPerStep << " ms/step, " << result.m_worldBytes / 1024 << " KB world, "
+				<< result.m_allocationsPerStep << " allocs/step\n";
+			for (unsigned int n = 0; n < result.m_phases.size(); n++)
+			{
+				const PhaseTime& phase = result.m_phases[n];
+				cout << "  " << string(phase.m_depth * 2, ' ') << phase.m_name << ": "
+					<< phase.m_totalMs / (float)options.m_ticks << " ms/step\n";
+			}
+		}
+	}
+	if (!saveResultsGNUPLOT(results, outFile))
+	{
+		cout << "Could not write " << outFile << "\n";
+		return 1;
+	}
 	return 0;
-}
\ No newline at end of file
+}
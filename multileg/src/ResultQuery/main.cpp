@@ -0,0 +1,158 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <ResultStore.h>
+
+using namespace std;
+
+// =======================================================================================
+//                                      Result Query
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Lists, queries and exports the runs in a ResultStore file.
+///
+///			Usage: ResultQuery [-in file] [-where column=value ...] [-list]
+///					  [-columns a,b,c] [-export] [-out folder]
+///
+///			-where keeps the records whose column reads as the value, can be repeated.
+///			-list prints the configuration and summary of each record, the default.
+///			-columns prints the given columns of each record as CSV.
+///			-export regenerates the gnuplot tables the app writes, the per run perf_*
+///			tables and the CollectedRunsResult* tables over the character counts.
+///			For a configuration stored more than once the last record is used.
+///
+/// # main
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+bool matches(const ResultRecord& p_record, const vector<pair<string, string> >& p_filters)
+{
+	for (unsigned int i = 0; i < p_filters.size(); i++)
+	{
+		if (p_record.getText(p_filters[i].first) != p_filters[i].second)
+			return false;
+	}
+	return true;
+}
+
+void listRecords(const vector<const ResultRecord*>& p_records)
+{
+	for (unsigned int i = 0; i < p_records.size(); i++)
+	{
+		const ResultRecord& record = *p_records[i];
+		cout << i << ": " << record.getString("exec") << " " << record.getString("pod") << " c=" << record.getInt("chars")
+			<< " t=" << record.getInt("threads") << " ticks=" << record.getInt("ticks") << " r=" << record.getInt("runs")
+			<< " mean=" << record.getDouble("mean") << " std=" << record.getDouble("std")
+			<< " [" << record.getString("host") << ", " << record.getInt("logicalCores") << " cores, "
+			<< record.getString("build") << ", time " << record.getInt("time") << "]\n";
+	}
+}
+
+void printColumns(const vector<const ResultRecord*>& p_records, const vector<string>& p_columns)
+{
+	for (unsigned int n = 0; n < p_columns.size(); n++)
+		cout << (n > 0 ? "," : "") << p_columns[n];
+	cout << "\n";
+	for (unsigned int i = 0; i < p_records.size(); i++)
+	{
+		for (unsigned int n = 0; n < p_columns.size(); n++)
+			cout << (n > 0 ? "," : "") << p_records[i]->getText(p_columns[n]);
+		cout << "\n";
+	}
+}
+
+// Returns the number of tables that could not be written
+int exportTables(const vector<const ResultRecord*>& p_records, const string& p_folder)
+{
+	int failed = 0;
+	// Last record per run configuration, and the records of each collection table in file order
+	map<string, const ResultRecord*> runs;
+	map<string, vector<const ResultRecord*> > collections;
+	for (unsigned int i = 0; i < p_records.size(); i++)
+	{
+		if (p_records[i]->getFloats("stepMeans") == NULL) continue; // not a perf run
+		runs[ResultStore::getPerfTableName(*p_records[i])] = p_records[i];
+		collections[ResultStore::getCollectionTableName(*p_records[i])].push_back(p_records[i]);
+	}
+	for (map<string, const ResultRecord*>::iterator it = runs.begin(); it != runs.end(); ++it)
+	{
+		if (!ResultStore::savePerfGNUPLOT(*it->second, p_folder + it->first))
+		{
+			cout << "Could not write " << p_folder + it->first << "\n";
+			failed++;
+		}
+	}
+	for (map<string, vector<const ResultRecord*> >::iterator it = collections.begin(); it != collections.end(); ++it)
+	{
+		if (!ResultStore::saveCollectionGNUPLOT(it->second, p_folder + it->first))
+		{
+			cout << "Could not write " << p_folder + it->first << "\n";
+			failed++;
+		}
+	}
+	cout << runs.size() << " run tables, " << collections.size() << " collection tables written to " << p_folder << "\n";
+	return failed;
+}
+
+int main(int argc, char* argv[])
+{
+	string inFile = "../output/graphs/results.rstore", outFolder = "../output/graphs/";
+	bool exportMode = false;
+	vector<string> columns;
+	vector<pair<string, string> > filters;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		bool hasValue = i < argc - 1;
+		if (arg == "-list") columns.clear();
+		else if (arg == "-export") exportMode = true;
+		else if (!hasValue) break;
+		else if (arg == "-in") inFile = argv[++i];
+		else if (arg == "-out") outFolder = argv[++i];
+		else if (arg == "-columns")
+		{
+			stringstream list(argv[++i]);
+			string column;
+			columns.clear();
+			while (getline(list, column, ','))
+				columns.push_back(column);
+		}
+		else if (arg == "-where")
+		{
+			string filter = argv[++i];
+			size_t split = filter.find('=');
+			if (split != string::npos)
+				filters.push_back(make_pair(filter.substr(0, split), filter.substr(split + 1)));
+		}
+	}
+	if (outFolder != "" && outFolder[outFolder.size() - 1] != '/' && outFolder[outFolder.size() - 1] != '\\')
+		outFolder += "/";
+
+	vector<ResultRecord> records;
+	unsigned int skipped = 0;
+	if (!ResultStore::readAll(inFile, records, &skipped))
+	{
+		cout << "Could not read " << inFile << "\n";
+		return 1;
+	}
+	if (skipped > 0)
+		cout << "Skipped " << skipped << " broken records\n";
+	vector<const ResultRecord*> selected;
+	for (unsigned int i = 0; i < records.size(); i++)
+	{
+		if (matches(records[i], filters))
+			selected.push_back(&records[i]);
+	}
+
+	if (exportMode)
+		return exportTables(selected, outFolder) > 0 ? 1 : 0;
+	if (!columns.empty())
+		printColumns(selected, columns);
+	else
+		listRecords(selected);
+	return 0;
+}
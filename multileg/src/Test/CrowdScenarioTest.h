@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <CrowdScenario.h>
+#include <CurrentPathHelper.h>
+
+TEST_CASE("CrowdScenarioValid", "[CrowdScenario]")
+{
+	std::string name = "crowdscenariotest_valid.txt";
+	std::string path = GetExecutablePathDirectory() + name;
+	{
+		std::ofstream os(path.c_str());
+		os << "# two pods\n"
+			<< "template walker biped scale=1.5 lfDist=3\n"
+			<< "template dog quadruped gait=dog.gait\n"
+			<< "\n"
+			<< "grid walker count=5 columns=2 origin=1,0,2 spacing=4,0,6\n"
+			<< "scatter dog count=3 min=-10,0,-10 max=10,0,10 seed=7 velocity=0,0,1 # herd\n"
+			<< "place dog 0,0,-5\n";
+	}
+	CrowdScenario scenario;
+	REQUIRE(scenario.load(name));
+	REQUIRE(scenario.getTemplates().size() == 2);
+	const CrowdScenario::Template& walker = scenario.getTemplates()[0];
+	REQUIRE(walker.m_pod == CrowdScenario::BIPED);
+	REQUIRE(walker.m_gaitFile == "");
+	REQUIRE(walker.m_dimensions.size() == 2);
+	REQUIRE(walker.m_dimensions[0].first == "scale");
+	REQUIRE(walker.m_dimensions[0].second == 1.5f);
+	REQUIRE(scenario.getTemplates()[1].m_gaitFile == "dog.gait");
+	// File order is the character index
+	REQUIRE(scenario.getInstanceCount() == 9);
+	REQUIRE(scenario.getPodCount(CrowdScenario::BIPED) == 5);
+	REQUIRE(scenario.getPodCount(CrowdScenario::QUADRUPED) == 4);
+	const std::vector<CrowdScenario::Instance>& instances = scenario.getInstances();
+	// Grid rows along x
+	REQUIRE(instances[3].m_position.x == 5.0f);
+	REQUIRE(instances[3].m_position.z == 8.0f);
+	REQUIRE(instances[4].m_position.x == 1.0f);
+	REQUIRE(instances[4].m_position.z == 14.0f);
+	REQUIRE(instances[0].m_goalVelocity.z == 0.5f);
+	for (unsigned int i = 5; i < 8; i++)
+	{
+		REQUIRE(instances[i].m_template == 1);
+		REQUIRE(instances[i].m_position.x >= -10.0f);
+		REQUIRE(instances[i].m_position.x <= 10.0f);
+		REQUIRE(instances[i].m_position.y == 0.0f);
+		REQUIRE(instances[i].m_goalVelocity.z == 1.0f);
+	}
+	REQUIRE(instances[8].m_position.z == -5.0f);
+	// A seed gives the same scatter every time
+	CrowdScenario again;
+	REQUIRE(again.load(name));
+	REQUIRE(again.getInstances()[7].m_position.x == instances[7].m_position.x);
+	REQUIRE(again.getInstances()[7].m_position.z == instances[7].m_position.z);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("CrowdScenarioMalformed", "[CrowdScenario]")
+{
+	// Each file is refused with the line that broke it, and leaves no crowd behind
+	const char* files[][2] = {
+		{ "template dog quadruped\nscatter dog count=3 min=-10,0,-10\n", "line 2: scatter needs count, min and max" },
+		{ "template dog quadruped\nscatter dog count=3 max=10,0,10\n", "line 2: scatter needs count, min and max" },
+		{ "template dog quadruped\nscatter dog count=3 min=10,0,-10 max=-10,0,10\n", "line 2: scatter min is above its max" },
+		{ "template dog quadruped\nscatter dog min=0,0,0 max=1,0,1\n", "line 2: scatter needs count, min and max" },
+		{ "template walker\n", "line 1: template walker needs biped or quadruped, not ''" },
+		{ "template walker biped\ntemplate walker quadruped\n", "line 2: template walker declared twice" },
+		{ "template walker biped lfDist=far\n", "line 1: bad value for lfDist" },
+		{ "place walker 0,0,0\n", "line 1: unknown template walker" },
+		{ "template walker biped\nplace walker 0,0\n", "line 2: place needs a position x,y,z" },
+		{ "template walker biped\nplace walker 0,0,0,0\n", "line 2: place needs a position x,y,z" },
+		{ "template walker biped\nplace walker 0,0,0 count=2\n", "line 2: bad or unknown option count for place" },
+		{ "template walker biped\ngrid walker count=4\n", "line 2: grid needs count and columns" },
+		{ "template walker biped\ngrid walker count=4 columns=0\n", "line 2: bad or unknown option columns for grid" },
+		{ "template walker biped\ngrid walker count=-4 columns=2\n", "line 2: bad or unknown option count for grid" },
+		{ "template walker biped\ngrid walker count=4 columns=2 seed\n", "line 2: expected name=value, not 'seed'" },
+		{ "template walker biped\nspawn walker 0,0,0\n", "line 2: unknown statement spawn" }
+	};
+	std::string name = "crowdscenariotest_malformed.txt";
+	std::string path = GetExecutablePathDirectory() + name;
+	CrowdScenario scenario;
+	for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+	{
+		{
+			std::ofstream os(path.c_str());
+			os << files[i][0];
+		}
+		REQUIRE_FALSE(scenario.load(name));
+		REQUIRE(scenario.getError() == files[i][1]);
+		REQUIRE(scenario.getInstanceCount() == 0);
+		REQUIRE(scenario.getTemplates().empty());
+	}
+	std::remove(path.c_str());
+	// Missing file
+	REQUIRE_FALSE(scenario.load(name));
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <EvaluationCache.h>
+
+TEST_CASE("EvaluationCacheHit", "[EvaluationCache]")
+{
+	EvaluationCache cache(0.001f);
+	std::vector<float> params;
+	params.push_back(0.25f);
+	params.push_back(-1.5f);
+	EvaluationCache::Entry evaluated = { 1.0, 2.0, 3.0, 4.0, 5.0, 42.0 };
+	cache.insert(cache.makeKey(params), evaluated);
+	// Round-off far below the quantum hits the same entry
+	std::vector<float> nearDuplicate = params;
+	nearDuplicate[0] += 0.00001f;
+	EvaluationCache::Entry found;
+	REQUIRE(cache.lookup(cache.makeKey(nearDuplicate), found));
+	REQUIRE(found.m_fd == 1.0);
+	REQUIRE(found.m_fp == 5.0);
+	REQUIRE(found.m_score == 42.0);
+	// A step of a quantum is another candidate
+	nearDuplicate[0] += 0.001f;
+	REQUIRE_FALSE(cache.lookup(cache.makeKey(nearDuplicate), found));
+	REQUIRE(cache.getHits() == 1);
+	REQUIRE(cache.getMisses() == 1);
+	REQUIRE(cache.getHitRate() == Approx(0.5));
+	// contains doesn't count
+	REQUIRE(cache.contains(cache.makeKey(params)));
+	REQUIRE(cache.getHits() == 1);
+}
+
+TEST_CASE("EvaluationCacheContextMismatch", "[EvaluationCache]")
+{
+	EvaluationCache cache;
+	std::vector<float> params(3, 0.5f);
+	int biped = 0, quadruped = 1;
+	cache.setContextKey(EvaluationCache::hash(&biped, sizeof(biped)));
+	EvaluationCache::Entry evaluated = { 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+	cache.insert(cache.makeKey(params), evaluated);
+	// The same parameters evaluated for another pod are not the same evaluation
+	cache.setContextKey(EvaluationCache::hash(&quadruped, sizeof(quadruped)));
+	EvaluationCache::Entry found;
+	REQUIRE_FALSE(cache.lookup(cache.makeKey(params), found));
+	cache.setContextKey(EvaluationCache::hash(&biped, sizeof(biped)));
+	REQUIRE(cache.lookup(cache.makeKey(params), found));
+	// Nor is a vector that only shares a prefix
+	std::vector<float> longer(4, 0.5f);
+	REQUIRE_FALSE(cache.lookup(cache.makeKey(longer), found));
+}
+
+TEST_CASE("EvaluationCacheSaveLoad", "[EvaluationCache]")
+{
+	std::string path = "evaluationcachetest.bin";
+	EvaluationCache saved;
+	saved.setContextKey(1234);
+	std::vector<float> params(2, 0.0f);
+	for (int i = 0; i < 10; i++)
+	{
+		params[1] = (float)i;
+		EvaluationCache::Entry evaluated = { (double)i, 0.0, 0.0, 0.0, 0.0, (double)i * 100.0 };
+		saved.insert(saved.makeKey(params), evaluated);
+	}
+	REQUIRE(saved.save(path));
+	EvaluationCache loaded;
+	REQUIRE(loaded.load(path));
+	REQUIRE(loaded.getSize() == 10);
+	REQUIRE(loaded.getHits() == 0);
+	loaded.setContextKey(1234);
+	params[1] = 7.0f;
+	EvaluationCache::Entry found;
+	REQUIRE(loaded.lookup(loaded.makeKey(params), found));
+	REQUIRE(found.m_fd == 7.0);
+	REQUIRE(found.m_score == 700.0);
+	std::remove(path.c_str());
+	// A file that isn't a cache is refused
+	std::vector<float> notACache(4, 1.0f);
+	{
+		std::ofstream os(path.c_str(), std::ios::binary);
+		os.write(reinterpret_cast<const char*>(&notACache[0]), notACache.size() * sizeof(float));
+	}
+	EvaluationCache other;
+	REQUIRE_FALSE(other.load(path));
+	REQUIRE(other.getSize() == 0);
+	std::remove(path.c_str());
+}
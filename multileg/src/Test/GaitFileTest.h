@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <GaitFile.h>
+#include <FileHandler.h>
+
+TEST_CASE("GaitFileRoundTrip", "[GaitFile]")
+{
+	std::string path = "gaitfiletest_roundtrip.gait";
+	float values[4] = { -1.0f, 0.75f, 0.001f, 3.5f };
+	std::vector<float> params(values, values + 4);
+	double score = 12.5;
+	REQUIRE(GaitFile::save(path, GaitFile::BIPED, params, 0x1234, &score));
+	{
+		GaitFile file;
+		REQUIRE(file.open(path));
+		REQUIRE(file.getHeader().m_pod == (unsigned int)GaitFile::BIPED);
+		REQUIRE(file.getParamCount() == 4);
+		REQUIRE(file.hasScore());
+		REQUIRE(file.getScore() == 12.5);
+		REQUIRE(file.getParams()[3] == params[3]);
+	}
+	std::vector<float> loaded;
+	REQUIRE(GaitFile::load(path, &loaded, GaitFile::BIPED, 4, 0x1234));
+	REQUIRE(loaded == params);
+	// Unchecked fields match anything
+	loaded.clear();
+	REQUIRE(GaitFile::load(path, &loaded));
+	REQUIRE(loaded == params);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("GaitFileRejectsMismatch", "[GaitFile]")
+{
+	std::string path = "gaitfiletest_mismatch.gait";
+	std::vector<float> params(4, 0.5f);
+	REQUIRE(GaitFile::save(path, GaitFile::BIPED, params, 0x1234));
+	std::vector<float> loaded(1, 5.0f);
+	REQUIRE_FALSE(GaitFile::load(path, &loaded, GaitFile::QUADRUPED, 4, 0x1234));
+	REQUIRE_FALSE(GaitFile::load(path, &loaded, GaitFile::BIPED, 5, 0x1234));
+	REQUIRE_FALSE(GaitFile::load(path, &loaded, GaitFile::BIPED, 4, 0x4321));
+	// A refused file leaves the output alone
+	REQUIRE(loaded.size() == 1);
+	REQUIRE(loaded[0] == 5.0f);
+	std::remove(path.c_str());
+	// A file saved without a schema can't be checked on layout
+	REQUIRE(GaitFile::save(path, GaitFile::BIPED, params));
+	REQUIRE(GaitFile::load(path, &loaded, GaitFile::BIPED, 4, 0x4321));
+	REQUIRE(loaded == params);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("GaitFileRejectsBrokenFile", "[GaitFile]")
+{
+	std::string path = "gaitfiletest_broken.gait";
+	std::vector<float> params(4, 1.0f);
+	REQUIRE(GaitFile::save(path, GaitFile::BIPED, params));
+	// Cut off the last parameter, the header now claims more than the file holds
+	std::vector<char> bytes;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+	REQUIRE(bytes.size() == sizeof(GaitFile::Header) + 4 * sizeof(float));
+	REQUIRE(write_file_binary(path, &bytes[0], bytes.size() - sizeof(float)));
+	GaitFile file;
+	REQUIRE_FALSE(file.open(path));
+	std::vector<float> loaded;
+	// Not read as an old float dump either
+	REQUIRE_FALSE(GaitFile::load(path, &loaded));
+	REQUIRE(loaded.empty());
+	std::remove(path.c_str());
+}
+
+TEST_CASE("GaitFileLoadsFloatDump", "[GaitFile]")
+{
+	// A gait saved before the header, a bare float array
+	std::string path = "gaitfiletest_dump.bgait";
+	std::vector<float> params;
+	for (int i = 0; i < 4; i++) params.push_back(0.25f * (float)i);
+	REQUIRE(saveFloatArray(&params, path));
+	std::vector<float> loaded;
+	REQUIRE(GaitFile::load(path, &loaded, GaitFile::BIPED, 4, 0x1234));
+	REQUIRE(loaded == params);
+	// Only the size can be checked
+	REQUIRE_FALSE(GaitFile::load(path, &loaded, GaitFile::BIPED, 3));
+	std::remove(path.c_str());
+}
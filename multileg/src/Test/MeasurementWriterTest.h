@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <MeasurementWriter.h>
+#include <CurrentPathHelper.h>
+
+TEST_CASE("MeasurementWriterBlocksInOrder", "[MeasurementWriter]")
+{
+	std::string name = "measurementwritertest.bin";
+	const unsigned int block = MeasurementWriter::BLOCK_SAMPLES;
+	MeasurementWriter writer;
+	REQUIRE(writer.start(name));
+	REQUIRE(writer.isRunning());
+	for (unsigned int i = 0; i < block + 10; i++)
+		writer.push(1, i, (float)i);
+	// A job runs after the blocks submitted before it, the partial block is still being filled
+	unsigned long long writtenAtJob = 0;
+	writer.post([&]() { writtenAtJob = writer.getSamplesWritten(); });
+	writer.wait();
+	REQUIRE(writtenAtJob == block);
+	// wait also writes the partial block
+	REQUIRE(writer.getSamplesWritten() == block + 10);
+	for (unsigned int i = 0; i < block; i++)
+		writer.push(2, i, -(float)i);
+	writer.stop();
+	REQUIRE_FALSE(writer.isRunning());
+	REQUIRE(writer.getSamplesWritten() == 2 * block + 10);
+
+	std::string path = GetExecutablePathDirectory() + name;
+	std::vector<char> bytes;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		bytes.assign((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	}
+	std::remove(path.c_str());
+	REQUIRE(bytes.size() == sizeof(MeasurementWriter::FileHeader) + (2 * block + 10) * sizeof(MeasurementWriter::Sample));
+	const MeasurementWriter::FileHeader* header = reinterpret_cast<const MeasurementWriter::FileHeader*>(&bytes[0]);
+	REQUIRE(header->m_magic == MeasurementWriter::FILE_MAGIC);
+	REQUIRE(header->m_version == MeasurementWriter::VERSION);
+	const MeasurementWriter::Sample* samples = reinterpret_cast<const MeasurementWriter::Sample*>(&bytes[sizeof(MeasurementWriter::FileHeader)]);
+	bool inOrder = true;
+	for (unsigned int i = 0; i < 2 * block + 10; i++)
+	{
+		unsigned int run = i < block + 10 ? 1 : 2;
+		unsigned int step = i < block + 10 ? i : i - block - 10;
+		float value = run == 1 ? (float)step : -(float)step;
+		inOrder = inOrder && samples[i].m_run == run && samples[i].m_step == step && samples[i].m_value == value;
+	}
+	REQUIRE(inOrder);
+}
+
+TEST_CASE("MeasurementWriterStall", "[MeasurementWriter]")
+{
+	std::string name = "measurementwritertest.bin";
+	const unsigned int block = MeasurementWriter::BLOCK_SAMPLES;
+	MeasurementWriter writer;
+	REQUIRE(writer.start(name));
+	// Hold the writer thread, the first full block is swapped out and queued behind the job
+	std::atomic<bool> release(false);
+	writer.post([&]() { while (!release) std::this_thread::yield(); });
+	for (unsigned int i = 0; i < block; i++)
+		writer.push(0, i, 0.0f);
+	std::thread releaser([&]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		release = true;
+	});
+	// The second one has nowhere to go until the first is written
+	for (unsigned int i = 0; i < block; i++)
+		writer.push(0, block + i, 0.0f);
+	releaser.join();
+	REQUIRE(writer.getStallCount() == 1);
+	writer.stop();
+	REQUIRE(writer.getSamplesWritten() == 2 * block);
+	std::remove((GetExecutablePathDirectory() + name).c_str());
+}
+
+TEST_CASE("MeasurementWriterJobsOnly", "[MeasurementWriter]")
+{
+	MeasurementWriter writer;
+	// Not started, a job runs at once
+	bool ran = false;
+	writer.post([&]() { ran = true; });
+	REQUIRE(ran);
+	REQUIRE(writer.start());
+	std::vector<int> order;
+	for (int i = 0; i < 5; i++)
+		writer.post([&order, i]() { order.push_back(i); });
+	writer.push(0, 0, 1.0f); // no file, ignored
+	writer.stop();
+	REQUIRE(order.size() == 5);
+	REQUIRE(order[4] == 4);
+	REQUIRE(writer.getSamplesWritten() == 0);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <MotionCodec.h>
+
+TEST_CASE("MotionCodecVarintRoundTrip", "[MotionCodec]")
+{
+	std::vector<unsigned char> bytes;
+	unsigned int values[] = { 0, 1, 127, 128, 300, 16383, 16384, 0xffffffff };
+	int count = sizeof(values) / sizeof(values[0]);
+	for (int i = 0; i < count; i++) MotionCodec::putVarint(bytes, values[i]);
+	REQUIRE(bytes[0] == 0);
+	REQUIRE(bytes[2] == 127); // one byte below 128
+	const unsigned char* data = &bytes[0];
+	const unsigned char* end = data + bytes.size();
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int value = 0;
+		REQUIRE(MotionCodec::getVarint(data, end, value));
+		REQUIRE(value == values[i]);
+	}
+	REQUIRE(data == end);
+}
+
+TEST_CASE("MotionCodecTruncatedVarint", "[MotionCodec]")
+{
+	std::vector<unsigned char> bytes;
+	MotionCodec::putVarint(bytes, 300);
+	REQUIRE(bytes.size() == 2);
+	const unsigned char* data = &bytes[0];
+	unsigned int value = 0;
+	REQUIRE_FALSE(MotionCodec::getVarint(data, data + 1, value));
+	int delta = 0;
+	data = &bytes[0];
+	REQUIRE_FALSE(MotionCodec::getDelta(data, data + 1, 0, delta));
+}
+
+TEST_CASE("MotionCodecDeltaRoundTrip", "[MotionCodec]")
+{
+	std::vector<unsigned char> bytes;
+	int values[] = { 0, -1, 1, -64, 63, -100000, 100000 };
+	int count = sizeof(values) / sizeof(values[0]);
+	for (int i = 0; i < count; i++) MotionCodec::putDelta(bytes, values[i], i > 0 ? values[i - 1] : 0);
+	const unsigned char* data = &bytes[0];
+	const unsigned char* end = data + bytes.size();
+	int previous = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int value = 0;
+		REQUIRE(MotionCodec::getDelta(data, end, previous, value));
+		REQUIRE(value == values[i]);
+		previous = value;
+	}
+	// Small deltas, either sign, cost a single byte
+	bytes.clear();
+	MotionCodec::putDelta(bytes, 37, 40);
+	MotionCodec::putDelta(bytes, 40, 37);
+	REQUIRE(bytes.size() == 2);
+}
+
+TEST_CASE("MotionCodecJointRoundTrip", "[MotionCodec]")
+{
+	float posStep = 0.001f, torqueStep = 0.01f;
+	glm::vec3 pos(1.25f, -0.5f, 3.0f), torque(-12.0f, 0.0f, 4.5f);
+	// Largest component negative, so the encoder has to flip the sign
+	glm::quat rot = glm::normalize(glm::quat(-0.8f, 0.1f, -0.3f, 0.2f));
+	MotionCodec::Joint zero = { { 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0 } };
+	MotionCodec::Joint joint;
+	MotionCodec::quantize(pos, rot, torque, posStep, torqueStep, joint);
+	REQUIRE(joint.m_rot[0] == 3); // w dropped
+	std::vector<unsigned char> bytes;
+	MotionCodec::putJoint(bytes, joint, zero);
+	MotionCodec::putJoint(bytes, joint, joint);
+	REQUIRE(bytes.size() > 10);
+	const unsigned char* data = &bytes[0];
+	const unsigned char* end = data + bytes.size();
+	MotionCodec::Joint first, second;
+	REQUIRE(MotionCodec::getJoint(data, end, zero, first));
+	REQUIRE(MotionCodec::getJoint(data, end, first, second));
+	REQUIRE(data == end);
+	glm::vec3 outPos, outTorque;
+	glm::quat outRot;
+	MotionCodec::dequantize(second, posStep, torqueStep, outPos, outRot, outTorque);
+	for (int i = 0; i < 3; i++)
+	{
+		REQUIRE(outPos[i] == Approx(pos[i]).epsilon(0.001));
+		REQUIRE(outTorque[i] == Approx(torque[i]).epsilon(0.01));
+	}
+	// q and -q are the same rotation
+	REQUIRE(outRot.w == Approx(-rot.w).epsilon(0.001));
+	REQUIRE(outRot.x == Approx(-rot.x).epsilon(0.001));
+	REQUIRE(outRot.y == Approx(-rot.y).epsilon(0.001));
+	REQUIRE(outRot.z == Approx(-rot.z).epsilon(0.001));
+	// A truncated joint is refused
+	data = &bytes[0];
+	REQUIRE_FALSE(MotionCodec::getJoint(data, data + 5, zero, first));
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <IOptimizable.h>
+
+// A small optimizable hierarchy, a leg of two joints and a length,
+// serialized depth first like the controllers
+struct ParamCursorTestJoint : public IOptimizable
+{
+	float m_kp, m_kd;
+	virtual void writeParams(ParamCursor& p_cursor) { p_cursor.write(m_kp); p_cursor.write(m_kd); }
+	virtual void writeParamsMax(ParamCursor& p_cursor) { p_cursor.write(100.0f); p_cursor.write(10.0f); }
+	virtual void writeParamsMin(ParamCursor& p_cursor) { p_cursor.write(0.0f); p_cursor.write(0.0f); }
+	virtual void readParams(ParamCursor& p_cursor) { p_cursor.read(&m_kp); p_cursor.read(&m_kd); }
+	virtual void describeParams(ParamSchema& p_schema) {}
+};
+
+struct ParamCursorTestLeg : public IOptimizable
+{
+	ParamCursorTestJoint m_joints[2];
+	float m_length;
+	virtual void writeParams(ParamCursor& p_cursor)
+	{
+		for (int i = 0; i < 2; i++) m_joints[i].writeParams(p_cursor);
+		p_cursor.write(m_length);
+	}
+	virtual void writeParamsMax(ParamCursor& p_cursor)
+	{
+		for (int i = 0; i < 2; i++) m_joints[i].writeParamsMax(p_cursor);
+		p_cursor.write(2.0f);
+	}
+	virtual void writeParamsMin(ParamCursor& p_cursor)
+	{
+		for (int i = 0; i < 2; i++) m_joints[i].writeParamsMin(p_cursor);
+		p_cursor.write(0.5f);
+	}
+	virtual void readParams(ParamCursor& p_cursor)
+	{
+		for (int i = 0; i < 2; i++) m_joints[i].readParams(p_cursor);
+		p_cursor.read(&m_length);
+	}
+	virtual void describeParams(ParamSchema& p_schema) {}
+};
+
+TEST_CASE("ParamCursorHierarchyRoundTrip", "[ParamCursor]")
+{
+	ParamCursorTestLeg leg;
+	leg.m_joints[0].m_kp = 50.0f; leg.m_joints[0].m_kd = 5.0f;
+	leg.m_joints[1].m_kp = 60.0f; leg.m_joints[1].m_kd = 6.0f;
+	leg.m_length = 1.25f;
+	REQUIRE(leg.getParamCount() == 5);
+	std::vector<float> params = leg.getParams();
+	REQUIRE(params.size() == 5);
+	REQUIRE(params[1] == 5.0f);
+	REQUIRE(params[2] == 60.0f); // depth first, the second joint follows the first
+	REQUIRE(params[4] == 1.25f);
+	ParamCursorTestLeg copy;
+	REQUIRE(copy.setParams(params));
+	REQUIRE(copy.m_joints[1].m_kd == 6.0f);
+	REQUIRE(copy.m_length == 1.25f);
+	std::vector<float> max = leg.getParamsMax(), min = leg.getParamsMin();
+	REQUIRE(max.size() == 5);
+	REQUIRE(max[4] == 2.0f);
+	REQUIRE(min[4] == 0.5f);
+	// Writing into a caller's buffer at an offset, as for a whole population
+	std::vector<float> population(10, -1.0f);
+	ParamCursor cursor(population.data(), (unsigned int)population.size(), 5);
+	leg.writeParams(cursor);
+	REQUIRE(cursor.isComplete());
+	REQUIRE(population[4] == -1.0f);
+	REQUIRE(population[5] == 50.0f);
+}
+
+TEST_CASE("ParamCursorOverrun", "[ParamCursor]")
+{
+	ParamCursorTestLeg leg;
+	leg.m_joints[0].m_kp = leg.m_joints[0].m_kd = 1.0f;
+	leg.m_joints[1].m_kp = leg.m_joints[1].m_kd = 2.0f;
+	leg.m_length = 3.0f;
+	// Counting has no buffer to overrun
+	ParamCursor counter;
+	leg.writeParams(counter);
+	REQUIRE(counter.m_pos == 5);
+	REQUIRE_FALSE(counter.m_overrun);
+	// A buffer one short, the last value is dropped and flagged
+	float buffer[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	ParamCursor writer(buffer, 4);
+	leg.writeParams(writer);
+	REQUIRE(writer.m_overrun);
+	REQUIRE_FALSE(writer.isComplete());
+	REQUIRE(buffer[3] == 2.0f);
+	ParamCursorTestLeg target;
+	target.m_length = 7.0f;
+	ParamCursor reader(buffer, 4);
+	target.readParams(reader);
+	REQUIRE(reader.m_overrun);
+	REQUIRE_FALSE(reader.isComplete());
+	REQUIRE(target.m_length == 7.0f);
+	// Stopping short of the end isn't complete either
+	float longer[6] = { 1.0f, 1.0f, 2.0f, 2.0f, 3.0f, 4.0f };
+	ParamCursor longReader(longer, 6);
+	target.readParams(longReader);
+	REQUIRE_FALSE(longReader.m_overrun);
+	REQUIRE_FALSE(longReader.isComplete());
+}
+
+TEST_CASE("ParamCursorConsumeSiblings", "[ParamCursor]")
+{
+	// Two legs read one after the other from one list, without copying it
+	std::vector<float> list;
+	for (int i = 0; i < 10; i++) list.push_back((float)i);
+	ParamCursorTestLeg front, back;
+	ParamCursor cursor(list.data(), (unsigned int)list.size());
+	REQUIRE(front.consumeParams(cursor));
+	REQUIRE(cursor.m_pos == 5);
+	REQUIRE(back.consumeParams(cursor));
+	REQUIRE(cursor.isComplete());
+	REQUIRE(front.m_length == 4.0f);
+	REQUIRE(back.m_joints[0].m_kp == 5.0f);
+	REQUIRE(back.m_length == 9.0f);
+	// The list ends inside the second leg
+	ParamCursor shortCursor(list.data(), 7);
+	REQUIRE(front.consumeParams(shortCursor));
+	REQUIRE_FALSE(back.consumeParams(shortCursor));
+	// setParams wants the whole layout, no more and no less
+	std::vector<float> tooLong(6, 1.0f), tooShort(4, 1.0f);
+	REQUIRE_FALSE(front.setParams(tooLong));
+	REQUIRE_FALSE(front.setParams(tooShort));
+	tooLong.pop_back();
+	REQUIRE(front.setParams(tooLong));
+}
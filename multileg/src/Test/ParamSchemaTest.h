@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <ParamSchema.h>
+
+TEST_CASE("ParamSchemaFrozenPrefix", "[ParamSchema]")
+{
+	ParamSchema schema;
+	for (int n = 0; n < 2; n++)
+	{
+		schema.pushScope(n == 0 ? "legFrame0" : "legFrame1");
+		schema.add("FhPD", 2);
+		schema.add("FhPDGain");
+		schema.pushScope("leg0");
+		schema.add("stepHeight");
+		schema.popScope();
+		schema.popScope();
+	}
+	REQUIRE(schema.getSize() == 8);
+	REQUIRE(schema.getPath(1) == "legFrame0/FhPD[1]");
+	REQUIRE(schema.getPath(3) == "legFrame0/leg0/stepHeight");
+	REQUIRE(schema.findIndex("legFrame1/FhPDGain") == 6);
+	// Whole segments only, FhPD doesn't freeze FhPDGain
+	schema.addFrozenPattern("legFrame0/FhPD");
+	REQUIRE(schema.getEntry(0).m_frozen);
+	REQUIRE(schema.getEntry(1).m_frozen);
+	REQUIRE_FALSE(schema.getEntry(2).m_frozen);
+	REQUIRE_FALSE(schema.getEntry(4).m_frozen);
+	REQUIRE(schema.getFreeCount() == 6);
+	// A scope freezes everything under it, an index only itself, a partial name nothing
+	schema.addFrozenPattern("legFrame1/leg0");
+	schema.addFrozenPattern("legFrame1/FhPD[0]");
+	schema.addFrozenPattern("legFrame");
+	REQUIRE(schema.getEntry(7).m_frozen);
+	REQUIRE(schema.getEntry(4).m_frozen);
+	REQUIRE_FALSE(schema.getEntry(5).m_frozen);
+	const std::vector<unsigned int>& free = schema.getFreeIndices();
+	REQUIRE(free.size() == 4);
+	REQUIRE(free[0] == 2);
+	REQUIRE(free[1] == 3);
+	REQUIRE(free[2] == 5);
+	REQUIRE(free[3] == 6);
+	// Only the free subset moves
+	std::vector<float> full(8, 1.0f), subset;
+	schema.gatherFree(full, subset);
+	REQUIRE(subset.size() == 4);
+	subset.assign(4, 9.0f);
+	schema.scatterFree(subset, full);
+	REQUIRE(full[0] == 1.0f);
+	REQUIRE(full[2] == 9.0f);
+	REQUIRE(full[5] == 9.0f);
+	REQUIRE(full[7] == 1.0f);
+}
+
+TEST_CASE("ParamSchemaFrozenFile", "[ParamSchema]")
+{
+	std::string path = "paramschematest.txt";
+	{
+		std::ofstream os(path.c_str());
+		os << "# frozen\n\n  spine \t\r\n#legFrame0\nlegFrame0/stepLength[1]\n";
+	}
+	ParamSchema schema;
+	schema.add("spine", 2);
+	schema.pushScope("legFrame0");
+	schema.add("stepLength", 2);
+	schema.popScope();
+	// Blank lines and comments are skipped, whitespace around a pattern is trimmed
+	REQUIRE(schema.loadFrozenPatterns(path));
+	std::remove(path.c_str());
+	REQUIRE(schema.getEntry(0).m_frozen);
+	REQUIRE(schema.getEntry(1).m_frozen);
+	REQUIRE_FALSE(schema.getEntry(2).m_frozen);
+	REQUIRE(schema.getEntry(3).m_frozen);
+	REQUIRE(schema.getFreeCount() == 1);
+	// The file is gone
+	REQUIRE_FALSE(schema.loadFrozenPatterns(path));
+}
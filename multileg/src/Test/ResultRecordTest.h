@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <ResultRecord.h>
+#include <ResultStore.h>
+#include <CurrentPathHelper.h>
+#include <FileHandler.h>
+
+TEST_CASE("ResultRecordSerialization", "[ResultRecord]")
+{
+	ResultRecord record;
+	record.setInt("chars", 8);
+	record.setDouble("mean", 1.5);
+	record.setString("exec", "Parallel");
+	std::vector<float> samples;
+	for (int i = 0; i < 5; i++) samples.push_back((float)i * 0.5f);
+	record.setFloats("samples", samples);
+	record.setInt("chars", 16); // replaces
+	record.setFloats("empty", std::vector<float>());
+	REQUIRE(record.getColumnCount() == 5);
+	std::vector<unsigned char> data;
+	record.serialize(data);
+	ResultRecord loaded;
+	REQUIRE(loaded.deserialize(&data[0], (unsigned int)data.size(), record.getColumnCount()));
+	REQUIRE(loaded.getColumnCount() == 5);
+	REQUIRE(loaded.getColumnName(0) == "chars");
+	REQUIRE(loaded.getColumnType(3) == ResultRecord::FLOATS);
+	REQUIRE(loaded.getInt("chars") == 16);
+	REQUIRE(loaded.getDouble("mean") == 1.5);
+	REQUIRE(loaded.getDouble("chars") == 16.0);
+	REQUIRE(loaded.getString("exec") == "Parallel");
+	REQUIRE(*loaded.getFloats("samples") == samples);
+	REQUIRE(loaded.getFloats("empty")->empty());
+	// Wrong type or missing column gives the default
+	REQUIRE(loaded.getInt("exec", -1) == -1);
+	REQUIRE(loaded.getFloats("mean") == NULL);
+	REQUIRE_FALSE(loaded.has("missing"));
+}
+
+TEST_CASE("ResultRecordRejectsBadData", "[ResultRecord]")
+{
+	ResultRecord record;
+	record.setString("pod", "Biped");
+	record.setDouble("p99", 4.25);
+	std::vector<unsigned char> data;
+	record.serialize(data);
+	unsigned int size = (unsigned int)data.size();
+	ResultRecord loaded;
+	REQUIRE_FALSE(loaded.deserialize(&data[0], size - 1, record.getColumnCount()));
+	REQUIRE_FALSE(loaded.deserialize(&data[0], size, record.getColumnCount() + 1));
+	data.push_back(0);
+	REQUIRE_FALSE(loaded.deserialize(&data[0], size + 1, record.getColumnCount()));
+	// An unknown column type, the type follows the name in the first column header
+	data[ResultRecord::MAX_NAME] = 9;
+	REQUIRE_FALSE(loaded.deserialize(&data[0], size, record.getColumnCount()));
+}
+
+TEST_CASE("ResultStoreSkipsCorruptRecord", "[ResultStore]")
+{
+	std::string fileName = "resultstoretest_corrupt.bin";
+	std::string path = GetExecutablePathDirectory() + fileName;
+	std::remove(path.c_str());
+	// Three runs appended to one store, as three benchmark processes would
+	size_t firstSize = 0;
+	for (long long run = 1; run <= 3; run++)
+	{
+		ResultRecord record;
+		record.setInt("run", run);
+		record.setDouble("mean", 0.5 * (double)run);
+		REQUIRE(ResultStore::append(fileName, record));
+		if (run == 1)
+		{
+			std::ifstream is(path.c_str(), std::ios::binary | std::ios::ate);
+			firstSize = (size_t)is.tellg();
+		}
+	}
+	// Damage a value of the second record, its checksum no longer matches
+	std::vector<char> data;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		data.assign((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	}
+	data[firstSize + sizeof(ResultStore::RecordHeader) + 2] ^= 0xff;
+	REQUIRE(write_file_binary(path, &data[0], data.size()));
+	std::vector<ResultRecord> records;
+	unsigned int skipped = 0;
+	REQUIRE(ResultStore::readAll(fileName, records, &skipped));
+	REQUIRE(skipped == 1);
+	REQUIRE(records.size() == 2);
+	REQUIRE(records[0].getInt("run") == 1);
+	REQUIRE(records[1].getInt("run") == 3);
+	REQUIRE(records[1].getDouble("mean") == 1.5);
+	std::remove(path.c_str());
+}
+
+TEST_CASE("ResultStoreSkipsTruncatedRecord", "[ResultStore]")
+{
+	std::string fileName = "resultstoretest_truncated.bin";
+	std::string path = GetExecutablePathDirectory() + fileName;
+	std::remove(path.c_str());
+	ResultRecord record;
+	record.setString("exec", "Serial");
+	std::vector<float> means(8, 2.0f);
+	record.setFloats("means", means);
+	REQUIRE(ResultStore::append(fileName, record));
+	record.setString("exec", "Parallel");
+	REQUIRE(ResultStore::append(fileName, record));
+	// A writer that died half way
+	std::vector<char> data;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		data.assign((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	}
+	REQUIRE(write_file_binary(path, &data[0], data.size() - 3));
+	std::vector<ResultRecord> records;
+	unsigned int skipped = 0;
+	REQUIRE(ResultStore::readAll(fileName, records, &skipped));
+	REQUIRE(skipped == 1);
+	REQUIRE(records.size() == 1);
+	REQUIRE(records[0].getString("exec") == "Serial");
+	REQUIRE(*records[0].getFloats("means") == means);
+	// The lost run appended again after the broken tail is readable
+	REQUIRE(ResultStore::append(fileName, record));
+	records.clear();
+	REQUIRE(ResultStore::readAll(fileName, records, &skipped));
+	REQUIRE(skipped == 1);
+	REQUIRE(records.size() == 2);
+	REQUIRE(records[1].getString("exec") == "Parallel");
+	std::remove(path.c_str());
+}
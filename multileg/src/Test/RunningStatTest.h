@@ -0,0 +1,70 @@
+#pragma once
+#include <RunningStat.h>
+#include <LatencyHistogram.h>
+
+TEST_CASE("RunningStatMoments", "[RunningStat]")
+{
+	// Population variance of 2,4,4,4,5,5,7,9 is 4
+	RunningStat stat;
+	double values[8] = { 2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0 };
+	for (int i = 0; i < 8; i++)
+		stat.add(values[i]);
+	REQUIRE(stat.getCount() == 8);
+	REQUIRE(stat.getSum() == Approx(40.0));
+	REQUIRE(stat.getMean() == Approx(5.0));
+	REQUIRE(stat.getVariance() == Approx(4.0));
+	REQUIRE(stat.getSTD() == Approx(2.0));
+}
+
+TEST_CASE("RunningStatEmpty", "[RunningStat]")
+{
+	RunningStat stat;
+	REQUIRE(stat.getMean() == 0.0);
+	REQUIRE(stat.getVariance() == 0.0);
+	stat.add(3.0);
+	REQUIRE(stat.getMean() == Approx(3.0));
+	REQUIRE(stat.getVariance() == 0.0); // one value has no spread
+	stat.clear();
+	REQUIRE(stat.getCount() == 0);
+	REQUIRE(stat.getMean() == 0.0);
+}
+
+TEST_CASE("LatencyHistogramPercentiles", "[LatencyHistogram]")
+{
+	// 1 to 1000 ms, a percentile is within the ~3% bucket width of the exact one
+	LatencyHistogram histogram;
+	for (int i = 1000; i >= 1; i--)
+		histogram.record((double)i);
+	REQUIRE(histogram.getCount() == 1000);
+	REQUIRE(histogram.getMax() == 1000.0);
+	REQUIRE(histogram.getPercentile(50.0) == Approx(500.0).epsilon(0.03));
+	REQUIRE(histogram.getPercentile(90.0) == Approx(900.0).epsilon(0.03));
+	REQUIRE(histogram.getPercentile(99.0) == Approx(990.0).epsilon(0.03));
+	REQUIRE(histogram.getPercentile(100.0) == 1000.0);
+	// never above the exact max
+	REQUIRE(histogram.getPercentile(99.9) <= 1000.0);
+	std::vector<float> summary;
+	histogram.getSummary(summary);
+	REQUIRE(summary.size() == 5);
+	for (unsigned int i = 1; i < summary.size(); i++)
+		REQUIRE(summary[i] >= summary[i - 1]);
+}
+
+TEST_CASE("LatencyHistogramSmallAndMerged", "[LatencyHistogram]")
+{
+	LatencyHistogram empty;
+	REQUIRE(empty.getPercentile(50.0) == 0.0);
+	// below 64 ns the buckets are 1 ns wide
+	LatencyHistogram small;
+	small.record(0.00001); // 10 ns
+	REQUIRE(small.getPercentile(50.0) == Approx(0.00001).epsilon(0.06));
+	// merging keeps the counts and the max
+	LatencyHistogram a, b;
+	for (int i = 0; i < 10; i++) a.record(1.0);
+	for (int i = 0; i < 10; i++) b.record(4.0);
+	a.add(b);
+	REQUIRE(a.getCount() == 20);
+	REQUIRE(a.getMax() == 4.0);
+	REQUIRE(a.getPercentile(25.0) == Approx(1.0).epsilon(0.03));
+	REQUIRE(a.getPercentile(75.0) == Approx(4.0).epsilon(0.03));
+}
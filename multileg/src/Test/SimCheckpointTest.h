@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <SimCheckpoint.h>
+#include <CurrentPathHelper.h>
+
+TEST_CASE("SimCheckpointRoundTrip", "[SimCheckpoint]")
+{
+	std::vector<float> transforms(12);
+	for (unsigned int i = 0; i < transforms.size(); i++) transforms[i] = (float)i * 0.25f;
+	std::vector<bool> enabled(3, true);
+	enabled[1] = false;
+	SimCheckpoint saved;
+	saved.setTick(1234);
+	saved.beginSection(SimCheckpoint::PHYSICS);
+	saved.write(99u);
+	saved.endSection();
+	saved.beginSection(SimCheckpoint::CONTROLLERS);
+	saved.writeVector(transforms);
+	saved.writeBools(enabled);
+	saved.write(2.5);
+	saved.endSection();
+	std::string name = "simcheckpointtest.schk";
+	REQUIRE(saved.save(name));
+
+	SimCheckpoint loaded;
+	REQUIRE(loaded.load(name));
+	std::remove((GetExecutablePathDirectory() + name).c_str());
+	REQUIRE(loaded.getTick() == 1234);
+	REQUIRE(loaded.getSize() == saved.getSize());
+	// Sections are found by id, in any order
+	std::vector<float> readTransforms(12, 0.0f);
+	std::vector<bool> readEnabled(3, true);
+	double value = 0.0;
+	REQUIRE(loaded.seekSection(SimCheckpoint::CONTROLLERS));
+	REQUIRE(loaded.readVector(readTransforms));
+	REQUIRE(loaded.readBools(readEnabled));
+	REQUIRE_FALSE(loaded.isSectionRead());
+	REQUIRE(loaded.read(value));
+	REQUIRE(loaded.isSectionRead());
+	REQUIRE(readTransforms == transforms);
+	REQUIRE(readEnabled == enabled);
+	REQUIRE(value == 2.5);
+	unsigned int physics = 0;
+	REQUIRE(loaded.seekSection(SimCheckpoint::PHYSICS));
+	REQUIRE(loaded.read(physics));
+	REQUIRE(physics == 99u);
+	// The check pass skips the values but still ends at the end of the section
+	std::vector<float> untouched(12, -1.0f);
+	REQUIRE(loaded.seekSection(SimCheckpoint::CONTROLLERS));
+	REQUIRE(loaded.readVector(untouched, false));
+	REQUIRE(loaded.readBools(readEnabled, false));
+	REQUIRE(loaded.skip(sizeof(double)));
+	REQUIRE(loaded.isSectionRead());
+	REQUIRE(untouched[0] == -1.0f);
+}
+
+TEST_CASE("SimCheckpointBadSection", "[SimCheckpoint]")
+{
+	SimCheckpoint checkpoint;
+	checkpoint.beginSection(SimCheckpoint::BODIES);
+	checkpoint.writeVector(std::vector<int>(4, 7));
+	checkpoint.endSection();
+	// Not written
+	REQUIRE_FALSE(checkpoint.seekSection(SimCheckpoint::CONTROLLERS));
+	REQUIRE_FALSE(checkpoint.isReadValid());
+	// Another count than the world has
+	std::vector<int> values(5, 0);
+	REQUIRE(checkpoint.seekSection(SimCheckpoint::BODIES));
+	REQUIRE_FALSE(checkpoint.readVector(values));
+	REQUIRE_FALSE(checkpoint.isReadValid());
+	REQUIRE(values[0] == 0);
+	// Past the end of the section, and nothing is read after that
+	values.resize(4);
+	int extra = 0;
+	REQUIRE(checkpoint.seekSection(SimCheckpoint::BODIES));
+	REQUIRE(checkpoint.readVector(values));
+	REQUIRE(checkpoint.isSectionRead());
+	REQUIRE_FALSE(checkpoint.read(extra));
+	REQUIRE_FALSE(checkpoint.isSectionRead());
+	REQUIRE_FALSE(checkpoint.skip(0));
+}
+
+TEST_CASE("SimCheckpointBadFile", "[SimCheckpoint]")
+{
+	SimCheckpoint saved;
+	saved.setTick(5);
+	saved.beginSection(SimCheckpoint::PHYSICS);
+	saved.write(1.0f);
+	saved.endSection();
+	std::string name = "simcheckpointtest.schk";
+	std::string path = GetExecutablePathDirectory() + name;
+	REQUIRE(saved.save(name));
+	std::vector<char> blob;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		blob.assign((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	}
+	REQUIRE(blob.size() == saved.getSize());
+
+	SimCheckpoint loaded;
+	loaded.setTick(77);
+	// Another version
+	std::vector<char> other = blob;
+	SimCheckpoint::Header header;
+	memcpy(&header, &other[0], sizeof(header));
+	header.m_version = SimCheckpoint::VERSION + 1;
+	memcpy(&other[0], &header, sizeof(header));
+	{
+		std::ofstream os(path.c_str(), std::ios::binary);
+		os.write(&other[0], other.size());
+	}
+	REQUIRE_FALSE(loaded.load(name));
+	// A flipped byte in the state
+	other = blob;
+	other.back() ^= 1;
+	{
+		std::ofstream os(path.c_str(), std::ios::binary);
+		os.write(&other[0], other.size());
+	}
+	REQUIRE_FALSE(loaded.load(name));
+	// Cut short
+	{
+		std::ofstream os(path.c_str(), std::ios::binary);
+		os.write(&blob[0], blob.size() - 1);
+	}
+	REQUIRE_FALSE(loaded.load(name));
+	// A failed load leaves the checkpoint as it was
+	REQUIRE(loaded.getTick() == 77);
+	REQUIRE(loaded.isEmpty());
+	std::remove(path.c_str());
+	REQUIRE_FALSE(loaded.load(name));
+}
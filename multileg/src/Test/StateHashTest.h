@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdio>
+#include <StateHash.h>
+#include <CurrentPathHelper.h>
+
+TEST_CASE("StateHashStable", "[StateHash]")
+{
+	// Pinned, hash streams saved by an older build must still compare equal
+	StateHash empty;
+	REQUIRE(empty.get() == 0xefd01f60ba992926ULL);
+	StateHash hash;
+	hash.add(1u);
+	hash.add(2.5f);
+	hash.add(0x0123456789abcdefULL);
+	REQUIRE(hash.get() == 0x6b8e7441cff6f1b2ULL);
+	REQUIRE(hash.get() == 0x6b8e7441cff6f1b2ULL); // get doesn't finalize the state
+}
+
+TEST_CASE("StateHashBitExact", "[StateHash]")
+{
+	float transform[3] = { 1.0f, -2.0f, 0.5f };
+	StateHash reference, bodyWise;
+	reference.add(transform, 3);
+	for (int i = 0; i < 3; i++) bodyWise.add(transform[i]);
+	REQUIRE(reference.get() == bodyWise.get());
+	// One ulp off in the last coordinate
+	union { float f; unsigned int u; } bits;
+	bits.f = transform[2];
+	bits.u ^= 1;
+	StateHash ulp;
+	ulp.add(transform, 2);
+	ulp.add(bits.f);
+	REQUIRE(ulp.get() != reference.get());
+	// Same values, other body order
+	StateHash swapped;
+	swapped.add(transform[1]);
+	swapped.add(transform[0]);
+	swapped.add(transform[2]);
+	REQUIRE(swapped.get() != reference.get());
+	// -0 compares equal as a float but is a different state
+	StateHash zero, negZero;
+	zero.add(0.0f);
+	negZero.add(-0.0f);
+	REQUIRE(zero.get() != negZero.get());
+}
+
+TEST_CASE("StateHashRecorderFirstDivergence", "[StateHash]")
+{
+	// Two bodies over three ticks, the parallel run drifts on body 1 at tick 11
+	StateHashRecorder serial, parallel;
+	serial.activate();
+	parallel.activate();
+	for (unsigned int tick = 10; tick < 13; tick++)
+	{
+		serial.beginTick(tick);
+		parallel.beginTick(tick);
+		for (unsigned int body = 0; body < 2; body++)
+		{
+			StateHash serialBody, parallelBody;
+			serialBody.add((float)(tick + body));
+			parallelBody.add((float)(tick + body) + (tick >= 11 && body == 1 ? 0.001f : 0.0f));
+			serial.addEntry(serialBody.get());
+			parallel.addEntry(parallelBody.get());
+		}
+		serial.endTick();
+		parallel.endTick();
+	}
+	REQUIRE(serial.getTickCount() == 3);
+	REQUIRE(serial.getEntryCount(1) == 2);
+	REQUIRE(serial.getTickHash(0) == parallel.getTickHash(0));
+	REQUIRE_FALSE(StateHashRecorder::compare(serial, serial).m_diverged);
+	StateHashRecorder::Divergence divergence = StateHashRecorder::compare(serial, parallel);
+	REQUIRE(divergence.m_diverged);
+	REQUIRE(divergence.m_tick == 11);
+	REQUIRE(divergence.m_entry == 1);
+	REQUIRE(StateHashRecorder::toString(divergence) == "Diverged at tick 11, entry 1");
+}
+
+TEST_CASE("StateHashRecorderLengthMismatch", "[StateHash]")
+{
+	StateHashRecorder full, truncated, fewerBodies;
+	full.activate();
+	truncated.activate();
+	fewerBodies.activate();
+	for (unsigned int tick = 0; tick < 4; tick++)
+	{
+		full.beginTick(tick);
+		full.addEntry(tick);
+		full.addEntry(tick + 100ULL);
+		full.endTick();
+		if (tick < 2)
+		{
+			truncated.beginTick(tick);
+			truncated.addEntry(tick);
+			truncated.addEntry(tick + 100ULL);
+			truncated.endTick();
+		}
+		fewerBodies.beginTick(tick);
+		fewerBodies.addEntry(tick);
+		fewerBodies.endTick();
+	}
+	// A run that stops early diverges at its first missing tick, either way round
+	StateHashRecorder::Divergence divergence = StateHashRecorder::compare(truncated, full);
+	REQUIRE(divergence.m_diverged);
+	REQUIRE(divergence.m_tick == 2);
+	REQUIRE(divergence.m_missingTick);
+	REQUIRE(StateHashRecorder::compare(full, truncated).m_tick == 2);
+	// A body missing from every tick
+	divergence = StateHashRecorder::compare(full, fewerBodies);
+	REQUIRE(divergence.m_diverged);
+	REQUIRE(divergence.m_tick == 0);
+	REQUIRE(divergence.m_entry == -1);
+	REQUIRE_FALSE(divergence.m_missingTick);
+}
+
+TEST_CASE("StateHashRecorderSaveLoad", "[StateHash]")
+{
+	StateHashRecorder saved;
+	saved.activate();
+	for (unsigned int tick = 0; tick < 3; tick++)
+	{
+		saved.beginTick(tick);
+		for (unsigned int body = 0; body <= tick; body++)
+			saved.addEntry(tick * 10ULL + body);
+		saved.endTick();
+	}
+	REQUIRE(saved.save("statehashtest.bin"));
+	StateHashRecorder loaded;
+	REQUIRE(loaded.load("statehashtest.bin"));
+	REQUIRE(loaded.getTickCount() == 3);
+	REQUIRE(loaded.getEntryCount(2) == 3);
+	REQUIRE(loaded.getEntryHash(2, 1) == 21);
+	REQUIRE_FALSE(StateHashRecorder::compare(saved, loaded).m_diverged);
+	std::remove((GetExecutablePathDirectory() + "statehashtest.bin").c_str());
+	// Nowhere to write to
+	REQUIRE_FALSE(saved.save("no_such_folder/statehashtest.bin"));
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdio>
+#include <fstream>
+#include <SweepJobFile.h>
+#include <ParamSchema.h>
+#include <CurrentPathHelper.h>
+
+TEST_CASE("SweepJobFileGrid", "[SweepJobFile]")
+{
+	std::string name = "sweepjobfiletest_grid.txt";
+	std::string path = GetExecutablePathDirectory() + name;
+	{
+		std::ofstream os(path.c_str());
+		os << "pod quadruped\n"
+			<< "horizon 400\n"
+			<< "job single 3=0.5\n"
+			<< "grid g 1=1,2,3 2=0:1:0.5 # 3x3\n"
+			<< "grid r 0=0:1:0.1\n";
+	}
+	SweepJobFile jobs;
+	REQUIRE(jobs.load(name));
+	REQUIRE(jobs.isQuadruped());
+	REQUIRE(jobs.getHorizon() == 400);
+	REQUIRE(jobs.getBaseGait() == "");
+	REQUIRE(jobs.getJobs().size() == 1 + 9 + 11);
+	REQUIRE(jobs.getJobs()[0].m_name == "single");
+	// Every combination, the first key changing slowest
+	const SweepJobFile::Job& second = jobs.getJobs()[2];
+	REQUIRE(second.m_name == "g_1");
+	REQUIRE(second.m_overrides.size() == 2);
+	REQUIRE(second.m_overrides[0].m_key == "1");
+	REQUIRE(second.m_overrides[0].m_value == 1.0f);
+	REQUIRE(second.m_overrides[1].m_value == 0.5f);
+	const SweepJobFile::Job& last = jobs.getJobs()[9];
+	REQUIRE(last.m_name == "g_8");
+	REQUIRE(last.m_overrides[0].m_value == 3.0f);
+	REQUIRE(last.m_overrides[1].m_value == 1.0f);
+	REQUIRE(SweepJobFile::toString(jobs.getJobs()[1]) == "1=1;2=0");
+	// A range is counted, 0.1 steps reach the end exactly once
+	REQUIRE(jobs.getJobs()[10].m_name == "r_0");
+	REQUIRE(jobs.getJobs()[20].m_name == "r_10");
+	REQUIRE(jobs.getJobs()[20].m_overrides[0].m_value == Approx(1.0f));
+
+	// Refused grids leave no jobs
+	const char* bad[] = {
+		"grid r 0=1:0:0.1\n",
+		"grid r 0=0:1:0\n",
+		"grid r 0=0:1\n",
+		"job j 0=1,2\n",
+		"grid big 0=0:999:1 1=0:999:1\n"
+	};
+	for (unsigned int i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+	{
+		{
+			std::ofstream os(path.c_str());
+			os << "job ok 0=1\n" << bad[i];
+		}
+		REQUIRE_FALSE(jobs.load(name));
+		REQUIRE(jobs.getError().substr(0, 7) == "line 2:");
+		REQUIRE(jobs.getJobs().empty());
+	}
+	std::remove(path.c_str());
+}
+
+TEST_CASE("SweepJobFileResolvePathPrefix", "[SweepJobFile]")
+{
+	ParamSchema schema;
+	schema.pushScope("legFrame0");
+	schema.add("FhPD", 2);
+	schema.add("FhPDx", 1);
+	schema.popScope();
+	schema.pushScope("legFrame1");
+	schema.add("FhPD", 2);
+	schema.popScope();
+	std::vector<float> base(5, 0.0f);
+
+	std::string name = "sweepjobfiletest_resolve.txt";
+	std::string path = GetExecutablePathDirectory() + name;
+	{
+		std::ofstream os(path.c_str());
+		os << "job gains legFrame0/FhPD=2\n"
+			<< "job one legFrame1/FhPD[1]=3 4=5\n"
+			<< "job frame legFrame1=7\n";
+	}
+	SweepJobFile jobs;
+	REQUIRE(jobs.load(name));
+	std::vector<std::vector<float> > params;
+	REQUIRE(jobs.resolve(schema, base, params));
+	REQUIRE(params.size() == 3);
+	// A prefix of whole segments sets both gains, not a longer name
+	REQUIRE(params[0][0] == 2.0f);
+	REQUIRE(params[0][1] == 2.0f);
+	REQUIRE(params[0][2] == 0.0f);
+	REQUIRE(params[0][3] == 0.0f);
+	// A later override of the same entry wins
+	REQUIRE(params[1][3] == 0.0f);
+	REQUIRE(params[1][4] == 5.0f);
+	REQUIRE(params[2][3] == 7.0f);
+	REQUIRE(params[2][4] == 7.0f);
+	REQUIRE(params[2][0] == 0.0f);
+	// Another layout than the base gait's
+	REQUIRE_FALSE(jobs.resolve(schema, std::vector<float>(4, 0.0f), params));
+
+	{
+		std::ofstream os(path.c_str());
+		os << "job partial legFrame0/Fh=1\n";
+	}
+	REQUIRE(jobs.load(name));
+	REQUIRE_FALSE(jobs.resolve(schema, base, params));
+	REQUIRE(jobs.getError() == "job partial: no parameter legFrame0/Fh");
+	{
+		std::ofstream os(path.c_str());
+		os << "job past 5=1\n";
+	}
+	REQUIRE(jobs.load(name));
+	REQUIRE_FALSE(jobs.resolve(schema, base, params));
+	REQUIRE(jobs.getError() == "job past: index 5 is past the last parameter");
+	std::remove(path.c_str());
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <TelemetryFeed.h>
+
+TEST_CASE("TelemetryFeedPublishRead", "[TelemetryFeed]")
+{
+	TelemetryFeed writer;
+	REQUIRE(writer.create("multilegtelemetrytest", 2, 4));
+	TelemetryFeed other;
+	REQUIRE_FALSE(other.create("multilegtelemetrytest", 2, 4)); // taken
+	TelemetryFeed reader;
+	REQUIRE(reader.attach("multilegtelemetrytest"));
+	REQUIRE_FALSE(reader.isWriter());
+	REQUIRE(reader.getMaxCharacters() == 2);
+	TelemetryFeed::Snapshot snapshot;
+	std::vector<TelemetryFeed::Character> characters;
+	REQUIRE_FALSE(reader.readLatest(snapshot, characters));
+
+	writer.setOptimizerScore(12.5);
+	for (unsigned int tick = 0; tick < 6; tick++)
+	{
+		writer.beginTick(tick, 1.0, 2.0);
+		for (int i = 0; i < 3; i++) // one past the max
+			writer.addCharacter(glm::vec3((float)tick, (float)i, 0.0f), glm::vec3(0.0f, 0.0f, 0.5f), i == 0);
+		writer.endTick();
+	}
+	REQUIRE(reader.getPublishedCount() == 6);
+	REQUIRE(reader.readLatest(snapshot, characters));
+	REQUIRE(snapshot.m_tick == 5);
+	REQUIRE(snapshot.m_physicsMs == 2.0);
+	REQUIRE(snapshot.m_optimizerScore == 12.5);
+	REQUIRE(characters.size() == 2);
+	REQUIRE(characters[1].m_position[0] == 5.0f);
+	REQUIRE(characters[1].m_position[1] == 1.0f);
+	REQUIRE(characters[1].m_velocity[2] == 0.5f);
+	REQUIRE(characters[0].m_enabled == 1);
+	REQUIRE(characters[1].m_enabled == 0);
+	// The ring holds the last four, the first two have been overwritten
+	REQUIRE(reader.read(2, snapshot, characters));
+	REQUIRE(snapshot.m_tick == 2);
+	REQUIRE_FALSE(reader.read(1, snapshot, characters));
+	REQUIRE_FALSE(reader.read(6, snapshot, characters));
+
+	// A slot being written is not read, the one before it still is
+	writer.beginTick(6, 1.0, 2.0);
+	REQUIRE_FALSE(reader.read(2, snapshot, characters));
+	REQUIRE(reader.readLatest(snapshot, characters));
+	REQUIRE(snapshot.m_tick == 5);
+	writer.endTick();
+	REQUIRE(reader.readLatest(snapshot, characters));
+	REQUIRE(snapshot.m_tick == 6);
+	REQUIRE(characters.size() == 0);
+
+	writer.close();
+	TelemetryFeed late;
+	REQUIRE_FALSE(late.attach("multilegtelemetrytest"));
+}
+
+TEST_CASE("TelemetryFeedTornReadRetry", "[TelemetryFeed]")
+{
+	// One slot, so every snapshot overwrites the one being read
+	TelemetryFeed writer;
+	REQUIRE(writer.create("multilegtelemetrytest", 64, 1));
+	TelemetryFeed reader;
+	REQUIRE(reader.attach("multilegtelemetrytest"));
+	TelemetryFeed::Snapshot snapshot;
+	std::vector<TelemetryFeed::Character> characters;
+
+	writer.beginTick(0, 0.0, 0.0);
+	writer.addCharacter(glm::vec3(0.0f), glm::vec3(0.0f), true);
+	writer.endTick();
+	writer.beginTick(1, 0.0, 0.0);
+	// Every retry finds the only slot half written
+	REQUIRE_FALSE(reader.readLatest(snapshot, characters));
+	writer.endTick();
+	REQUIRE(reader.readLatest(snapshot, characters));
+	REQUIRE(snapshot.m_tick == 1);
+
+	// Whatever is accepted while the writer runs is one whole snapshot
+	std::atomic<bool> done(false);
+	std::thread simulation([&]()
+	{
+		for (unsigned int tick = 2; tick < 20000; tick++)
+		{
+			writer.beginTick(tick, (double)tick, 0.0);
+			for (unsigned int i = 0; i < 64; i++)
+				writer.addCharacter(glm::vec3((float)tick), glm::vec3((float)i), true);
+			writer.endTick();
+		}
+		done = true;
+	});
+	bool whole = true;
+	while (!done)
+	{
+		if (!reader.readLatest(snapshot, characters) || snapshot.m_tick < 2)
+			continue;
+		whole = whole && snapshot.m_controllerMs == (double)snapshot.m_tick && characters.size() == 64;
+		for (unsigned int i = 0; i < characters.size(); i++)
+			whole = whole && characters[i].m_position[2] == (float)snapshot.m_tick && characters[i].m_velocity[0] == (float)i;
+	}
+	simulation.join();
+	REQUIRE(whole);
+	REQUIRE(reader.readLatest(snapshot, characters));
+	REQUIRE(snapshot.m_tick == 19999);
+}
@@ -3,6 +3,19 @@
 #include <MathHelp.h>
 //#include "CMatrixTest.h"
 #include "RandomTest.h"
+#include "EvaluationCacheTest.h"
+#include "ParamCursorTest.h"
+#include "ParamSchemaTest.h"
+#include "RunningStatTest.h"
+#include "StateHashTest.h"
+#include "GaitFileTest.h"
+#include "MotionCodecTest.h"
+#include "ResultRecordTest.h"
+#include "SimCheckpointTest.h"
+#include "CrowdScenarioTest.h"
+#include "MeasurementWriterTest.h"
+#include "SweepJobFileTest.h"
+#include "TelemetryFeedTest.h"
 
 // =======================================================================================
 //                                      Unit Tests
@@ -0,0 +1,294 @@
+#include "AllocTracker.h"
+#include <Windows.h>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <new>
+#include <fstream>
+#include "CurrentPathHelper.h"
+#include "ToString.h"
+
+namespace
+{
+	const char* NO_ZONE = "(no zone)";
+	const char* OTHER_ZONES = "(other zones)"; // zones past MAX_ZONES
+	std::ofstream* s_reportFile = NULL;
+}
+
+struct AllocTracker::ThreadCounters
+{
+	unsigned int m_depth;		// currently open zones
+	unsigned int m_suspended;	// the tracker itself is allocating, don't count
+	const char* m_openNames[MAX_DEPTH];
+	unsigned int m_zoneCount;
+	ZoneCount m_zones[MAX_ZONES];
+};
+
+bool AllocTracker::s_enabled = false;
+bool AllocTracker::s_expectNone = false;
+bool AllocTracker::s_abortOnViolation = false;
+unsigned int AllocTracker::s_violations = 0;
+AllocTracker::Report AllocTracker::s_lastReport = { 0, 0, 0, 0 };
+AllocTracker::ThreadCounters* AllocTracker::s_counters[MAX_THREADS] = { NULL };
+volatile long AllocTracker::s_counterCount = 0;
+__declspec(thread) AllocTracker::ThreadCounters* AllocTracker::s_threadCounters = NULL;
+
+bool AllocTracker::isCompiledIn()
+{
+#ifdef ALLOC_TRACK
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AllocTracker::setEnabled(bool p_enabled)
+{
+	s_enabled = p_enabled;
+}
+
+bool AllocTracker::isEnabled()
+{
+	return s_enabled;
+}
+
+AllocTracker::ThreadCounters* AllocTracker::getThreadCounters()
+{
+	if (s_threadCounters == NULL)
+	{
+		// First use on this thread, claim a slot. The counters are taken with
+		// malloc as new would come back here.
+		long slot = InterlockedIncrement(&s_counterCount) - 1;
+		if (slot >= (long)MAX_THREADS)
+			return NULL; // out of slots, this thread isn't counted
+		ThreadCounters* counters = (ThreadCounters*)malloc(sizeof(ThreadCounters));
+		if (counters == NULL) return NULL;
+		memset(counters, 0, sizeof(ThreadCounters));
+		s_counters[slot] = counters;
+		s_threadCounters = counters;
+	}
+	return s_threadCounters;
+}
+
+void AllocTracker::pushZone(const char* p_name)
+{
+	ThreadCounters* counters = getThreadCounters();
+	if (counters == NULL) return;
+	if (counters->m_depth < MAX_DEPTH)
+		counters->m_openNames[counters->m_depth] = p_name;
+	counters->m_depth++;
+}
+
+void AllocTracker::popZone()
+{
+	ThreadCounters* counters = s_threadCounters;
+	if (counters == NULL || counters->m_depth == 0) return;
+	counters->m_depth--;
+}
+
+void AllocTracker::recordAllocation(size_t p_bytes)
+{
+	if (!s_enabled) return;
+	ThreadCounters* counters = getThreadCounters();
+	if (counters == NULL || counters->m_suspended > 0) return;
+	// Innermost open zone, zones deeper than MAX_DEPTH count on their deepest kept parent
+	const char* name = NO_ZONE;
+	if (counters->m_depth > 0)
+		name = counters->m_openNames[(counters->m_depth < MAX_DEPTH ? counters->m_depth : MAX_DEPTH) - 1];
+	// Few distinct zones, a linear search on the name pointer is enough
+	unsigned int idx = 0;
+	while (idx < counters->m_zoneCount && counters->m_zones[idx].m_name != name)
+		idx++;
+	if (idx == counters->m_zoneCount)
+	{
+		if (counters->m_zoneCount < MAX_ZONES)
+		{
+			counters->m_zones[idx].m_name = name;
+			counters->m_zoneCount++;
+		}
+		else
+		{
+			// Table full, the last entry is reused for the rest
+			idx = MAX_ZONES - 1;
+			counters->m_zones[idx].m_name = OTHER_ZONES;
+		}
+	}
+	counters->m_zones[idx].m_count++;
+	counters->m_zones[idx].m_bytes += p_bytes;
+}
+
+const AllocTracker::Report& AllocTracker::endTick(unsigned int p_tick)
+{
+	// The report file and the abort message may allocate, don't count that on the next tick
+	ThreadCounters* own = getThreadCounters();
+	if (own != NULL) own->m_suspended++;
+
+	Report& report = s_lastReport;
+	report.m_tick = p_tick;
+	report.m_count = 0;
+	report.m_bytes = 0;
+	report.m_zoneCount = 0;
+	long threads = s_counterCount < (long)MAX_THREADS ? s_counterCount : (long)MAX_THREADS;
+	for (long t = 0; t < threads; t++)
+	{
+		ThreadCounters* counters = s_counters[t];
+		if (counters == NULL) continue;
+		for (unsigned int i = 0; i < counters->m_zoneCount; i++)
+		{
+			ZoneCount& zone = counters->m_zones[i];
+			if (zone.m_count == 0) continue;
+			// Threads are merged on the zone name, the same literal may have
+			// different addresses in different modules
+			unsigned int idx = 0;
+			while (idx < report.m_zoneCount && strcmp(report.m_zones[idx].m_name, zone.m_name) != 0)
+				idx++;
+			if (idx == report.m_zoneCount)
+			{
+				if (report.m_zoneCount == MAX_ZONES)
+					idx = MAX_ZONES - 1;
+				else
+				{
+					report.m_zones[idx].m_name = zone.m_name;
+					report.m_zones[idx].m_count = 0;
+					report.m_zones[idx].m_bytes = 0;
+					report.m_zoneCount++;
+				}
+			}
+			report.m_zones[idx].m_count += zone.m_count;
+			report.m_zones[idx].m_bytes += zone.m_bytes;
+			report.m_count += zone.m_count;
+			report.m_bytes += zone.m_bytes;
+			zone.m_count = 0;
+			zone.m_bytes = 0;
+		}
+	}
+
+	if (s_reportFile != NULL)
+	{
+		for (unsigned int i = 0; i < report.m_zoneCount; i++)
+		{
+			*s_reportFile << report.m_tick << " " << report.m_zones[i].m_name << " "
+				<< report.m_zones[i].m_count << " " << report.m_zones[i].m_bytes << "\n";
+		}
+	}
+	if (s_expectNone && report.m_count > 0)
+	{
+		s_violations++;
+		// Not an assert, the Instrumented configuration is a release build
+		if (s_abortOnViolation)
+		{
+			if (s_reportFile != NULL) s_reportFile->flush();
+			fprintf(stderr, "AllocTracker: allocation in steady state\n%s\n", toString(report).c_str());
+			abort();
+		}
+	}
+
+	if (own != NULL) own->m_suspended--;
+	return report;
+}
+
+const AllocTracker::Report& AllocTracker::getLastReport()
+{
+	return s_lastReport;
+}
+
+void AllocTracker::expectNoAllocations(bool p_expect, bool p_abort /*= false*/)
+{
+	s_expectNone = p_expect;
+	s_abortOnViolation = p_abort;
+	s_violations = 0;
+}
+
+unsigned int AllocTracker::getViolationCount()
+{
+	return s_violations;
+}
+
+bool AllocTracker::openReportFile(const std::string& p_fileName)
+{
+	closeReportFile();
+	std::ofstream* file = new std::ofstream();
+	file->open(GetExecutablePathDirectory() + p_fileName, std::ios::out);
+	if (!file->good() || !file->is_open())
+	{
+		delete file;
+		return false;
+	}
+	*file << "# tick zone allocations bytes\n";
+	s_reportFile = file;
+	return true;
+}
+
+void AllocTracker::closeReportFile()
+{
+	if (s_reportFile == NULL) return;
+	s_reportFile->close();
+	delete s_reportFile;
+	s_reportFile = NULL;
+}
+
+std::string AllocTracker::toString(const Report& p_report)
+{
+	std::string str = "Tick " + ToString(p_report.m_tick) + ": " + ToString(p_report.m_count) +
+		" allocations, " + ToString(p_report.m_bytes) + " bytes";
+	for (unsigned int i = 0; i < p_report.m_zoneCount; i++)
+	{
+		str += "\n  " + std::string(p_report.m_zones[i].m_name) + ": " + ToString(p_report.m_zones[i].m_count) +
+			" (" + ToString(p_report.m_zones[i].m_bytes) + " bytes)";
+	}
+	return str;
+}
+
+#ifdef ALLOC_TRACK
+// Global replacements, every heap allocation through new is counted. Only the
+// size is recorded so delete needs no bookkeeping.
+void* operator new(size_t p_size)
+{
+	void* ptr = malloc(p_size == 0 ? 1 : p_size);
+	if (ptr == NULL) throw std::bad_alloc();
+	AllocTracker::recordAllocation(p_size);
+	return ptr;
+}
+
+void* operator new[](size_t p_size)
+{
+	void* ptr = malloc(p_size == 0 ? 1 : p_size);
+	if (ptr == NULL) throw std::bad_alloc();
+	AllocTracker::recordAllocation(p_size);
+	return ptr;
+}
+
+void* operator new(size_t p_size, const std::nothrow_t&) throw()
+{
+	void* ptr = malloc(p_size == 0 ? 1 : p_size);
+	if (ptr != NULL) AllocTracker::recordAllocation(p_size);
+	return ptr;
+}
+
+void* operator new[](size_t p_size, const std::nothrow_t&) throw()
+{
+	void* ptr = malloc(p_size == 0 ? 1 : p_size);
+	if (ptr != NULL) AllocTracker::recordAllocation(p_size);
+	return ptr;
+}
+
+void operator delete(void* p_ptr) throw()
+{
+	free(p_ptr);
+}
+
+void operator delete[](void* p_ptr) throw()
+{
+	free(p_ptr);
+}
+
+void operator delete(void* p_ptr, const std::nothrow_t&) throw()
+{
+	free(p_ptr);
+}
+
+void operator delete[](void* p_ptr, const std::nothrow_t&) throw()
+{
+	free(p_ptr);
+}
+#endif
@@ -0,0 +1,93 @@
+#pragma once
+#include <string>
+
+// =======================================================================================
+//                                      AllocTracker
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Counts heap allocations per tick and instrumentation zone. With ALLOC_TRACK
+///			defined, the global operator new/delete are replaced and every allocation
+///			is counted, with its size, on the zone currently open on the allocating
+///			thread. Zones are the TRACE_ZONE zones of TickTrace, allocations outside
+///			of any zone are counted on "(no zone)".
+///
+///			The counters are per thread and plain data, so counting takes no locks.
+///			endTick sums and resets the counters of all threads into a per tick
+///			report, call it between ticks. In steady state a tick is expected not to
+///			allocate at all, with expectNoAllocations(true) any allocation is counted
+///			as a violation. If asked to, the first violation prints its report and
+///			aborts the process, also in release builds.
+///			Nothing is counted until setEnabled(true).
+///
+/// # AllocTracker
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+/***************************************************************************/
+/* ALLOC_TRACK replaces operator new/delete and tags the TRACE_ZONE zones, */
+/* the Instrumented configuration defines it for Util, Benchmark and       */
+/* WinApp. The replacement lives in the util library, see isCompiledIn.    */
+/***************************************************************************/
+// #define ALLOC_TRACK
+
+class AllocTracker
+{
+public:
+	static const unsigned int MAX_THREADS = 64;
+	static const unsigned int MAX_ZONES = 64;	// distinct zone names counted per thread
+	static const unsigned int MAX_DEPTH = 32;
+
+	struct ZoneCount
+	{
+		const char* m_name;
+		unsigned int m_count;
+		unsigned long long m_bytes;
+	};
+
+	struct Report
+	{
+		unsigned int m_tick;
+		unsigned int m_count;
+		unsigned long long m_bytes;
+		unsigned int m_zoneCount;
+		ZoneCount m_zones[MAX_ZONES];
+	};
+
+	// If the util library was built with ALLOC_TRACK, otherwise nothing is ever counted
+	static bool isCompiledIn();
+	static void setEnabled(bool p_enabled);
+	static bool isEnabled();
+
+	static void pushZone(const char* p_name);
+	static void popZone();
+	// Called by the replaced operator new
+	static void recordAllocation(size_t p_bytes);
+
+	// Sums and resets the counters of all threads, the result is the report of p_tick
+	static const Report& endTick(unsigned int p_tick);
+	static const Report& getLastReport();
+
+	// Steady state, ticks that allocate are counted as violations, or abort with p_abort
+	static void expectNoAllocations(bool p_expect, bool p_abort = false);
+	static unsigned int getViolationCount();
+
+	// Per tick lines (tick, zone, count, bytes) at GetExecutablePathDirectory()+p_fileName
+	static bool openReportFile(const std::string& p_fileName);
+	static void closeReportFile();
+	static std::string toString(const Report& p_report);
+private:
+	struct ThreadCounters;
+
+	static ThreadCounters* getThreadCounters();
+
+	static bool s_enabled;
+	static bool s_expectNone;
+	static bool s_abortOnViolation;
+	static unsigned int s_violations;
+	static Report s_lastReport;
+	static ThreadCounters* s_counters[MAX_THREADS];
+	static volatile long s_counterCount;
+	static __declspec(thread) ThreadCounters* s_threadCounters;
+};
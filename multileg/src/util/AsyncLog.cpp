@@ -0,0 +1,283 @@
+#include "AsyncLog.h"
+#include <Windows.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include "ConsoleContext.h"
+
+// Single producer (the owning thread), single consumer (the formatter) ring
+struct AsyncLog::ThreadRing
+{
+	std::atomic<unsigned int> m_head;	// records written, only the owning thread moves it
+	std::atomic<unsigned int> m_tail;	// records formatted, only the formatter moves it
+	unsigned long long m_pushed;		// statistics, written by the owning thread only
+	unsigned long long m_dropped;
+	Record m_records[RING_SIZE];
+};
+
+AsyncLog::ThreadRing* AsyncLog::s_rings[MAX_THREADS] = { NULL };
+volatile long AsyncLog::s_ringCount = 0;
+__declspec(thread) AsyncLog::ThreadRing* AsyncLog::s_threadRing = NULL;
+
+// Formatter state
+static std::atomic<bool> s_running(false);
+static std::thread s_formatter;
+static std::mutex s_consoleMutex;
+static std::string s_consoleText;
+static const unsigned int MAX_CONSOLE_TEXT = 8192; // the console only shows the start anyway
+
+void AsyncLog::start()
+{
+	if (s_running) return;
+	s_running = true;
+	s_formatter = std::thread(&AsyncLog::formatterLoop);
+}
+
+void AsyncLog::stop()
+{
+	if (!s_running) return;
+	s_running = false;
+	s_formatter.join();
+}
+
+bool AsyncLog::isRunning()
+{
+	return s_running;
+}
+
+AsyncLog::ThreadRing* AsyncLog::getThreadRing()
+{
+	if (s_threadRing == NULL)
+	{
+		// First record on this thread, claim a slot
+		long slot = InterlockedIncrement(&s_ringCount) - 1;
+		if (slot >= (long)MAX_THREADS)
+			return NULL; // out of slots, this thread isn't logged
+		ThreadRing* ring = new ThreadRing;
+		ring->m_head = 0;
+		ring->m_tail = 0;
+		ring->m_pushed = 0;
+		ring->m_dropped = 0;
+		s_rings[slot] = ring;
+		s_threadRing = ring;
+	}
+	return s_threadRing;
+}
+
+void AsyncLog::write(Record& p_record)
+{
+	ThreadRing* ring = getThreadRing();
+	if (ring == NULL) return;
+	unsigned int head = ring->m_head.load(std::memory_order_relaxed);
+	if (head - ring->m_tail.load(std::memory_order_acquire) >= RING_SIZE)
+	{
+		ring->m_dropped++;
+		return;
+	}
+	LARGE_INTEGER stamp;
+	QueryPerformanceCounter(&stamp);
+	p_record.m_stamp = stamp.QuadPart;
+	ring->m_records[head & (RING_SIZE - 1)] = p_record;
+	ring->m_head.store(head + 1, std::memory_order_release);
+	ring->m_pushed++;
+}
+
+void AsyncLog::push(const char* p_format)
+{
+	if (!s_running) return;
+	Record record;
+	record.m_format = p_format;
+	record.m_argCount = 0;
+	write(record);
+}
+
+void AsyncLog::push(const char* p_format, const Arg& p_a0)
+{
+	if (!s_running) return;
+	Record record;
+	record.m_format = p_format;
+	record.m_argCount = 1;
+	record.m_args[0] = p_a0;
+	write(record);
+}
+
+void AsyncLog::push(const char* p_format, const Arg& p_a0, const Arg& p_a1)
+{
+	if (!s_running) return;
+	Record record;
+	record.m_format = p_format;
+	record.m_argCount = 2;
+	record.m_args[0] = p_a0; record.m_args[1] = p_a1;
+	write(record);
+}
+
+void AsyncLog::push(const char* p_format, const Arg& p_a0, const Arg& p_a1, const Arg& p_a2)
+{
+	if (!s_running) return;
+	Record record;
+	record.m_format = p_format;
+	record.m_argCount = 3;
+	record.m_args[0] = p_a0; record.m_args[1] = p_a1; record.m_args[2] = p_a2;
+	write(record);
+}
+
+void AsyncLog::push(const char* p_format, const Arg& p_a0, const Arg& p_a1, const Arg& p_a2, const Arg& p_a3)
+{
+	if (!s_running) return;
+	Record record;
+	record.m_format = p_format;
+	record.m_argCount = 4;
+	record.m_args[0] = p_a0; record.m_args[1] = p_a1; record.m_args[2] = p_a2; record.m_args[3] = p_a3;
+	write(record);
+}
+
+void AsyncLog::flushConsole()
+{
+	std::string text;
+	{
+		std::lock_guard<std::mutex> lock(s_consoleMutex);
+		text.swap(s_consoleText);
+	}
+	if (!text.empty())
+		ConsoleContext::addMsg(text, false);
+}
+
+unsigned long long AsyncLog::getPushedCount()
+{
+	unsigned long long count = 0;
+	for (long i = 0; i < s_ringCount && i < (long)MAX_THREADS; i++)
+		if (s_rings[i] != NULL) count += s_rings[i]->m_pushed;
+	return count;
+}
+
+unsigned long long AsyncLog::getDroppedCount()
+{
+	unsigned long long count = 0;
+	for (long i = 0; i < s_ringCount && i < (long)MAX_THREADS; i++)
+		if (s_rings[i] != NULL) count += s_rings[i]->m_dropped;
+	return count;
+}
+
+static long long argToInt(const AsyncLog::Arg& p_arg)
+{
+	if (p_arg.m_type == AsyncLog::Arg::DOUBLE) return (long long)p_arg.m_double;
+	if (p_arg.m_type == AsyncLog::Arg::STRING) return 0;
+	return p_arg.m_int; // unsigned shares the bits
+}
+
+static double argToDouble(const AsyncLog::Arg& p_arg)
+{
+	if (p_arg.m_type == AsyncLog::Arg::INT) return (double)p_arg.m_int;
+	if (p_arg.m_type == AsyncLog::Arg::UINT) return (double)p_arg.m_uint;
+	if (p_arg.m_type == AsyncLog::Arg::STRING) return 0.0;
+	return p_arg.m_double;
+}
+
+std::string AsyncLog::format(const char* p_format, const Arg* p_args, unsigned int p_argCount)
+{
+	std::string text;
+	unsigned int argIdx = 0;
+	char buffer[128];
+	for (const char* c = p_format; *c != '\0'; c++)
+	{
+		if (*c != '%')
+		{
+			text += *c;
+			continue;
+		}
+		const char* specStart = c++;
+		if (*c == '%')
+		{
+			text += '%';
+			continue;
+		}
+		// Flags, width and precision are kept, the length comes from the argument type
+		std::string spec(1, '%');
+		while (*c != '\0' && strchr("-+ #0123456789.", *c) != NULL) spec += *c++;
+		while (*c != '\0' && strchr("hljztL", *c) != NULL) c++;
+		if (*c == '\0' || argIdx >= p_argCount)
+		{
+			// broken spec or missing argument, printed as is
+			if (*c == '\0') { text += specStart; break; }
+			text.append(specStart, c + 1);
+			continue;
+		}
+		const Arg& arg = p_args[argIdx];
+		switch (*c)
+		{
+		case 'd': case 'i': case 'c':
+			spec += *c == 'c' ? "c" : "lld";
+			if (*c == 'c') _snprintf_s(buffer, sizeof(buffer), _TRUNCATE, spec.c_str(), (int)argToInt(arg));
+			else _snprintf_s(buffer, sizeof(buffer), _TRUNCATE, spec.c_str(), argToInt(arg));
+			break;
+		case 'u': case 'x': case 'X': case 'o':
+			spec += "ll";
+			spec += *c;
+			_snprintf_s(buffer, sizeof(buffer), _TRUNCATE, spec.c_str(), (unsigned long long)argToInt(arg));
+			break;
+		case 'f': case 'e': case 'E': case 'g': case 'G':
+			spec += *c;
+			_snprintf_s(buffer, sizeof(buffer), _TRUNCATE, spec.c_str(), argToDouble(arg));
+			break;
+		case 's':
+			spec += 's';
+			_snprintf_s(buffer, sizeof(buffer), _TRUNCATE, spec.c_str(),
+				arg.m_type == Arg::STRING && arg.m_string != NULL ? arg.m_string : "(?)");
+			break;
+		default:
+			// unknown conversion, printed as is and the argument is kept for the next
+			text.append(specStart, c + 1);
+			continue;
+		}
+		argIdx++;
+		text += buffer;
+	}
+	return text;
+}
+
+unsigned int AsyncLog::drain()
+{
+	static std::vector<Record> batch; // formatter thread only
+	batch.clear();
+	long ringCount = s_ringCount < (long)MAX_THREADS ? s_ringCount : (long)MAX_THREADS;
+	for (long i = 0; i < ringCount; i++)
+	{
+		ThreadRing* ring = s_rings[i];
+		if (ring == NULL) continue; // slot claimed but not yet set up
+		unsigned int tail = ring->m_tail.load(std::memory_order_relaxed);
+		unsigned int head = ring->m_head.load(std::memory_order_acquire);
+		for (; tail != head; tail++)
+			batch.push_back(ring->m_records[tail & (RING_SIZE - 1)]);
+		ring->m_tail.store(tail, std::memory_order_release);
+	}
+	if (batch.empty()) return 0;
+	// Interleave the threads in the order they logged, within this batch
+	std::stable_sort(batch.begin(), batch.end(),
+		[](const Record& p_a, const Record& p_b) { return p_a.m_stamp < p_b.m_stamp; });
+	std::string text;
+	for (unsigned int i = 0; i < batch.size(); i++)
+		text += format(batch[i].m_format, batch[i].m_args, batch[i].m_argCount);
+	OutputDebugStringA(text.c_str());
+	{
+		std::lock_guard<std::mutex> lock(s_consoleMutex);
+		if (s_consoleText.size() < MAX_CONSOLE_TEXT)
+			s_consoleText += text;
+	}
+	return (unsigned int)batch.size();
+}
+
+void AsyncLog::formatterLoop()
+{
+	// Polled, so logging threads never have to wake the formatter
+	while (s_running)
+	{
+		if (drain() == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	drain();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <string>
+
+// =======================================================================================
+//                                      AsyncLog
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Logging for the hot paths, in place of DEBUGPRINT. A log call only copies
+///			its format string pointer (the format id) and raw arguments into a fixed
+///			ring buffer of the calling thread, no formatting, locks or allocations
+///			after the first call of a thread. A background thread drains the rings,
+///			formats the records printf style and sinks them to the debugger output
+///			and the console. A full ring drops the record, it never blocks.
+///
+///			Call with LOG_DEBUG("\nController System(ms): %g", ms), the format must
+///			be a string literal and take at most MAX_ARGS arguments, string arguments
+///			must be literals too. Levels below ASYNCLOG_LEVEL are compiled out with
+///			their arguments. Records are not kept without the background thread,
+///			call start() first.
+///
+/// # AsyncLog
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+#define ASYNCLOG_TRACE	0
+#define ASYNCLOG_DEBUG	1
+#define ASYNCLOG_INFO	2
+#define ASYNCLOG_WARN	3
+#define ASYNCLOG_OFF	4
+
+/***************************************************************************/
+/* ASYNCLOG_LEVEL is the lowest level compiled in, define it here or in a  */
+/* project. FORCE_DISABLE_OUTPUT removes all levels like for DEBUGPRINT    */
+/***************************************************************************/
+#ifndef ASYNCLOG_LEVEL
+#ifdef FORCE_DISABLE_OUTPUT
+#define ASYNCLOG_LEVEL ASYNCLOG_OFF
+#else
+#define ASYNCLOG_LEVEL ASYNCLOG_DEBUG
+#endif
+#endif
+
+#if ASYNCLOG_LEVEL <= ASYNCLOG_TRACE
+#define LOG_TRACE(...) AsyncLog::push(__VA_ARGS__)
+#else
+#define LOG_TRACE(...)
+#endif
+#if ASYNCLOG_LEVEL <= ASYNCLOG_DEBUG
+#define LOG_DEBUG(...) AsyncLog::push(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...)
+#endif
+#if ASYNCLOG_LEVEL <= ASYNCLOG_INFO
+#define LOG_INFO(...) AsyncLog::push(__VA_ARGS__)
+#else
+#define LOG_INFO(...)
+#endif
+#if ASYNCLOG_LEVEL <= ASYNCLOG_WARN
+#define LOG_WARN(...) AsyncLog::push(__VA_ARGS__)
+#else
+#define LOG_WARN(...)
+#endif
+
+class AsyncLog
+{
+public:
+	static const unsigned int RING_SIZE = 4096;	// records per thread, power of two
+	static const unsigned int MAX_THREADS = 64;
+	static const unsigned int MAX_ARGS = 4;
+
+	// A raw argument, converted to the type of its conversion when formatted
+	struct Arg
+	{
+		enum Type
+		{
+			INT, UINT, DOUBLE, STRING
+		};
+		Arg(int p_value)				{ m_type = INT; m_int = p_value; }
+		Arg(long p_value)				{ m_type = INT; m_int = p_value; }
+		Arg(long long p_value)			{ m_type = INT; m_int = p_value; }
+		Arg(unsigned int p_value)		{ m_type = UINT; m_uint = p_value; }
+		Arg(unsigned long p_value)		{ m_type = UINT; m_uint = p_value; }
+		Arg(unsigned long long p_value)	{ m_type = UINT; m_uint = p_value; }
+		Arg(float p_value)				{ m_type = DOUBLE; m_double = p_value; }
+		Arg(double p_value)				{ m_type = DOUBLE; m_double = p_value; }
+		Arg(const char* p_literal)		{ m_type = STRING; m_string = p_literal; }
+		Arg()							{ m_type = INT; m_int = 0; }
+
+		Type m_type;
+		union
+		{
+			long long m_int;
+			unsigned long long m_uint;
+			double m_double;
+			const char* m_string;
+		};
+	};
+
+	// Background formatter, records pushed before start are dropped
+	static void start();
+	// Formats what is left in the rings and stops the formatter
+	static void stop();
+	static bool isRunning();
+
+	static void push(const char* p_format);
+	static void push(const char* p_format, const Arg& p_a0);
+	static void push(const char* p_format, const Arg& p_a0, const Arg& p_a1);
+	static void push(const char* p_format, const Arg& p_a0, const Arg& p_a1, const Arg& p_a2);
+	static void push(const char* p_format, const Arg& p_a0, const Arg& p_a1, const Arg& p_a2, const Arg& p_a3);
+
+	// Moves the formatted text to the ConsoleContext, call from the thread refreshing the console
+	static void flushConsole();
+
+	static unsigned long long getPushedCount();
+	static unsigned long long getDroppedCount();
+
+	// Formats one record the way the background thread does
+	static std::string format(const char* p_format, const Arg* p_args, unsigned int p_argCount);
+private:
+	struct Record
+	{
+		const char* m_format;
+		long long m_stamp;	// performance counter, orders the records of different threads
+		unsigned int m_argCount;
+		Arg m_args[MAX_ARGS];
+	};
+	struct ThreadRing;
+
+	static ThreadRing* getThreadRing();
+	static void write(Record& p_record);
+	// Formats and sinks the records in the rings, returns how many there were
+	static unsigned int drain();
+	static void formatterLoop();
+
+	static ThreadRing* s_rings[MAX_THREADS];
+	static volatile long s_ringCount;
+	static __declspec(thread) ThreadRing* s_threadRing;
+};
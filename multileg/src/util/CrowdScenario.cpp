@@ -0,0 +1,224 @@
+#include "CrowdScenario.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include "CurrentPathHelper.h"
+#include "ToString.h"
+
+namespace
+{
+	bool parseFloat(const std::string& p_text, float& p_outValue)
+	{
+		char* end = NULL;
+		p_outValue = (float)strtod(p_text.c_str(), &end);
+		return p_text != "" && *end == '\0';
+	}
+
+	bool parseUInt(const std::string& p_text, unsigned int& p_outValue)
+	{
+		char* end = NULL;
+		long value = strtol(p_text.c_str(), &end, 10);
+		p_outValue = (unsigned int)value;
+		return p_text != "" && *end == '\0' && value >= 0;
+	}
+
+	bool parseVec3(const std::string& p_text, glm::vec3& p_outValue)
+	{
+		std::stringstream list(p_text);
+		std::string component;
+		int i = 0;
+		while (std::getline(list, component, ','))
+		{
+			if (i > 2 || !parseFloat(component, p_outValue[i]))
+				return false;
+			i++;
+		}
+		return i == 3;
+	}
+
+	// 32 bits from a 64 bit LCG, the same sequence for a seed with every compiler
+	float nextUniform(unsigned long long& p_state)
+	{
+		p_state = p_state * 6364136223846793005ULL + 1442695040888963407ULL;
+		return (float)((double)(p_state >> 32) / 4294967296.0);
+	}
+}
+
+bool CrowdScenario::load(const std::string& p_fileName)
+{
+	clear();
+	std::ifstream is((GetExecutablePathDirectory() + p_fileName).c_str());
+	if (!is.good() || !is.is_open())
+		return fail("could not open " + p_fileName);
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(is, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line = line.substr(0, comment);
+		if (!parseLine(line))
+		{
+			m_error = "line " + ToString(lineNumber) + ": " + m_error;
+			m_templates.clear();
+			m_instances.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+void CrowdScenario::clear()
+{
+	m_templates.clear();
+	m_instances.clear();
+	m_error = "";
+}
+
+const std::vector<CrowdScenario::Template>& CrowdScenario::getTemplates() const
+{
+	return m_templates;
+}
+
+const std::vector<CrowdScenario::Instance>& CrowdScenario::getInstances() const
+{
+	return m_instances;
+}
+
+unsigned int CrowdScenario::getInstanceCount() const
+{
+	return (unsigned int)m_instances.size();
+}
+
+unsigned int CrowdScenario::getPodCount(Pod p_pod) const
+{
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < m_instances.size(); i++)
+	{
+		if (m_templates[m_instances[i].m_template].m_pod == p_pod)
+			count++;
+	}
+	return count;
+}
+
+const std::string& CrowdScenario::getError() const
+{
+	return m_error;
+}
+
+bool CrowdScenario::parseLine(const std::string& p_line)
+{
+	std::stringstream words(p_line);
+	std::string statement, name;
+	if (!(words >> statement))
+		return true; // empty
+	if (!(words >> name))
+		return fail(statement + " without a template name");
+	if (statement == "template")
+	{
+		for (unsigned int i = 0; i < m_templates.size(); i++)
+		{
+			if (m_templates[i].m_name == name)
+				return fail("template " + name + " declared twice");
+		}
+		Template declared;
+		declared.m_name = name;
+		std::string pod;
+		words >> pod;
+		if (pod == "biped") declared.m_pod = BIPED;
+		else if (pod == "quadruped") declared.m_pod = QUADRUPED;
+		else return fail("template " + name + " needs biped or quadruped, not '" + pod + "'");
+		std::string option;
+		while (words >> option)
+		{
+			size_t split = option.find('=');
+			if (split == std::string::npos)
+				return fail("expected name=value, not '" + option + "'");
+			std::string key = option.substr(0, split), value = option.substr(split + 1);
+			float dimension = 0.0f;
+			if (key == "gait")
+				declared.m_gaitFile = value;
+			else if (parseFloat(value, dimension))
+				declared.m_dimensions.push_back(std::make_pair(key, dimension));
+			else
+				return fail("bad value for " + key);
+		}
+		m_templates.push_back(declared);
+		return true;
+	}
+
+	// Placements
+	unsigned int templateIdx = (unsigned int)m_templates.size();
+	for (unsigned int i = 0; i < m_templates.size(); i++)
+	{
+		if (m_templates[i].m_name == name)
+			templateIdx = i;
+	}
+	if (templateIdx == m_templates.size())
+		return fail("unknown template " + name);
+	Instance instance;
+	instance.m_template = templateIdx;
+	instance.m_position = glm::vec3(0.0f);
+	instance.m_goalVelocity = glm::vec3(0.0f, 0.0f, 0.5f);
+	if (statement == "place")
+	{
+		std::string position;
+		words >> position;
+		if (!parseVec3(position, instance.m_position))
+			return fail("place needs a position x,y,z");
+	}
+	else if (statement != "grid" && statement != "scatter")
+		return fail("unknown statement " + statement);
+
+	unsigned int count = 1, columns = 1, seed = 1;
+	glm::vec3 origin(0.0f), spacing(3.0f, 0.0f, 3.0f), boxMin(0.0f), boxMax(0.0f);
+	bool hasCount = false, hasColumns = false, hasMin = false, hasMax = false;
+	std::string option;
+	while (words >> option)
+	{
+		size_t split = option.find('=');
+		if (split == std::string::npos)
+			return fail("expected name=value, not '" + option + "'");
+		std::string key = option.substr(0, split), value = option.substr(split + 1);
+		bool parsed = false;
+		if (key == "velocity") parsed = parseVec3(value, instance.m_goalVelocity);
+		else if (statement == "place") parsed = false;
+		else if (key == "count") parsed = hasCount = parseUInt(value, count);
+		else if (key == "seed") parsed = parseUInt(value, seed);
+		else if (statement == "grid" && key == "columns") parsed = hasColumns = parseUInt(value, columns) && columns > 0;
+		else if (statement == "grid" && key == "origin") parsed = parseVec3(value, origin);
+		else if (statement == "grid" && key == "spacing") parsed = parseVec3(value, spacing);
+		else if (statement == "scatter" && key == "min") parsed = hasMin = parseVec3(value, boxMin);
+		else if (statement == "scatter" && key == "max") parsed = hasMax = parseVec3(value, boxMax);
+		if (!parsed)
+			return fail("bad or unknown option " + key + " for " + statement);
+	}
+	if (statement == "grid" && (!hasCount || !hasColumns))
+		return fail("grid needs count and columns");
+	if (statement == "scatter" && (!hasCount || !hasMin || !hasMax))
+		return fail("scatter needs count, min and max");
+	if (statement == "scatter" && (boxMin.x > boxMax.x || boxMin.y > boxMax.y || boxMin.z > boxMax.z))
+		return fail("scatter min is above its max");
+
+	m_instances.reserve(m_instances.size() + count);
+	unsigned long long random = seed;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (statement == "grid")
+			instance.m_position = origin + glm::vec3((float)(i % columns), 0.0f, (float)(i / columns)) * spacing;
+		else if (statement == "scatter")
+		{
+			for (int n = 0; n < 3; n++)
+				instance.m_position[n] = boxMin[n] + (boxMax[n] - boxMin[n]) * nextUniform(random);
+		}
+		m_instances.push_back(instance);
+	}
+	return true;
+}
+
+bool CrowdScenario::fail(const std::string& p_message)
+{
+	m_error = p_message;
+	return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm\gtc\type_ptr.hpp>
+
+// =======================================================================================
+//                                      CrowdScenario
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Text file declaring a crowd, as character templates and placements of
+///			them, instead of one pod type in a row. One statement per line, '#'
+///			starts a comment, vectors are written x,y,z:
+///
+///			template name biped|quadruped [gait=file] [dimension=value ...]
+///			grid name count=n columns=n [origin=x,y,z] [spacing=x,y,z] [velocity=x,y,z]
+///			scatter name count=n min=x,y,z max=x,y,z [seed=n] [velocity=x,y,z]
+///			place name x,y,z [velocity=x,y,z]
+///
+///			A template is a pod type, optionally a gait file (in ../output/sav/) and
+///			the body part sizes that differ from CharacterFactory::Dimensions, by
+///			member name without m_. A scale is applied first and scales the other
+///			defaults. A grid is filled row by row along x, a scatter is uniform in
+///			its box from its seed, so the same file gives the same crowd. The goal
+///			velocity defaults to the controllers' 0,0,0.5.
+///
+///			The instances are listed in file order, that is the character index.
+///			Spawning is done by CharacterFactory::createCrowd.
+///
+/// # CrowdScenario
+///
+/// 19-10-2026
+///---------------------------------------------------------------------------------------
+
+class CrowdScenario
+{
+public:
+	// Same values as GaitFile::Pod
+	enum Pod
+	{
+		BIPED = 0,
+		QUADRUPED = 1
+	};
+
+	struct Template
+	{
+		std::string m_name;
+		Pod m_pod;
+		std::string m_gaitFile; // empty for the built-in gait
+		std::vector<std::pair<std::string, float> > m_dimensions; // in file order
+	};
+
+	struct Instance
+	{
+		unsigned int m_template;
+		glm::vec3 m_position;
+		glm::vec3 m_goalVelocity;
+	};
+
+	// From GetExecutablePathDirectory()+p_fileName, on failure getError tells the line
+	bool load(const std::string& p_fileName);
+	void clear();
+
+	const std::vector<Template>& getTemplates() const;
+	const std::vector<Instance>& getInstances() const;
+	unsigned int getInstanceCount() const;
+	// Number of instances of the pod type
+	unsigned int getPodCount(Pod p_pod) const;
+	const std::string& getError() const;
+private:
+	bool parseLine(const std::string& p_line);
+	bool fail(const std::string& p_message);
+
+	std::vector<Template> m_templates;
+	std::vector<Instance> m_instances;
+	std::string m_error;
+};
@@ -0,0 +1,141 @@
+#include "EvaluationCache.h"
+#include <fstream>
+#include <cmath>
+
+EvaluationCache::EvaluationCache(float p_quantum /*= 0.0001f*/)
+{
+	m_quantum = p_quantum;
+	m_contextKey = HASH_SEED;
+	m_hits = 0;
+	m_misses = 0;
+}
+
+unsigned long long EvaluationCache::hash(const void* p_data, size_t p_bytes,
+	unsigned long long p_seed /*= HASH_SEED*/)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(p_data);
+	unsigned long long h = p_seed;
+	for (size_t i = 0; i < p_bytes; i++)
+	{
+		h ^= (unsigned long long)bytes[i];
+		h *= 1099511628211ULL; // FNV-1a prime
+	}
+	return h;
+}
+
+void EvaluationCache::setContextKey(unsigned long long p_contextKey)
+{
+	m_contextKey = p_contextKey;
+}
+
+unsigned long long EvaluationCache::getContextKey() const
+{
+	return m_contextKey;
+}
+
+unsigned long long EvaluationCache::makeKey(const std::vector<float>& p_params) const
+{
+	unsigned int count = (unsigned int)p_params.size();
+	unsigned long long h = hash(&count, sizeof(count), m_contextKey);
+	double invQuantum = 1.0 / (double)m_quantum;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		// Quantize so that round-off from serialization does not produce new keys
+		long long q = (long long)floor((double)p_params[i] * invQuantum + 0.5);
+		h = hash(&q, sizeof(q), h);
+	}
+	return h;
+}
+
+bool EvaluationCache::lookup(unsigned long long p_key, Entry& p_outEntry)
+{
+	auto it = m_entries.find(p_key);
+	if (it != m_entries.end())
+	{
+		p_outEntry = it->second;
+		m_hits++;
+		return true;
+	}
+	m_misses++;
+	return false;
+}
+
+bool EvaluationCache::contains(unsigned long long p_key) const
+{
+	return m_entries.find(p_key) != m_entries.end();
+}
+
+void EvaluationCache::insert(unsigned long long p_key, const Entry& p_entry)
+{
+	m_entries[p_key] = p_entry;
+}
+
+unsigned int EvaluationCache::getHits() const
+{
+	return m_hits;
+}
+
+unsigned int EvaluationCache::getMisses() const
+{
+	return m_misses;
+}
+
+double EvaluationCache::getHitRate() const
+{
+	unsigned int total = m_hits + m_misses;
+	if (total == 0) return 0.0;
+	return (double)m_hits / (double)total;
+}
+
+unsigned int EvaluationCache::getSize() const
+{
+	return (unsigned int)m_entries.size();
+}
+
+void EvaluationCache::resetStats()
+{
+	m_hits = 0;
+	m_misses = 0;
+}
+
+bool EvaluationCache::save(const std::string& p_filePath) const
+{
+	std::ofstream os;
+	os.open(p_filePath, std::ios::binary | std::ios::out);
+	if (!os.good() || !os.is_open())
+		return false;
+	unsigned int header[3] = { FILE_MAGIC, FILE_VERSION, (unsigned int)m_entries.size() };
+	os.write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		os.write(reinterpret_cast<const char*>(&it->first), sizeof(it->first));
+		os.write(reinterpret_cast<const char*>(&it->second), sizeof(Entry));
+	}
+	bool ok = os.good();
+	os.close();
+	return ok;
+}
+
+bool EvaluationCache::load(const std::string& p_filePath)
+{
+	std::ifstream is;
+	is.open(p_filePath.c_str(), std::ios::binary | std::ios::in);
+	if (!is.good() || !is.is_open())
+		return false;
+	unsigned int header[3] = { 0, 0, 0 };
+	is.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!is.good() || header[0] != FILE_MAGIC || header[1] != FILE_VERSION)
+		return false;
+	m_entries.reserve(m_entries.size() + header[2]);
+	for (unsigned int i = 0; i < header[2]; i++)
+	{
+		unsigned long long key = 0;
+		Entry entry;
+		is.read(reinterpret_cast<char*>(&key), sizeof(key));
+		is.read(reinterpret_cast<char*>(&entry), sizeof(Entry));
+		if (!is.good()) return false; // keep what was read before a truncation
+		m_entries[key] = entry;
+	}
+	is.close();
+	return true;
+}
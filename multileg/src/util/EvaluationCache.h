@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// =======================================================================================
+//                                      EvaluationCache
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Cache of optimization evaluations, keyed by a hash of the quantized
+///			parameter vector combined with a context key (pod type, sim settings).
+///			Stores the full objective breakdown so a hit can be reported as if it
+///			was evaluated. Can be persisted to and loaded from a binary file.
+///
+/// # EvaluationCache
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class EvaluationCache
+{
+public:
+	struct Entry
+	{
+		double m_fd, m_fv, m_fh, m_fr, m_fp; // unweighted objective terms
+		double m_score; // weighted result, fobj
+	};
+
+	static const unsigned long long HASH_SEED = 14695981039346656037ULL; // FNV-1a offset basis
+
+	EvaluationCache(float p_quantum = 0.0001f);
+	virtual ~EvaluationCache() {}
+
+	// FNV-1a hash of raw bytes, chainable through the seed
+	static unsigned long long hash(const void* p_data, size_t p_bytes, unsigned long long p_seed = HASH_SEED);
+
+	// The context key is folded into every parameter key, so entries from
+	// different pods or sim settings never collide
+	void setContextKey(unsigned long long p_contextKey);
+	unsigned long long getContextKey() const;
+
+	unsigned long long makeKey(const std::vector<float>& p_params) const;
+
+	// Counts as a hit or a miss
+	bool lookup(unsigned long long p_key, Entry& p_outEntry);
+	// Does not affect hit statistics
+	bool contains(unsigned long long p_key) const;
+	void insert(unsigned long long p_key, const Entry& p_entry);
+
+	unsigned int getHits() const;
+	unsigned int getMisses() const;
+	double getHitRate() const;
+	unsigned int getSize() const;
+	void resetStats();
+
+	bool save(const std::string& p_filePath) const;
+	bool load(const std::string& p_filePath);
+private:
+	static const unsigned int FILE_MAGIC = 0x48434345; // "ECCH"
+	static const unsigned int FILE_VERSION = 2;
+
+	float m_quantum;
+	unsigned long long m_contextKey;
+	unsigned int m_hits, m_misses;
+	std::unordered_map<unsigned long long, Entry> m_entries;
+};
@@ -5,6 +5,7 @@
 #include "CurrentPathHelper.h"
 #include <windows.h>
 #include "StrTools.h"
+#include "GaitFile.h"
 
 bool write_file_binary(std::string const & filename,
 	char const * data, size_t const bytes)
@@ -48,14 +49,8 @@ bool loadFloatArray(std::vector<float>* p_outData,
 	{
 		int members = bytelength / sizeof(float);
 		p_outData->resize(members);
-		float* tArr = new float[members]; // temp buffer array
 		is.seekg(0, std::ios::beg); // place at start
-		is.read(reinterpret_cast<char*>(tArr), bytelength); // read data to buffer
-		for (int i = 0; i < members; i++) // copy to vector
-		{
-			(*p_outData)[i] = tArr[i];
-		}
-		delete[] tArr;
+		is.read(reinterpret_cast<char*>(&(*p_outData)[0]), members*sizeof(float)); // read data straight to vector
 	}
 	is.close();
 	return true;
@@ -63,7 +58,16 @@ bool loadFloatArray(std::vector<float>* p_outData,
 
 
 
-void saveFloatArrayPrompt(std::vector<float>* p_inData, int p_fileTypeIdx)
+// File type index 2 is the biped and 3 the quadruped filter
+static unsigned int gaitFilePod(int p_fileTypeIdx)
+{
+	if (p_fileTypeIdx == 2) return GaitFile::BIPED;
+	if (p_fileTypeIdx == 3) return GaitFile::QUADRUPED;
+	return GaitFile::ANY_POD;
+}
+
+void saveFloatArrayPrompt(std::vector<float>* p_inData, int p_fileTypeIdx,
+	unsigned long long p_schemaHash, const double* p_score)
 {
 	std::string path = "../output/sav/biptest";
 #ifndef _DEBUG
@@ -85,15 +89,17 @@ void saveFloatArrayPrompt(std::vector<float>* p_inData, int p_fileTypeIdx)
 	if (hasFileName)
 	{
 		path = ofn.lpstrFile;
-		saveFloatArray(p_inData, path);
+		GaitFile::save(path, gaitFilePod(p_fileTypeIdx), *p_inData, p_schemaHash, p_score);
 	}
 #else
-	saveFloatArray(p_inData, path);
+	GaitFile::save(path, gaitFilePod(p_fileTypeIdx), *p_inData, p_schemaHash, p_score);
 #endif
 	//MessageBox(NULL, ofn.lpstrFile, "File Name", MB_OK);
 }
-void loadFloatArrayPrompt(std::vector<float>*& p_outData, int p_fileTypeIdx)
+bool loadFloatArrayPrompt(std::vector<float>*& p_outData, int p_fileTypeIdx,
+	unsigned int p_paramCount/* = 0*/, unsigned long long p_schemaHash/* = 0*/)
 {
+	bool res = false;
 	std::string path = "../output/sav/biptest";
 #ifndef _DEBUG
 	OPENFILENAME ofn;
@@ -116,14 +122,15 @@ void loadFloatArrayPrompt(std::vector<float>*& p_outData, int p_fileTypeIdx)
 		if (p_outData == NULL)
 			p_outData = new std::vector<float>();
 		path = ofn.lpstrFile;
-		loadFloatArray(p_outData, path);
+		res = GaitFile::load(path, p_outData, gaitFilePod(p_fileTypeIdx), p_paramCount, p_schemaHash);
 	}
 #else
 	if (p_outData == NULL)
 		p_outData = new std::vector<float>();
-	loadFloatArray(p_outData, path);
+	res = GaitFile::load(path, p_outData, gaitFilePod(p_fileTypeIdx), p_paramCount, p_schemaHash);
 #endif
 	//MessageBox(NULL, ofn.lpstrFile, "File Name", MB_OK);
+	return res;
 }
 
 bool writeSettings(SettingsData& p_settingsfile)
@@ -316,78 +323,6 @@ bool loadSettings(SettingsData& p_settingsfile)
 	return true;
 }
 
-bool saveMeasurementToCollectionFileAtRow(std::string& p_filePath, float p_average, float p_std, int p_rowIdx)
-{
-	std::string exePathPrefix = GetExecutablePathDirectory();
-	std::string path = exePathPrefix + p_filePath;
-	std::vector<std::string> rows;
-	// existing file
-	std::ifstream is;
-	is.open(path.c_str(), std::ios::in);
-	if (!is.good() || !is.is_open())
-		return false;
-	//is>>length; // read size
-	std::string tmpStr;
-	// read all
-	while (!is.eof())
-	{
-		std::getline(is, tmpStr);
-		if (tmpStr!="") rows.push_back(tmpStr);
-	}
-	is.close();
-
-	// Find the row with the right index (the first character denotes the index)
-	int vectorIdx = -1;
-	int lastIdx = 0;
-	for (int i = 0; i < rows.size(); i++)
-	{
-		std::string firstChars = rows[i].substr(0, rows[i].find(" "));
-		if (firstChars != "#" && firstChars != "")
-		{
-			int idx = stringToInt(firstChars);
-			lastIdx = idx;
-			if (p_rowIdx == idx)
-			{
-				vectorIdx = i;
-				break;
-			}
-		}
-	}
-	if (vectorIdx == -1) // not found
-	{
-		vectorIdx=rows.size()-1;
-		while (lastIdx<p_rowIdx)
-		{
-			lastIdx++;
-			vectorIdx++;
-			rows.push_back(ToString(lastIdx) + " 0 0 0 0");
-		}
-	}
-
-	float ylow = p_average - p_std, yhigh = p_average + p_std;
-	std::string newRow = ToString(p_rowIdx) + " " + ToString(p_average) + " " + ToString(p_std) + " " + ToString(ylow) + " " + ToString(yhigh);
-	// replace
-	rows[vectorIdx] = newRow;
-
-
-	// now write
-	std::ofstream os;
-	os.open(path, std::ios::out);
-	if (!os.good() || !os.is_open())
-		return false;
-
-	for (int i = 0; i < rows.size(); i++)
-	{
-		os << rows[i]<<"\n";
-	}
-
-	//os<<length; // write size
-	//size_t length = p_inData->size();
-	//os.write(reinterpret_cast<char*>(&(*p_inData)[0]),
-	//	std::streamsize(length*sizeof(float))); // write data
-	os.close();
-}
-
 std::string getAutoLoadFilenameSetting(const std::string& p_autoloadFilePath)
 {
 	std::string exePathPrefix = GetExecutablePathDirectory();
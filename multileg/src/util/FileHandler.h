@@ -12,14 +12,16 @@ bool saveFloatArray(std::vector<float>* p_inData, const std::string& file_path);
 bool loadFloatArray(std::vector<float>* p_outData, const std::string& file_path);
 
 
-void saveFloatArrayPrompt(std::vector<float>* p_inData, int p_fileTypeIdx);
+// Saved as GaitFile, loading also accepts the old raw float dumps
+void saveFloatArrayPrompt(std::vector<float>* p_inData, int p_fileTypeIdx,
+	unsigned long long p_schemaHash = 0, const double* p_score = NULL);
 
-void loadFloatArrayPrompt(std::vector<float>*& p_outData, int p_fileTypeIdx);
+// Returns false if no file was picked or it does not match the pod, count or layout hash (0 matches any)
+bool loadFloatArrayPrompt(std::vector<float>*& p_outData, int p_fileTypeIdx,
+	unsigned int p_paramCount = 0, unsigned long long p_schemaHash = 0);
 
 bool writeSettings(SettingsData& p_settingsfile);
 
 bool loadSettings(SettingsData& p_settingsfile);
 
-bool saveMeasurementToCollectionFileAtRow(std::string& p_filePath, float p_average, float p_std, int p_rowIdx);
-
 std::string getAutoLoadFilenameSetting(const std::string& p_autoloadFilePath);
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "GaitFile.h"
+#include <fstream>
+#include "FileHandler.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+GaitFile::GaitFile()
+{
+	m_header = NULL;
+	m_view = NULL;
+	m_viewSize = 0;
+#ifdef _WIN32
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+#else
+	m_file = -1;
+#endif
+}
+
+GaitFile::~GaitFile()
+{
+	close();
+}
+
+bool GaitFile::open(const std::string& p_filePath)
+{
+	close();
+#ifdef _WIN32
+	m_file = CreateFileA(p_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart < (LONGLONG)sizeof(Header))
+	{
+		close();
+		return false;
+	}
+	m_viewSize = (size_t)size.QuadPart;
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping == NULL)
+	{
+		close();
+		return false;
+	}
+	m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	m_file = ::open(p_filePath.c_str(), O_RDONLY);
+	if (m_file == -1)
+		return false;
+	struct stat st;
+	if (fstat(m_file, &st) != 0 || st.st_size < (off_t)sizeof(Header))
+	{
+		close();
+		return false;
+	}
+	m_viewSize = (size_t)st.st_size;
+	m_view = mmap(NULL, m_viewSize, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (m_view == MAP_FAILED) m_view = NULL;
+#endif
+	if (m_view == NULL)
+	{
+		close();
+		return false;
+	}
+	// The header must describe what is actually in the file
+	const Header* header = static_cast<const Header*>(m_view);
+	if (header->m_magic != MAGIC || header->m_version != VERSION ||
+		header->m_dataOffset < sizeof(Header) || header->m_dataOffset % sizeof(float) != 0 ||
+		header->m_dataOffset > m_viewSize ||
+		(m_viewSize - header->m_dataOffset) / sizeof(float) < header->m_paramCount)
+	{
+		close();
+		return false;
+	}
+	m_header = header;
+	return true;
+}
+
+void GaitFile::close()
+{
+	m_header = NULL;
+#ifdef _WIN32
+	if (m_view != NULL) UnmapViewOfFile(m_view);
+	if (m_mapping != NULL) CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+	m_mapping = NULL;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (m_view != NULL) munmap(const_cast<void*>(m_view), m_viewSize);
+	if (m_file != -1) ::close(m_file);
+	m_file = -1;
+#endif
+	m_view = NULL;
+	m_viewSize = 0;
+}
+
+bool GaitFile::isOpen() const
+{
+	return m_header != NULL;
+}
+
+const GaitFile::Header& GaitFile::getHeader() const
+{
+	return *m_header;
+}
+
+const float* GaitFile::getParams() const
+{
+	return reinterpret_cast<const float*>(static_cast<const char*>(m_view) + m_header->m_dataOffset);
+}
+
+unsigned int GaitFile::getParamCount() const
+{
+	return m_header->m_paramCount;
+}
+
+bool GaitFile::hasScore() const
+{
+	return (m_header->m_flags & HAS_SCORE) != 0;
+}
+
+double GaitFile::getScore() const
+{
+	return m_header->m_score;
+}
+
+bool GaitFile::matches(unsigned int p_pod, unsigned int p_paramCount, unsigned long long p_schemaHash) const
+{
+	if (!isOpen()) return false;
+	if (p_pod != ANY_POD && m_header->m_pod != p_pod) return false;
+	if (p_paramCount != 0 && m_header->m_paramCount != p_paramCount) return false;
+	if (p_schemaHash != 0 && m_header->m_schemaHash != 0 && m_header->m_schemaHash != p_schemaHash) return false;
+	return true;
+}
+
+bool GaitFile::save(const std::string& p_filePath, unsigned int p_pod, const std::vector<float>& p_params,
+	unsigned long long p_schemaHash /*= 0*/, const double* p_score /*= NULL*/)
+{
+	Header header;
+	header.m_magic = MAGIC;
+	header.m_version = VERSION;
+	header.m_pod = p_pod;
+	header.m_paramCount = (unsigned int)p_params.size();
+	header.m_schemaHash = p_schemaHash;
+	header.m_flags = p_score != NULL ? HAS_SCORE : 0;
+	header.m_dataOffset = sizeof(Header);
+	header.m_score = p_score != NULL ? *p_score : 0.0;
+	std::ofstream os;
+	os.open(p_filePath, std::ios::binary | std::ios::out);
+	if (!os.good() || !os.is_open())
+		return false;
+	os.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	if (!p_params.empty())
+		os.write(reinterpret_cast<const char*>(&p_params[0]), std::streamsize(p_params.size()*sizeof(float)));
+	bool res = os.good();
+	os.close();
+	return res;
+}
+
+bool GaitFile::load(const std::string& p_filePath, std::vector<float>* p_outParams,
+	unsigned int p_pod /*= ANY_POD*/, unsigned int p_paramCount /*= 0*/, unsigned long long p_schemaHash /*= 0*/)
+{
+	GaitFile file;
+	if (file.open(p_filePath))
+	{
+		if (!file.matches(p_pod, p_paramCount, p_schemaHash))
+			return false;
+		p_outParams->assign(file.getParams(), file.getParams() + file.getParamCount());
+		return true;
+	}
+	// Not a gait file, read it as an old float dump. Those can only be checked on size.
+	std::ifstream is;
+	is.open(p_filePath.c_str(), std::ios::binary | std::ios::in);
+	if (!is.good() || !is.is_open())
+		return false;
+	unsigned int magic = 0;
+	is.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	is.close();
+	if (magic == MAGIC)
+		return false; // a gait file of another version, or a broken one
+	std::vector<float> params;
+	if (!loadFloatArray(&params, p_filePath))
+		return false;
+	if (p_paramCount != 0 && params.size() != p_paramCount)
+		return false;
+	p_outParams->swap(params);
+	return true;
+}
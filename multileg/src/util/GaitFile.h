@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// =======================================================================================
+//                                      GaitFile
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Versioned binary gait parameter file. A fixed header with magic, version,
+///			pod type, parameter count, the ParamSchema layout hash and an optional
+///			optimization score is followed by the raw parameters.
+///			The file is opened as a read only memory mapping and the parameters are
+///			used in place, so opening a library of gaits doesn't copy them. The
+///			header is validated against the file size and checked against the
+///			expected pod, count and layout before the parameters are handed out.
+///			Old headerless float dumps (.bgait/.qgait) are still read by load.
+///
+/// # GaitFile
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class GaitFile
+{
+public:
+	enum Pod
+	{
+		BIPED = 0,
+		QUADRUPED = 1,
+		ANY_POD = 0xffffffff
+	};
+
+	static const unsigned int MAGIC = 0x54494147; // "GAIT"
+	static const unsigned int VERSION = 1;
+	static const unsigned int HAS_SCORE = 1;
+
+	// On-disk header, little endian, the parameters start at m_dataOffset
+	struct Header
+	{
+		unsigned int m_magic;
+		unsigned int m_version;
+		unsigned int m_pod;
+		unsigned int m_paramCount;
+		unsigned long long m_schemaHash;	// 0 if saved without a schema
+		unsigned int m_flags;
+		unsigned int m_dataOffset;
+		double m_score;						// valid with HAS_SCORE
+	};
+
+	GaitFile();
+	~GaitFile();
+
+	// Maps the file, returns false if it can't be mapped or isn't a valid gait file
+	bool open(const std::string& p_filePath);
+	void close();
+	bool isOpen() const;
+
+	const Header& getHeader() const;
+	// Points into the mapping, valid until close
+	const float* getParams() const;
+	unsigned int getParamCount() const;
+	bool hasScore() const;
+	double getScore() const;
+	// ANY_POD, a count of 0 or a hash of 0 (on either side) match anything
+	bool matches(unsigned int p_pod, unsigned int p_paramCount, unsigned long long p_schemaHash) const;
+
+	static bool save(const std::string& p_filePath, unsigned int p_pod, const std::vector<float>& p_params,
+		unsigned long long p_schemaHash = 0, const double* p_score = NULL);
+	// Copies the parameters of a gait file, or of a headerless float dump, into p_outParams.
+	// Fails on a gait file that doesn't match the expected pod, count and layout.
+	static bool load(const std::string& p_filePath, std::vector<float>* p_outParams,
+		unsigned int p_pod = ANY_POD, unsigned int p_paramCount = 0, unsigned long long p_schemaHash = 0);
+private:
+	GaitFile(const GaitFile&);
+	GaitFile& operator=(const GaitFile&);
+
+	const Header* m_header;
+	const void* m_view;
+	size_t m_viewSize;
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+};
@@ -1,5 +1,55 @@
 #pragma once
 #include <vector>
+#include <cstddef>
+
+class ParamSchema;
+
+// =======================================================================================
+//                                      ParamCursor
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Read/write position in a preallocated, flat parameter buffer.
+///			A cursor without a buffer only advances, which is used for counting.
+///			Reading or writing past the end of a buffer is skipped but flagged,
+///			isComplete tells if a buffer was used exactly to its end.
+///        
+/// # ParamCursor
+/// 
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+struct ParamCursor
+{
+	ParamCursor(float* p_data = NULL, unsigned int p_size = 0, unsigned int p_offset = 0)
+	{
+		m_data = p_data; m_size = p_size; m_pos = p_offset; m_overrun = false;
+	}
+
+	inline void write(float p_value)
+	{
+		if (m_pos < m_size) m_data[m_pos] = p_value;
+		else if (m_data != NULL) m_overrun = true;
+		m_pos++;
+	}
+
+	inline void read(float* p_outValue)
+	{
+		if (m_pos < m_size) *p_outValue = m_data[m_pos];
+		else m_overrun = true;
+		m_pos++;
+	}
+
+	inline bool isComplete() const
+	{
+		return !m_overrun && m_pos == m_size;
+	}
+
+	float* m_data;
+	unsigned int m_size;
+	unsigned int m_pos;
+	bool m_overrun; // something was read or written past the end
+};
 
 // =======================================================================================
 //                                      IOptimizable
@@ -7,7 +57,8 @@
 
 ///---------------------------------------------------------------------------------------
 /// \brief	Interface for optimizable data class for which optimizable vars
-///			can be serialized
+///			can be serialized. Implementers read and write at a cursor, so a 
+///			hierarchy of optimizables serializes into one flat buffer in one pass.
 ///        
 /// # IOptimizable
 /// 
@@ -17,12 +68,65 @@
 class IOptimizable
 {
 public:
-	virtual std::vector<float> getParamsMax() = 0;
-	virtual std::vector<float> getParamsMin() = 0;
-	virtual std::vector<float> getParams() = 0;
-	virtual void consumeParams(std::vector<float>& p_other) = 0;
+	virtual void writeParams(ParamCursor& p_cursor) = 0;
+	virtual void writeParamsMax(ParamCursor& p_cursor) = 0;
+	virtual void writeParamsMin(ParamCursor& p_cursor) = 0;
+	virtual void readParams(ParamCursor& p_cursor) = 0;
+	// Names the parameters, in the same order as they are written
+	virtual void describeParams(ParamSchema& p_schema) = 0;
+
+	unsigned int getParamCount()
+	{
+		ParamCursor counter;
+		writeParams(counter);
+		return counter.m_pos;
+	}
+
+	// Allocating convenience versions
+	std::vector<float> getParams()
+	{
+		std::vector<float> params(getParamCount());
+		ParamCursor cursor(params.data(), (unsigned int)params.size());
+		writeParams(cursor);
+		return params;
+	}
+
+	std::vector<float> getParamsMax()
+	{
+		std::vector<float> params(getParamCount());
+		ParamCursor cursor(params.data(), (unsigned int)params.size());
+		writeParamsMax(cursor);
+		return params;
+	}
+
+	std::vector<float> getParamsMin()
+	{
+		std::vector<float> params(getParamCount());
+		ParamCursor cursor(params.data(), (unsigned int)params.size());
+		writeParamsMin(cursor);
+		return params;
+	}
+
+	// Reads a whole parameter list in one pass, fails if it isn't exactly as
+	// long as the parameter layout. A list that is too short is still read up
+	// to its end, check the length first where that matters.
+	bool setParams(std::vector<float>& p_params)
+	{
+		ParamCursor cursor(p_params.data(), (unsigned int)p_params.size());
+		readParams(cursor);
+		return cursor.isComplete();
+	}
+
+	// Reads from the cursor's position and leaves it after what was read, so
+	// several optimizables are read from one list without copying it.
+	// Fails if the list ended first.
+	bool consumeParams(ParamCursor& p_cursor)
+	{
+		readParams(p_cursor);
+		return !p_cursor.m_overrun;
+	}
 protected:
 	IOptimizable() {}
 	IOptimizable(const IOptimizable& p_other) {}
 private:
-};
\ No newline at end of file
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+// =======================================================================================
+//                                      LatencyHistogram
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Log-bucketed histogram of timings (in ms), in the style of HDR histograms.
+///			Values are stored in nanoseconds; each power of two is split into 32 linear
+///			sub-buckets, so a percentile is within ~3% of the recorded value. Recording
+///			is a frexp and an increment into a fixed array, cheap enough to do for
+///			every physics tick. The max is kept exact.
+///
+/// # LatencyHistogram
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class LatencyHistogram
+{
+public:
+	static const int LINEAR_BUCKETS = 64;	// below this many ns the buckets are 1 ns wide
+	static const int SUB_BUCKETS = 32;		// per power of two above that
+	static const int FIRST_EXPONENT = 6;	// 2^6 = LINEAR_BUCKETS
+	static const int LAST_EXPONENT = 40;	// 2^40 ns, around 18 minutes, larger is clamped
+	static const int BUCKETS = LINEAR_BUCKETS + (LAST_EXPONENT - FIRST_EXPONENT + 1) * SUB_BUCKETS;
+
+	LatencyHistogram()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		for (int i = 0; i < BUCKETS; i++)
+			m_counts[i] = 0;
+		m_count = 0;
+		m_max = 0.0;
+	}
+
+	void record(double p_ms)
+	{
+		double ns = p_ms > 0.0 ? p_ms * 1000000.0 : 0.0;
+		m_counts[getBucketIdx(ns)]++;
+		m_count++;
+		if (p_ms > m_max) m_max = p_ms;
+	}
+
+	void add(const LatencyHistogram& p_other)
+	{
+		for (int i = 0; i < BUCKETS; i++)
+			m_counts[i] += p_other.m_counts[i];
+		m_count += p_other.m_count;
+		if (p_other.m_max > m_max) m_max = p_other.m_max;
+	}
+
+	unsigned int getCount() const	{ return m_count; }
+	double getMax() const			{ return m_max; }
+
+	// Value (ms) below which p_percentile percent of the recorded values lie
+	double getPercentile(double p_percentile) const
+	{
+		if (m_count == 0) return 0.0;
+		if (p_percentile >= 100.0) return m_max;
+		double target = ceil(p_percentile * 0.01 * (double)m_count);
+		if (target < 1.0) target = 1.0;
+		double accumulated = 0.0;
+		for (int i = 0; i < BUCKETS; i++)
+		{
+			accumulated += (double)m_counts[i];
+			if (accumulated >= target)
+			{
+				double ms = getBucketMidValue(i) / 1000000.0;
+				return ms < m_max ? ms : m_max;
+			}
+		}
+		return m_max;
+	}
+
+	// p50, p90, p99, p99.9 and max, in that order
+	void getSummary(std::vector<float>& p_outSummary) const
+	{
+		p_outSummary.clear();
+		p_outSummary.push_back((float)getPercentile(50.0));
+		p_outSummary.push_back((float)getPercentile(90.0));
+		p_outSummary.push_back((float)getPercentile(99.0));
+		p_outSummary.push_back((float)getPercentile(99.9));
+		p_outSummary.push_back((float)m_max);
+	}
+
+	static const char* getSummaryNames()
+	{
+		return "p50 - p90 - p99 - p99.9 - max";
+	}
+private:
+	static int getBucketIdx(double p_ns)
+	{
+		if (p_ns < (double)LINEAR_BUCKETS)
+			return (int)p_ns;
+		int exponent = 0;
+		double mantissa = frexp(p_ns, &exponent); // p_ns = mantissa*2^exponent, mantissa in [0.5,1)
+		int msb = exponent - 1;
+		if (msb > LAST_EXPONENT)
+			return BUCKETS - 1;
+		int sub = (int)((mantissa * 2.0 - 1.0) * (double)SUB_BUCKETS);
+		if (sub >= SUB_BUCKETS) sub = SUB_BUCKETS - 1;
+		return LINEAR_BUCKETS + (msb - FIRST_EXPONENT) * SUB_BUCKETS + sub;
+	}
+
+	static double getBucketMidValue(int p_idx)
+	{
+		if (p_idx < LINEAR_BUCKETS)
+			return (double)p_idx + 0.5;
+		int msb = FIRST_EXPONENT + (p_idx - LINEAR_BUCKETS) / SUB_BUCKETS;
+		int sub = (p_idx - LINEAR_BUCKETS) % SUB_BUCKETS;
+		double width = ldexp(1.0, msb) / (double)SUB_BUCKETS;
+		return ldexp(1.0, msb) + ((double)sub + 0.5) * width;
+	}
+
+	unsigned int m_counts[BUCKETS];
+	unsigned int m_count;
+	double m_max;
+};
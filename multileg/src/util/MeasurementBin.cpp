@@ -1,4 +1,5 @@
 #include "MeasurementBin.h"
+#include "MeasurementWriter.h"
 
 template<>
 void MeasurementBin<std::vector<float>>::finishRound()
@@ -43,50 +44,41 @@ float MeasurementBin<float>::calculateSTD()
 template<>
 float MeasurementBin<std::vector<float>>::calculateMean()
 {
-	unsigned int count = (unsigned int)m_measurements.size();
+	unsigned int count = (unsigned int)m_stepStats.size();
 	unsigned int totcounted = 0;
+	double accumulate = 0.0;
 	m_allMeans.clear();
 	for (unsigned int i = 0; i < count; i++)
 	{
-		double accumulate = 0.0;
-		unsigned int runs = (unsigned int)m_measurements[i].size();
-		m_internalRuns = runs;
-		for (unsigned int j = 0; j < runs; j++)
-		{
-			accumulate += (double)m_measurements[i][j];
-			totcounted++;
-		}
-		double thisMean = accumulate / (double)runs;
-		m_allMeans.push_back(thisMean);
-		m_mean += accumulate;
+		const RunningStat& step = m_stepStats[i];
+		m_internalRuns = step.getCount();
+		m_allMeans.push_back(step.getMean());
+		accumulate += step.getSum();
+		totcounted += step.getCount();
 	}
-	m_mean /= (double)totcounted;
-	return m_mean; // return the total mean
+	m_mean = accumulate / (double)totcounted;
+	return (float)m_mean; // return the total mean
 
 }
 
 template<>
 float MeasurementBin<std::vector<float>>::calculateSTD()
 {
-	float mean = calculateMean();
-	unsigned int count = (unsigned int)m_allMeans.size();
+	calculateMean();
+	unsigned int count = (unsigned int)m_stepStats.size();
 	double squaredDistsToMean = 0.0;
 	unsigned int totcounted = 0;
+	m_allSTDs.clear();
 	for (unsigned int i = 0; i < count; i++)
 	{
-		double localMean = m_allMeans[i];
-		double localSquaredDistsToMean = 0.0;
-		unsigned int runs = (unsigned int)m_measurements[i].size();
-		for (unsigned int j = 0; j < runs; j++)
-		{
-			double dist = (double)m_measurements[i][j] - (double)localMean;
-			double globDist = (double)m_measurements[i][j] - (double)mean;
-			localSquaredDistsToMean += dist*dist;
-			squaredDistsToMean += globDist*globDist;
-			totcounted++;
-		}
-		double localStandardDeviation = sqrt(localSquaredDistsToMean / (double)runs);
-		m_allSTDs.push_back(localStandardDeviation);
+		// The squared distances of a step to the total mean are its own variance
+		// plus the distance of its mean, for each of its measurements
+		const RunningStat& step = m_stepStats[i];
+		double runs = (double)step.getCount();
+		double dist = step.getMean() - m_mean;
+		squaredDistsToMean += step.getVariance()*runs + dist*dist*runs;
+		totcounted += step.getCount();
+		m_allSTDs.push_back(step.getSTD());
 	}
 	double standardDeviation = sqrt(squaredDistsToMean / (double)totcounted);
 	m_std = standardDeviation;
@@ -98,12 +90,19 @@ void MeasurementBin<std::vector<float>>::accumulateMeasurementAt(float p_measure
 {
 	if (m_active)
 	{
-		if (p_idx >= m_measurements.size())
+		if (p_idx >= m_stepStats.size())
 		{
-			m_measurements.push_back(std::vector<float>());
+			m_stepStats.push_back(RunningStat());
 		}
-		if (p_idx < m_measurements.size())
-			m_measurements[p_idx].push_back(p_measurement);
+		if (p_idx < m_stepStats.size())
+		{
+			// the measurements already at the step are the earlier runs
+			if (m_writer != NULL)
+				m_writer->push(m_stepStats[p_idx].getCount(), (unsigned int)p_idx, p_measurement);
+			m_stepStats[p_idx].add((double)p_measurement);
+		}
+		if (m_histogramActive)
+			m_histogram.record(p_measurement);
 	}
 }
 
@@ -235,7 +234,15 @@ bool MeasurementBin<std::vector<float>>::saveResultsCSV(const string& p_fileName
 			if (m_allMeans.size() > 0 && m_allSTDs.size() > 0 &&
 				m_allMeans.size() == m_allSTDs.size())
 			{
-				outFile << "Mean time (" << m_mean << "),Standard deviation (" << m_std << ") r=" << m_internalRuns << "\n";
+				outFile << "Mean time (" << m_mean << "),Standard deviation (" << m_std << ") r=" << m_internalRuns;
+				if (m_histogramActive)
+				{
+					std::vector<float> summary;
+					m_histogram.getSummary(summary);
+					outFile << ",p50 (" << summary[0] << "),p90 (" << summary[1] << "),p99 (" << summary[2]
+						<< "),p99.9 (" << summary[3] << "),max (" << summary[4] << ")";
+				}
+				outFile << "\n";
 				for (int i = 0; i < m_allMeans.size(); i++)
 				{
 					outFile << m_allMeans[i] << "," << m_allSTDs[i] << "\n";
@@ -269,6 +276,13 @@ bool MeasurementBin<std::vector<float>>::saveResultsGNUPLOT(const string& p_file
 				m_allMeans.size() == m_allSTDs.size())
 			{
 				outFile << "# step - mean (" << m_mean << ") - standard deviation (" << m_std << ") r=" << m_internalRuns << " - ylow - yhigh\n";
+				if (m_histogramActive)
+				{
+					std::vector<float> summary;
+					m_histogram.getSummary(summary);
+					outFile << "# " << LatencyHistogram::getSummaryNames() << " (" << summary[0] << " " << summary[1] << " "
+						<< summary[2] << " " << summary[3] << " " << summary[4] << ")\n";
+				}
 				if (m_timestamps.size() == m_allMeans.size())
 				{
 					for (int i = 0; i < m_allMeans.size(); i++)
@@ -3,15 +3,22 @@
 #include <string>
 #include <fstream>
 #include "CurrentPathHelper.h"
+#include "LatencyHistogram.h"
+#include "RunningStat.h"
 
 using namespace std;
 
+class MeasurementWriter;
+
 // =======================================================================================
 //                                  Measurement Bin
 // =======================================================================================
 
 ///---------------------------------------------------------------------------------------
-/// \brief	Brief
+/// \brief	Measurements of a run, or per step over several runs, and their mean
+///			and standard deviation. For vector<float> the measurements of a step
+///			are accumulated in a RunningStat, so memory doesn't grow with the
+///			number of runs. They can be streamed raw to a MeasurementWriter.
 ///        
 /// # MeasurementBin
 /// 
@@ -37,8 +44,19 @@ public:
 	bool isActive();
 	double getMean();
 	double getSTD();
+	// Per step means and standard deviations of the finished rounds
+	const vector<double>& getAllMeans();
+	const vector<double>& getAllSTDs();
+	int getInternalRuns();
+	// Also bin every accumulated measurement into a histogram, for percentiles
+	void activateHistogram();
+	bool isHistogramActive();
+	const LatencyHistogram& getHistogram();
+	// Also push every accumulated measurement to p_writer, as run, step and value
+	void streamTo(MeasurementWriter* p_writer);
 private:
 	vector<T> m_measurements;
+	vector<RunningStat> m_stepStats; // per step, used if T is vector
 	vector<float> m_timestamps;
 	double m_mean;
 	double m_std;
@@ -46,6 +64,9 @@ private:
 	vector<double> m_allSTDs;
 	bool m_active;
 	int m_internalRuns;
+	bool m_histogramActive;
+	LatencyHistogram m_histogram;
+	MeasurementWriter* m_writer;
 };
 
 template<class T>
@@ -60,6 +81,24 @@ double MeasurementBin<T>::getMean()
 	return m_mean;
 }
 
+template<class T>
+const vector<double>& MeasurementBin<T>::getAllMeans()
+{
+	return m_allMeans;
+}
+
+template<class T>
+const vector<double>& MeasurementBin<T>::getAllSTDs()
+{
+	return m_allSTDs;
+}
+
+template<class T>
+int MeasurementBin<T>::getInternalRuns()
+{
+	return m_internalRuns;
+}
+
 template<class T>
 MeasurementBin<T>::MeasurementBin()
 {
@@ -67,6 +106,8 @@ MeasurementBin<T>::MeasurementBin()
 	m_mean = 0.0;
 	m_std = 0.0f;
 	m_internalRuns = 0; // only used if T is vector
+	m_histogramActive = false;
+	m_writer = NULL;
 }
 
 template<class T>
@@ -176,6 +217,30 @@ bool MeasurementBin<T>::isActive()
 	return m_active;
 }
 
+template<class T>
+void MeasurementBin<T>::activateHistogram()
+{
+	m_histogramActive = true;
+}
+
+template<class T>
+bool MeasurementBin<T>::isHistogramActive()
+{
+	return m_histogramActive;
+}
+
+template<class T>
+const LatencyHistogram& MeasurementBin<T>::getHistogram()
+{
+	return m_histogram;
+}
+
+template<class T>
+void MeasurementBin<T>::streamTo(MeasurementWriter* p_writer)
+{
+	m_writer = p_writer;
+}
+
 template<class T>
 void MeasurementBin<T>::saveMeasurementRelTStamp(T p_measurement, float p_deltaTimeStamp)
 {
@@ -0,0 +1,169 @@
+#include "MeasurementWriter.h"
+#include "CurrentPathHelper.h"
+
+MeasurementWriter::MeasurementWriter()
+{
+	m_running = false;
+	m_stalls = 0;
+	m_front = 0;
+	m_back = 1;
+	m_backBusy = false;
+	m_jobsPosted = 0;
+	m_jobsDone = 0;
+	m_stopWriter = false;
+	m_samplesWritten = 0;
+}
+
+MeasurementWriter::~MeasurementWriter()
+{
+	stop();
+}
+
+bool MeasurementWriter::start(const std::string& p_sampleFileName /*= ""*/)
+{
+	stop();
+	if (p_sampleFileName != "")
+	{
+		m_file.open(GetExecutablePathDirectory() + p_sampleFileName, std::ios::binary | std::ios::out);
+		if (!m_file.good() || !m_file.is_open())
+			return false;
+		FileHeader header;
+		header.m_magic = FILE_MAGIC;
+		header.m_version = VERSION;
+		m_file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+	}
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		m_blocks[i].clear();
+		m_blocks[i].reserve(BLOCK_SAMPLES);
+	}
+	m_front = 0;
+	m_back = 1;
+	m_backBusy = false;
+	m_jobs.clear();
+	m_jobsPosted = 0;
+	m_jobsDone = 0;
+	m_stalls = 0;
+	m_samplesWritten = 0;
+	m_stopWriter = false;
+	m_writer = std::thread(&MeasurementWriter::writerLoop, this);
+	m_running = true;
+	return true;
+}
+
+void MeasurementWriter::stop()
+{
+	if (!m_running) return;
+	if (!m_blocks[m_front].empty())
+		submitBlock();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopWriter = true;
+	}
+	m_jobPosted.notify_one();
+	m_writer.join();
+	if (m_file.is_open())
+		m_file.close();
+	m_running = false;
+}
+
+bool MeasurementWriter::isRunning() const
+{
+	return m_running;
+}
+
+void MeasurementWriter::push(unsigned int p_run, unsigned int p_step, float p_value)
+{
+	if (!m_running || !m_file.is_open()) return;
+	Sample sample = { p_run, p_step, p_value };
+	m_blocks[m_front].push_back(sample);
+	if (m_blocks[m_front].size() >= BLOCK_SAMPLES)
+		submitBlock();
+}
+
+void MeasurementWriter::post(const std::function<void()>& p_job)
+{
+	if (!m_running)
+	{
+		p_job(); // no thread, run it here
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(p_job);
+		m_jobsPosted++;
+	}
+	m_jobPosted.notify_one();
+}
+
+void MeasurementWriter::wait()
+{
+	if (!m_running) return;
+	if (!m_blocks[m_front].empty())
+		submitBlock();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	unsigned long long posted = m_jobsPosted;
+	m_jobDone.wait(lock, [this, posted]() { return m_jobsDone >= posted; });
+}
+
+unsigned long long MeasurementWriter::getSamplesWritten() const
+{
+	return m_samplesWritten;
+}
+
+unsigned int MeasurementWriter::getStallCount() const
+{
+	return m_stalls;
+}
+
+void MeasurementWriter::submitBlock()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_backBusy)
+		{
+			m_stalls++;
+			m_jobDone.wait(lock, [this]() { return !m_backBusy; });
+		}
+		std::swap(m_front, m_back);
+		m_backBusy = true;
+		m_jobs.push_back(std::bind(&MeasurementWriter::writeBlock, this));
+		m_jobsPosted++;
+	}
+	m_jobPosted.notify_one();
+}
+
+void MeasurementWriter::writeBlock()
+{
+	// The simulation thread doesn't touch the back block while it is busy
+	std::vector<Sample>& block = m_blocks[m_back];
+	if (!block.empty())
+		m_file.write(reinterpret_cast<const char*>(&block[0]), std::streamsize(block.size() * sizeof(Sample)));
+	m_file.flush();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_samplesWritten += block.size();
+	block.clear(); // keeps its capacity
+	m_backBusy = false;
+}
+
+void MeasurementWriter::writerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobPosted.wait(lock, [this]() { return m_stopWriter || !m_jobs.empty(); });
+			if (m_jobs.empty())
+				return; // stopped and everything done
+			job = m_jobs.front();
+			m_jobs.pop_front();
+		}
+		job();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobsDone++;
+		}
+		m_jobDone.notify_all();
+	}
+}
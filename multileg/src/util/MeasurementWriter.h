@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// =======================================================================================
+//                                      MeasurementWriter
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Background thread for measurement output. Raw samples are streamed to a
+///			binary file during the run through two blocks of BLOCK_SAMPLES samples,
+///			one filled by the simulation thread while the other is written. If the
+///			written block isn't done when the next one is full the simulation thread
+///			waits (counted as a stall), so memory use stays at the two blocks.
+///
+///			Other output, like the result tables at the end of a run, is posted as
+///			jobs that run on the same thread, in order with the blocks. stop writes
+///			what is left and waits for every job.
+///
+///			File layout: FileHeader, then Samples until the end of the file.
+///
+/// # MeasurementWriter
+///
+/// 19-10-2026
+///---------------------------------------------------------------------------------------
+
+class MeasurementWriter
+{
+public:
+	static const unsigned int FILE_MAGIC = 0x504d534d; // "MSMP"
+	static const unsigned int VERSION = 1;
+	static const unsigned int BLOCK_SAMPLES = 4096;
+
+	struct FileHeader
+	{
+		unsigned int m_magic;
+		unsigned int m_version;
+	};
+
+	struct Sample
+	{
+		unsigned int m_run;
+		unsigned int m_step;
+		float m_value;
+	};
+
+	MeasurementWriter();
+	~MeasurementWriter();
+
+	// Starts the thread, samples are written to GetExecutablePathDirectory()+p_sampleFileName.
+	// Without a file name only jobs are run.
+	bool start(const std::string& p_sampleFileName = "");
+	// Writes the last block, runs the posted jobs and waits for the thread
+	void stop();
+	bool isRunning() const;
+
+	// From the simulation thread
+	void push(unsigned int p_run, unsigned int p_step, float p_value);
+	// Runs p_job on the writer thread, after the samples pushed before it
+	void post(const std::function<void()>& p_job);
+	// Waits until everything posted or pushed before the call is written
+	void wait();
+
+	unsigned long long getSamplesWritten() const;
+	unsigned int getStallCount() const;
+private:
+	MeasurementWriter(const MeasurementWriter&);
+	MeasurementWriter& operator=(const MeasurementWriter&);
+
+	void submitBlock();
+	void writeBlock();
+	void writerLoop();
+
+	std::ofstream m_file;
+	bool m_running;
+	unsigned int m_stalls;
+	// m_front is filled by the simulation thread, m_back is written while busy
+	std::vector<Sample> m_blocks[2];
+	unsigned int m_front, m_back;
+	bool m_backBusy;
+	std::deque<std::function<void()> > m_jobs;
+	unsigned long long m_jobsPosted, m_jobsDone;
+	std::mutex m_mutex;
+	std::condition_variable m_jobPosted;
+	std::condition_variable m_jobDone;
+	bool m_stopWriter;
+	unsigned long long m_samplesWritten;
+	std::thread m_writer;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <glm\gtc\type_ptr.hpp>
+#include <glm\gtc\quaternion.hpp>
+
+// =======================================================================================
+//                                      MotionCodec
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Quantization and byte coding of joint motion, shared by MotionRecorder and
+///			MotionReader. Positions and torques are quantized to a fixed step,
+///			rotations are stored as the smallest three quaternion components and the
+///			index of the dropped (largest) one. Within a chunk every joint value is
+///			coded as the zigzag varint of its delta to the previous tick, so a slowly
+///			moving joint costs about a byte per component.
+///
+/// # MotionCodec
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class MotionCodec
+{
+public:
+	static const int QUAT_RANGE = 16383; // +-1/sqrt(2) maps to +-QUAT_RANGE
+
+	// One joint, quantized. m_rot[0] is the index of the dropped component.
+	struct Joint
+	{
+		int m_pos[3];
+		int m_rot[4];
+		int m_torque[3];
+	};
+
+	static void quantize(const glm::vec3& p_pos, const glm::quat& p_rot, const glm::vec3& p_torque,
+		float p_posStep, float p_torqueStep, Joint& p_out)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			p_out.m_pos[i] = quantizeValue(p_pos[i], p_posStep);
+			p_out.m_torque[i] = quantizeValue(p_torque[i], p_torqueStep);
+		}
+		float q[4] = { p_rot.x, p_rot.y, p_rot.z, p_rot.w };
+		int largest = 0;
+		for (int i = 1; i < 4; i++)
+		{
+			if (fabs(q[i]) > fabs(q[largest])) largest = i;
+		}
+		// q and -q are the same rotation, flip so the dropped component is positive
+		float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+		p_out.m_rot[0] = largest;
+		for (int i = 0, n = 1; i < 4; i++)
+		{
+			if (i == largest) continue;
+			p_out.m_rot[n++] = quantizeValue(sign * q[i], quatStep());
+		}
+	}
+
+	static void dequantize(const Joint& p_in, float p_posStep, float p_torqueStep,
+		glm::vec3& p_outPos, glm::quat& p_outRot, glm::vec3& p_outTorque)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			p_outPos[i] = (float)p_in.m_pos[i] * p_posStep;
+			p_outTorque[i] = (float)p_in.m_torque[i] * p_torqueStep;
+		}
+		float q[4];
+		float sum = 0.0f;
+		int largest = p_in.m_rot[0] & 3;
+		for (int i = 0, n = 1; i < 4; i++)
+		{
+			if (i == largest) continue;
+			q[i] = (float)p_in.m_rot[n++] * quatStep();
+			sum += q[i] * q[i];
+		}
+		q[largest] = sqrt(sum < 1.0f ? 1.0f - sum : 0.0f);
+		p_outRot = glm::quat(q[3], q[0], q[1], q[2]);
+	}
+
+	static void putVarint(std::vector<unsigned char>& p_out, unsigned int p_value)
+	{
+		while (p_value >= 0x80)
+		{
+			p_out.push_back((unsigned char)(p_value | 0x80));
+			p_value >>= 7;
+		}
+		p_out.push_back((unsigned char)p_value);
+	}
+
+	// Returns false on a truncated value
+	static bool getVarint(const unsigned char*& p_data, const unsigned char* p_end, unsigned int& p_outValue)
+	{
+		p_outValue = 0;
+		for (unsigned int shift = 0; shift < 35 && p_data < p_end; shift += 7)
+		{
+			unsigned char byte = *p_data++;
+			p_outValue |= (unsigned int)(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) return true;
+		}
+		return false;
+	}
+
+	static void putDelta(std::vector<unsigned char>& p_out, int p_value, int p_previous)
+	{
+		int delta = p_value - p_previous;
+		putVarint(p_out, (unsigned int)((delta << 1) ^ (delta >> 31))); // zigzag, small magnitudes in few bytes
+	}
+
+	static bool getDelta(const unsigned char*& p_data, const unsigned char* p_end, int p_previous, int& p_outValue)
+	{
+		unsigned int zigzag = 0;
+		if (!getVarint(p_data, p_end, zigzag)) return false;
+		p_outValue = p_previous + ((int)(zigzag >> 1) ^ -(int)(zigzag & 1));
+		return true;
+	}
+
+	static void putJoint(std::vector<unsigned char>& p_out, const Joint& p_joint, const Joint& p_previous)
+	{
+		for (int i = 0; i < 3; i++) putDelta(p_out, p_joint.m_pos[i], p_previous.m_pos[i]);
+		for (int i = 0; i < 4; i++) putDelta(p_out, p_joint.m_rot[i], p_previous.m_rot[i]);
+		for (int i = 0; i < 3; i++) putDelta(p_out, p_joint.m_torque[i], p_previous.m_torque[i]);
+	}
+
+	static bool getJoint(const unsigned char*& p_data, const unsigned char* p_end, const Joint& p_previous, Joint& p_out)
+	{
+		bool res = true;
+		for (int i = 0; i < 3; i++) res = res && getDelta(p_data, p_end, p_previous.m_pos[i], p_out.m_pos[i]);
+		for (int i = 0; i < 4; i++) res = res && getDelta(p_data, p_end, p_previous.m_rot[i], p_out.m_rot[i]);
+		for (int i = 0; i < 3; i++) res = res && getDelta(p_data, p_end, p_previous.m_torque[i], p_out.m_torque[i]);
+		return res;
+	}
+private:
+	static int quantizeValue(float p_value, float p_step)
+	{
+		float q = p_value / p_step;
+		return (int)(q < 0.0f ? q - 0.5f : q + 0.5f);
+	}
+
+	static float quatStep()
+	{
+		return 0.70710678f / (float)QUAT_RANGE;
+	}
+};
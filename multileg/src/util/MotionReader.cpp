@@ -0,0 +1,139 @@
+#include "MotionReader.h"
+#include "CurrentPathHelper.h"
+
+MotionReader::MotionReader()
+{
+	m_fileHeader.m_magic = 0;
+}
+
+bool MotionReader::open(const std::string& p_fileName)
+{
+	close();
+	m_file.open(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::in);
+	if (!m_file.good() || !m_file.is_open())
+		return false;
+	m_file.read(reinterpret_cast<char*>(&m_fileHeader), sizeof(MotionRecorder::FileHeader));
+	if (!m_file.good() || m_fileHeader.m_magic != MotionRecorder::FILE_MAGIC ||
+		m_fileHeader.m_version != MotionRecorder::VERSION)
+	{
+		close();
+		return false;
+	}
+	std::streamoff offset = m_file.tellg();
+	m_file.seekg(0, std::ios::end);
+	std::streamoff fileSize = m_file.tellg();
+	m_file.seekg(offset, std::ios::beg);
+	// Index the chunks, a truncated last chunk (recording not closed) is left out
+	while (offset + (std::streamoff)sizeof(MotionRecorder::ChunkHeader) <= fileSize)
+	{
+		IndexEntry entry;
+		m_file.read(reinterpret_cast<char*>(&entry.m_header), sizeof(MotionRecorder::ChunkHeader));
+		if (!m_file.good() || entry.m_header.m_magic != MotionRecorder::CHUNK_MAGIC)
+			break;
+		entry.m_payloadOffset = offset + sizeof(MotionRecorder::ChunkHeader);
+		offset = entry.m_payloadOffset + entry.m_header.m_payloadSize;
+		if (offset > fileSize)
+			break;
+		m_index.push_back(entry);
+		m_file.seekg(offset, std::ios::beg);
+	}
+	m_file.clear();
+	return true;
+}
+
+void MotionReader::close()
+{
+	if (m_file.is_open())
+		m_file.close();
+	m_file.clear();
+	m_index.clear();
+	m_fileHeader.m_magic = 0;
+}
+
+bool MotionReader::isOpen() const
+{
+	return m_fileHeader.m_magic == MotionRecorder::FILE_MAGIC;
+}
+
+unsigned int MotionReader::getChunkCount() const
+{
+	return (unsigned int)m_index.size();
+}
+
+unsigned int MotionReader::getFirstTick() const
+{
+	return m_index.empty() ? 0 : m_index.front().m_header.m_firstTick;
+}
+
+unsigned int MotionReader::getEndTick() const
+{
+	return m_index.empty() ? 0 : m_index.back().m_header.m_firstTick + m_index.back().m_header.m_tickCount;
+}
+
+int MotionReader::findChunk(unsigned int p_tick) const
+{
+	// Chunks are in tick order, binary search on the first tick
+	int low = 0, high = (int)m_index.size() - 1;
+	while (low <= high)
+	{
+		int mid = (low + high) / 2;
+		const MotionRecorder::ChunkHeader& header = m_index[mid].m_header;
+		if (p_tick < header.m_firstTick)
+			high = mid - 1;
+		else if (p_tick >= header.m_firstTick + header.m_tickCount)
+			low = mid + 1;
+		else
+			return mid;
+	}
+	return -1;
+}
+
+bool MotionReader::decodeChunk(unsigned int p_chunkIdx, Chunk& p_outChunk)
+{
+	if (p_chunkIdx >= m_index.size())
+		return false;
+	const IndexEntry& entry = m_index[p_chunkIdx];
+	unsigned int joints = entry.m_header.m_jointCount;
+	unsigned int ticks = entry.m_header.m_tickCount;
+	m_payload.resize(entry.m_header.m_payloadSize);
+	m_file.seekg(entry.m_payloadOffset, std::ios::beg);
+	if (!m_payload.empty())
+		m_file.read(reinterpret_cast<char*>(&m_payload[0]), std::streamsize(m_payload.size()));
+	if (!m_file.good())
+	{
+		m_file.clear();
+		return false;
+	}
+
+	p_outChunk.m_firstTick = entry.m_header.m_firstTick;
+	p_outChunk.m_tickCount = ticks;
+	p_outChunk.m_jointCount = joints;
+	p_outChunk.m_positions.resize(ticks * joints);
+	p_outChunk.m_rotations.resize(ticks * joints);
+	p_outChunk.m_torques.resize(ticks * joints);
+	p_outChunk.m_contacts.resize(ticks * joints);
+	MotionCodec::Joint zero = { { 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0 } };
+	m_previous.assign(joints, zero);
+	const unsigned char* data = m_payload.empty() ? NULL : &m_payload[0];
+	const unsigned char* end = data + m_payload.size();
+	unsigned int contactBytes = (joints + 7) / 8;
+	for (unsigned int t = 0; t < ticks; t++)
+	{
+		for (unsigned int j = 0; j < joints; j++)
+		{
+			MotionCodec::Joint joint;
+			if (!MotionCodec::getJoint(data, end, m_previous[j], joint))
+				return false;
+			m_previous[j] = joint;
+			unsigned int idx = t * joints + j;
+			MotionCodec::dequantize(joint, m_fileHeader.m_posStep, m_fileHeader.m_torqueStep,
+				p_outChunk.m_positions[idx], p_outChunk.m_rotations[idx], p_outChunk.m_torques[idx]);
+		}
+		if (end - data < (std::ptrdiff_t)contactBytes)
+			return false;
+		for (unsigned int j = 0; j < joints; j++)
+			p_outChunk.m_contacts[t * joints + j] = (data[j / 8] >> (j % 8)) & 1;
+		data += contactBytes;
+	}
+	return true;
+}
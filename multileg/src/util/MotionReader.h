@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include "MotionRecorder.h"
+
+// =======================================================================================
+//                                      MotionReader
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Reads a MotionRecorder file. Opening scans the chunk headers into an
+///			index, chunks are then decoded one at a time, any chunk can be decoded
+///			without the ones before it.
+///
+/// # MotionReader
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class MotionReader
+{
+public:
+	// A decoded chunk, values are stored tick major: [tick * jointCount + joint]
+	struct Chunk
+	{
+		unsigned int m_firstTick;
+		unsigned int m_tickCount;
+		unsigned int m_jointCount;
+		std::vector<glm::vec3> m_positions;
+		std::vector<glm::quat> m_rotations;
+		std::vector<glm::vec3> m_torques;
+		std::vector<unsigned char> m_contacts;
+	};
+
+	MotionReader();
+
+	// Reads GetExecutablePathDirectory()+p_fileName
+	bool open(const std::string& p_fileName);
+	void close();
+	bool isOpen() const;
+
+	unsigned int getChunkCount() const;
+	unsigned int getFirstTick() const;
+	// One past the last recorded tick
+	unsigned int getEndTick() const;
+	// Chunk holding p_tick, -1 if it isn't recorded
+	int findChunk(unsigned int p_tick) const;
+	bool decodeChunk(unsigned int p_chunkIdx, Chunk& p_outChunk);
+private:
+	struct IndexEntry
+	{
+		MotionRecorder::ChunkHeader m_header;
+		std::streamoff m_payloadOffset;
+	};
+
+	std::ifstream m_file;
+	MotionRecorder::FileHeader m_fileHeader;
+	std::vector<IndexEntry> m_index;
+	std::vector<unsigned char> m_payload;
+	std::vector<MotionCodec::Joint> m_previous;
+};
@@ -0,0 +1,183 @@
+#include "MotionRecorder.h"
+#include "CurrentPathHelper.h"
+
+MotionRecorder::MotionRecorder()
+{
+	m_open = false;
+	m_inTick = false;
+	m_recordedTicks = 0;
+	m_stalls = 0;
+	m_current = NULL;
+	m_jointIdx = 0;
+	m_stopWriter = false;
+	m_bytesWritten = 0;
+}
+
+MotionRecorder::~MotionRecorder()
+{
+	close();
+}
+
+bool MotionRecorder::open(const std::string& p_fileName, float p_posStep /*= 1.0f / 1024.0f*/,
+	float p_torqueStep /*= 1.0f / 64.0f*/)
+{
+	close();
+	m_file.open(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::out);
+	if (!m_file.good() || !m_file.is_open())
+		return false;
+	m_fileHeader.m_magic = FILE_MAGIC;
+	m_fileHeader.m_version = VERSION;
+	m_fileHeader.m_posStep = p_posStep;
+	m_fileHeader.m_torqueStep = p_torqueStep;
+	m_fileHeader.m_chunkTicks = CHUNK_TICKS;
+	m_file.write(reinterpret_cast<const char*>(&m_fileHeader), sizeof(FileHeader));
+	m_bytesWritten = sizeof(FileHeader);
+
+	m_free.clear();
+	m_pending.clear();
+	m_free.reserve(CHUNK_BUFFERS);
+	m_pending.reserve(CHUNK_BUFFERS);
+	for (unsigned int i = 0; i < CHUNK_BUFFERS; i++)
+		m_free.push_back(&m_chunks[i]);
+	m_current = NULL;
+	m_inTick = false;
+	m_recordedTicks = 0;
+	m_stalls = 0;
+	m_stopWriter = false;
+	m_writer = std::thread(&MotionRecorder::writerLoop, this);
+	m_open = true;
+	return true;
+}
+
+void MotionRecorder::close()
+{
+	if (!m_open) return;
+	if (m_current != NULL && m_current->m_header.m_tickCount > 0)
+		submitChunk();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopWriter = true;
+	}
+	m_chunkPending.notify_one();
+	m_writer.join();
+	m_file.close();
+	m_current = NULL;
+	m_open = false;
+}
+
+bool MotionRecorder::isOpen() const
+{
+	return m_open;
+}
+
+void MotionRecorder::beginTick(unsigned int p_tick, unsigned int p_jointCount)
+{
+	if (!m_open) return;
+	// A new chunk when the current is full, or the ticks are no longer consecutive
+	if (m_current != NULL && (m_current->m_header.m_tickCount >= CHUNK_TICKS ||
+		m_current->m_header.m_jointCount != p_jointCount ||
+		m_current->m_header.m_firstTick + m_current->m_header.m_tickCount != p_tick))
+	{
+		submitChunk();
+	}
+	if (m_current == NULL)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_free.empty())
+			{
+				m_stalls++;
+				m_chunkFreed.wait(lock, [this]() { return !m_free.empty(); });
+			}
+			m_current = m_free.back();
+			m_free.pop_back();
+		}
+		m_current->m_header.m_magic = CHUNK_MAGIC;
+		m_current->m_header.m_firstTick = p_tick;
+		m_current->m_header.m_tickCount = 0;
+		m_current->m_header.m_jointCount = p_jointCount;
+		m_current->m_payload.clear(); // keeps its capacity from earlier chunks
+		// first tick of a chunk is coded against zero
+		MotionCodec::Joint zero = { { 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0 } };
+		m_previous.assign(p_jointCount, zero);
+	}
+	m_contactBits.assign((p_jointCount + 7) / 8, 0);
+	m_jointIdx = 0;
+	m_inTick = true;
+}
+
+void MotionRecorder::addJoint(const glm::mat4& p_worldTransform, const glm::vec3& p_torque, bool p_contact)
+{
+	if (!m_inTick || m_jointIdx >= m_current->m_header.m_jointCount) return;
+	MotionCodec::Joint joint;
+	MotionCodec::quantize(glm::vec3(p_worldTransform[3]), glm::normalize(glm::quat_cast(p_worldTransform)), p_torque,
+		m_fileHeader.m_posStep, m_fileHeader.m_torqueStep, joint);
+	MotionCodec::putJoint(m_current->m_payload, joint, m_previous[m_jointIdx]);
+	m_previous[m_jointIdx] = joint;
+	if (p_contact)
+		m_contactBits[m_jointIdx / 8] |= (unsigned char)(1 << (m_jointIdx % 8));
+	m_jointIdx++;
+}
+
+void MotionRecorder::endTick()
+{
+	if (!m_inTick) return;
+	// Joints that weren't added are repeated from the previous tick
+	for (; m_jointIdx < m_current->m_header.m_jointCount; m_jointIdx++)
+		MotionCodec::putJoint(m_current->m_payload, m_previous[m_jointIdx], m_previous[m_jointIdx]);
+	m_current->m_payload.insert(m_current->m_payload.end(), m_contactBits.begin(), m_contactBits.end());
+	m_current->m_header.m_tickCount++;
+	m_recordedTicks++;
+	m_inTick = false;
+}
+
+unsigned int MotionRecorder::getRecordedTicks() const
+{
+	return m_recordedTicks;
+}
+
+unsigned long long MotionRecorder::getBytesWritten() const
+{
+	return m_bytesWritten;
+}
+
+unsigned int MotionRecorder::getStallCount() const
+{
+	return m_stalls;
+}
+
+void MotionRecorder::submitChunk()
+{
+	m_current->m_header.m_payloadSize = (unsigned int)m_current->m_payload.size();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending.push_back(m_current);
+	}
+	m_chunkPending.notify_one();
+	m_current = NULL;
+}
+
+void MotionRecorder::writerLoop()
+{
+	while (true)
+	{
+		Chunk* chunk = NULL;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_chunkPending.wait(lock, [this]() { return m_stopWriter || !m_pending.empty(); });
+			if (m_pending.empty())
+				return; // stopped and everything written
+			chunk = m_pending.front();
+			m_pending.erase(m_pending.begin());
+		}
+		m_file.write(reinterpret_cast<const char*>(&chunk->m_header), sizeof(ChunkHeader));
+		if (!chunk->m_payload.empty())
+			m_file.write(reinterpret_cast<const char*>(&chunk->m_payload[0]), std::streamsize(chunk->m_payload.size()));
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bytesWritten += sizeof(ChunkHeader) + chunk->m_payload.size();
+			m_free.push_back(chunk);
+		}
+		m_chunkFreed.notify_one();
+	}
+}
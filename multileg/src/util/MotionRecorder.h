@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "MotionCodec.h"
+
+// =======================================================================================
+//                                      MotionRecorder
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Records the world transform, torque and contact flag of every joint, each
+///			physics tick, to a chunked binary file. Joints are coded with MotionCodec
+///			as deltas within a chunk of up to CHUNK_TICKS ticks, the first tick of a
+///			chunk is coded against zero so every chunk decodes on its own.
+///
+///			Encoding happens on the simulation thread into one of a fixed set of
+///			chunk buffers, full chunks are written by a background thread. If all
+///			buffers are waiting on the disk the simulation thread waits as well
+///			(counted as a stall), so memory use stays bounded.
+///
+///			File layout: FileHeader, then chunks of ChunkHeader + payload. A tick of
+///			the payload is every joint (see MotionCodec::putJoint) followed by the
+///			contact flags, one bit per joint.
+///
+/// # MotionRecorder
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class MotionRecorder
+{
+public:
+	static const unsigned int FILE_MAGIC = 0x4345524d; // "MREC"
+	static const unsigned int CHUNK_MAGIC = 0x4b4e4843; // "CHNK"
+	static const unsigned int VERSION = 1;
+	static const unsigned int CHUNK_TICKS = 64;
+	static const unsigned int CHUNK_BUFFERS = 8;
+
+	struct FileHeader
+	{
+		unsigned int m_magic;
+		unsigned int m_version;
+		float m_posStep;		// metres per position unit
+		float m_torqueStep;		// Nm per torque unit
+		unsigned int m_chunkTicks;
+	};
+
+	struct ChunkHeader
+	{
+		unsigned int m_magic;
+		unsigned int m_firstTick;
+		unsigned int m_tickCount;	// consecutive ticks
+		unsigned int m_jointCount;
+		unsigned int m_payloadSize;	// bytes after the header
+	};
+
+	MotionRecorder();
+	~MotionRecorder();
+
+	// Writes to GetExecutablePathDirectory()+p_fileName
+	bool open(const std::string& p_fileName, float p_posStep = 1.0f / 1024.0f, float p_torqueStep = 1.0f / 64.0f);
+	// Writes what is left and waits for the writer thread
+	void close();
+	bool isOpen() const;
+
+	// A tick is beginTick, p_jointCount addJoint calls and endTick
+	void beginTick(unsigned int p_tick, unsigned int p_jointCount);
+	void addJoint(const glm::mat4& p_worldTransform, const glm::vec3& p_torque, bool p_contact);
+	void endTick();
+
+	unsigned int getRecordedTicks() const;
+	unsigned long long getBytesWritten() const;
+	unsigned int getStallCount() const;
+private:
+	struct Chunk
+	{
+		ChunkHeader m_header;
+		std::vector<unsigned char> m_payload;
+	};
+
+	void submitChunk();
+	void writerLoop();
+
+	std::ofstream m_file;
+	FileHeader m_fileHeader;
+	bool m_open;
+	bool m_inTick;
+	unsigned int m_recordedTicks;
+	unsigned int m_stalls;
+	// encoding state, only touched by the simulation thread
+	Chunk* m_current;
+	std::vector<MotionCodec::Joint> m_previous;
+	std::vector<unsigned char> m_contactBits;
+	unsigned int m_jointIdx;
+	// chunk buffers, either free or pending for the writer
+	Chunk m_chunks[CHUNK_BUFFERS];
+	std::vector<Chunk*> m_free;
+	std::vector<Chunk*> m_pending;
+	std::mutex m_mutex;
+	std::condition_variable m_chunkFreed;
+	std::condition_variable m_chunkPending;
+	bool m_stopWriter;
+	unsigned long long m_bytesWritten;
+	std::thread m_writer;
+};
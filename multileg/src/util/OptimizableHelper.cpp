@@ -1,93 +1,75 @@
-#include "OptimizableHelper.h"
-
+#include "OptimizableHelper.h"
 
-void OptimizableHelper::popFront(std::vector<float>& p_params, unsigned int p_range/* = 1*/)
+
+void OptimizableHelper::WriteParamsFrom(ParamCursor& p_cursor, const glm::vec2& p_vec2)
 {
-	p_params = std::vector<float>(p_params.begin() + p_range,
-		p_params.end());
+	p_cursor.write(p_vec2.x);
+	p_cursor.write(p_vec2.y);
 }
 
-std::vector<float> OptimizableHelper::ExtractParamsListFrom(const glm::vec2& p_vec2)
+void OptimizableHelper::WriteParamsFrom(ParamCursor& p_cursor, const glm::vec3& p_vec3)
 {
-	std::vector<float> vals;
-	vals.push_back(p_vec2.x);
-	vals.push_back(p_vec2.y);
-	return vals;
+	p_cursor.write(p_vec3.x);
+	p_cursor.write(p_vec3.y);
+	p_cursor.write(p_vec3.z);
 }
 
-std::vector<float> OptimizableHelper::ExtractParamsListFrom(const glm::vec3& p_vec3)
+void OptimizableHelper::WriteParamsFrom(ParamCursor& p_cursor, const glm::quat& p_quat)
 {
-	std::vector<float> vals;
-	vals.push_back(p_vec3.x);
-	vals.push_back(p_vec3.y);
-	vals.push_back(p_vec3.z);
-	return vals;
+	p_cursor.write(p_quat.x);
+	p_cursor.write(p_quat.y);
+	p_cursor.write(p_quat.z);
+	p_cursor.write(p_quat.w);
 }
 
-std::vector<float> OptimizableHelper::ExtractParamsListFrom(const glm::quat& p_quat)
+void OptimizableHelper::WriteParamsFrom(ParamCursor& p_cursor, const glm::vec4& p_vec4)
 {
-	std::vector<float> vals;
-	vals.push_back(p_quat.x);
-	vals.push_back(p_quat.y);
-	vals.push_back(p_quat.z);
-	vals.push_back(p_quat.w);
-	return vals;
+	p_cursor.write(p_vec4.x);
+	p_cursor.write(p_vec4.y);
+	p_cursor.write(p_vec4.z);
+	p_cursor.write(p_vec4.w);
 }
 
-std::vector<float> OptimizableHelper::ExtractParamsListFrom(const glm::vec4& p_vec4)
+void OptimizableHelper::WriteParamsRepeated(ParamCursor& p_cursor, float p_value, unsigned int p_count)
 {
-	std::vector<float> vals;
-	vals.push_back(p_vec4.x);
-	vals.push_back(p_vec4.y);
-	vals.push_back(p_vec4.z);
-	vals.push_back(p_vec4.w);
-	return vals;
+	for (unsigned int i = 0; i < p_count; i++)
+		p_cursor.write(p_value);
 }
 
-void OptimizableHelper::ConsumeParamsTo(std::vector<float>& p_params, float* p_inoutFloat)
+void OptimizableHelper::ConsumeParamsTo(ParamCursor& p_cursor, float* p_inoutFloat)
 {
-	*p_inoutFloat = p_params[0];
-	popFront(p_params);
+	p_cursor.read(p_inoutFloat);
 }
 
-void OptimizableHelper::ConsumeParamsTo(std::vector<float>& p_params, glm::vec2* p_inoutVec2)
+void OptimizableHelper::ConsumeParamsTo(ParamCursor& p_cursor, glm::vec2* p_inoutVec2)
 {
 	for (int i = 0; i < 2; i++)
 	{
-		(*p_inoutVec2)[i] = p_params[i];
+		p_cursor.read(&(*p_inoutVec2)[i]);
 	}
-	popFront(p_params, 2);
 }
 
-void OptimizableHelper::ConsumeParamsTo(std::vector<float>& p_params, glm::vec3* p_inoutVec3)
+void OptimizableHelper::ConsumeParamsTo(ParamCursor& p_cursor, glm::vec3* p_inoutVec3)
 {
 	for (int i = 0; i < 3; i++)
 	{
-		(*p_inoutVec3)[i] = p_params[i];
+		p_cursor.read(&(*p_inoutVec3)[i]);
 	}
-	popFront(p_params, 3);
 }
 
-void OptimizableHelper::ConsumeParamsTo(std::vector<float>& p_params, glm::vec4* p_inoutVec4)
+void OptimizableHelper::ConsumeParamsTo(ParamCursor& p_cursor, glm::vec4* p_inoutVec4)
 {
 	for (int i = 0; i < 4; i++)
 	{
-		(*p_inoutVec4)[i] = p_params[i];
+		p_cursor.read(&(*p_inoutVec4)[i]);
 	}
-	popFront(p_params, 4);
 }
 
 
-void OptimizableHelper::ConsumeParamsTo(std::vector<float>& p_params, glm::quat* p_inoutQuat)
+void OptimizableHelper::ConsumeParamsTo(ParamCursor& p_cursor, glm::quat* p_inoutQuat)
 {
 	for (int i = 0; i < 4; i++)
 	{
-		(*p_inoutQuat)[i] = p_params[i];
+		p_cursor.read(&(*p_inoutQuat)[i]);
 	}
-	popFront(p_params, 4);
 }
-
-void OptimizableHelper::addRange(std::vector<float>& p_params, const std::vector<float>& p_rangeToAdd)
-{
-	p_params.insert(p_params.end(), p_rangeToAdd.begin(), p_rangeToAdd.end());
-}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <glm\gtc\type_ptr.hpp>
+#include "IOptimizable.h"
+#include "ParamSchema.h"
 
 // =======================================================================================
 //                                      OptimizableHelper
@@ -16,25 +18,23 @@
 
 namespace OptimizableHelper
 {
-	void popFront(std::vector<float>& p_params, unsigned int p_range = 1);
+	void WriteParamsFrom(ParamCursor& p_cursor, const glm::vec2& p_vec2);
 
-	std::vector<float> ExtractParamsListFrom(const glm::vec2& p_vec2);
+	void WriteParamsFrom(ParamCursor& p_cursor, const glm::vec3& p_vec3);
 
-	std::vector<float> ExtractParamsListFrom(const glm::vec3& p_vec3);
+	void WriteParamsFrom(ParamCursor& p_cursor, const glm::quat& p_quat);
 
-	std::vector<float> ExtractParamsListFrom(const glm::quat& p_quat);
+	void WriteParamsFrom(ParamCursor& p_cursor, const glm::vec4& p_vec4);
 
-	std::vector<float> ExtractParamsListFrom(const glm::vec4& p_vec4);
+	void WriteParamsRepeated(ParamCursor& p_cursor, float p_value, unsigned int p_count);
 
-	void ConsumeParamsTo(std::vector<float>& p_params, float* p_inoutFloat);
+	void ConsumeParamsTo(ParamCursor& p_cursor, float* p_inoutFloat);
 
-	void ConsumeParamsTo(std::vector<float>& p_params, glm::vec2* p_inoutVec2);
+	void ConsumeParamsTo(ParamCursor& p_cursor, glm::vec2* p_inoutVec2);
 
-	void ConsumeParamsTo(std::vector<float>& p_params, glm::vec3* p_inoutVec3);
+	void ConsumeParamsTo(ParamCursor& p_cursor, glm::vec3* p_inoutVec3);
 
-	void ConsumeParamsTo(std::vector<float>& p_params, glm::vec4* p_inoutVec4);
+	void ConsumeParamsTo(ParamCursor& p_cursor, glm::vec4* p_inoutVec4);
 
-	void ConsumeParamsTo(std::vector<float>& p_params, glm::quat* p_inoutQuat);
-
-	void addRange(std::vector<float>& p_params, const std::vector<float>& p_rangeToAdd);
-};
\ No newline at end of file
+	void ConsumeParamsTo(ParamCursor& p_cursor, glm::quat* p_inoutQuat);
+};
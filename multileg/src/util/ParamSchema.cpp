@@ -0,0 +1,199 @@
+#include "ParamSchema.h"
+#include "IOptimizable.h"
+#include "EvaluationCache.h"
+#include "ToString.h"
+#include <fstream>
+
+ParamSchema::ParamSchema()
+{
+}
+
+void ParamSchema::pushScope(const std::string& p_name)
+{
+	m_scope.push_back(p_name);
+	m_currentOwner = m_currentOwner.empty() ? p_name : m_currentOwner + "/" + p_name;
+}
+
+void ParamSchema::popScope()
+{
+	if (m_scope.empty()) return;
+	m_scope.pop_back();
+	m_currentOwner.clear();
+	for (unsigned int i = 0; i < m_scope.size(); i++)
+		m_currentOwner += (i > 0 ? "/" : "") + m_scope[i];
+}
+
+void ParamSchema::add(const std::string& p_name, unsigned int p_count/* = 1*/)
+{
+	for (unsigned int i = 0; i < p_count; i++)
+	{
+		Entry entry;
+		entry.m_name = p_count > 1 ? p_name + "[" + ToString(i) + "]" : p_name;
+		entry.m_owner = m_currentOwner;
+		entry.m_min = 0.0f;
+		entry.m_max = 0.0f;
+		entry.m_frozen = false;
+		m_entries.push_back(entry);
+	}
+}
+
+bool ParamSchema::build(IOptimizable* p_root)
+{
+	m_entries.clear();
+	m_scope.clear();
+	m_currentOwner.clear();
+	p_root->describeParams(*this);
+	std::vector<float> paramsMax = p_root->getParamsMax();
+	std::vector<float> paramsMin = p_root->getParamsMin();
+	bool layoutOk = paramsMax.size() == m_entries.size();
+	for (unsigned int i = 0; i < m_entries.size() && i < paramsMax.size(); i++)
+	{
+		m_entries[i].m_max = paramsMax[i];
+		m_entries[i].m_min = paramsMin[i];
+	}
+	applyFrozenPatterns();
+	return layoutOk;
+}
+
+void ParamSchema::clear()
+{
+	m_entries.clear();
+	m_freeIndices.clear();
+}
+
+unsigned int ParamSchema::getSize() const
+{
+	return (unsigned int)m_entries.size();
+}
+
+const ParamSchema::Entry& ParamSchema::getEntry(unsigned int p_idx) const
+{
+	return m_entries[p_idx];
+}
+
+std::string ParamSchema::getPath(unsigned int p_idx) const
+{
+	const Entry& entry = m_entries[p_idx];
+	return entry.m_owner.empty() ? entry.m_name : entry.m_owner + "/" + entry.m_name;
+}
+
+int ParamSchema::findIndex(const std::string& p_path) const
+{
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		if (getPath(i) == p_path) return (int)i;
+	}
+	return -1;
+}
+
+unsigned long long ParamSchema::getLayoutHash() const
+{
+	unsigned long long h = EvaluationCache::HASH_SEED;
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		std::string path = getPath(i);
+		h = EvaluationCache::hash(path.c_str(), path.size() + 1, h); // include terminator as separator
+	}
+	return h;
+}
+
+void ParamSchema::addFrozenPattern(const std::string& p_pattern)
+{
+	m_frozenPatterns.push_back(p_pattern);
+	applyFrozenPatterns();
+}
+
+bool ParamSchema::loadFrozenPatterns(const std::string& p_filePath)
+{
+	std::ifstream is(p_filePath.c_str());
+	if (!is.good() || !is.is_open())
+		return false;
+	std::string line;
+	while (std::getline(is, line))
+	{
+		// strip whitespace and skip comments
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start == std::string::npos || line[start] == '#') continue;
+		size_t end = line.find_last_not_of(" \t\r");
+		m_frozenPatterns.push_back(line.substr(start, end - start + 1));
+	}
+	applyFrozenPatterns();
+	return true;
+}
+
+void ParamSchema::setFrozen(unsigned int p_idx, bool p_frozen)
+{
+	m_entries[p_idx].m_frozen = p_frozen;
+	updateFreeIndices();
+}
+
+unsigned int ParamSchema::getFreeCount() const
+{
+	return (unsigned int)m_freeIndices.size();
+}
+
+const std::vector<unsigned int>& ParamSchema::getFreeIndices() const
+{
+	return m_freeIndices;
+}
+
+void ParamSchema::gatherFree(const std::vector<float>& p_full, std::vector<float>& p_outSubset) const
+{
+	p_outSubset.resize(m_freeIndices.size());
+	for (unsigned int i = 0; i < m_freeIndices.size(); i++)
+		p_outSubset[i] = p_full[m_freeIndices[i]];
+}
+
+void ParamSchema::scatterFree(const std::vector<float>& p_subset, std::vector<float>& p_inoutFull) const
+{
+	for (unsigned int i = 0; i < m_freeIndices.size() && i < p_subset.size(); i++)
+		p_inoutFull[m_freeIndices[i]] = p_subset[i];
+}
+
+bool ParamSchema::saveListing(const std::string& p_filePath, const std::vector<float>* p_values/* = NULL*/) const
+{
+	std::ofstream os(p_filePath.c_str());
+	if (!os.good() || !os.is_open())
+		return false;
+	os << "# layout " << getLayoutHash() << "\n";
+	os << "# idx path min max frozen" << (p_values != NULL ? " value" : "") << "\n";
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		const Entry& entry = m_entries[i];
+		os << i << " " << getPath(i) << " " << entry.m_min << " " << entry.m_max << " " << (entry.m_frozen ? 1 : 0);
+		if (p_values != NULL && i < p_values->size()) os << " " << (*p_values)[i];
+		os << "\n";
+	}
+	bool ok = os.good();
+	os.close();
+	return ok;
+}
+
+void ParamSchema::applyFrozenPatterns()
+{
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		std::string path = getPath(i);
+		for (unsigned int n = 0; n < m_frozenPatterns.size(); n++)
+		{
+			const std::string& pattern = m_frozenPatterns[n];
+			// prefix match on whole path segments
+			if (path.compare(0, pattern.size(), pattern) == 0 &&
+				(path.size() == pattern.size() || path[pattern.size()] == '/' || path[pattern.size()] == '['))
+			{
+				m_entries[i].m_frozen = true;
+				break;
+			}
+		}
+	}
+	updateFreeIndices();
+}
+
+void ParamSchema::updateFreeIndices()
+{
+	m_freeIndices.clear();
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		if (!m_entries[i].m_frozen) m_freeIndices.push_back(i);
+	}
+}
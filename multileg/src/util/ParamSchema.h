@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class IOptimizable;
+
+// =======================================================================================
+//                                      ParamSchema
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Named layout of a flattened IOptimizable parameter list. Every entry has
+///			a name, the path of its owner in the IOptimizable hierarchy, bounds
+///			and a frozen flag. Frozen entries are left out when optimizing, so
+///			only the free subset is perturbed.
+///
+/// # ParamSchema
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class ParamSchema
+{
+public:
+	struct Entry
+	{
+		std::string m_name;
+		std::string m_owner; // scope path, '/' separated
+		float m_min, m_max;
+		bool m_frozen;
+	};
+
+	ParamSchema();
+	virtual ~ParamSchema() {}
+
+	// Generation, called from IOptimizable::describeParams in serialization order
+	void pushScope(const std::string& p_name);
+	void popScope();
+	// Adds one entry, or p_count indexed entries named name[i]
+	void add(const std::string& p_name, unsigned int p_count = 1);
+
+	// Describe the hierarchy of the root and fetch its bounds, returns false on layout mismatch
+	bool build(IOptimizable* p_root);
+	void clear();
+
+	unsigned int getSize() const;
+	const Entry& getEntry(unsigned int p_idx) const;
+	std::string getPath(unsigned int p_idx) const;
+	int findIndex(const std::string& p_path) const;
+	// Hash of all paths in order, identifies the layout a parameter file was saved with
+	unsigned long long getLayoutHash() const;
+
+	// Frozen patterns match path prefixes, "legFrame0/FhPD" freezes both gains of that PD
+	void addFrozenPattern(const std::string& p_pattern);
+	bool loadFrozenPatterns(const std::string& p_filePath);
+	void setFrozen(unsigned int p_idx, bool p_frozen);
+	unsigned int getFreeCount() const;
+	const std::vector<unsigned int>& getFreeIndices() const;
+
+	// Copy between a full parameter list and the list of free parameters
+	void gatherFree(const std::vector<float>& p_full, std::vector<float>& p_outSubset) const;
+	void scatterFree(const std::vector<float>& p_subset, std::vector<float>& p_inoutFull) const;
+
+	// Text listing of the layout, optionally with the values of a parameter list
+	bool saveListing(const std::string& p_filePath, const std::vector<float>* p_values = NULL) const;
+private:
+	void applyFrozenPatterns();
+	void updateFreeIndices();
+
+	std::vector<Entry> m_entries;
+	std::vector<std::string> m_scope;
+	std::string m_currentOwner;
+	std::vector<std::string> m_frozenPatterns;
+	std::vector<unsigned int> m_freeIndices;
+};
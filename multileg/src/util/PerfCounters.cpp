@@ -0,0 +1,162 @@
+#include "PerfCounters.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#define PERF_THREAD_LOCAL __declspec(thread)
+#else
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#define PERF_THREAD_LOCAL __thread
+#endif
+
+bool PerfCounters::s_enabled = false;
+bool PerfCounters::s_available[PerfCounters::COUNTER_COUNT] = { false };
+
+namespace
+{
+	// Per thread counter handles, plain data so it can be thread local
+	struct ThreadCounters
+	{
+		bool m_opened;
+		int m_leaderFd;
+		int m_groupIdx[PerfCounters::COUNTER_COUNT]; // position in the group read, -1 if not opened
+		int m_groupSize;
+	};
+	PERF_THREAD_LOCAL ThreadCounters t_counters;
+
+#ifndef _WIN32
+	int openEvent(unsigned int p_type, unsigned long long p_config, int p_groupFd)
+	{
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = p_type;
+		attr.config = p_config;
+		attr.disabled = p_groupFd == -1 ? 1 : 0; // members follow the leader
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		// this thread, on any cpu
+		return (int)syscall(__NR_perf_event_open, &attr, 0, -1, p_groupFd, 0);
+	}
+#endif
+}
+
+void PerfCounters::setEnabled(bool p_enabled)
+{
+	s_enabled = p_enabled;
+}
+
+bool PerfCounters::isEnabled()
+{
+	return s_enabled;
+}
+
+bool PerfCounters::isAvailable(Counter p_counter)
+{
+	return s_available[p_counter];
+}
+
+const char* PerfCounters::getName(Counter p_counter)
+{
+	switch (p_counter)
+	{
+	case CYCLES:		return "cycles";
+	case INSTRUCTIONS:	return "instructions";
+	case L1D_MISSES:	return "l1d_misses";
+	case LLC_MISSES:	return "llc_misses";
+	case BRANCH_MISSES:	return "branch_misses";
+	default:			return "unknown";
+	}
+}
+
+void PerfCounters::read(Sample& p_outSample)
+{
+	p_outSample.clear();
+	if (!s_enabled) return;
+	ThreadCounters& counters = t_counters;
+#ifdef _WIN32
+	// Only the cycles are reachable from user mode
+	if (!counters.m_opened)
+	{
+		counters.m_opened = true;
+		s_available[CYCLES] = true;
+	}
+	ULONG64 cycles = 0;
+	QueryThreadCycleTime(GetCurrentThread(), &cycles);
+	p_outSample.m_values[CYCLES] = (unsigned long long)cycles;
+#else
+	if (!counters.m_opened)
+	{
+		counters.m_opened = true;
+		counters.m_leaderFd = -1;
+		counters.m_groupSize = 0;
+		const unsigned int types[COUNTER_COUNT] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+													PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+		const unsigned long long configs[COUNTER_COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+			PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+		// Counters the pmu (or vm) doesn't support are left out of the group
+		for (int i = 0; i < COUNTER_COUNT; i++)
+		{
+			counters.m_groupIdx[i] = -1;
+			int fd = openEvent(types[i], configs[i], counters.m_leaderFd);
+			if (fd == -1) continue;
+			if (counters.m_leaderFd == -1) counters.m_leaderFd = fd;
+			counters.m_groupIdx[i] = counters.m_groupSize++;
+			s_available[i] = true;
+		}
+		if (counters.m_leaderFd != -1)
+			ioctl(counters.m_leaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+	if (counters.m_leaderFd == -1) return;
+	unsigned long long buffer[1 + COUNTER_COUNT]; // nr, then the values in group order
+	if (::read(counters.m_leaderFd, buffer, sizeof(buffer)) <= 0) return;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		if (counters.m_groupIdx[i] >= 0)
+			p_outSample.m_values[i] = buffer[1 + counters.m_groupIdx[i]];
+	}
+#endif
+}
+
+void PerfCounterRecorder::activate()
+{
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+		m_bins[i].activate();
+}
+
+bool PerfCounterRecorder::isActive()
+{
+	return m_bins[0].isActive();
+}
+
+void PerfCounterRecorder::accumulateAt(const PerfCounters::Sample& p_sample, int p_tick)
+{
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+	{
+		if (PerfCounters::isAvailable((PerfCounters::Counter)i))
+			m_bins[i].accumulateMeasurementAt((float)p_sample.m_values[i], p_tick);
+	}
+}
+
+void PerfCounterRecorder::finishRound()
+{
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+		m_bins[i].finishRound();
+}
+
+bool PerfCounterRecorder::saveResultsGNUPLOT(const std::string& p_fileNamePrefix)
+{
+	bool res = true;
+	for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+	{
+		PerfCounters::Counter counter = (PerfCounters::Counter)i;
+		if (PerfCounters::isAvailable(counter))
+			res = m_bins[i].saveResultsGNUPLOT(p_fileNamePrefix + "_" + PerfCounters::getName(counter)) && res;
+	}
+	return res;
+}
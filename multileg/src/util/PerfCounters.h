@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "MeasurementBin.h"
+
+// =======================================================================================
+//                                      PerfCounters
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Per thread hardware counters: cycles, instructions, L1 data misses, last
+///			level cache misses and branch misses. Each thread opens its own counters
+///			on its first read, so a worker reads its own start and end around the
+///			work it does.
+///
+///			On Linux the counters are perf_event_open groups. On Windows there is no
+///			user mode access to the PMU, only the cycles are available through
+///			QueryThreadCycleTime and the others read as zero, check isAvailable.
+///			Nothing is opened or read until setEnabled(true).
+///
+/// # PerfCounters
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class PerfCounters
+{
+public:
+	enum Counter
+	{
+		CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES,
+		COUNTER_COUNT
+	};
+
+	struct Sample
+	{
+		unsigned long long m_values[COUNTER_COUNT];
+
+		Sample() { clear(); }
+		void clear()
+		{
+			for (int i = 0; i < COUNTER_COUNT; i++) m_values[i] = 0;
+		}
+		void add(const Sample& p_other)
+		{
+			for (int i = 0; i < COUNTER_COUNT; i++) m_values[i] += p_other.m_values[i];
+		}
+		// Counter difference from p_start to this
+		Sample delta(const Sample& p_start) const
+		{
+			Sample res;
+			for (int i = 0; i < COUNTER_COUNT; i++) res.m_values[i] = m_values[i] - p_start.m_values[i];
+			return res;
+		}
+		// Instructions per cycle, zero if either is unavailable
+		double getIPC() const
+		{
+			return m_values[CYCLES] > 0 ? (double)m_values[INSTRUCTIONS] / (double)m_values[CYCLES] : 0.0;
+		}
+	};
+
+	static void setEnabled(bool p_enabled);
+	static bool isEnabled();
+	// Whether the backend could open this counter (known after the first read)
+	static bool isAvailable(Counter p_counter);
+	static const char* getName(Counter p_counter);
+
+	// Current counter values of the calling thread
+	static void read(Sample& p_outSample);
+private:
+	static bool s_enabled;
+	static bool s_available[COUNTER_COUNT];
+};
+
+// =======================================================================================
+//                                      PerfCounterRecorder
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	One MeasurementBin series per counter, keyed by tick, for a measured
+///			section such as the controller phase or the physics step.
+///
+/// # PerfCounterRecorder
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class PerfCounterRecorder
+{
+public:
+	void activate();
+	bool isActive();
+	void accumulateAt(const PerfCounters::Sample& p_sample, int p_tick);
+	void finishRound();
+	// Writes p_fileNamePrefix_<counter>.gnuplot.txt for every available counter
+	bool saveResultsGNUPLOT(const std::string& p_fileNamePrefix);
+private:
+	MeasurementBin<std::vector<float>> m_bins[PerfCounters::COUNTER_COUNT];
+};
@@ -0,0 +1,231 @@
+#include "ResultRecord.h"
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include "ToString.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+void ResultRecord::setInt(const std::string& p_name, long long p_value)
+{
+	set(p_name, INT).m_int = p_value;
+}
+
+void ResultRecord::setDouble(const std::string& p_name, double p_value)
+{
+	set(p_name, DOUBLE).m_double = p_value;
+}
+
+void ResultRecord::setFloats(const std::string& p_name, const std::vector<float>& p_values)
+{
+	set(p_name, FLOATS).m_floats = p_values;
+}
+
+void ResultRecord::setString(const std::string& p_name, const std::string& p_value)
+{
+	set(p_name, STRING).m_string = p_value;
+}
+
+void ResultRecord::setHostInfo()
+{
+	char host[256] = "unknown";
+#ifdef _WIN32
+	DWORD hostSize = sizeof(host);
+	GetComputerNameA(host, &hostSize);
+#else
+	gethostname(host, sizeof(host));
+	host[sizeof(host) - 1] = '\0';
+#endif
+	setString("host", host);
+	setInt("logicalCores", (long long)std::thread::hardware_concurrency());
+#ifdef _DEBUG
+	std::string build = "Debug";
+#else
+	std::string build = "Release";
+#endif
+#if defined(_WIN64) || defined(__x86_64__)
+	build += " x64";
+#else
+	build += " x86";
+#endif
+	setString("build", build);
+	setInt("time", (long long)time(NULL));
+}
+
+bool ResultRecord::has(const std::string& p_name) const
+{
+	return find(p_name) != NULL;
+}
+
+long long ResultRecord::getInt(const std::string& p_name, long long p_default /*= 0*/) const
+{
+	const Column* column = find(p_name);
+	return column != NULL && column->m_type == INT ? column->m_int : p_default;
+}
+
+double ResultRecord::getDouble(const std::string& p_name, double p_default /*= 0.0*/) const
+{
+	const Column* column = find(p_name);
+	if (column == NULL) return p_default;
+	if (column->m_type == DOUBLE) return column->m_double;
+	if (column->m_type == INT) return (double)column->m_int;
+	return p_default;
+}
+
+const std::vector<float>* ResultRecord::getFloats(const std::string& p_name) const
+{
+	const Column* column = find(p_name);
+	return column != NULL && column->m_type == FLOATS ? &column->m_floats : NULL;
+}
+
+std::string ResultRecord::getString(const std::string& p_name, const std::string& p_default /*= ""*/) const
+{
+	const Column* column = find(p_name);
+	return column != NULL && column->m_type == STRING ? column->m_string : p_default;
+}
+
+std::string ResultRecord::getText(const std::string& p_name) const
+{
+	const Column* column = find(p_name);
+	if (column == NULL) return "";
+	switch (column->m_type)
+	{
+	case INT:
+		return ToString(column->m_int);
+	case DOUBLE:
+		return ToString(column->m_double);
+	case STRING:
+		return column->m_string;
+	default:
+	{
+		std::string text;
+		for (unsigned int i = 0; i < column->m_floats.size(); i++)
+			text += (i > 0 ? " " : "") + ToString(column->m_floats[i]);
+		return text;
+	}
+	}
+}
+
+unsigned int ResultRecord::getColumnCount() const
+{
+	return (unsigned int)m_columns.size();
+}
+
+const std::string& ResultRecord::getColumnName(unsigned int p_idx) const
+{
+	return m_columns[p_idx].m_name;
+}
+
+ResultRecord::ColumnType ResultRecord::getColumnType(unsigned int p_idx) const
+{
+	return m_columns[p_idx].m_type;
+}
+
+void ResultRecord::serialize(std::vector<unsigned char>& p_outData) const
+{
+	// Column table
+	for (unsigned int i = 0; i < m_columns.size(); i++)
+	{
+		const Column& column = m_columns[i];
+		ColumnHeader header;
+		memset(&header, 0, sizeof(ColumnHeader));
+		memcpy(header.m_name, column.m_name.c_str(), column.m_name.size()); // set() keeps it below MAX_NAME
+		header.m_type = (unsigned int)column.m_type;
+		header.m_count = 1;
+		if (column.m_type == FLOATS) header.m_count = (unsigned int)column.m_floats.size();
+		if (column.m_type == STRING) header.m_count = (unsigned int)column.m_string.size();
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&header);
+		p_outData.insert(p_outData.end(), bytes, bytes + sizeof(ColumnHeader));
+	}
+	// Values
+	for (unsigned int i = 0; i < m_columns.size(); i++)
+	{
+		const Column& column = m_columns[i];
+		const unsigned char* bytes = NULL;
+		size_t size = 0;
+		switch (column.m_type)
+		{
+		case INT:
+			bytes = reinterpret_cast<const unsigned char*>(&column.m_int); size = sizeof(long long); break;
+		case DOUBLE:
+			bytes = reinterpret_cast<const unsigned char*>(&column.m_double); size = sizeof(double); break;
+		case FLOATS:
+			size = column.m_floats.size() * sizeof(float);
+			if (size > 0) bytes = reinterpret_cast<const unsigned char*>(&column.m_floats[0]);
+			break;
+		case STRING:
+			bytes = reinterpret_cast<const unsigned char*>(column.m_string.c_str()); size = column.m_string.size(); break;
+		}
+		if (size > 0)
+			p_outData.insert(p_outData.end(), bytes, bytes + size);
+	}
+}
+
+bool ResultRecord::deserialize(const unsigned char* p_data, unsigned int p_size, unsigned int p_columnCount)
+{
+	m_columns.clear();
+	unsigned int offset = p_columnCount * (unsigned int)sizeof(ColumnHeader);
+	if (offset > p_size)
+		return false;
+	for (unsigned int i = 0; i < p_columnCount; i++)
+	{
+		ColumnHeader header;
+		memcpy(&header, p_data + i * sizeof(ColumnHeader), sizeof(ColumnHeader));
+		header.m_name[MAX_NAME - 1] = '\0';
+		if (header.m_type > STRING || header.m_count > p_size)
+			return false;
+		unsigned int bytes = header.m_type == FLOATS ? header.m_count * (unsigned int)sizeof(float) :
+			header.m_type == STRING ? header.m_count : 8;
+		if (bytes > p_size - offset)
+			return false;
+		Column& column = set(header.m_name, (ColumnType)header.m_type);
+		const unsigned char* value = p_data + offset;
+		switch (column.m_type)
+		{
+		case INT:
+			memcpy(&column.m_int, value, sizeof(long long)); break;
+		case DOUBLE:
+			memcpy(&column.m_double, value, sizeof(double)); break;
+		case FLOATS:
+			column.m_floats.resize(header.m_count);
+			if (bytes > 0) memcpy(&column.m_floats[0], value, bytes);
+			break;
+		case STRING:
+			column.m_string.assign(reinterpret_cast<const char*>(value), header.m_count); break;
+		}
+		offset += bytes;
+	}
+	return offset == p_size;
+}
+
+const ResultRecord::Column* ResultRecord::find(const std::string& p_name) const
+{
+	for (unsigned int i = 0; i < m_columns.size(); i++)
+	{
+		if (m_columns[i].m_name == p_name)
+			return &m_columns[i];
+	}
+	return NULL;
+}
+
+ResultRecord::Column& ResultRecord::set(const std::string& p_name, ColumnType p_type)
+{
+	std::string name = p_name.substr(0, MAX_NAME - 1);
+	Column* column = const_cast<Column*>(find(name));
+	if (column == NULL)
+	{
+		m_columns.push_back(Column());
+		column = &m_columns.back();
+		column->m_name = name;
+	}
+	column->m_type = p_type;
+	column->m_int = 0;
+	column->m_double = 0.0;
+	column->m_string.clear();
+	column->m_floats.clear();
+	return *column;
+}
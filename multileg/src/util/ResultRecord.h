@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// =======================================================================================
+//                                      ResultRecord
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	One benchmark run as named, typed columns: integers and doubles for the
+///			configuration and summary stats, strings for host info and float arrays
+///			for the per tick samples. Setting a column that exists replaces it. The
+///			binary layout is a column table followed by each column's values stored
+///			contiguously, see ResultStore.
+///
+/// # ResultRecord
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class ResultRecord
+{
+public:
+	enum ColumnType
+	{
+		INT, DOUBLE, FLOATS, STRING
+	};
+	static const unsigned int MAX_NAME = 32; // including the terminator
+
+	void setInt(const std::string& p_name, long long p_value);
+	void setDouble(const std::string& p_name, double p_value);
+	void setFloats(const std::string& p_name, const std::vector<float>& p_values);
+	void setString(const std::string& p_name, const std::string& p_value);
+	// Host name, logical processors, build and time of the run
+	void setHostInfo();
+
+	bool has(const std::string& p_name) const;
+	long long getInt(const std::string& p_name, long long p_default = 0) const;
+	// Integer columns are converted
+	double getDouble(const std::string& p_name, double p_default = 0.0) const;
+	// NULL if there is no such float array column
+	const std::vector<float>* getFloats(const std::string& p_name) const;
+	std::string getString(const std::string& p_name, const std::string& p_default = "") const;
+	// Any column as text, for listing and filtering
+	std::string getText(const std::string& p_name) const;
+
+	unsigned int getColumnCount() const;
+	const std::string& getColumnName(unsigned int p_idx) const;
+	ColumnType getColumnType(unsigned int p_idx) const;
+
+	// Appends the column table and values to p_outData
+	void serialize(std::vector<unsigned char>& p_outData) const;
+	// p_size must be exactly the table of p_columnCount columns and their values
+	bool deserialize(const unsigned char* p_data, unsigned int p_size, unsigned int p_columnCount);
+private:
+	struct Column
+	{
+		std::string m_name;
+		ColumnType m_type;
+		long long m_int;
+		double m_double;
+		std::string m_string;
+		std::vector<float> m_floats;
+	};
+	// On disk, followed by the values of all columns in the same order
+	struct ColumnHeader
+	{
+		char m_name[MAX_NAME];
+		unsigned int m_type;
+		unsigned int m_count;	// values, characters for strings
+	};
+
+	const Column* find(const std::string& p_name) const;
+	Column& set(const std::string& p_name, ColumnType p_type);
+
+	std::vector<Column> m_columns;
+};
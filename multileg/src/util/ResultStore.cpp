@@ -0,0 +1,215 @@
+#include "ResultStore.h"
+#include <cstring>
+#include <fstream>
+#include "CurrentPathHelper.h"
+#include "LatencyHistogram.h"
+#include "ToString.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool ResultStore::append(const std::string& p_fileName, const ResultRecord& p_record)
+{
+	// The whole record is put together first so it goes out in a single write
+	std::vector<unsigned char> data(sizeof(RecordHeader));
+	p_record.serialize(data);
+	RecordHeader header;
+	header.m_magic = RECORD_MAGIC;
+	header.m_version = VERSION;
+	header.m_size = (unsigned int)(data.size() - sizeof(RecordHeader));
+	header.m_columnCount = p_record.getColumnCount();
+	header.m_checksum = checksum(&data[sizeof(RecordHeader)], header.m_size);
+	memcpy(&data[0], &header, sizeof(RecordHeader));
+
+	std::string path = GetExecutablePathDirectory() + p_fileName;
+	bool written = false;
+#ifdef _WIN32
+	// LockFileEx needs read or write access, append only access can't be locked
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+		OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	// Locking the largest range serializes the writers, readers don't lock
+	OVERLAPPED region;
+	memset(&region, 0, sizeof(OVERLAPPED));
+	if (LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &region))
+	{
+		// The end is only known once the lock is held
+		LARGE_INTEGER zero;
+		zero.QuadPart = 0;
+		DWORD bytes = 0;
+		written = SetFilePointerEx(file, zero, NULL, FILE_END) &&
+			WriteFile(file, &data[0], (DWORD)data.size(), &bytes, NULL) && bytes == (DWORD)data.size();
+		UnlockFileEx(file, 0, MAXDWORD, MAXDWORD, &region);
+	}
+	CloseHandle(file);
+#else
+	int file = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+	if (file == -1)
+		return false;
+	if (flock(file, LOCK_EX) == 0)
+	{
+		written = write(file, &data[0], data.size()) == (ssize_t)data.size();
+		flock(file, LOCK_UN);
+	}
+	::close(file);
+#endif
+	return written;
+}
+
+bool ResultStore::readAll(const std::string& p_fileName, std::vector<ResultRecord>& p_outRecords,
+	unsigned int* p_outSkipped /*= NULL*/)
+{
+	std::ifstream file(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::in);
+	if (!file.good() || !file.is_open())
+		return false;
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	unsigned int skipped = 0;
+	bool skipping = false;
+	size_t offset = 0;
+	while (offset + sizeof(RecordHeader) <= data.size())
+	{
+		RecordHeader header;
+		memcpy(&header, &data[offset], sizeof(RecordHeader));
+		const unsigned char* payload = &data[offset] + sizeof(RecordHeader);
+		bool valid = header.m_magic == RECORD_MAGIC && header.m_version == VERSION &&
+			header.m_size <= data.size() - offset - sizeof(RecordHeader) &&
+			checksum(payload, header.m_size) == header.m_checksum;
+		ResultRecord record;
+		if (valid && record.deserialize(payload, header.m_size, header.m_columnCount))
+		{
+			p_outRecords.push_back(record);
+			offset += sizeof(RecordHeader) + header.m_size;
+			skipping = false;
+		}
+		else
+		{
+			// Look for the next record header byte by byte
+			if (!skipping) skipped++;
+			skipping = true;
+			offset++;
+		}
+	}
+	if (offset < data.size() && !skipping)
+		skipped++; // truncated tail
+	if (p_outSkipped != NULL)
+		*p_outSkipped = skipped;
+	return true;
+}
+
+void ResultStore::setPerfColumns(ResultRecord& p_record, double p_mean, double p_std, int p_runs,
+	const std::vector<double>& p_stepMeans, const std::vector<double>& p_stepSTDs,
+	const std::vector<float>& p_percentiles)
+{
+	p_record.setDouble("mean", p_mean);
+	p_record.setDouble("std", p_std);
+	p_record.setInt("runs", p_runs);
+	p_record.setFloats("stepMeans", std::vector<float>(p_stepMeans.begin(), p_stepMeans.end()));
+	p_record.setFloats("stepSTDs", std::vector<float>(p_stepSTDs.begin(), p_stepSTDs.end()));
+	p_record.setFloats("percentiles", p_percentiles);
+}
+
+bool ResultStore::savePerfGNUPLOT(const ResultRecord& p_record, const std::string& p_fileName)
+{
+	const std::vector<float>* means = p_record.getFloats("stepMeans");
+	const std::vector<float>* stds = p_record.getFloats("stepSTDs");
+	if (means == NULL || stds == NULL || means->size() != stds->size())
+		return false;
+	std::ofstream outFile(GetExecutablePathDirectory() + p_fileName + ".gnuplot.txt");
+	if (!outFile.good())
+		return false;
+	outFile << "# " << p_fileName << "\n";
+	outFile << "# step - mean (" << p_record.getDouble("mean") << ") - standard deviation (" << p_record.getDouble("std")
+		<< ") r=" << p_record.getInt("runs") << " - ylow - yhigh\n";
+	const std::vector<float>* percentiles = p_record.getFloats("percentiles");
+	if (percentiles != NULL && percentiles->size() == 5)
+	{
+		outFile << "# " << LatencyHistogram::getSummaryNames() << " (" << (*percentiles)[0] << " " << (*percentiles)[1] << " "
+			<< (*percentiles)[2] << " " << (*percentiles)[3] << " " << (*percentiles)[4] << ")\n";
+	}
+	for (unsigned int i = 0; i < means->size(); i++)
+	{
+		double mean = (*means)[i], std = (*stds)[i];
+		outFile << i << " " << mean << " " << std << " " << mean - std << " " << mean + std << "\n";
+	}
+	outFile.close();
+	return true;
+}
+
+bool ResultStore::saveCollectionGNUPLOT(const std::vector<const ResultRecord*>& p_records, const std::string& p_fileName)
+{
+	// One row per character count, starting at one character, the last record of a count is used
+	std::vector<const ResultRecord*> rows;
+	bool hasPercentiles = false;
+	for (unsigned int i = 0; i < p_records.size(); i++)
+	{
+		long long chars = p_records[i]->getInt("chars");
+		if (chars < 1) continue;
+		if (rows.size() < (size_t)chars)
+			rows.resize((size_t)chars, NULL);
+		rows[(size_t)chars - 1] = p_records[i];
+		hasPercentiles = hasPercentiles || p_records[i]->getFloats("percentiles") != NULL;
+	}
+	std::ofstream outFile(GetExecutablePathDirectory() + p_fileName + ".gnuplot.txt");
+	if (!outFile.good())
+		return false;
+	outFile << "# " << p_fileName << "\n";
+	outFile << "# step - mean - standard deviation - ylow - yhigh";
+	if (hasPercentiles)
+		outFile << " - " << LatencyHistogram::getSummaryNames();
+	outFile << "\n";
+	for (unsigned int i = 0; i < rows.size(); i++)
+	{
+		if (rows[i] == NULL)
+		{
+			outFile << i << " 0 0 0 0\n"; // not measured
+			continue;
+		}
+		float mean = (float)rows[i]->getDouble("mean"), std = (float)rows[i]->getDouble("std");
+		outFile << i << " " << mean << " " << std << " " << mean - std << " " << mean + std;
+		const std::vector<float>* percentiles = rows[i]->getFloats("percentiles");
+		if (percentiles != NULL)
+		{
+			for (unsigned int n = 0; n < percentiles->size(); n++)
+				outFile << " " << (*percentiles)[n];
+		}
+		outFile << "\n";
+	}
+	outFile.close();
+	return true;
+}
+
+std::string ResultStore::getPerfTableName(const ResultRecord& p_record)
+{
+	bool serial = p_record.getString("exec") == "Serial";
+	std::string name = std::string("perf_") + (serial ? "serial" : "parallel") +
+		ToString(p_record.getInt("chars")) + p_record.getString("pod");
+	if (!serial)
+		name += "_thread" + ToString(p_record.getInt("threads"));
+	return name;
+}
+
+std::string ResultStore::getCollectionTableName(const ResultRecord& p_record)
+{
+	bool serial = p_record.getString("exec") == "Serial";
+	std::string name = "CollectedRunsResult" + p_record.getString("exec") + p_record.getString("pod");
+	if (!serial)
+		name += ToString(p_record.getInt("threads"));
+	return name;
+}
+
+unsigned long long ResultStore::checksum(const unsigned char* p_data, unsigned int p_size)
+{
+	// FNV-1a
+	unsigned long long hash = 14695981039346656037ULL;
+	for (unsigned int i = 0; i < p_size; i++)
+		hash = (hash ^ (unsigned long long)p_data[i]) * 1099511628211ULL;
+	return hash;
+}
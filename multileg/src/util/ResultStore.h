@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "ResultRecord.h"
+
+// =======================================================================================
+//                                      ResultStore
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Append-only binary file of benchmark results, replacing the collection
+///			text files that were rewritten in place for every run. Each run is one
+///			ResultRecord, written with a header holding its size and a checksum.
+///			There is no file header, so any number of processes can append to the
+///			same file: a record is written with one write at the end of the file,
+///			under an exclusive file lock.
+///
+///			Reading skips records that are half written or damaged, so a crashed
+///			writer only loses its own record. When the same configuration is stored
+///			more than once, the last record is the current result.
+///
+/// # ResultStore
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class ResultStore
+{
+public:
+	static const unsigned int RECORD_MAGIC = 0x53455252; // "RRES"
+	static const unsigned int VERSION = 1;
+
+	struct RecordHeader
+	{
+		unsigned int m_magic;
+		unsigned int m_version;
+		unsigned int m_size;			// bytes of the column table and values after this header
+		unsigned int m_columnCount;
+		unsigned long long m_checksum;	// of the bytes after this header
+	};
+
+	// Appends to GetExecutablePathDirectory()+p_fileName, creating it if needed
+	static bool append(const std::string& p_fileName, const ResultRecord& p_record);
+	// Reads the complete records in file order, p_outSkipped counts the broken ones
+	static bool readAll(const std::string& p_fileName, std::vector<ResultRecord>& p_outRecords,
+		unsigned int* p_outSkipped = NULL);
+
+	// Fills in the summary and per step columns of a controller performance run,
+	// p_stepMeans and p_stepSTDs are over the runs of each step. The raw per tick
+	// samples aren't kept, MeasurementBin only holds running stats, they are
+	// streamed by MeasurementWriter instead.
+	static void setPerfColumns(ResultRecord& p_record, double p_mean, double p_std, int p_runs,
+		const std::vector<double>& p_stepMeans, const std::vector<double>& p_stepSTDs,
+		const std::vector<float>& p_percentiles);
+
+	// The tables the app used to write, regenerated from the records.
+	// Per step mean and std of one run, like MeasurementBin::saveResultsGNUPLOT
+	static bool savePerfGNUPLOT(const ResultRecord& p_record, const std::string& p_fileName);
+	// Mean, std and percentiles per character count, for one execution setup
+	static bool saveCollectionGNUPLOT(const std::vector<const ResultRecord*>& p_records, const std::string& p_fileName);
+
+	// The file name the app used for the tables of the record, without folder and extension
+	static std::string getPerfTableName(const ResultRecord& p_record);
+	static std::string getCollectionTableName(const ResultRecord& p_record);
+
+	static unsigned long long checksum(const unsigned char* p_data, unsigned int p_size);
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <cmath>
+
+// =======================================================================================
+//                                      RunningStat
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Constant memory accumulator of a stream of values. The mean is kept as a
+///			plain running sum, so it matches summing a stored list in the same
+///			order. Variance uses Welford's update.
+///
+/// # RunningStat
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class RunningStat
+{
+public:
+	RunningStat()
+	{
+		clear();
+	}
+
+	void add(double p_value)
+	{
+		m_count++;
+		m_sum += p_value;
+		double delta = p_value - m_welfordMean;
+		m_welfordMean += delta / (double)m_count;
+		m_m2 += delta * (p_value - m_welfordMean);
+	}
+
+	void clear()
+	{
+		m_count = 0;
+		m_sum = 0.0;
+		m_welfordMean = 0.0;
+		m_m2 = 0.0;
+	}
+
+	unsigned int getCount() const	{ return m_count; }
+	double getSum() const			{ return m_sum; }
+
+	// Mean, zero when empty
+	double getMean() const
+	{
+		return m_sum / (m_count > 0 ? (double)m_count : 1.0);
+	}
+
+	// Population variance and standard deviation
+	double getVariance() const
+	{
+		return m_count > 1 ? m_m2 / (double)m_count : 0.0;
+	}
+
+	double getSTD() const
+	{
+		return sqrt(getVariance());
+	}
+private:
+	unsigned int m_count;
+	double m_sum;
+	double m_welfordMean;
+	double m_m2; // sum of squared differences from the current mean
+};
@@ -0,0 +1,196 @@
+#include "SimCheckpoint.h"
+#include <cstring>
+#include <fstream>
+#include "CurrentPathHelper.h"
+#include "ResultStore.h"
+
+SimCheckpoint::SimCheckpoint()
+{
+	clear();
+}
+
+void SimCheckpoint::clear()
+{
+	m_data.clear();
+	m_tick = 0;
+	m_sectionStart = 0;
+	m_readOffset = 0;
+	m_readEnd = 0;
+	m_readValid = false;
+}
+
+bool SimCheckpoint::isEmpty() const
+{
+	return m_data.empty();
+}
+
+void SimCheckpoint::setTick(unsigned int p_tick)
+{
+	m_tick = p_tick;
+}
+
+unsigned int SimCheckpoint::getTick() const
+{
+	return m_tick;
+}
+
+unsigned int SimCheckpoint::getSize() const
+{
+	return (unsigned int)(sizeof(Header) + m_data.size());
+}
+
+void SimCheckpoint::beginSection(Section p_id)
+{
+	m_sectionStart = m_data.size();
+	SectionHeader header;
+	header.m_id = (unsigned int)p_id;
+	header.m_size = 0;
+	write(&header, (unsigned int)sizeof(SectionHeader));
+}
+
+void SimCheckpoint::endSection()
+{
+	SectionHeader header;
+	memcpy(&header, &m_data[m_sectionStart], sizeof(SectionHeader));
+	header.m_size = (unsigned int)(m_data.size() - m_sectionStart - sizeof(SectionHeader));
+	memcpy(&m_data[m_sectionStart], &header, sizeof(SectionHeader));
+}
+
+void SimCheckpoint::write(const void* p_data, unsigned int p_size)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p_data);
+	m_data.insert(m_data.end(), bytes, bytes + p_size);
+}
+
+void SimCheckpoint::writeBools(const std::vector<bool>& p_values)
+{
+	// vector<bool> is packed, so one byte each
+	write((unsigned int)p_values.size());
+	for (unsigned int i = 0; i < p_values.size(); i++)
+		write((unsigned char)(p_values[i] ? 1 : 0));
+}
+
+bool SimCheckpoint::seekSection(Section p_id)
+{
+	size_t offset = 0;
+	while (offset + sizeof(SectionHeader) <= m_data.size())
+	{
+		SectionHeader header;
+		memcpy(&header, &m_data[offset], sizeof(SectionHeader));
+		offset += sizeof(SectionHeader);
+		if (header.m_size > m_data.size() - offset)
+			break;
+		if (header.m_id == (unsigned int)p_id)
+		{
+			m_readOffset = offset;
+			m_readEnd = offset + header.m_size;
+			m_readValid = true;
+			return true;
+		}
+		offset += header.m_size;
+	}
+	return invalidate();
+}
+
+bool SimCheckpoint::read(void* p_data, unsigned int p_size)
+{
+	if (!m_readValid || p_size > m_readEnd - m_readOffset)
+		return invalidate();
+	if (p_size > 0)
+		memcpy(p_data, &m_data[m_readOffset], p_size);
+	m_readOffset += p_size;
+	return true;
+}
+
+bool SimCheckpoint::readCount(unsigned int p_expected)
+{
+	unsigned int count = 0;
+	if (!read(count) || count != p_expected)
+		return invalidate();
+	return true;
+}
+
+bool SimCheckpoint::readBools(std::vector<bool>& p_values)
+{
+	if (!readCount((unsigned int)p_values.size()))
+		return false;
+	for (unsigned int i = 0; i < p_values.size(); i++)
+	{
+		unsigned char value = 0;
+		if (!read(value))
+			return false;
+		p_values[i] = value != 0;
+	}
+	return true;
+}
+
+bool SimCheckpoint::readBools(std::vector<bool>& p_values, bool p_apply)
+{
+	if (p_apply) return readBools(p_values);
+	return readCount((unsigned int)p_values.size()) && skip((unsigned int)p_values.size());
+}
+
+bool SimCheckpoint::skip(unsigned int p_size)
+{
+	if (!m_readValid || p_size > m_readEnd - m_readOffset)
+		return invalidate();
+	m_readOffset += p_size;
+	return true;
+}
+
+bool SimCheckpoint::isReadValid() const
+{
+	return m_readValid;
+}
+
+bool SimCheckpoint::isSectionRead() const
+{
+	return m_readValid && m_readOffset == m_readEnd;
+}
+
+bool SimCheckpoint::save(const std::string& p_fileName) const
+{
+	Header header;
+	header.m_magic = MAGIC;
+	header.m_version = VERSION;
+	header.m_tick = m_tick;
+	header.m_size = (unsigned int)m_data.size();
+	header.m_checksum = ResultStore::checksum(m_data.empty() ? NULL : &m_data[0], header.m_size);
+	std::vector<unsigned char> blob(sizeof(Header));
+	memcpy(&blob[0], &header, sizeof(Header));
+	blob.insert(blob.end(), m_data.begin(), m_data.end());
+	std::ofstream file(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!file.good() || !file.is_open())
+		return false;
+	file.write(reinterpret_cast<const char*>(&blob[0]), blob.size());
+	bool written = file.good();
+	file.close();
+	return written;
+}
+
+bool SimCheckpoint::load(const std::string& p_fileName)
+{
+	std::ifstream file(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::in);
+	if (!file.good() || !file.is_open())
+		return false;
+	std::vector<unsigned char> blob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	Header header;
+	if (blob.size() < sizeof(Header))
+		return false;
+	memcpy(&header, &blob[0], sizeof(Header));
+	const unsigned char* sections = &blob[0] + sizeof(Header);
+	if (header.m_magic != MAGIC || header.m_version != VERSION || header.m_size != blob.size() - sizeof(Header) ||
+		ResultStore::checksum(sections, header.m_size) != header.m_checksum)
+		return false;
+	clear();
+	m_tick = header.m_tick;
+	m_data.assign(sections, sections + header.m_size);
+	return true;
+}
+
+bool SimCheckpoint::invalidate()
+{
+	m_readValid = false;
+	return false;
+}
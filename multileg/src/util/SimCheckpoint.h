@@ -0,0 +1,120 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// =======================================================================================
+//                                      SimCheckpoint
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Complete run-time state of a simulation at one tick, in one binary blob.
+///			The state is written in sections, one per owner: the physics world, the
+///			rigidbodies and their components, and the controllers. Each owner writes
+///			and reads its own section, see PhysicsWorldHandler::saveCheckpoint.
+///
+///			Only state is stored, not structure. A checkpoint is restored into a
+///			world built the same way, same pod and character count, after its
+///			controllers are built. The gait parameters are not part of the state,
+///			so one checkpoint can be forked into runs with different gaits.
+///
+///			Reading past the end of a section invalidates the reader. A restore
+///			reads every section twice, first a check pass that verifies the counts
+///			and that each section is read to its end without applying anything,
+///			then the pass that applies it. A bad checkpoint leaves the world as it was.
+///
+/// # SimCheckpoint
+///
+/// 19-10-2026
+///---------------------------------------------------------------------------------------
+
+class SimCheckpoint
+{
+public:
+	static const unsigned int MAGIC = 0x4B484353; // "SCHK"
+	static const unsigned int VERSION = 1;
+
+	enum Section
+	{
+		PHYSICS = 1, BODIES = 2, CONTROLLERS = 3
+	};
+
+	struct Header
+	{
+		unsigned int m_magic;
+		unsigned int m_version;
+		unsigned int m_tick;			// internal physics step the state was taken after
+		unsigned int m_size;			// bytes of the sections after this header
+		unsigned long long m_checksum;	// of the bytes after this header
+	};
+
+	struct SectionHeader
+	{
+		unsigned int m_id;
+		unsigned int m_size;	// bytes after this header
+	};
+
+	SimCheckpoint();
+
+	void clear();
+	bool isEmpty() const;
+	void setTick(unsigned int p_tick);
+	unsigned int getTick() const;
+	// Bytes of the blob, header included
+	unsigned int getSize() const;
+
+	// Writing, values go to the section begun last
+	void beginSection(Section p_id);
+	void endSection();
+	void write(const void* p_data, unsigned int p_size);
+	template<class T>
+	void write(const T& p_value) { write(&p_value, (unsigned int)sizeof(T)); }
+	template<class T>
+	void writeVector(const std::vector<T>& p_values)
+	{
+		write((unsigned int)p_values.size());
+		if (!p_values.empty()) write(&p_values[0], (unsigned int)(p_values.size() * sizeof(T)));
+	}
+	void writeBools(const std::vector<bool>& p_values);
+
+	// Reading, a section is read in the order it was written
+	bool seekSection(Section p_id);
+	bool read(void* p_data, unsigned int p_size);
+	template<class T>
+	bool read(T& p_value) { return read(&p_value, (unsigned int)sizeof(T)); }
+	// A written count, that has to be p_expected
+	bool readCount(unsigned int p_expected);
+	// Into a vector of the same size as the written one
+	template<class T>
+	bool readVector(std::vector<T>& p_values)
+	{
+		if (!readCount((unsigned int)p_values.size()))
+			return false;
+		return p_values.empty() || read(&p_values[0], (unsigned int)(p_values.size() * sizeof(T)));
+	}
+	bool readBools(std::vector<bool>& p_values);
+	// Check pass versions, unless p_apply the count is verified and the values are skipped
+	template<class T>
+	bool readVector(std::vector<T>& p_values, bool p_apply)
+	{
+		if (p_apply) return readVector(p_values);
+		return readCount((unsigned int)p_values.size()) && skip((unsigned int)(p_values.size() * sizeof(T)));
+	}
+	bool readBools(std::vector<bool>& p_values, bool p_apply);
+	bool skip(unsigned int p_size);
+	// False once a read has gone past its section or a count did not match
+	bool isReadValid() const;
+	// Valid and every byte of the section sought last has been read
+	bool isSectionRead() const;
+
+	// The blob as one write, to GetExecutablePathDirectory()+p_fileName
+	bool save(const std::string& p_fileName) const;
+	bool load(const std::string& p_fileName);
+private:
+	bool invalidate();
+
+	std::vector<unsigned char> m_data; // sections
+	unsigned int m_tick;
+	size_t m_sectionStart;
+	size_t m_readOffset, m_readEnd;
+	bool m_readValid;
+};
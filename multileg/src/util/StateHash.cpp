@@ -0,0 +1,195 @@
+#include "StateHash.h"
+#include <fstream>
+#include "CurrentPathHelper.h"
+#include "ToString.h"
+
+namespace
+{
+	const unsigned int STATEHASH_MAGIC = 0x48535453; // "STSH"
+	const unsigned int STATEHASH_VERSION = 1;
+}
+
+StateHashRecorder::StateHashRecorder()
+{
+	m_active = false;
+	m_inTick = false;
+}
+
+void StateHashRecorder::activate()
+{
+	m_active = true;
+}
+
+bool StateHashRecorder::isActive()
+{
+	return m_active;
+}
+
+void StateHashRecorder::clear()
+{
+	m_inTick = false;
+	m_ticks.clear();
+	m_tickHashes.clear();
+	m_entryStarts.clear();
+	m_entryHashes.clear();
+}
+
+void StateHashRecorder::beginTick(unsigned int p_tick)
+{
+	m_inTick = true;
+	m_currentTick = StateHash();
+	m_ticks.push_back(p_tick);
+	m_entryStarts.push_back((unsigned int)m_entryHashes.size());
+}
+
+void StateHashRecorder::addEntry(unsigned long long p_hash)
+{
+	if (!m_inTick) return;
+	m_entryHashes.push_back(p_hash);
+	m_currentTick.add(p_hash);
+}
+
+void StateHashRecorder::endTick()
+{
+	if (!m_inTick) return;
+	m_tickHashes.push_back(m_currentTick.get());
+	m_inTick = false;
+}
+
+unsigned int StateHashRecorder::getTickCount() const
+{
+	return (unsigned int)m_tickHashes.size();
+}
+
+unsigned int StateHashRecorder::getTick(unsigned int p_idx) const
+{
+	return m_ticks[p_idx];
+}
+
+unsigned long long StateHashRecorder::getTickHash(unsigned int p_idx) const
+{
+	return m_tickHashes[p_idx];
+}
+
+unsigned int StateHashRecorder::getEntryCount(unsigned int p_idx) const
+{
+	unsigned int end = p_idx + 1 < m_entryStarts.size() ? m_entryStarts[p_idx + 1] : (unsigned int)m_entryHashes.size();
+	return end - m_entryStarts[p_idx];
+}
+
+unsigned long long StateHashRecorder::getEntryHash(unsigned int p_idx, unsigned int p_entry) const
+{
+	return m_entryHashes[m_entryStarts[p_idx] + p_entry];
+}
+
+bool StateHashRecorder::save(const std::string& p_fileName) const
+{
+	std::ofstream os;
+	os.open(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::out);
+	if (!os.good() || !os.is_open())
+		return false;
+	unsigned int header[3] = { STATEHASH_MAGIC, STATEHASH_VERSION, getTickCount() };
+	os.write(reinterpret_cast<const char*>(header), sizeof(header));
+	// per tick: tick, entry count, tick hash, entry hashes
+	for (unsigned int i = 0; i < getTickCount(); i++)
+	{
+		unsigned int tickHeader[2] = { m_ticks[i], getEntryCount(i) };
+		os.write(reinterpret_cast<const char*>(tickHeader), sizeof(tickHeader));
+		os.write(reinterpret_cast<const char*>(&m_tickHashes[i]), sizeof(unsigned long long));
+		if (tickHeader[1] > 0)
+		{
+			os.write(reinterpret_cast<const char*>(&m_entryHashes[m_entryStarts[i]]),
+				std::streamsize(tickHeader[1] * sizeof(unsigned long long)));
+		}
+	}
+	// A baseline that didn't make it to disk must not count as saved
+	os.flush();
+	bool res = os.good();
+	os.close();
+	return res;
+}
+
+bool StateHashRecorder::load(const std::string& p_fileName)
+{
+	std::ifstream is;
+	is.open(GetExecutablePathDirectory() + p_fileName, std::ios::binary | std::ios::in);
+	if (!is.good() || !is.is_open())
+		return false;
+	unsigned int header[3] = { 0, 0, 0 };
+	is.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!is.good() || header[0] != STATEHASH_MAGIC || header[1] != STATEHASH_VERSION)
+		return false;
+	clear();
+	for (unsigned int i = 0; i < header[2]; i++)
+	{
+		unsigned int tickHeader[2] = { 0, 0 };
+		unsigned long long tickHash = 0;
+		is.read(reinterpret_cast<char*>(tickHeader), sizeof(tickHeader));
+		is.read(reinterpret_cast<char*>(&tickHash), sizeof(tickHash));
+		if (!is.good())
+			return false;
+		m_ticks.push_back(tickHeader[0]);
+		m_tickHashes.push_back(tickHash);
+		m_entryStarts.push_back((unsigned int)m_entryHashes.size());
+		if (tickHeader[1] > 0)
+		{
+			m_entryHashes.resize(m_entryHashes.size() + tickHeader[1]);
+			is.read(reinterpret_cast<char*>(&m_entryHashes[m_entryStarts.back()]),
+				std::streamsize(tickHeader[1] * sizeof(unsigned long long)));
+			if (!is.good())
+				return false;
+		}
+	}
+	is.close();
+	return true;
+}
+
+StateHashRecorder::Divergence StateHashRecorder::compare(const StateHashRecorder& p_a, const StateHashRecorder& p_b)
+{
+	Divergence res;
+	res.m_diverged = false;
+	res.m_tick = 0;
+	res.m_entry = -1;
+	res.m_missingTick = false;
+	unsigned int ticks = p_a.getTickCount() < p_b.getTickCount() ? p_a.getTickCount() : p_b.getTickCount();
+	for (unsigned int i = 0; i < ticks; i++)
+	{
+		if (p_a.getTickHash(i) == p_b.getTickHash(i) && p_a.getTick(i) == p_b.getTick(i))
+			continue;
+		res.m_diverged = true;
+		res.m_tick = p_a.getTick(i);
+		unsigned int entries = p_a.getEntryCount(i);
+		if (entries == p_b.getEntryCount(i))
+		{
+			for (unsigned int n = 0; n < entries; n++)
+			{
+				if (p_a.getEntryHash(i, n) != p_b.getEntryHash(i, n))
+				{
+					res.m_entry = (int)n;
+					break;
+				}
+			}
+		}
+		break;
+	}
+	// A stream that stops early, or runs on, diverges at the first tick the other lacks
+	if (!res.m_diverged && p_a.getTickCount() != p_b.getTickCount())
+	{
+		const StateHashRecorder& longer = p_a.getTickCount() > p_b.getTickCount() ? p_a : p_b;
+		res.m_diverged = true;
+		res.m_tick = longer.getTick(ticks);
+		res.m_missingTick = true;
+	}
+	return res;
+}
+
+std::string StateHashRecorder::toString(const Divergence& p_divergence)
+{
+	if (!p_divergence.m_diverged)
+		return "No divergence";
+	if (p_divergence.m_missingTick)
+		return "Diverged at tick " + ToString(p_divergence.m_tick) + ", missing from one run";
+	if (p_divergence.m_entry < 0)
+		return "Diverged at tick " + ToString(p_divergence.m_tick) + ", different entry count";
+	return "Diverged at tick " + ToString(p_divergence.m_tick) + ", entry " + ToString(p_divergence.m_entry);
+}
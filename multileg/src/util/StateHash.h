@@ -0,0 +1,125 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// =======================================================================================
+//                                      StateHash
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Incremental 64-bit hash of simulation state. The bit patterns of the
+///			values are mixed in, so any difference, also in the last bit of a float,
+///			changes the hash. This is what a determinism check wants.
+///
+/// # StateHash
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class StateHash
+{
+public:
+	StateHash()
+	{
+		m_hash = 14695981039346656037ULL; // FNV offset basis
+	}
+
+	void add(unsigned int p_value)
+	{
+		// FNV-1a step on whole words instead of bytes
+		m_hash = (m_hash ^ (unsigned long long)p_value) * 1099511628211ULL;
+	}
+
+	void add(float p_value)
+	{
+		union { float f; unsigned int u; } bits;
+		bits.f = p_value;
+		add(bits.u);
+	}
+
+	void add(const float* p_values, unsigned int p_count)
+	{
+		for (unsigned int i = 0; i < p_count; i++)
+			add(p_values[i]);
+	}
+
+	void add(unsigned long long p_value)
+	{
+		add((unsigned int)(p_value & 0xffffffffULL));
+		add((unsigned int)(p_value >> 32));
+	}
+
+	// Finalized hash, the avalanche spreads the last words over all bits
+	unsigned long long get() const
+	{
+		unsigned long long h = m_hash;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+private:
+	unsigned long long m_hash;
+};
+
+// =======================================================================================
+//                                      StateHashRecorder
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Stream of state hashes, one set per physics tick. Every tick has one hash
+///			per entry (body, or other state such as the joint torques) and a tick
+///			hash over all entries. Two streams, e.g. a serial and a parallel run,
+///			are compared to find the first tick and entry that diverges.
+///			Only the hashes are stored, 8 bytes per entry and tick.
+///
+/// # StateHashRecorder
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class StateHashRecorder
+{
+public:
+	struct Divergence
+	{
+		bool m_diverged;
+		unsigned int m_tick;	// first tick that differs
+		int m_entry;			// first entry of that tick that differs, -1 if the entry count differs
+		bool m_missingTick;		// the tick is only in the longer stream
+	};
+
+	StateHashRecorder();
+
+	void activate();
+	bool isActive();
+	void clear();
+
+	void beginTick(unsigned int p_tick);
+	void addEntry(unsigned long long p_hash);
+	void endTick();
+
+	unsigned int getTickCount() const;
+	unsigned int getTick(unsigned int p_idx) const;
+	unsigned long long getTickHash(unsigned int p_idx) const;
+	unsigned int getEntryCount(unsigned int p_idx) const;
+	unsigned long long getEntryHash(unsigned int p_idx, unsigned int p_entry) const;
+
+	// Binary hash stream at GetExecutablePathDirectory()+p_fileName
+	bool save(const std::string& p_fileName) const;
+	bool load(const std::string& p_fileName);
+
+	// Ticks are compared in order, streams of different length diverge where the shorter ends
+	static Divergence compare(const StateHashRecorder& p_a, const StateHashRecorder& p_b);
+	static std::string toString(const Divergence& p_divergence);
+private:
+	bool m_active;
+	bool m_inTick;
+	StateHash m_currentTick;
+	std::vector<unsigned int> m_ticks;
+	std::vector<unsigned long long> m_tickHashes;
+	std::vector<unsigned int> m_entryStarts;	// first entry of each tick
+	std::vector<unsigned long long> m_entryHashes;
+};
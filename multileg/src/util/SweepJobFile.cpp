@@ -0,0 +1,269 @@
+#include "SweepJobFile.h"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include "CurrentPathHelper.h"
+#include "ParamSchema.h"
+#include "ToString.h"
+
+namespace
+{
+	bool parseFloat(const std::string& p_text, float& p_outValue)
+	{
+		char* end = NULL;
+		p_outValue = (float)strtod(p_text.c_str(), &end);
+		return p_text != "" && *end == '\0';
+	}
+
+	bool parseIndex(const std::string& p_text, unsigned int& p_outValue)
+	{
+		if (p_text == "" || p_text.find_first_not_of("0123456789") != std::string::npos)
+			return false;
+		p_outValue = (unsigned int)strtoul(p_text.c_str(), NULL, 10);
+		return true;
+	}
+}
+
+SweepJobFile::SweepJobFile()
+{
+	clear();
+}
+
+bool SweepJobFile::load(const std::string& p_fileName)
+{
+	clear();
+	std::ifstream is((GetExecutablePathDirectory() + p_fileName).c_str());
+	if (!is.good() || !is.is_open())
+		return fail("could not open " + p_fileName);
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(is, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line = line.substr(0, comment);
+		if (!parseLine(line))
+		{
+			m_error = "line " + ToString(lineNumber) + ": " + m_error;
+			m_jobs.clear();
+			return false;
+		}
+	}
+	if (m_jobs.empty())
+		return fail("no jobs in " + p_fileName);
+	return true;
+}
+
+void SweepJobFile::clear()
+{
+	m_quadruped = false;
+	m_baseGait = "";
+	m_horizon = 800;
+	m_jobs.clear();
+	m_error = "";
+}
+
+bool SweepJobFile::isQuadruped() const
+{
+	return m_quadruped;
+}
+
+const std::string& SweepJobFile::getBaseGait() const
+{
+	return m_baseGait;
+}
+
+int SweepJobFile::getHorizon() const
+{
+	return m_horizon;
+}
+
+const std::vector<SweepJobFile::Job>& SweepJobFile::getJobs() const
+{
+	return m_jobs;
+}
+
+std::string SweepJobFile::toString(const Job& p_job)
+{
+	std::string res;
+	for (unsigned int i = 0; i < p_job.m_overrides.size(); i++)
+	{
+		if (i > 0) res += ";";
+		res += p_job.m_overrides[i].m_key + "=" + ToString(p_job.m_overrides[i].m_value);
+	}
+	return res;
+}
+
+bool SweepJobFile::resolve(const ParamSchema& p_schema, const std::vector<float>& p_base,
+	std::vector<std::vector<float> >& p_outParams)
+{
+	p_outParams.assign(m_jobs.size(), p_base);
+	if (p_schema.getSize() != p_base.size())
+		return fail("the base gait has " + ToString(p_base.size()) + " parameters, the schema " + ToString(p_schema.getSize()));
+	std::vector<std::string> paths(p_schema.getSize());
+	for (unsigned int i = 0; i < paths.size(); i++)
+		paths[i] = p_schema.getPath(i);
+	for (unsigned int j = 0; j < m_jobs.size(); j++)
+	{
+		const std::vector<Override>& overrides = m_jobs[j].m_overrides;
+		std::vector<float>& params = p_outParams[j];
+		for (unsigned int o = 0; o < overrides.size(); o++)
+		{
+			const std::string& key = overrides[o].m_key;
+			unsigned int idx = 0;
+			if (parseIndex(key, idx))
+			{
+				if (idx >= params.size())
+					return fail("job " + m_jobs[j].m_name + ": index " + key + " is past the last parameter");
+				params[idx] = overrides[o].m_value;
+				continue;
+			}
+			bool found = false;
+			for (unsigned int i = 0; i < paths.size(); i++)
+			{
+				// prefix match on whole path segments, as the frozen patterns
+				const std::string& path = paths[i];
+				if (path.compare(0, key.size(), key) == 0 &&
+					(path.size() == key.size() || path[key.size()] == '/' || path[key.size()] == '['))
+				{
+					params[i] = overrides[o].m_value;
+					found = true;
+				}
+			}
+			if (!found)
+				return fail("job " + m_jobs[j].m_name + ": no parameter " + key);
+		}
+	}
+	return true;
+}
+
+const std::string& SweepJobFile::getError() const
+{
+	return m_error;
+}
+
+bool SweepJobFile::parseLine(const std::string& p_line)
+{
+	std::stringstream words(p_line);
+	std::string statement, name;
+	if (!(words >> statement))
+		return true; // empty
+	if (!(words >> name))
+		return fail(statement + " without a value");
+	if (statement == "pod")
+	{
+		if (name == "biped") m_quadruped = false;
+		else if (name == "quadruped") m_quadruped = true;
+		else return fail("pod needs biped or quadruped, not '" + name + "'");
+		return true;
+	}
+	if (statement == "base")
+	{
+		m_baseGait = name;
+		return true;
+	}
+	if (statement == "horizon")
+	{
+		m_horizon = atoi(name.c_str());
+		if (m_horizon <= 0)
+			return fail("bad horizon " + name);
+		return true;
+	}
+	if (statement != "job" && statement != "grid")
+		return fail("unknown statement " + statement);
+
+	std::vector<std::string> keys;
+	std::vector<std::vector<float> > values;
+	std::string option;
+	while (words >> option)
+	{
+		size_t split = option.find('=');
+		if (split == std::string::npos || split == 0)
+			return fail("expected key=value, not '" + option + "'");
+		keys.push_back(option.substr(0, split));
+		values.push_back(std::vector<float>());
+		if (!parseValues(option.substr(split + 1), values.back()) ||
+			(statement == "job" && values.back().size() != 1))
+			return fail("bad value for " + keys.back());
+	}
+	if (statement == "job")
+	{
+		Job job;
+		job.m_name = name;
+		for (unsigned int i = 0; i < keys.size(); i++)
+		{
+			Override entry = { keys[i], values[i][0] };
+			job.m_overrides.push_back(entry);
+		}
+		m_jobs.push_back(job);
+		return true;
+	}
+
+	// Every combination, the last key changing fastest
+	unsigned int count = 1;
+	for (unsigned int i = 0; i < values.size(); i++)
+	{
+		if (count * values[i].size() > MAX_JOBS)
+			return fail("grid " + name + " has more than " + ToString((unsigned int)MAX_JOBS) + " jobs");
+		count *= (unsigned int)values[i].size();
+	}
+	if (m_jobs.size() + count > MAX_JOBS)
+		return fail("more than " + ToString((unsigned int)MAX_JOBS) + " jobs");
+	m_jobs.reserve(m_jobs.size() + count);
+	for (unsigned int n = 0; n < count; n++)
+	{
+		Job job;
+		job.m_name = name + "_" + ToString(n);
+		unsigned int rest = n;
+		job.m_overrides.resize(keys.size());
+		for (int i = (int)keys.size() - 1; i >= 0; i--)
+		{
+			job.m_overrides[i].m_key = keys[i];
+			job.m_overrides[i].m_value = values[i][rest % values[i].size()];
+			rest /= (unsigned int)values[i].size();
+		}
+		m_jobs.push_back(job);
+	}
+	return true;
+}
+
+bool SweepJobFile::parseValues(const std::string& p_text, std::vector<float>& p_outValues)
+{
+	std::stringstream list(p_text);
+	std::string part;
+	if (p_text.find(':') != std::string::npos)
+	{
+		float range[3] = { 0.0f, 0.0f, 0.0f };
+		int i = 0;
+		while (std::getline(list, part, ':'))
+		{
+			if (i > 2 || !parseFloat(part, range[i]))
+				return false;
+			i++;
+		}
+		if (i != 3 || range[2] <= 0.0f || range[1] < range[0])
+			return false;
+		// counted, so float steps don't add up past or short of the end
+		unsigned int steps = (unsigned int)((range[1] - range[0]) / range[2] + 0.001f);
+		if (steps >= MAX_JOBS)
+			return false;
+		for (unsigned int n = 0; n <= steps; n++)
+			p_outValues.push_back(range[0] + range[2] * (float)n);
+		return true;
+	}
+	while (std::getline(list, part, ','))
+	{
+		float value = 0.0f;
+		if (!parseFloat(part, value))
+			return false;
+		p_outValues.push_back(value);
+	}
+	return !p_outValues.empty();
+}
+
+bool SweepJobFile::fail(const std::string& p_message)
+{
+	m_error = p_message;
+	return false;
+}
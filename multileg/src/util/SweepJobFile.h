@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class ParamSchema;
+
+// =======================================================================================
+//                                      SweepJobFile
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Text file listing gait parameter variations to evaluate in one batch, each
+///			one a job with overrides of a base gait. One statement per line, '#'
+///			starts a comment:
+///
+///			pod biped|quadruped
+///			base file
+///			horizon ticks
+///			job name key=value [key=value ...]
+///			grid name key=values [key=values ...]
+///
+///			The base is a gait file in ../output/sav/, without it the built-in gait
+///			is used. A key is a parameter index or a ParamSchema path, a path that is
+///			a prefix of whole segments sets all its entries (legFrame0/FhPD sets both
+///			gains). A grid is every combination of its value lists, written a,b,c or
+///			from:to:step, and gives the jobs name_0, name_1 and so on, the first key
+///			changing slowest. The horizon defaults to the optimizer's 800 ticks.
+///
+///			Keys are resolved against the schema when the parameter lists are made,
+///			see resolve. Run by the benchmark's ParamSweep.
+///
+/// # SweepJobFile
+///
+/// 19-10-2026
+///---------------------------------------------------------------------------------------
+
+class SweepJobFile
+{
+public:
+	static const unsigned int MAX_JOBS = 100000;
+
+	struct Override
+	{
+		std::string m_key;
+		float m_value;
+	};
+
+	struct Job
+	{
+		std::string m_name;
+		std::vector<Override> m_overrides; // in file order, a later one wins
+	};
+
+	SweepJobFile();
+
+	// From GetExecutablePathDirectory()+p_fileName, on failure getError tells the line
+	bool load(const std::string& p_fileName);
+	void clear();
+
+	bool isQuadruped() const;
+	// Empty for the built-in gait
+	const std::string& getBaseGait() const;
+	int getHorizon() const;
+	const std::vector<Job>& getJobs() const;
+	// The overrides of a job as key=value;key=value
+	static std::string toString(const Job& p_job);
+
+	// One parameter list per job, the base with the job's overrides.
+	// Fails on a key that isn't in the schema.
+	bool resolve(const ParamSchema& p_schema, const std::vector<float>& p_base,
+		std::vector<std::vector<float> >& p_outParams);
+	const std::string& getError() const;
+private:
+	bool parseLine(const std::string& p_line);
+	bool parseValues(const std::string& p_text, std::vector<float>& p_outValues);
+	bool fail(const std::string& p_message);
+
+	bool m_quadruped;
+	std::string m_baseGait;
+	int m_horizon;
+	std::vector<Job> m_jobs;
+	std::string m_error;
+};
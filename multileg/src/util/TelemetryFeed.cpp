@@ -0,0 +1,291 @@
+#include "TelemetryFeed.h"
+#include <cstring>
+#include <cfloat>
+#include <atomic>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Sequence and padding in front of the snapshot
+	const size_t SLOT_HEADER_SIZE = 2 * sizeof(unsigned int);
+}
+
+TelemetryFeed::TelemetryFeed()
+{
+	m_header = NULL;
+	m_view = NULL;
+	m_viewSize = 0;
+	m_writer = false;
+	m_writeSlot = 0;
+	m_writeIndex = 0;
+	m_writeSnapshot = NULL;
+	m_writeCharacters = NULL;
+	m_optimizerScore = FLT_MAX;
+#ifdef _WIN32
+	m_mapping = NULL;
+#else
+	m_file = -1;
+#endif
+}
+
+TelemetryFeed::~TelemetryFeed()
+{
+	close();
+}
+
+bool TelemetryFeed::create(const std::string& p_name, unsigned int p_maxCharacters, unsigned int p_slotCount /*= DEFAULT_SLOTS*/)
+{
+	close();
+	if (p_slotCount == 0)
+		return false;
+	size_t slotSize = SLOT_HEADER_SIZE + sizeof(Snapshot) + p_maxCharacters * sizeof(Character);
+	slotSize = (slotSize + 7) & ~(size_t)7; // keeps the doubles aligned
+	if (!map(p_name, sizeof(Header) + slotSize * p_slotCount, true))
+		return false;
+	m_writer = true;
+	// New memory is zeroed, so every sequence starts as never written
+	m_header->m_version = VERSION;
+	m_header->m_slotCount = p_slotCount;
+	m_header->m_maxCharacters = p_maxCharacters;
+	m_header->m_slotSize = (unsigned int)slotSize;
+	m_header->m_published = 0;
+	// Readers that attach meanwhile don't accept it until the magic is there
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->m_magic = MAGIC;
+	m_writeIndex = 0;
+	return true;
+}
+
+bool TelemetryFeed::attach(const std::string& p_name)
+{
+	close();
+	if (!map(p_name, 0, false))
+		return false;
+	const Header* header = m_header;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	// The header must describe what is actually mapped
+	if (m_viewSize < sizeof(Header) || header->m_magic != MAGIC || header->m_version != VERSION ||
+		header->m_slotCount == 0 ||
+		header->m_slotSize < SLOT_HEADER_SIZE + sizeof(Snapshot) + header->m_maxCharacters * sizeof(Character) ||
+		(m_viewSize - sizeof(Header)) / header->m_slotSize < header->m_slotCount)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void TelemetryFeed::close()
+{
+#ifdef _WIN32
+	if (m_view != NULL) UnmapViewOfFile(m_view);
+	if (m_mapping != NULL) CloseHandle(m_mapping);
+	m_mapping = NULL;
+#else
+	if (m_view != NULL) munmap(m_view, m_viewSize);
+	if (m_file != -1) ::close(m_file);
+	// Readers keep their mapping, but no one new can attach
+	if (m_writer && m_file != -1) shm_unlink(("/" + m_name).c_str());
+	m_file = -1;
+#endif
+	m_header = NULL;
+	m_view = NULL;
+	m_viewSize = 0;
+	m_writer = false;
+	m_writeSnapshot = NULL;
+	m_writeCharacters = NULL;
+}
+
+bool TelemetryFeed::isOpen() const
+{
+	return m_header != NULL;
+}
+
+bool TelemetryFeed::isWriter() const
+{
+	return m_writer;
+}
+
+void TelemetryFeed::setOptimizerScore(double p_score)
+{
+	m_optimizerScore = p_score;
+}
+
+void TelemetryFeed::beginTick(unsigned int p_tick, double p_controllerMs, double p_physicsMs)
+{
+	if (!m_writer) return;
+	m_writeSlot = m_writeIndex % m_header->m_slotCount;
+	*getSequence(m_writeSlot) = 2 * m_writeIndex + 1; // odd, being written
+	std::atomic_thread_fence(std::memory_order_release);
+	m_writeSnapshot = getSnapshot(m_writeSlot);
+	m_writeCharacters = getCharacters(m_writeSlot);
+	m_writeSnapshot->m_tick = p_tick;
+	m_writeSnapshot->m_characterCount = 0;
+	m_writeSnapshot->m_controllerMs = p_controllerMs;
+	m_writeSnapshot->m_physicsMs = p_physicsMs;
+	m_writeSnapshot->m_optimizerScore = m_optimizerScore;
+}
+
+void TelemetryFeed::addCharacter(const glm::vec3& p_position, const glm::vec3& p_velocity, bool p_enabled)
+{
+	if (m_writeSnapshot == NULL || m_writeSnapshot->m_characterCount >= m_header->m_maxCharacters) return;
+	Character& character = m_writeCharacters[m_writeSnapshot->m_characterCount];
+	for (int i = 0; i < 3; i++)
+	{
+		character.m_position[i] = p_position[i];
+		character.m_velocity[i] = p_velocity[i];
+	}
+	character.m_enabled = p_enabled ? 1 : 0;
+	m_writeSnapshot->m_characterCount++;
+}
+
+void TelemetryFeed::endTick()
+{
+	if (m_writeSnapshot == NULL) return;
+	std::atomic_thread_fence(std::memory_order_release);
+	*getSequence(m_writeSlot) = 2 * m_writeIndex + 2; // even, complete
+	m_writeIndex++;
+	m_header->m_published = m_writeIndex;
+	m_writeSnapshot = NULL;
+	m_writeCharacters = NULL;
+}
+
+unsigned int TelemetryFeed::getPublishedCount() const
+{
+	if (m_header == NULL) return 0;
+	unsigned int published = m_header->m_published;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return published;
+}
+
+unsigned int TelemetryFeed::getMaxCharacters() const
+{
+	return m_header != NULL ? m_header->m_maxCharacters : 0;
+}
+
+bool TelemetryFeed::read(unsigned int p_index, Snapshot& p_outSnapshot, std::vector<Character>& p_outCharacters) const
+{
+	if (m_header == NULL || p_index >= getPublishedCount())
+		return false;
+	unsigned int slot = p_index % m_header->m_slotCount;
+	volatile unsigned int* sequence = getSequence(slot);
+	unsigned int complete = 2 * p_index + 2;
+	if (*sequence != complete)
+		return false; // overwritten by a later lap
+	std::atomic_thread_fence(std::memory_order_acquire);
+	memcpy(&p_outSnapshot, getSnapshot(slot), sizeof(Snapshot));
+	unsigned int count = p_outSnapshot.m_characterCount;
+	if (count > m_header->m_maxCharacters)
+		count = 0; // torn, the sequence check below fails
+	p_outCharacters.resize(count);
+	if (count > 0)
+		memcpy(&p_outCharacters[0], getCharacters(slot), count * sizeof(Character));
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return *sequence == complete;
+}
+
+bool TelemetryFeed::readLatest(Snapshot& p_outSnapshot, std::vector<Character>& p_outCharacters) const
+{
+	for (unsigned int i = 0; i < MAX_READ_RETRIES; i++)
+	{
+		unsigned int published = getPublishedCount();
+		if (published == 0)
+			return false;
+		if (read(published - 1, p_outSnapshot, p_outCharacters))
+			return true;
+	}
+	return false;
+}
+
+bool TelemetryFeed::map(const std::string& p_name, size_t p_size, bool p_write)
+{
+	m_name = p_name;
+#ifdef _WIN32
+	std::string mappingName = "Local\\" + p_name;
+	if (p_write)
+	{
+		m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+			(DWORD)((unsigned long long)p_size >> 32), (DWORD)(p_size & 0xffffffff), mappingName.c_str());
+		// Someone else's, or still held by a reader of an earlier run
+		if (m_mapping != NULL && GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			close();
+			return false;
+		}
+	}
+	else
+		m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+	if (m_mapping == NULL)
+		return false;
+	m_view = MapViewOfFile(m_mapping, p_write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, p_size);
+	if (m_view != NULL)
+	{
+		MEMORY_BASIC_INFORMATION info;
+		m_viewSize = VirtualQuery(m_view, &info, sizeof(info)) != 0 ? (size_t)info.RegionSize : 0;
+	}
+#else
+	std::string shmName = "/" + p_name;
+	if (p_write)
+	{
+		m_file = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (m_file == -1)
+			return false;
+		if (ftruncate(m_file, (off_t)p_size) != 0)
+		{
+			// Unlinked by close, it is ours
+			m_writer = true;
+			close();
+			return false;
+		}
+		m_viewSize = p_size;
+	}
+	else
+	{
+		m_file = shm_open(shmName.c_str(), O_RDONLY, 0);
+		struct stat st;
+		if (m_file == -1 || fstat(m_file, &st) != 0)
+		{
+			close();
+			return false;
+		}
+		m_viewSize = (size_t)st.st_size;
+	}
+	m_view = m_viewSize > 0 ? mmap(NULL, m_viewSize, p_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0) : NULL;
+	if (m_view == MAP_FAILED) m_view = NULL;
+	if (m_view == NULL)
+		m_writer = p_write; // the name is unlinked by close
+#endif
+	if (m_view == NULL)
+	{
+		close();
+		return false;
+	}
+	m_header = static_cast<Header*>(m_view);
+	return true;
+}
+
+volatile unsigned int* TelemetryFeed::getSequence(unsigned int p_slot) const
+{
+	char* slot = static_cast<char*>(m_view) + sizeof(Header) + (size_t)p_slot * m_header->m_slotSize;
+	return reinterpret_cast<volatile unsigned int*>(slot);
+}
+
+TelemetryFeed::Snapshot* TelemetryFeed::getSnapshot(unsigned int p_slot) const
+{
+	char* slot = static_cast<char*>(m_view) + sizeof(Header) + (size_t)p_slot * m_header->m_slotSize;
+	return reinterpret_cast<Snapshot*>(slot + SLOT_HEADER_SIZE);
+}
+
+TelemetryFeed::Character* TelemetryFeed::getCharacters(unsigned int p_slot) const
+{
+	char* slot = static_cast<char*>(m_view) + sizeof(Header) + (size_t)p_slot * m_header->m_slotSize;
+	return reinterpret_cast<Character*>(slot + SLOT_HEADER_SIZE + sizeof(Snapshot));
+}
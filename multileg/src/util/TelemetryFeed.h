@@ -0,0 +1,119 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm\gtc\type_ptr.hpp>
+
+// =======================================================================================
+//                                      TelemetryFeed
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Per tick snapshots of the simulation in named shared memory, for viewers
+///			and scripts in other processes. The simulation writes a ring of
+///			m_slotCount snapshots and never waits for a reader; every slot has a
+///			sequence number (a seqlock), odd while it is written, so a reader copies
+///			a snapshot and keeps it only if the sequence was the same before and
+///			after. A reader that is slower than the simulation simply skips ticks.
+///
+///			Layout, little endian, no padding besides what is listed:
+///			Header, then m_slotCount slots of m_slotSize bytes each. A slot is an
+///			unsigned int sequence and an unsigned int of padding, then a Snapshot,
+///			then m_maxCharacters Characters (m_characterCount of them filled).
+///			The n:th published snapshot (from 0) is in slot n % m_slotCount and is
+///			complete when that slot's sequence is 2n+2. Header::m_published is the
+///			number of snapshots published so far.
+///
+///			The memory is a named file mapping (Local\name) on Windows and POSIX
+///			shared memory (/name) elsewhere. The name is released when the writer
+///			closes, on Windows once the readers have closed it as well.
+///
+/// # TelemetryFeed
+///
+/// 19-10-2026
+///---------------------------------------------------------------------------------------
+
+class TelemetryFeed
+{
+public:
+	static const unsigned int MAGIC = 0x4d4c4554; // "TELM"
+	static const unsigned int VERSION = 1;
+	static const unsigned int DEFAULT_SLOTS = 64;
+	static const unsigned int MAX_READ_RETRIES = 16;
+
+	struct Header
+	{
+		unsigned int m_magic;
+		unsigned int m_version;
+		unsigned int m_slotCount;
+		unsigned int m_maxCharacters;
+		unsigned int m_slotSize;
+		volatile unsigned int m_published;
+	};
+
+	struct Snapshot
+	{
+		unsigned int m_tick;			// physics internal step
+		unsigned int m_characterCount;
+		double m_controllerMs;			// controller system, this tick
+		double m_physicsMs;				// the rest of the tick
+		double m_optimizerScore;		// best so far, FLT_MAX without one
+	};
+
+	struct Character
+	{
+		float m_position[3];	// root, the first leg frame
+		float m_velocity[3];	// m/s
+		unsigned int m_enabled;	// 0 once fallen
+	};
+
+	TelemetryFeed();
+	~TelemetryFeed();
+
+	// Writer, fails if the name is already in use
+	bool create(const std::string& p_name, unsigned int p_maxCharacters, unsigned int p_slotCount = DEFAULT_SLOTS);
+	// Reader, read only
+	bool attach(const std::string& p_name);
+	void close();
+	bool isOpen() const;
+	bool isWriter() const;
+
+	// Writing, from the simulation thread. The score is kept for the following snapshots.
+	void setOptimizerScore(double p_score);
+	void beginTick(unsigned int p_tick, double p_controllerMs, double p_physicsMs);
+	// Characters past the max are left out
+	void addCharacter(const glm::vec3& p_position, const glm::vec3& p_velocity, bool p_enabled);
+	void endTick();
+
+	// Reading
+	unsigned int getPublishedCount() const;
+	unsigned int getMaxCharacters() const;
+	// Copies the n:th published snapshot, false if it isn't published or has been overwritten
+	bool read(unsigned int p_index, Snapshot& p_outSnapshot, std::vector<Character>& p_outCharacters) const;
+	// Copies the newest snapshot, retrying if the writer overwrites it meanwhile
+	bool readLatest(Snapshot& p_outSnapshot, std::vector<Character>& p_outCharacters) const;
+private:
+	TelemetryFeed(const TelemetryFeed&);
+	TelemetryFeed& operator=(const TelemetryFeed&);
+
+	bool map(const std::string& p_name, size_t p_size, bool p_write);
+	volatile unsigned int* getSequence(unsigned int p_slot) const;
+	Snapshot* getSnapshot(unsigned int p_slot) const;
+	Character* getCharacters(unsigned int p_slot) const;
+
+	Header* m_header;
+	void* m_view;
+	size_t m_viewSize;
+	bool m_writer;
+	std::string m_name;
+	// The slot being written
+	unsigned int m_writeSlot;
+	unsigned int m_writeIndex;
+	Snapshot* m_writeSnapshot;
+	Character* m_writeCharacters;
+	double m_optimizerScore;
+#ifdef _WIN32
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+};
@@ -0,0 +1,148 @@
+#include "TickTrace.h"
+#include <Windows.h>
+#include <fstream>
+#include "CurrentPathHelper.h"
+
+struct TickTrace::ThreadBuffer
+{
+	unsigned long m_threadId;
+	unsigned int m_written;	// total zones written, the ring index is m_written % RING_SIZE
+	unsigned int m_depth;	// currently open zones
+	const char* m_openNames[MAX_DEPTH];
+	long long m_openStarts[MAX_DEPTH];
+	Zone m_zones[RING_SIZE];
+};
+
+bool TickTrace::s_enabled = false;
+TickTrace::ThreadBuffer* TickTrace::s_buffers[MAX_THREADS] = { NULL };
+volatile long TickTrace::s_bufferCount = 0;
+__declspec(thread) TickTrace::ThreadBuffer* TickTrace::s_threadBuffer = NULL;
+
+void TickTrace::setEnabled(bool p_enabled)
+{
+	s_enabled = p_enabled;
+}
+
+bool TickTrace::isEnabled()
+{
+	return s_enabled;
+}
+
+TickTrace::ThreadBuffer* TickTrace::getThreadBuffer()
+{
+	if (s_threadBuffer == NULL)
+	{
+		// First zone on this thread, claim a slot
+		long slot = InterlockedIncrement(&s_bufferCount) - 1;
+		if (slot >= (long)MAX_THREADS)
+			return NULL; // out of slots, this thread isn't traced
+		ThreadBuffer* buffer = new ThreadBuffer;
+		buffer->m_threadId = GetCurrentThreadId();
+		buffer->m_written = 0;
+		buffer->m_depth = 0;
+		s_buffers[slot] = buffer;
+		s_threadBuffer = buffer;
+	}
+	return s_threadBuffer;
+}
+
+void TickTrace::beginZone(const char* p_name)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+	if (buffer == NULL) return;
+	if (buffer->m_depth < MAX_DEPTH)
+	{
+		LARGE_INTEGER stamp;
+		QueryPerformanceCounter(&stamp);
+		buffer->m_openNames[buffer->m_depth] = p_name;
+		buffer->m_openStarts[buffer->m_depth] = stamp.QuadPart;
+	}
+	buffer->m_depth++;
+}
+
+void TickTrace::endZone()
+{
+	ThreadBuffer* buffer = s_threadBuffer;
+	if (buffer == NULL || buffer->m_depth == 0) return;
+	buffer->m_depth--;
+	unsigned int depth = buffer->m_depth;
+	if (depth < MAX_DEPTH)
+	{
+		LARGE_INTEGER stamp;
+		QueryPerformanceCounter(&stamp);
+		Zone& zone = buffer->m_zones[buffer->m_written % RING_SIZE];
+		zone.m_name = buffer->m_openNames[depth];
+		zone.m_start = buffer->m_openStarts[depth];
+		zone.m_end = stamp.QuadPart;
+		zone.m_depth = depth;
+		buffer->m_written++;
+	}
+}
+
+void TickTrace::clear()
+{
+	long count = min(s_bufferCount, (long)MAX_THREADS);
+	for (long i = 0; i < count; i++)
+	{
+		if (s_buffers[i] != NULL)
+			s_buffers[i]->m_written = 0;
+	}
+}
+
+bool TickTrace::saveChromeTrace(const std::string& p_fileName)
+{
+	std::ofstream outFile;
+	std::string file = GetExecutablePathDirectory() + p_fileName + ".json";
+	outFile.open(file);
+	if (!outFile.good())
+		return false;
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	double usPerTick = 1000000.0 / (double)frequency.QuadPart;
+	long count = min(s_bufferCount, (long)MAX_THREADS);
+
+	// Timestamps are written relative to the oldest zone still in a ring
+	long long origin = 0;
+	bool hasOrigin = false;
+	for (long i = 0; i < count; i++)
+	{
+		ThreadBuffer* buffer = s_buffers[i];
+		if (buffer == NULL) continue;
+		unsigned int zones = min(buffer->m_written, RING_SIZE);
+		for (unsigned int n = 0; n < zones; n++)
+		{
+			if (!hasOrigin || buffer->m_zones[n].m_start < origin)
+			{
+				origin = buffer->m_zones[n].m_start;
+				hasOrigin = true;
+			}
+		}
+	}
+
+	outFile << "{\"traceEvents\":[\n";
+	bool first = true;
+	outFile.precision(3);
+	outFile << std::fixed;
+	for (long i = 0; i < count; i++)
+	{
+		ThreadBuffer* buffer = s_buffers[i];
+		if (buffer == NULL) continue;
+		// name the track after the OS thread
+		outFile << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i
+			<< ",\"args\":{\"name\":\"thread " << buffer->m_threadId << "\"}}";
+		first = false;
+		unsigned int zones = min(buffer->m_written, RING_SIZE);
+		unsigned int oldest = buffer->m_written > RING_SIZE ? buffer->m_written % RING_SIZE : 0;
+		for (unsigned int n = 0; n < zones; n++)
+		{
+			const Zone& zone = buffer->m_zones[(oldest + n) % RING_SIZE];
+			outFile << ",\n{\"name\":\"" << zone.m_name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << i
+				<< ",\"ts\":" << (double)(zone.m_start - origin) * usPerTick
+				<< ",\"dur\":" << (double)(zone.m_end - zone.m_start) * usPerTick
+				<< ",\"args\":{\"depth\":" << zone.m_depth << "}}";
+		}
+	}
+	outFile << "\n],\"displayTimeUnit\":\"ns\"}\n";
+	outFile.close();
+	return true;
+}
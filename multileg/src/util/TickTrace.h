@@ -0,0 +1,96 @@
+#pragma once
+#include <string>
+#include "AllocTracker.h"
+
+// =======================================================================================
+//                                      TickTrace
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Hierarchical zone timing of the simulation tick. Each thread records its
+///			finished zones into its own fixed ring buffer (the oldest are overwritten),
+///			so recording needs no locks or allocations after the first zone of a
+///			thread. The buffers can be exported as Chrome trace / Perfetto JSON, open
+///			it in chrome://tracing or ui.perfetto.dev to see the parallel tick.
+///
+///			Zones are placed with TRACE_ZONE("name"), the name must be a string
+///			literal. The macro is compiled out unless TICK_TRACE (or ALLOC_TRACK,
+///			which counts allocations on the same zones) is defined, and when
+///			compiled in nothing is recorded until setEnabled(true).
+///			Export and clear are not synchronized with recording, call them
+///			between ticks.
+///
+/// # TickTrace
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+/***************************************************************************/
+/* TICK_TRACE compiles the trace zones in, define it here or in a project  */
+/***************************************************************************/
+// #define TICK_TRACE
+
+class TickTrace
+{
+public:
+	static const unsigned int RING_SIZE = 65536;	// zones kept per thread
+	static const unsigned int MAX_THREADS = 64;
+	static const unsigned int MAX_DEPTH = 32;		// deeper zones are skipped
+
+	static void setEnabled(bool p_enabled);
+	static bool isEnabled();
+
+	static void beginZone(const char* p_name);
+	static void endZone();
+
+	static void clear();
+	// Writes the recorded zones of all threads to GetExecutablePathDirectory()+p_fileName+".json"
+	static bool saveChromeTrace(const std::string& p_fileName);
+private:
+	struct Zone
+	{
+		const char* m_name;
+		long long m_start, m_end;	// performance counter stamps
+		unsigned int m_depth;
+	};
+	struct ThreadBuffer;
+
+	static ThreadBuffer* getThreadBuffer();
+
+	static bool s_enabled;
+	static ThreadBuffer* s_buffers[MAX_THREADS];
+	static volatile long s_bufferCount;
+	static __declspec(thread) ThreadBuffer* s_threadBuffer;
+};
+
+// Begins a zone on construction and ends it when going out of scope
+class TickTraceZone
+{
+public:
+	TickTraceZone(const char* p_name)
+	{
+		// Sampled once, so toggling tracing inside a zone keeps begin and end paired
+		m_active = TickTrace::isEnabled();
+		if (m_active) TickTrace::beginZone(p_name);
+		// The same in every module, whether or not it defines ALLOC_TRACK. Zones
+		// are only pushed while the tracker is enabled.
+		m_allocActive = AllocTracker::isEnabled();
+		if (m_allocActive) AllocTracker::pushZone(p_name);
+	}
+	~TickTraceZone()
+	{
+		if (m_active) TickTrace::endZone();
+		if (m_allocActive) AllocTracker::popZone();
+	}
+private:
+	bool m_active;
+	bool m_allocActive;
+};
+
+#if defined(TICK_TRACE) || defined(ALLOC_TRACK)
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) TickTraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define TRACE_ZONE(name)
+#endif
@@ -3,6 +3,8 @@
 #include "Toolbar.h"
 #include "DebugDrawBatch.h"
 
+class SimCheckpoint;
+
 // =======================================================================================
 //                              AdvancedEntitySystem
 // =======================================================================================
@@ -25,6 +27,11 @@ public:
 	static void registerDebugDrawBatch(DebugDrawBatch* p_dbgDrawer){ m_dbgDrawer = p_dbgDrawer; }
 
 	virtual void fixedUpdate(float p_dt) {}
+	// Run-time state of the system for a simulation checkpoint, in a section of its own.
+	// Reading returns false if the checkpoint does not fit the system, and only
+	// changes the system if p_apply. Restoring checks every section before applying.
+	virtual void writeCheckpoint(SimCheckpoint& p_checkpoint) {}
+	virtual bool readCheckpoint(SimCheckpoint& p_checkpoint, bool p_apply) { return true; }
 protected:
 	static Toolbar* dbgToolbar() { return m_toolbar; }
 	static DebugDrawBatch* dbgDrawer() { return m_dbgDrawer; }
@@ -13,6 +13,17 @@
 #include <Input.h>
 #include <Util.h>
 #include <MeasurementBin.h>
+#include <MeasurementWriter.h>
+#include <TickTrace.h>
+#include <StateHash.h>
+#include <MotionRecorder.h>
+#include <AsyncLog.h>
+#include <RunningStat.h>
+#include <ResultStore.h>
+#include <SimCheckpoint.h>
+#include <CrowdScenario.h>
+#include <TelemetryFeed.h>
+#include "MotionPlayback.h"
 #include <MathHelp.h>
 
 #include <ValueClamp.h>
@@ -41,7 +52,12 @@
 #include "ConstraintSystem.h"
 #include "ControllerOptimizationSystem.h"
 #include "ReferenceLegMovementController.h"
+#include "ReferenceMotionTable.h"
+#include "CharacterFactory.h"
 #include <FileHandler.h>
+#include <GaitFile.h>
+#include <EvaluationCache.h>
+#include <ParamSchema.h>
 #include <SettingsData.h>
 #include <ConsoleContext.h>
 
@@ -62,6 +78,7 @@ App::App(HINSTANCE p_hInstance, unsigned int p_width/*=1280*/, unsigned int p_he
 	m_initWindowHeight = p_height;
 	m_runOptimization = false;
 	m_measurePerf = false;
+	m_playbackMotion = false;
 	m_initWindowMode = true;
 	m_initExecSetup = InitExecSetup::SERIAL;
 	m_initCharCountSerial = 1;
@@ -69,6 +86,8 @@ App::App(HINSTANCE p_hInstance, unsigned int p_width/*=1280*/, unsigned int p_he
 	m_initCharOffset = 0.0f;
 
 	m_bestParams = NULL;
+	m_bestParamsLayoutHash = 0;
+	m_bestParamsScore = FLT_MAX;
 
 	m_characterCreateType = CharCreateType::BIPED;
 	m_fpsUpdateTick = 0.0f;
@@ -123,16 +142,30 @@ App::App(HINSTANCE p_hInstance, unsigned int p_width/*=1280*/, unsigned int p_he
 				autoLoadPath = getAutoLoadFilenameSetting("../autoloadQuadruped.txt");
 			if (autoLoadPath != "") autoLoad = true;
 		}
+		// Only accept gaits saved with the current parameter layout
+		ParamSchema layout;
+		ControllerComponent::describeLayout(m_characterCreateType != BIPED, layout);
+		bool loaded = false;
 		if (!autoLoad)
 		{
 			int filetype = m_characterCreateType == BIPED ? 2 : 3;
-			loadFloatArrayPrompt(m_bestParams, filetype);
+			loaded = loadFloatArrayPrompt(m_bestParams, filetype, layout.getSize(), layout.getLayoutHash());
 		}
 		else
 		{
 			if (m_bestParams == NULL)
 				m_bestParams = new std::vector<float>();
-			loadFloatArray(m_bestParams, "../output/sav/"+autoLoadPath);
+			loaded = GaitFile::load("../output/sav/" + autoLoadPath, m_bestParams,
+				m_characterCreateType == BIPED ? GaitFile::BIPED : GaitFile::QUADRUPED,
+				layout.getSize(), layout.getLayoutHash());
+		}
+		if (loaded)
+			m_bestParamsLayoutHash = layout.getLayoutHash();
+		else
+		{
+			if (m_bestParams != NULL)
+				DEBUGPRINT(("Gait not loaded, it is missing or does not match the parameter layout. Using default params.\n"));
+			SAFE_DELETE(m_bestParams); // run with default params rather than stale ones
 		}
 	}
 	if (m_runOptimization || m_measurePerf) // no matter load settings, we don't pause at optimization
@@ -181,6 +214,8 @@ App::App(HINSTANCE p_hInstance, unsigned int p_width/*=1280*/, unsigned int p_he
 	{
 		ConsoleContext::init();
 	}
+	// formats the hot path prints off the simulation threads
+	AsyncLog::start();
 	// ====================================
 
 	// Global toolbar vars
@@ -210,6 +245,7 @@ App::~App()
 	SAFE_DELETE(m_context);
 	SAFE_DELETE(m_input);
 	SAFE_DELETE(m_controller);
+	AsyncLog::stop();
 	if (m_consoleMode)
 	{
 		ConsoleContext::end();
@@ -228,6 +264,19 @@ void App::run()
 	std::vector<double> allOptimizationResults;
 	int fixedStepCounter = 0;
 	std::vector<ReferenceLegMovementController> baseOptimizationReferenceMovementControllers;
+	// Evaluations are cached and persisted between optimization sessions
+	EvaluationCache evaluationCache;
+	std::string evaluationCachePath = "../output/sav/evaluationCache.bin";
+	// Named parameter layout, parameters listed in the frozen file are not optimized
+	ParamSchema paramSchema;
+	std::string podName = m_characterCreateType == BIPED ? "Biped" : "Quadruped";
+	if (m_runOptimization)
+	{
+		if (evaluationCache.load(evaluationCachePath))
+			DEBUGPRINT((("\nLoaded " + ToString(evaluationCache.getSize()) + " cached evaluations\n").c_str()));
+		if (paramSchema.loadFrozenPatterns("../frozenParams" + podName + ".txt"))
+			DEBUGPRINT(("\nLoaded frozen parameter list\n"));
+	}
 	if (m_runOptimization && m_toolBar)
 	{
 		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "O-Tick", Toolbar::INT, &fixedStepCounter);
@@ -237,12 +286,66 @@ void App::run()
 	// Normal inits
 	bool dbgDrawAllChars = true;
 	double controllerSystemTimingMs = 0.0;
+	RunningStat controllerSystemTimingStat;
+	double controllerSystemJitterMs = 0.0; // std of the timing, to see what logging costs
+	double tickTimingMs = 0.0;
+	float tickBudgetMs = 1000.0f / 120.0f; // real time at the physics step
+	int overBudgetTicks = 0;
+	unsigned int tickAllocations = 0;
+	bool recordMotion = false;
+	double motionRecordTimingMs = 0.0;
+	unsigned int recordedTicks = 0;
+	// Playback, the playhead can be dragged in the toolbar to scrub
+	float playbackSpeed = 1.0f;
+	float playheadTick = 0.0f, shownPlayheadTick = 0.0f;
+	bool playbackRunning = true;
+	unsigned int activeCharCount = 0; // all
 	bool lockLFY_onRestart = false;
+	// Checkpoint of the running simulation, saved and loaded from the toolbar
+	bool saveCheckpoint = false, loadCheckpoint = false;
+	std::string checkpointPath = "../output/sav/checkpoint" + podName + ".schk";
+	// Perf runs can start from a checkpoint named in the autoload file, instead of warming up
+	SimCheckpoint startCheckpoint;
+	if (m_measurePerf)
+	{
+		std::string startCheckpointPath = getAutoLoadFilenameSetting("../autoloadCheckpoint" + podName + ".txt");
+		if (startCheckpointPath != "" && !startCheckpoint.load("../output/sav/" + startCheckpointPath))
+			DEBUGPRINT(("\nCould not load the start checkpoint\n"));
+	}
+	// Normal runs can spawn a mixed crowd from the scenario named in the autoload file
+	CrowdScenario scenario;
+	if (!m_runOptimization)
+	{
+		std::string scenarioPath = getAutoLoadFilenameSetting("../autoloadScenario.txt");
+		if (scenarioPath != "" && scenario.load("../scenarios/" + scenarioPath))
+			m_initCharCountSerial = (int)scenario.getInstanceCount();
+		else if (scenarioPath != "")
+			DEBUGPRINT((("\nCould not load the scenario, " + scenario.getError() + "\n").c_str()));
+	}
 	if (m_toolBar)
 	{
 		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "CSystem Timing(ms)", Toolbar::DOUBLE, &controllerSystemTimingMs);
+		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "CSystem Jitter(ms)", Toolbar::DOUBLE, &controllerSystemJitterMs);
+		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "Tick Timing(ms)", Toolbar::DOUBLE, &tickTimingMs);
+		m_toolBar->addReadWriteVariable(Toolbar::PERFORMANCE, "Tick budget(ms)", Toolbar::FLOAT, &tickBudgetMs);
+		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "Over budget ticks", Toolbar::INT, &overBudgetTicks);
+		// only counted if the util library is built with ALLOC_TRACK
+		if (AllocTracker::isCompiledIn())
+			m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "Tick allocations", Toolbar::UNSIGNED_INT, &tickAllocations);
+		m_toolBar->addReadWriteVariable(Toolbar::PERFORMANCE, "Active chars", Toolbar::UNSIGNED_INT, &activeCharCount);
+		m_toolBar->addReadWriteVariable(Toolbar::PERFORMANCE, "Record motion", Toolbar::BOOL, &recordMotion);
+		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "Rec Timing(ms)", Toolbar::DOUBLE, &motionRecordTimingMs);
+		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "Recorded ticks", Toolbar::UNSIGNED_INT, &recordedTicks);
+		if (m_playbackMotion)
+		{
+			m_toolBar->addReadWriteVariable(Toolbar::PLAYER, "Play", Toolbar::BOOL, &playbackRunning);
+			m_toolBar->addReadWriteVariable(Toolbar::PLAYER, "Playback speed", Toolbar::FLOAT, &playbackSpeed);
+			m_toolBar->addReadWriteVariable(Toolbar::PLAYER, "Playhead(tick)", Toolbar::FLOAT, &playheadTick);
+		}
 		m_toolBar->addReadOnlyVariable(Toolbar::PERFORMANCE, "Tick", Toolbar::INT, &fixedStepCounter);
 		m_toolBar->addReadWriteVariable(Toolbar::PLAYER, "Lock LF Y (onRestart)", Toolbar::BOOL, &lockLFY_onRestart);
+		m_toolBar->addButton(Toolbar::PLAYER, "Save checkpoint", boolButton, (void*)&saveCheckpoint);
+		m_toolBar->addButton(Toolbar::PLAYER, "Load checkpoint", boolButton, (void*)&loadCheckpoint);
 		m_toolBar->addSeparator(Toolbar::PLAYER, "Torques");
 		m_toolBar->addReadWriteVariable(Toolbar::PLAYER, "t Limit", Toolbar::FLOAT, &ControllerSystem::m_torqueLim);
 		m_toolBar->addReadWriteVariable(Toolbar::PLAYER, "Use LF feedbk", Toolbar::BOOL, &ControllerSystem::m_useLFFeedbackTorque);
@@ -273,13 +376,39 @@ void App::run()
 	}
 
 	MeasurementBin<std::vector<float>> controllerPerfRecorder;
+	// Hardware counters of the controller phase and the physics step, per tick
+	PerfCounterRecorder controllerCounterRecorder;
+	PerfCounterRecorder physicsCounterRecorder;
+	// The raw timings are streamed to disk during the runs and the result files are
+	// written on the writer's thread, so neither a restart nor the last run waits on them
+	MeasurementWriter measurementWriter;
 	// The controller measurement is activated
 	// if measurement is turned on in settings:
 	if (m_measurePerf)
 	{
 		controllerPerfRecorder.activate();
+		controllerPerfRecorder.activateHistogram();
+		// zones are only recorded if compiled in with TICK_TRACE
+		TickTrace::setEnabled(true);
+		AllocTracker::setEnabled(AllocTracker::isCompiledIn());
+		PerfCounters::setEnabled(true);
+		controllerCounterRecorder.activate();
+		physicsCounterRecorder.activate();
+		bool serial = m_initExecSetup == InitExecSetup::SERIAL;
+		std::string sampleFile = std::string("../output/graphs/samples_") + (serial ? "serial" : "parallel") +
+			ToString(m_initCharCountSerial) + (m_characterCreateType == CharCreateType::BIPED ? "BIPED" : "QUADRUPED") +
+			(serial ? "" : "_thread" + ToString(m_initParallelInvocCount)) + ".msmp";
+		if (measurementWriter.start(sampleFile))
+			controllerPerfRecorder.streamTo(&measurementWriter);
+		else
+			DEBUGPRINT(("\nCould not open the measurement sample file\n"));
 		m_restart = true;
 	}
+	// Viewers in other processes can follow the runs through the feed named in the autoload file
+	TelemetryFeed telemetryFeed;
+	std::string telemetryName = getAutoLoadFilenameSetting("../autoloadTelemetry.txt");
+	if (telemetryName != "" && !telemetryFeed.create(telemetryName, (unsigned int)m_initCharCountSerial))
+		DEBUGPRINT(("\nCould not create the telemetry feed\n"));
 	int perfRuns = m_measurementRuns;
 
 
@@ -327,7 +456,11 @@ void App::run()
 		dynamicsWorld->setGravity(btVector3(0, WORLD_GRAVITY, 0));
 
 		// Measurements and debug
-		MeasurementBin<string> rigidBodyStateDbgRecorder;
+		StateHashRecorder stateHashRecorder;
+		MotionRecorder motionRecorder;
+		MotionPlayback motionPlayback;
+		bool playbackJointsSet = false;
+		bool restoreStartCheckpoint = !startCheckpoint.isEmpty();
 
 		// Artemis
 		// Create and initialize systems
@@ -336,17 +469,10 @@ void App::run()
 		if (m_debugDrawBatch) AdvancedEntitySystem::registerDebugDrawBatch(m_debugDrawBatch);
 		//MovementSystem * movementsys = (MovementSystem*)sm->setSystem(new MovementSystem());
 		//addGameLogic(movementsys);
-#ifdef MEASURE_RBODIES
 		if (m_runOptimization)
-			m_rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(dynamicsWorld,&rigidBodyStateDbgRecorder,true));
-		else
-			m_rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(dynamicsWorld, &rigidBodyStateDbgRecorder));
-#else
-		if (m_runOptimization)
-			m_rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(dynamicsWorld, NULL, true));
+			m_rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(dynamicsWorld, true));
 		else
 			m_rigidBodySystem = (RigidBodySystem*)sysManager->setSystem(new RigidBodySystem(dynamicsWorld));
-#endif
 		ConstantForceSystem* cforceSystem = (ConstantForceSystem*)sysManager->setSystem(new ConstantForceSystem());
 		//ConstraintSystem* constraintSystem = (ConstraintSystem*)sysManager->setSystem(new ConstraintSystem(dynamicsWorld));
 		if (!m_consoleMode)
@@ -369,6 +495,8 @@ void App::run()
 		if (m_runOptimization)
 		{
 			m_optimizationSystem = (ControllerOptimizationSystem*)sysManager->setSystem(new ControllerOptimizationSystem(m_optmesSteps));
+			m_optimizationSystem->setEvaluationCache(&evaluationCache);
+			m_optimizationSystem->setParamSchema(&paramSchema);
 		}
 
 		ConstraintSystem* constraintSystem = (ConstraintSystem*)sysManager->setSystem(new ConstraintSystem(dynamicsWorld));
@@ -387,6 +515,14 @@ void App::run()
 		PhysicsWorldHandler physicsWorldHandler(dynamicsWorld, m_controllerSystem);
 		physicsWorldHandler.addOrderIndependentSystem(cforceSystem);
 		physicsWorldHandler.addPreprocessSystem(m_rigidBodySystem);
+		physicsWorldHandler.setStateHashRecorder(&stateHashRecorder);
+		physicsWorldHandler.setMotionRecorder(&motionRecorder);
+		physicsWorldHandler.setTelemetryFeed(&telemetryFeed);
+		if (controllerCounterRecorder.isActive())
+		{
+			m_controllerSystem->setPerfCounterRecorder(&controllerCounterRecorder);
+			physicsWorldHandler.setPerfCounterRecorder(&physicsCounterRecorder);
+		}
 
 
 		// Entity manager fetch
@@ -406,15 +542,7 @@ void App::run()
 
 
 		// Test of controller
-		float scale = 2.0f;
-		float hipCoronalOffset = scale*0.2f; // coronal distance between hip joints and center
-		glm::vec3 bodOffset;
-		// size setups
-		float	lfHeight	= scale*0.48f;
-		float	uLegHeight	= scale*0.45f;
-		float	lLegHeight	= scale*0.45f;
-		float	footHeight	= scale*0.05f;
-		float	footLen		= scale*0.3f;
+		CharacterFactory characterFactory(entityManager, m_toolBar);
 		int chars = m_initCharCountSerial;
 		bool lockPos = true;
 		bool drawAll = dbgDrawAllChars;
@@ -428,569 +556,60 @@ void App::run()
 		{	
 			quadruped = false;
 		}
-		
+		characterFactory.setLockPos(lockPos, lockLFY_onRestart);
 
 		float charOffsetX = m_initCharOffset;
-		float charPosY = lfHeight*0.5f + uLegHeight + lLegHeight + footHeight;
 
-		DEBUGPRINT((ToString(charPosY).c_str()));
+		DEBUGPRINT((ToString(characterFactory.getStartHeight(false)).c_str()));
 
-		float lfDist = 2.0f;
-		int spineParts = 4;
 		if (m_runOptimization)
 		{
 			charOffsetX = 0.0f;
 			/*if (quadruped) chars = 5; else */chars = 10;
 		}
+		// A scenario replaces the row of characters
+		if (!m_runOptimization && scenario.getInstanceCount() > 0)
+		{
+			std::vector<CharacterFactory::Character> crowd;
+			if (characterFactory.createCrowd(scenario, drawAll, crowd))
+				chars = 0;
+			else
+				DEBUGPRINT(("\nCould not spawn the scenario, using the default characters\n"));
+			for (unsigned int i = 0; i < crowd.size(); i++)
+				crowd[i].m_controllerEntity->refresh();
+		}
 
-		if (quadruped)
+		for (int x = 0; x < chars; x++) // number of characters
 		{
-			lLegHeight = scale*0.4f;
-			footHeight = scale*0.05f;
-			footLen = scale*0.2f;
-			charPosY = lfHeight*0.5f + uLegHeight + lLegHeight + footHeight;
-#pragma region quadrupedtype
-			for (int x = 0; x < chars; x++) // number of characters
+			CharacterFactory::Character character = quadruped ? characterFactory.createQuadruped(x, charOffsetX, drawAll) :
+																characterFactory.createBiped(x, charOffsetX, drawAll);
+			artemis::Entity & controller = *character.m_controllerEntity;
+			ControllerComponent* controllerComp = character.m_controller;
+			if (m_runOptimization)
 			{
-				vector<artemis::Entity*> charLFs;
-				vector<artemis::Entity*> hipJoints;
-
-				std::vector<float> uLegLens; std::vector<float> lLegLens;
-				std::vector<int> kneeFlip;
-
-				int legFrames = 2;
-				artemis::Entity* prevlegFrame = NULL;
-				for (int y = 0; y < legFrames; y++) // number of leg frames
-				{
-					artemis::Entity& legFrame = entityManager->create();
-					glm::vec3 pos = bodOffset + glm::vec3(/*x*charOffsetX*/0.0f, charPosY, (float)-y*lfDist);
-
-					// if locked, we move down a tiny bit to get traction
-					//if (lockLFY_onRestart) pos.y -= 0.5f*footHeight;
-
-					//(float(i) - 50, 10.0f+float(i)*4.0f, float(i)*0.2f-50.0f);
-					glm::vec3 lfSize = glm::vec3(hipCoronalOffset*2.0f, lfHeight, (float)(2 - y)*hipCoronalOffset);
-					float characterMass = /*scale**/10.0f;
-					RigidBodyComponent* lfRB = new RigidBodyComponent(new btBoxShape(btVector3(lfSize.x, lfSize.y, lfSize.z)*0.5f), characterMass,
-						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT);
-					legFrame.addComponent(lfRB);
-					if (drawAll || x == 0) legFrame.addComponent(new RenderComponent());
-					MaterialComponent* matlf = new MaterialComponent(dawnBringerPalRGB[(x * 2) % 31]);
-					legFrame.addComponent(matlf);
-					TransformComponent* tc = new TransformComponent(pos,
-						glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
-						lfSize);
-					tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-					legFrame.addComponent(tc);
-
-					if (lockPos)
-					{
-						float lck = lockLFY_onRestart ? 0.0f : 1.0f;
-						lfRB->setLinearFactor(glm::vec3(lck, 1, 1));
-						lfRB->setAngularFactor(glm::vec3(1, lck, lck));
-					}
-
-
-					//legFrame.addComponent(new ConstantForceComponent(glm::vec3(0, characterMass*12.0f, 0)));
-					legFrame.refresh();
-					string legFrameName = "LegFrame";
-					/*m_toolBar->addLabel(Toolbar::CHARACTER, legFrameName.c_str(), (" label='" + legFrameName + "'").c_str());*/
-					if (x == 0 && m_toolBar) m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + legFrameName + "'").c_str());
-					//
-					// Number of leg frames per character
-					for (int n = 0; n < 2; n++) // number of legs per frame
-					{
-						string sideName = ToString(y) + (string(n == 0 ? "Left" : "Right") + "Leg");
-						if (x == 0 && m_toolBar)
-						{
-							m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + sideName + "' ").c_str());
-							m_toolBar->defineBarParams(Toolbar::CHARACTER, ("/" + sideName + " opened=false").c_str());
-						}
-						//m_toolBar->addLabel(Toolbar::CHARACTER, sideName.c_str(),"");
-						artemis::Entity* prev = &legFrame;
-						artemis::Entity* upperLegSegment = NULL;
-						float currentHipJointCoronalOffset = (float)(n * 2 - 1)*hipCoronalOffset;
-						glm::vec3 legpos = pos + glm::vec3(currentHipJointCoronalOffset, 0.0f, 0.0f);
-						glm::vec3 boxSize = glm::vec3(0.25f, uLegHeight, 0.25f);
-						glm::vec3 parentSz = glm::vec3(boxSize.x, lfHeight, boxSize.z);
-						for (int i = 0; i < 3; i++) // number of segments per leg
-						{
-							artemis::Entity & childJoint = entityManager->create();
-							float jointXOffsetFromParent = 0.0f; // for coronal displacement for hip joints
-							float jointYOffsetInChild = 0.0f; // for sagittal displacement for feet
-							float jointZOffsetInChild = 0.0f; // for sagittal displacment for feet
-							if (i != 0) parentSz = boxSize;//glm::vec3(boxSize.x, uLegHeight, boxSize.z);
-							//boxSize = glm::vec3(0.25f, uLegHeight, 0.25f); // set new size for current box
-							// segment specific constraint params
-							glm::vec3 lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.5f);
-							glm::vec3 upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.5f);
-							string partName;
-							float segmentMass = 5.0f;
-							bool foot = false;
-							float thisFootHeight = footHeight;
-							float thisFootLen = footLen;
-							/*if (y == 0) // digitigrade front feet
-								thisFootHeight = footHeight * 4;*/
-							if (i == 0) // if hip joint (upper leg)
-							{
-								partName = " upper";
-								upperLegSegment = &childJoint;
-								jointXOffsetFromParent = currentHipJointCoronalOffset;
-								//lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.0f);
-								//upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.0f);
-								lowerAngleLim = glm::vec3(-HALFPI*0.2f, -HALFPI*0.5f*0.0f, -HALFPI*0.1f*0.0f);
-								upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f*0.0f, HALFPI*0.1f*0.0f);
-								segmentMass = /*scale**/5.0f;
-								float height = uLegHeight;
-								/*if (y == 0) // front legs
-									height = height*0.8f;*/
-								boxSize = glm::vec3(scale*0.1f, height, scale*0.1f);
-								if (m_runOptimization)
-								{
-									if (n == 0) uLegLens.push_back(height);
-								}
-								//lowerAngleLim = glm::vec3(1, 1, 1);
-								//upperAngleLim = glm::vec3(0,0,0);
-							}
-							else if (i == 1) // if knee (lower leg)
-							{
-								partName = " lower";
-								if (y == 0) // front legs have "flipped" knees, for digitigrade anatomy
-								{
-									lowerAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-									upperAngleLim = glm::vec3(PI*0.5f, 0.0f, 0.0f);
-								}
-								else
-								{
-									lowerAngleLim = glm::vec3(-PI*0.7f/*-HALFPI*/, 0.0f, 0.0f);
-									upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-								}
-								segmentMass = /*scale**/4.0f;
-								float kneeheight = lLegHeight;
-								/*if (y == 0) // front legs
-									height = height*0.8f;*/
-								boxSize = glm::vec3(scale*0.1f, lLegHeight, scale*0.1f);
-								if (m_runOptimization)
-								{
-									if (n == 0)
-									{
-										lLegLens.push_back(kneeheight + thisFootHeight);
-										kneeFlip.push_back(y == 1 ? 1 : -1);
-									}
-								}
-							}
-							else if (i == 2) // if foot
-							{
-								partName = " foot";
-								//boxSize = glm::vec3(scale*0.08f, footHeight, scale*0.2f);
-								if (y == 0) // digitigrade front feet
-								{
-									lowerAngleLim = glm::vec3(HALFPI*0.3f, 0.0f, 0.0f);
-									upperAngleLim = glm::vec3(HALFPI*1.01f, 0.0f, 0.0f);
-									thisFootLen = 1.5f*footLen;
-									//thisFootLen = footLen*0.5f;
-								}
-								else // digitigrade back feet
-								{
-									thisFootLen = 1.5f*footLen;
-									lowerAngleLim = glm::vec3(HALFPI, 0.0f, 0.0f);
-									upperAngleLim = glm::vec3(HALFPI*1.2f, 0.0f, 0.0f);
-									//lowerAngleLim = glm::vec3(HALFPI*0.5f, -HALFPI*0.1f*0.0f, -HALFPI*0.1f);
-									//upperAngleLim = glm::vec3(HALFPI*1.2f, HALFPI*0.1f*0.0f, HALFPI*0.1f);
-								}
-								jointYOffsetInChild = thisFootLen*0.2f;
-								//jointYOffsetInChild = footLen*0.5f;
-								jointZOffsetInChild = -thisFootHeight*0.5f;
-								//lowerAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-								//upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-								//lowerAngleLim = glm::vec3(HALFPI*0.6f, -HALFPI*0.1f, -HALFPI*0.1f);
-								//upperAngleLim = glm::vec3(HALFPI*1.8f, HALFPI*0.1f, HALFPI*0.1f);
-								segmentMass = /*scale**/1.0f;
-								foot = true;
-								boxSize = glm::vec3(scale*0.2f, thisFootLen, thisFootHeight);
-							}
-							string dbgGrp = (" group='" + sideName + "'");
-							if (x == 0 && m_toolBar) m_toolBar->addLabel(Toolbar::CHARACTER, (ToString(x) + sideName.substr(0, 2) + partName).c_str(), dbgGrp.c_str());
-							legpos += glm::vec3(glm::vec3(0.0f, -parentSz.y*0.5f - boxSize.y*0.5f, 0.0f/*jointZOffsetInChild*/));
-							if (foot == true)
-							{
-								// foot need collision callback properties
-								childJoint.addComponent(new RigidBodyComponent(RigidBodyComponent::REGISTER_COLLISIONS,
-									new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
-									CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
-							}
-							else
-							{
-								// ordinary joint does not need collision callback
-								childJoint.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
-									CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
-							}
-							if (drawAll || x == 0) childJoint.addComponent(new RenderComponent());
-							if (i != 2)
-							{			
-								tc = new TransformComponent(legpos,
-									glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
-									boxSize);// note scale, so full lengths
-								tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-								childJoint.addComponent(tc);
-							}
-							else // foot
-							{
-								// TODO! digitigrade feet
-								//if (y == 0)// digitigrade front feet
-								//{
-								//	glm::quat rot = glm::quat(glm::vec3(-HALFPI, 0.0f, 0.0f));
-								//	childJoint.addComponent(new TransformComponent(legpos + glm::vec3(0.0f, footLen*0.5f + jointZOffsetInChild, footLen*0.5f - jointYOffsetInChild),
-								//		rot,
-								//		boxSize));					// note scale, so full lengths
-								//}
-								//else// digitigrade back feet
-								{
-									glm::quat rot = glm::quat(glm::vec3(-HALFPI, 0.0f, 0.0f));
-									// feet fly up for quadrupeds, optimize this for more correct: glm::vec3(0.0f, footLen*0.5f + jointZOffsetInChild, boxSize.y*0.5f - jointYOffsetInChild),
-
-									tc = new TransformComponent(legpos + glm::vec3(0.0f, thisFootLen*0.5f + jointZOffsetInChild, thisFootLen*0.5f - jointYOffsetInChild),
-										rot,
-										boxSize);					// note scale, so full lengths
-									tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-									childJoint.addComponent(tc);
-								}
-							}
-							MaterialComponent* mat = new MaterialComponent(colarr[(y + n) * 3 + i]);
-							childJoint.addComponent(mat);
-							if (x == 0 && m_toolBar) m_toolBar->addReadWriteVariable(Toolbar::CHARACTER, (sideName.substr(0, 2) + ToString(partName[1]) + " Color").c_str(), Toolbar::COL_RGBA, (void*)&mat->getColorRGBA(), dbgGrp.c_str());
-							ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, boxSize.y*0.5f - jointYOffsetInChild, -jointZOffsetInChild),	  // child (this)
-								glm::vec3(jointXOffsetFromParent, -parentSz.y*0.5f, 0.0f),													  // parent
-								{ lowerAngleLim, upperAngleLim },
-								false };
-							childJoint.addComponent(new ConstraintComponent(prev, constraintDesc));
-							childJoint.refresh();
-							prev = &childJoint;
-						}
-						hipJoints.push_back(upperLegSegment);
-					}
-					charLFs.push_back(&legFrame);
-					prevlegFrame = &legFrame;
-				} // leg frames
-				//
-				glm::vec3 pos = bodOffset + glm::vec3(/*x*charOffsetX*/0.0f, charPosY, -hipCoronalOffset*0.5f);
-				artemis::Entity* prev = charLFs[0]; // the first parent is the first leg frame
-				// The length of a spine (the height of its rotated segment) is the same as=
-				// The distance between the LFs minus the h-length of a LFs, times two; divided 
-				// by number of wanted spines:
-				float boxHeight = (lfDist - (hipCoronalOffset*0.5f * 2)) / (float)spineParts;
-				float spineHeight = lfHeight*0.75f;
-				glm::vec3 boxSize = glm::vec3(hipCoronalOffset, boxHeight, spineHeight); // note, we rotate it
-				glm::vec3 spinepos = pos + glm::vec3(0.0f, (lfHeight - spineHeight)*0.5f, -boxHeight*0.5f);
-				// first spine joint is child to leg frame
-				glm::vec3 parentSz = glm::vec3(boxSize.x, lfHeight, hipCoronalOffset);
-				float jointYOffsetInParent = lfHeight*0.5f; // for sagittal displacement
-				float jointZOffsetInParent = -parentSz.z*0.5f; // for sagittal displacment
-				glm::vec3 lowerAngleLim = glm::vec3(-HALFPI*0.1f, -HALFPI*0.1f, -HALFPI*0.1f);
-				glm::vec3 upperAngleLim = glm::vec3(HALFPI*0.1f, HALFPI*0.1f, HALFPI*0.1f);
-				glm::vec3 lowerAngleLimBase = glm::vec3(-HALFPI, 0, 0);
-				glm::vec3 upperAngleLimBase = glm::vec3(-HALFPI, 0, 0);
-				std::vector<artemis::Entity*> spines;
-				for (int s = 0; s < spineParts; s++)
+				ControllerMovementRecorderComponent* recComp = new ControllerMovementRecorderComponent();
+				recComp->setLowerLegLengths(character.m_lLegLens);
+				recComp->setUpperLegLengths(character.m_uLegLens);
+				// If first optimization run, and controller 0, add the current settings
+				// as the "ghost" reference to measure for leg movements (measure physics result to kinematic target)
+				// If this is another iteration, or another controller, add the reference ghost that we saved in the beginning.
+				// The ghost is thus not changed between runs or controllers, everyone measures to the same reference.
+				for (unsigned int r = 0; r < controllerComp->getLegFrameCount(); r++)
 				{
-					// Create the spine
-					// ----------------------------
-					// SPINE
-					// ----------------------------
-					artemis::Entity & spineJoint = entityManager->create();
-					if (s != 0) parentSz = boxSize;//glm::vec3(boxSize.x, uLegHeight, boxSize.z);
-					float segmentMass = 1.0f;
-
-					if (s > 0)
+					if (x == 0 && r >= (unsigned int)baseOptimizationReferenceMovementControllers.size())
 					{
-						// as the non-root spines are children to the root spine, which is rotated,
-						// we're working from another coordinate system for joint offsets and angle limits:
-						spinepos += glm::vec3(glm::vec3(0.0f, 0.0f, -boxHeight));
-						lowerAngleLimBase = glm::vec3(0.0f, 0, 0);
-						upperAngleLimBase = glm::vec3(0.0f, 0, 0);
-						jointYOffsetInParent = -parentSz.y*0.5f; // for sagittal displacement
-						jointZOffsetInParent = -spineHeight*0.5f; // for sagittal displacment
+						baseOptimizationReferenceMovementControllers.push_back(ReferenceLegMovementController(controllerComp, controllerComp->getLegFrame(r), 2, character.m_kneeFlip[r]));
 					}
-
-					// no need collision callback
-					spineJoint.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
-						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
-
-					if (drawAll || x == 0) spineJoint.addComponent(new RenderComponent());
-
-
-					TransformComponent* tc = new TransformComponent(spinepos,
-						glm::quat(glm::vec3(HALFPI, 0.0f, 0.0f)),
-						boxSize);
-					tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-					spineJoint.addComponent(tc);
-
-					MaterialComponent* mat = new MaterialComponent(colarr[s + 3]);
-					spineJoint.addComponent(mat);
-
-					ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, boxSize.y*0.5f, -spineHeight*0.5f),	  // child (this)
-						glm::vec3(0.0f, jointYOffsetInParent, jointZOffsetInParent),							  // parent
-						{ lowerAngleLimBase + lowerAngleLim, upperAngleLimBase + upperAngleLim },
-						false };
-					spineJoint.addComponent(new ConstraintComponent(prev, constraintDesc));
-					spineJoint.refresh();
-					spines.push_back(&spineJoint);
-					prev = &spineJoint;
+					recComp->addLegReferenceController(baseOptimizationReferenceMovementControllers[r]);
 				}
-				// finish by constraint the back LF to the last spine
-				// the back LF become the child of the last spine joint
-				jointYOffsetInParent = -boxSize.y*0.5f; // for sagittal displacement
-				jointZOffsetInParent = -spineHeight*0.5f; // for sagittal displacment
-				lowerAngleLim = glm::vec3(HALFPI, 0, 0);
-				upperAngleLim = glm::vec3(HALFPI, 0, 0);
-				ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, lfHeight*0.5f, hipCoronalOffset*0.5f),	  // child (this) ie. the LF
-					glm::vec3(0.0f, jointYOffsetInParent, jointZOffsetInParent),							 // parent ie. the last spine joint
-					{ lowerAngleLim, upperAngleLim },
-					false };
-				// parent to the last leg frame that was added
-				prevlegFrame->addComponent(new ConstraintComponent(prev, constraintDesc));
-				prevlegFrame->refresh();
-
-
-				// ------------------
-
-				// Controller
-				artemis::Entity & controller = entityManager->create();
-				ControllerComponent* controllerComp = new ControllerComponent(charLFs, hipJoints, &spines);
-				controller.addComponent(controllerComp);
-				if (m_runOptimization)
-				{
-					ControllerMovementRecorderComponent* recComp = new ControllerMovementRecorderComponent();
-					recComp->setLowerLegLengths(lLegLens);
-					recComp->setUpperLegLengths(uLegLens);
-					// If first optimization run, and controller 0, add the current settings
-					// as the "ghost" reference to measure for leg movements (measure physics result to kinematic target)
-					// If this is another iteration, or another controller, add the reference ghost that we saved in the beginning.
-					// The ghost is thus not changed between runs or controllers, everyone measures to the same reference.
-					for (unsigned int r = 0; r < controllerComp->getLegFrameCount(); r++)
-					{
-						if (x == 0 && r >= (unsigned int)baseOptimizationReferenceMovementControllers.size())
-						{
-							baseOptimizationReferenceMovementControllers.push_back(ReferenceLegMovementController(controllerComp, controllerComp->getLegFrame(r), 2, kneeFlip[r]));
-						}
-						recComp->addLegReferenceController(baseOptimizationReferenceMovementControllers[r]);
-					}
-					controller.addComponent(recComp);
+				controller.addComponent(recComp);
 
-				}
-				else if (m_bestParams!=NULL)// normal run and we have new param list loaded from file
-				{
-					controllerComp->setInitParams(*m_bestParams);
-				}
-				controller.refresh();
 			}
-#pragma endregion quadrupedtype
-		}
-		else
-		{
-#pragma region biped
-			for (int x = 0; x < chars; x++) // number of characters
+			else if (m_bestParams!=NULL)// normal run and we have new param list loaded from file
 			{
-				vector<artemis::Entity*> charLFs;
-				vector<artemis::Entity*> hipJoints;
-
-				std::vector<float> uLegLens; std::vector<float> lLegLens;
-
-				for (int y = 0; y < 1; y++) // number of leg frames
-				{
-					artemis::Entity& legFrame = entityManager->create();
-					glm::vec3 pos = bodOffset + glm::vec3(/*x*charOffsetX*/0.0f, charPosY, (float)-y);
-
-					// if locked, we move down a tiny bit to get traction
-					//if (lockLFY_onRestart) pos.y -= 0.5f*footHeight;
-
-					//(float(i) - 50, 10.0f+float(i)*4.0f, float(i)*0.2f-50.0f);
-					glm::vec3 lfSize = glm::vec3(hipCoronalOffset*2.0f, lfHeight, hipCoronalOffset);
-					float characterMass = /*scale**/10.0f;
-					RigidBodyComponent* lfRB = new RigidBodyComponent(new btBoxShape(btVector3(lfSize.x, lfSize.y, lfSize.z)*0.5f), characterMass,
-						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT);
-					legFrame.addComponent(lfRB);
-					if (drawAll || x == 0) legFrame.addComponent(new RenderComponent());
-					MaterialComponent* matlf = new MaterialComponent(dawnBringerPalRGB[(x * 2) % 31]);
-					legFrame.addComponent(matlf);
-					TransformComponent* tc = new TransformComponent(pos,
-						glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
-						lfSize);
-					tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-					legFrame.addComponent(tc);
-
-					if (lockPos)
-					{
-						float lck = lockLFY_onRestart ? 0.0f : 1.0f;
-						lfRB->setLinearFactor(glm::vec3(lck, 1, 1));
-						lfRB->setAngularFactor(glm::vec3(1, lck, lck));
-					}
-
-
-					//legFrame.addComponent(new ConstantForceComponent(glm::vec3(0, characterMass*12.0f, 0)));
-					legFrame.refresh();
-					string legFrameName = "LegFrame";
-					/*m_toolBar->addLabel(Toolbar::CHARACTER, legFrameName.c_str(), (" label='" + legFrameName + "'").c_str());*/
-					if (x == 0 && m_toolBar) m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + legFrameName + "'").c_str());
-					//
-					// Number of leg frames per character
-					for (int n = 0; n < 2; n++) // number of legs per frame
-					{
-						string sideName = (string(n == 0 ? "Left" : "Right") + "Leg");
-						if (x == 0 && m_toolBar)
-						{
-							m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + sideName + "' ").c_str());
-							m_toolBar->defineBarParams(Toolbar::CHARACTER, ("/" + sideName + " opened=false").c_str());
-						}
-						//m_toolBar->addLabel(Toolbar::CHARACTER, sideName.c_str(),"");
-						artemis::Entity* prev = &legFrame;
-						artemis::Entity* upperLegSegment = NULL;
-						float currentHipJointCoronalOffset = (float)(n * 2 - 1)*hipCoronalOffset;
-						glm::vec3 legpos = pos + glm::vec3(currentHipJointCoronalOffset, 0.0f, 0.0f);
-						glm::vec3 boxSize = glm::vec3(0.25f, uLegHeight, 0.25f);
-						glm::vec3 parentSz = glm::vec3(boxSize.x, lfHeight, boxSize.z);
-						for (int i = 0; i < 3; i++) // number of segments per leg
-						{
-							artemis::Entity & childJoint = entityManager->create();
-							float jointXOffsetFromParent = 0.0f; // for coronal displacement for hip joints
-							float jointYOffsetInChild = 0.0f; // for sagittal displacement for feet
-							float jointZOffsetInChild = 0.0f; // for sagittal displacment for feet
-							if (i != 0) parentSz = boxSize;//glm::vec3(boxSize.x, uLegHeight, boxSize.z);
-							//boxSize = glm::vec3(0.25f, uLegHeight, 0.25f); // set new size for current box
-							// segment specific constraint params
-							glm::vec3 lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.5f);
-							glm::vec3 upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.5f);
-							string partName;
-							float segmentMass = 5.0f;
-							bool foot = false;
-							if (i == 0) // if hip joint (upper leg)
-							{
-								partName = " upper";
-								upperLegSegment = &childJoint;
-								jointXOffsetFromParent = currentHipJointCoronalOffset;
-								//lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.0f);
-								//upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.0f);
-								lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f*0.0f, -HALFPI*0.1f*0.0f);
-								upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f*0.0f, HALFPI*0.1f*0.0f);
-								segmentMass = /*scale**/5.0f;
-								boxSize = glm::vec3(scale*0.1f, uLegHeight, scale*0.1f);
-								if (m_runOptimization)
-								{
-									if (n == 0) uLegLens.push_back(uLegHeight);
-								}
-								//lowerAngleLim = glm::vec3(1, 1, 1);
-								//upperAngleLim = glm::vec3(0,0,0);
-							}
-							else if (i == 1) // if knee (lower leg)
-							{
-								partName = " lower";
-								lowerAngleLim = glm::vec3(-PI*0.7f/*-HALFPI*/, 0.0f, 0.0f);
-								upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-								segmentMass = /*scale**/4.0f;
-								boxSize = glm::vec3(scale*0.1f, lLegHeight, scale*0.1f);
-								if (m_runOptimization)
-								{
-									if (n == 0) lLegLens.push_back(lLegHeight + footHeight);
-								}
-							}
-							else if (i == 2) // if foot
-							{
-								partName = " foot";
-								//boxSize = glm::vec3(scale*0.08f, footHeight, scale*0.2f);
-								boxSize = glm::vec3(scale*0.2f, footLen, footHeight);
-								jointYOffsetInChild = footLen*0.2f;
-								jointZOffsetInChild = 0.0f*-footHeight*0.5f;
-								//jointZOffsetInChild = (boxSize.z - parentSz.z)*0.5f;
-								lowerAngleLim = glm::vec3(HALFPI*0.8f, -HALFPI*0.1f*0.0f, -HALFPI*0.1f);
-								upperAngleLim = glm::vec3(HALFPI*1.2f, HALFPI*0.1f*0.0f, HALFPI*0.1f);
-								//lowerAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-								//upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
-								//lowerAngleLim = glm::vec3(HALFPI*0.6f, -HALFPI*0.1f, -HALFPI*0.1f);
-								//upperAngleLim = glm::vec3(HALFPI*1.8f, HALFPI*0.1f, HALFPI*0.1f);
-								segmentMass = /*scale**/1.0f;
-								foot = true;
-							}
-							string dbgGrp = (" group='" + sideName + "'");
-							if (x == 0 && m_toolBar) m_toolBar->addLabel(Toolbar::CHARACTER, (ToString(x) + sideName[0] + partName).c_str(), dbgGrp.c_str());
-							legpos += glm::vec3(glm::vec3(0.0f, -parentSz.y*0.5f - boxSize.y*0.5f, 0.0f/*jointZOffsetInChild*/));
-							if (foot == true)
-							{
-								// foot need collision callback properties
-								childJoint.addComponent(new RigidBodyComponent(RigidBodyComponent::REGISTER_COLLISIONS,
-									new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
-									CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
-							}
-							else
-							{
-								// ordinary joint does not need collision callback
-								childJoint.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
-									CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
-							}
-							if (drawAll || x == 0) childJoint.addComponent(new RenderComponent());
-							if (i != 2)
-							{
-								tc = new TransformComponent(legpos,
-									glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
-									boxSize);// note scale, so full lengths
-								tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-								childJoint.addComponent(tc);
-							}
-							else // foot
-							{
-								glm::quat rot = glm::quat(glm::vec3(-HALFPI, 0.0f, 0.0f));
-								tc = new TransformComponent(legpos + glm::vec3(0.0f, footLen*0.5f + jointZOffsetInChild, footLen*0.5f - jointYOffsetInChild),
-									rot,
-									boxSize);					// note scale, so full lengths
-								tc->setPositionOffset(glm::vec3(x*charOffsetX, 0.0f, 0.0f));
-								childJoint.addComponent(tc);
-							}
-							MaterialComponent* mat = new MaterialComponent(colarr[n * 3 + i]);
-							childJoint.addComponent(mat);
-							if (x == 0 && m_toolBar) m_toolBar->addReadWriteVariable(Toolbar::CHARACTER, (ToString(x) + sideName[1] + ToString(partName[1]) + " Color").c_str(), Toolbar::COL_RGBA, (void*)&mat->getColorRGBA(), dbgGrp.c_str());
-							ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, boxSize.y*0.5f - jointYOffsetInChild, -jointZOffsetInChild),	  // child (this)
-								glm::vec3(jointXOffsetFromParent, -parentSz.y*0.5f, 0.0f),													  // parent
-								{ lowerAngleLim, upperAngleLim },
-								false };
-							childJoint.addComponent(new ConstraintComponent(prev, constraintDesc));
-							childJoint.refresh();
-							prev = &childJoint;
-						}
-						hipJoints.push_back(upperLegSegment);
-					}
-					charLFs.push_back(&legFrame);
-				} // leg frames
-				// Controller
-				artemis::Entity & controller = entityManager->create();
-				ControllerComponent* controllerComp = new ControllerComponent(charLFs, hipJoints);
-				controller.addComponent(controllerComp);
-				if (m_runOptimization)
-				{
-					ControllerMovementRecorderComponent* recComp = new ControllerMovementRecorderComponent();
-					recComp->setLowerLegLengths(lLegLens);
-					recComp->setUpperLegLengths(uLegLens);
-					// If first optimization run, and controller 0, add the current settings
-					// as the "ghost" reference to measure for leg movements (measure physics result to kinematic target)
-					// If this is another iteration, or another controller, add the reference ghost that we saved in the beginning.
-					// The ghost is thus not changed between runs or controllers, everyone measures to the same reference.
-					for (int r = 0; r < controllerComp->getLegFrameCount(); r++)
-					{
-						if (x == 0 && r >= baseOptimizationReferenceMovementControllers.size())
-						{
-							baseOptimizationReferenceMovementControllers.push_back(ReferenceLegMovementController(controllerComp, controllerComp->getLegFrame(r)));
-						}
-						recComp->addLegReferenceController(baseOptimizationReferenceMovementControllers[r]);
-					}
-					controller.addComponent(recComp);
-
-				}
-				else if (m_bestParams != NULL)// normal run and we have new param list loaded from file
-				{
-					controllerComp->setInitParams(*m_bestParams);
-				}
-				controller.refresh();
+				controllerComp->setInitParams(*m_bestParams);
 			}
-
-#pragma endregion biped
+			controller.refresh();
 		}
 		if (m_runOptimization)
 		{
@@ -998,7 +617,10 @@ void App::run()
 		}
 
 #ifdef MEASURE_RBODIES
-		rigidBodyStateDbgRecorder.activate();
+		stateHashRecorder.activate();
+#else
+		// Hashing is cheap enough to also be on for perf runs
+		if (m_measurePerf) stateHashRecorder.activate();
 #endif
 
 
@@ -1011,6 +633,23 @@ void App::run()
 
 		double fixedStep = 1.0 / 60.0;
 		double physicsStep = 1.0 / 120.0;
+		if (m_playbackMotion && !motionPlayback.open("../output/sav/motion" + podName + ".mrec", physicsStep))
+			DEBUGPRINT(("\nCould not open the motion recording, nothing to play back\n"));
+
+		if (m_runOptimization)
+		{
+			// Everything besides the parameters that decides the outcome of an evaluation
+			int cachePod = (int)m_characterCreateType;
+			unsigned long long cacheContext = EvaluationCache::hash(&cachePod, sizeof(cachePod));
+			cacheContext = EvaluationCache::hash(&m_optmesSteps, sizeof(m_optmesSteps), cacheContext);
+			cacheContext = EvaluationCache::hash(&m_initCharOffset, sizeof(m_initCharOffset), cacheContext);
+			cacheContext = EvaluationCache::hash(&fixedStep, sizeof(fixedStep), cacheContext);
+			cacheContext = EvaluationCache::hash(&physicsStep, sizeof(physicsStep), cacheContext);
+			// and how it is scored, the weights are the recorder defaults
+			ControllerMovementRecorderComponent objective;
+			cacheContext = objective.hashObjective(cacheContext);
+			evaluationCache.setContextKey(cacheContext);
+		}
 
 		// Dry run, so artemis have run before physics first step
 		gameUpdate(0.0f);
@@ -1046,8 +685,56 @@ void App::run()
 			{				
 				// update timing debug var
 				controllerSystemTimingMs = m_controllerSystem->getLatestTiming() * 1000.0f;
+				if (m_controllerSystem->getControllerCount() > 0)
+				{
+					controllerSystemTimingStat.add(controllerSystemTimingMs);
+					controllerSystemJitterMs = controllerSystemTimingStat.getSTD();
+				}
+				tickTimingMs = physicsWorldHandler.getLatestTickTiming() * 1000.0;
+				physicsWorldHandler.setTickBudget((double)tickBudgetMs);
+				overBudgetTicks = (int)physicsWorldHandler.getOverBudgetCount();
+				tickAllocations = AllocTracker::getLastReport().m_count;
+				// Motion recording of this run, started and stopped from the toolbar
+				if (recordMotion != motionRecorder.isOpen())
+				{
+					if (recordMotion && !motionRecorder.open("../output/sav/motion" + podName + ".mrec"))
+						recordMotion = false;
+					else if (!recordMotion)
+						motionRecorder.close();
+				}
+				motionRecordTimingMs = physicsWorldHandler.getLatestMotionRecordTiming() * 1000.0;
+				recordedTicks = motionRecorder.getRecordedTicks();
+				// Crowd size from the toolbar, taken in once the controllers are built
+				unsigned int controllerCount = m_controllerSystem->getControllerCount();
+				if (controllerCount > 0)
+				{
+					if (activeCharCount == 0 || activeCharCount > controllerCount)
+						activeCharCount = controllerCount;
+					if (activeCharCount != m_controllerSystem->getActiveControllerCount())
+						m_controllerSystem->setActiveControllerCount(activeCharCount);
+				}
+				// Checkpoints need the controllers built as well
+				if (controllerCount > 0 && saveCheckpoint)
+				{
+					SimCheckpoint checkpoint;
+					physicsWorldHandler.saveCheckpoint(checkpoint);
+					if (!checkpoint.save(checkpointPath))
+						DEBUGPRINT(("\nCould not save the checkpoint\n"));
+					saveCheckpoint = false;
+				}
+				if (controllerCount > 0 && (loadCheckpoint || restoreStartCheckpoint))
+				{
+					SimCheckpoint loadedCheckpoint;
+					SimCheckpoint& checkpoint = restoreStartCheckpoint ? startCheckpoint : loadedCheckpoint;
+					if (!restoreStartCheckpoint && !loadedCheckpoint.load(checkpointPath))
+						DEBUGPRINT(("\nCould not load the checkpoint\n"));
+					else if (!physicsWorldHandler.restoreCheckpoint(checkpoint))
+						DEBUGPRINT(("\nThe checkpoint does not fit this world, it needs the same pod and character count\n"));
+					activeCharCount = m_controllerSystem->getActiveControllerCount();
+					loadCheckpoint = restoreStartCheckpoint = false;
+				}
 				if (m_consoleMode)
-					DEBUGPRINT((("\nController System(ms): "+ToString(controllerSystemTimingMs)).c_str()));
+					LOG_DEBUG("\nController System(ms): %g", controllerSystemTimingMs);
 
 				drawDebugAxes();
 				drawDebugOptimizationGraphs(&allOptimizationResults, optimizationDbgMaxscoreelem, 
@@ -1078,24 +765,47 @@ void App::run()
 						dynamicsWorld->setGravity(btVector3(0, 0.0f, 0));
 				}
 
-				// Tick the bullet world. Keep in mind that bullet takes seconds
-				// timeStep < maxSubSteps * fixedTimeStep
-	#if defined(MEASURE_RBODIES)
-				if (!optRealTimeMode)
-					dynamicsWorld->stepSimulation((btScalar)(double)m_timeScale*fixedStep, 1+(physicsStep / (m_timeScale*fixedStep)), (btScalar)physicsStep/*(btScalar)(double)m_timeScale*(1.0f / 1000.0f)*/);
-				else
-					dynamicsWorld->stepSimulation((btScalar)phys_dt/*, 10*/, 10, (btScalar)physicsStep);
-	#else
-				if (m_runOptimization || m_measurePerf)
+				// Recorded motion drives the joints instead, no physics or controllers
+				if (!m_playbackMotion)
 				{
+					// Tick the bullet world. Keep in mind that bullet takes seconds
+					// timeStep < maxSubSteps * fixedTimeStep
+		#if defined(MEASURE_RBODIES)
 					if (!optRealTimeMode)
-						dynamicsWorld->stepSimulation((btScalar)(double)m_timeScale*fixedStep, 1 + (physicsStep / (m_timeScale*fixedStep)), (btScalar)physicsStep/*(btScalar)(double)m_timeScale*(1.0f / 1000.0f)*/);
+						dynamicsWorld->stepSimulation((btScalar)(double)m_timeScale*fixedStep, 1+(physicsStep / (m_timeScale*fixedStep)), (btScalar)physicsStep/*(btScalar)(double)m_timeScale*(1.0f / 1000.0f)*/);
 					else
 						dynamicsWorld->stepSimulation((btScalar)phys_dt/*, 10*/, 10, (btScalar)physicsStep);
+		#else
+					if (m_runOptimization || m_measurePerf)
+					{
+						if (!optRealTimeMode)
+							dynamicsWorld->stepSimulation((btScalar)(double)m_timeScale*fixedStep, 1 + (physicsStep / (m_timeScale*fixedStep)), (btScalar)physicsStep/*(btScalar)(double)m_timeScale*(1.0f / 1000.0f)*/);
+						else
+							dynamicsWorld->stepSimulation((btScalar)phys_dt/*, 10*/, 10, (btScalar)physicsStep);
+					}
+					else
+						dynamicsWorld->stepSimulation((btScalar)phys_dt/*, 10*/,  1, (btScalar)physicsStep);
+		#endif
+				}
+				else if (motionPlayback.isOpen())
+				{
+					// Joints in controller order, known once the controllers are built
+					if (!playbackJointsSet && m_controllerSystem->getControllerCount() > 0)
+					{
+						std::vector<TransformComponent*> joints;
+						for (unsigned int i = 0; i < m_controllerSystem->getJointCount(); i++)
+							joints.push_back(m_controllerSystem->getJointTransform(i));
+						motionPlayback.setJointTransforms(joints);
+						playbackJointsSet = true;
+					}
+					if (playheadTick != shownPlayheadTick) // scrubbed in the toolbar
+						motionPlayback.seek((double)playheadTick);
+					motionPlayback.setSpeed(playbackSpeed);
+					motionPlayback.setPaused(!playbackRunning);
+					motionPlayback.update(phys_dt);
+					motionPlayback.apply();
+					playheadTick = shownPlayheadTick = (float)motionPlayback.getPlayhead();
 				}
-				else
-					dynamicsWorld->stepSimulation((btScalar)phys_dt/*, 10*/,  1, (btScalar)physicsStep);
-	#endif
 				// ========================================================
 
 				unsigned int steps = physicsWorldHandler.getNumberOfInternalSteps();
@@ -1134,7 +844,7 @@ void App::run()
 				if (m_measurePerf)
 				{
 					fixedStepCounter++;
-					DEBUGPRINT((("\n" + ToString(fixedStepCounter)).c_str()));
+					LOG_DEBUG("\n%d", fixedStepCounter);
 					if (fixedStepCounter >= m_optmesSteps)
 					{
 						run = false;
@@ -1240,6 +950,7 @@ void App::run()
 				double oldbestscore = bestOptimizationScore;
 				double firstScore = m_optimizationSystem->getScoreOf(0);
 				bestOptimizationScore = m_optimizationSystem->getWinnerScore();
+				telemetryFeed.setOptimizerScore(bestOptimizationScore);
 				//if (firstScore!=oldbestscore)
 				{
 					DEBUGPRINT(("\n========================================================================"));
@@ -1256,10 +967,15 @@ void App::run()
 					DEBUGPRINT(("\n========================================================================\n"));
 				}
 				DEBUGPRINT((("\nbestscore: " + ToString(bestOptimizationScore)).c_str()));
+				DEBUGPRINT((("\ncache hit rate: " + ToString(evaluationCache.getHitRate()*100.0) + "% (" + ToString(evaluationCache.getHits()) + 
+					" hits, " + ToString(evaluationCache.getMisses()) + " misses, " + ToString(evaluationCache.getSize()) + " entries)").c_str()));
+				DEBUGPRINT((("\nreference tables: " + ToString(ReferenceMotionTable::getSharedCount())).c_str()));
 				optimizationIterationCount++;
 				fixedStepCounter = 0;
 				SAFE_DELETE(m_bestParams);
 				m_bestParams = new std::vector<float>(m_optimizationSystem->getWinnerParams());
+				m_bestParamsLayoutHash = paramSchema.getSize() > 0 ? paramSchema.getLayoutHash() : 0;
+				m_bestParamsScore = bestOptimizationScore;
 				allOptimizationResults.push_back(bestOptimizationScore);
 				oldFirstOptimizationScore = firstScore;
 			}
@@ -1271,65 +987,92 @@ void App::run()
 		}
 
 
-	#ifdef MEASURE_RBODIES
-		rigidBodyStateDbgRecorder.saveMeasurement("Time: "+ToString(time));
-		rigidBodyStateDbgRecorder.saveMeasurement("Steps: "+ToString(physicsWorldHandler.getNumberOfInternalSteps()));
-	#ifndef MULTI
-	#ifdef _DEBUG
-		rigidBodyStateDbgRecorder.saveResultsCSV("../output/determinismTest_Debug_STCPU");
-	#else
-		rigidBodyStateDbgRecorder.saveResultsCSV("../output/determinismTest_Release_STCPU");
-	#endif
-	#else
+		// Determinism check, save this run's hash stream and compare it
+		// to the one of the other execution layout if that has been run
+		if (stateHashRecorder.isActive())
+		{
 	#ifdef _DEBUG
-		rigidBodyStateDbgRecorder.saveResultsCSV("../output/determinismTest_Debug_MTCPU");
+			std::string hashFile = "../output/determinismHash_Debug_";
 	#else
-		rigidBodyStateDbgRecorder.saveResultsCSV("../output/determinismTest_Release_MTCPU");
-	#endif
-	#endif
+			std::string hashFile = "../output/determinismHash_Release_";
 	#endif
+			std::string hashFileSuffix = (m_characterCreateType == CharCreateType::BIPED ? "BIPED" : "QUADRUPED") + ToString(m_initCharCountSerial) + ".bin";
+			bool serial = m_initExecSetup == InitExecSetup::SERIAL;
+			stateHashRecorder.save(hashFile + (serial ? "STCPU" : "MTCPU") + hashFileSuffix);
+			StateHashRecorder otherStateHashes;
+			if (otherStateHashes.load(hashFile + (serial ? "MTCPU" : "STCPU") + hashFileSuffix))
+			{
+				StateHashRecorder::Divergence divergence = StateHashRecorder::compare(stateHashRecorder, otherStateHashes);
+				std::string msg = "\nDeterminism (serial vs parallel): " + StateHashRecorder::toString(divergence);
+				if (divergence.m_entry >= 0)
+					msg += ", " + physicsWorldHandler.getStateHashEntryName(divergence.m_entry);
+				DEBUGPRINT(((msg + "\n").c_str()));
+			}
+		}
 		///////////////////////////////////
 
 		// Save measurements (only if any were taken)
 		// for when we have means and standard deviation
 		if (controllerPerfRecorder.isActive() && !m_restart)
 		{
-			int testUID = 0;
 			std::string podFileSuffix = "";
 			if (m_characterCreateType == CharCreateType::BIPED)
 				podFileSuffix = "BIPED";
 			else
 				podFileSuffix = "QUADRUPED";
 
-			std::string collectionfile;
-
 			controllerPerfRecorder.finishRound();
-			if (m_initExecSetup == InitExecSetup::SERIAL)
+			controllerCounterRecorder.finishRound();
+			physicsCounterRecorder.finishRound();
+			// The recorders are not changed after this, they are written while the app shuts down
+			measurementWriter.post([&, podFileSuffix]()
 			{
+				if (m_initExecSetup == InitExecSetup::SERIAL)
+				{
 #ifdef _DEBUG
-				controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_serial_D");
+					controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_serial_D");
 #else
-				controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_serial" + ToString(m_initCharCountSerial) + podFileSuffix);
+					controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_serial" + ToString(m_initCharCountSerial) + podFileSuffix);
+					controllerCounterRecorder.saveResultsGNUPLOT("../output/graphs/counters_serial" + ToString(m_initCharCountSerial) + podFileSuffix);
+					physicsCounterRecorder.saveResultsGNUPLOT("../output/graphs/counters_physics_serial" + ToString(m_initCharCountSerial) + podFileSuffix);
 #endif
-				// get file name for collection file
-				collectionfile = "../output/graphs/CollectedRunsResultSerial" + podFileSuffix + ".gnuplot.txt";
-			}
-			else
-			{
+				}
+				else
+				{
 #ifdef _DEBUG
-				controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_parallel_D");
+					controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_parallel_D");
 #else
-				controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_parallel" + ToString(m_initCharCountSerial) + podFileSuffix + "_thread" + ToString(m_initParallelInvocCount));
+					controllerPerfRecorder.saveResultsGNUPLOT("../output/graphs/perf_parallel" + ToString(m_initCharCountSerial) + podFileSuffix + "_thread" + ToString(m_initParallelInvocCount));
+					controllerCounterRecorder.saveResultsGNUPLOT("../output/graphs/counters_parallel" + ToString(m_initCharCountSerial) + podFileSuffix + "_thread" + ToString(m_initParallelInvocCount));
+					physicsCounterRecorder.saveResultsGNUPLOT("../output/graphs/counters_physics_parallel" + ToString(m_initCharCountSerial) + podFileSuffix + "_thread" + ToString(m_initParallelInvocCount));
+#endif
+				}
+			});
+
+			// Append the run to the results store, ResultQuery makes the collection tables from it
+			std::vector<float> percentiles;
+			controllerPerfRecorder.getHistogram().getSummary(percentiles);
+			ResultRecord result;
+			result.setHostInfo();
+			result.setString("exec", m_initExecSetup == InitExecSetup::SERIAL ? "Serial" : "Parallel");
+			result.setString("pod", podFileSuffix);
+			result.setInt("chars", m_initCharCountSerial);
+			result.setInt("threads", m_initExecSetup == InitExecSetup::SERIAL ? 1 : m_initParallelInvocCount);
+			result.setInt("ticks", m_optmesSteps);
+			ResultStore::setPerfColumns(result, controllerPerfRecorder.getMean(), controllerPerfRecorder.getSTD(),
+				controllerPerfRecorder.getInternalRuns(), controllerPerfRecorder.getAllMeans(),
+				controllerPerfRecorder.getAllSTDs(), percentiles);
+			measurementWriter.post([result]()
+			{
+				if (!ResultStore::append("../output/graphs/results.rstore", result))
+					LOG_WARN("\nCould not append to the results store\n");
+			});
+#ifdef TICK_TRACE
+			// Zones of the last ticks of the run
+			TickTrace::saveChromeTrace("../output/graphs/trace_" + podFileSuffix + ToString(m_initCharCountSerial) +
+				(m_initExecSetup == InitExecSetup::SERIAL ? "" : "_thread" + ToString(m_initParallelInvocCount)));
+			TickTrace::clear();
 #endif
-				// get file name for collection file
-				collectionfile = "../output/graphs/CollectedRunsResultParallel" + podFileSuffix + ToString(m_initParallelInvocCount) + ".gnuplot.txt";
-			}
-			testUID = m_initCharCountSerial - 1; // 1 char=idx 0
-		
-
-			// Save total avg and std to collection
-			saveMeasurementToCollectionFileAtRow(collectionfile, 
-				controllerPerfRecorder.getMean(), controllerPerfRecorder.getSTD(), testUID);
 
 		}
 
@@ -1368,8 +1111,22 @@ void App::run()
 
 		// debug
 		if (m_toolBar) m_toolBar->clearBar(Toolbar::CHARACTER);
+		// the recording is closed with the run, a new one would overwrite it
+		motionRecorder.close();
+		recordMotion = false;
 	} while (m_restart);
 #pragma endregion mainrestartloop
+	// Waits for the measurement files, while the recorders are still there
+	measurementWriter.stop();
+
+	if (m_runOptimization)
+	{
+		if (!evaluationCache.save(evaluationCachePath))
+			DEBUGPRINT(("\nCould not save evaluation cache\n"));
+		// Listing of names for the saved gait files of this pod
+		if (paramSchema.getSize() > 0)
+			paramSchema.saveListing("../output/sav/paramSchema" + podName + ".txt", m_bestParams);
+	}
 
 	SAFE_DELETE(m_bestParams);
 }
@@ -1471,7 +1228,11 @@ void App::handleContext(double p_dt, double p_physDt, unsigned int p_physSteps)
 		if (m_debugDrawer) m_debugDrawer->setDrawArea((float)width, (float)height);
 	}
 	// special console tick
-	if (m_consoleMode) ConsoleContext::refreshConsole(p_dt);
+	if (m_consoleMode)
+	{
+		AsyncLog::flushConsole();
+		ConsoleContext::refreshConsole(p_dt);
+	}
 	// Print fps in window head border
 	m_fpsUpdateTick -= (float)p_dt;
 	if (m_fpsUpdateTick <= 0.0f)
@@ -1501,7 +1262,8 @@ void App::gameUpdate( double p_dt )
 	{
 		if (m_bestParams != NULL)
 			saveFloatArrayPrompt(m_bestParams, 
-								 m_characterCreateType == BIPED ? 2 : 3);
+								 m_characterCreateType == BIPED ? 2 : 3, m_bestParamsLayoutHash,
+								 m_bestParamsScore < FLT_MAX ? &m_bestParamsScore : NULL);
 		m_saveParams = false;
 	}
 
@@ -1565,9 +1327,9 @@ void App::gameUpdate( double p_dt )
 	m_world.setDelta(game_dt);
 	// Physics result gathering have to run first
 	m_rigidBodySystem->executeDeferredConstraintInits();
-	m_rigidBodySystem->process();
+	if (!m_playbackMotion) // the transforms are set from the recording instead
+		m_rigidBodySystem->process();
 	m_controllerSystem->process();
-	m_rigidBodySystem->lateUpdate();
 	m_controllerSystem->buildCheck();
 	// // Run all other systems, for which order doesn't matter
 	processSystemCollection(&m_orderIndependentSystems);
@@ -1637,6 +1399,10 @@ void App::initFromSettings(SettingsData& p_settings)
 	{
 		m_measurePerf = true;
 	}
+	else if (p_settings.m_simMode == "p")
+	{
+		m_playbackMotion = true;
+	}
 	else
 	{
 		m_runOptimization = false;
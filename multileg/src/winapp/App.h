@@ -112,10 +112,14 @@ private:
 	int   m_initParallelInvocCount;
 	float m_initCharOffset;
 	bool  m_measurePerf;
+	bool  m_playbackMotion; // joints driven by a recording, no physics or controllers
 	int m_optmesSteps;
 	double m_frameTime;
 
 	std::vector<float>* m_bestParams;
+	// Saved with the gait file, when the parameters came from an optimization
+	unsigned long long m_bestParamsLayoutHash;
+	double m_bestParamsScore;
 
 	// Resource managers
 	//ResourceManager<btCollisionShape> m_collisionShapes;
@@ -0,0 +1,652 @@
+#include "CharacterFactory.h"
+#include <string>
+#include <btBulletDynamicsCommon.h>
+#include <ToString.h>
+#include <MathHelp.h>
+#include <ColorPalettes.h>
+#include <CrowdScenario.h>
+#include <GaitFile.h>
+#include <DebugPrint.h>
+#include "Toolbar.h"
+#include "RigidBodyComponent.h"
+#include "TransformComponent.h"
+#include "RenderComponent.h"
+#include "MaterialComponent.h"
+#include "ConstraintComponent.h"
+#include "ControllerComponent.h"
+
+using namespace std;
+
+CharacterFactory::Dimensions::Dimensions()
+{
+	m_scale = 2.0f;
+	m_hipCoronalOffset = m_scale*0.2f;
+	m_bodyOffset = glm::vec3(0.0f);
+	m_lfHeight = m_scale*0.48f;
+	m_uLegHeight = m_scale*0.45f;
+	m_lLegHeight = m_scale*0.45f;
+	m_footHeight = m_scale*0.05f;
+	m_footLen = m_scale*0.3f;
+	m_quadrupedLLegHeight = m_scale*0.4f;
+	m_quadrupedFootLen = m_scale*0.2f;
+	m_lfDist = 2.0f;
+	m_spineParts = 4;
+}
+
+bool CharacterFactory::Dimensions::set(const std::string& p_name, float p_value)
+{
+	if (p_name == "scale")
+	{
+		float rescale = p_value / m_scale;
+		m_scale = p_value;
+		m_hipCoronalOffset *= rescale;
+		m_bodyOffset *= rescale;
+		m_lfHeight *= rescale;
+		m_uLegHeight *= rescale;
+		m_lLegHeight *= rescale;
+		m_footHeight *= rescale;
+		m_footLen *= rescale;
+		m_quadrupedLLegHeight *= rescale;
+		m_quadrupedFootLen *= rescale;
+		m_lfDist *= rescale;
+	}
+	else if (p_name == "hipCoronalOffset") m_hipCoronalOffset = p_value;
+	else if (p_name == "lfHeight") m_lfHeight = p_value;
+	else if (p_name == "uLegHeight") m_uLegHeight = p_value;
+	else if (p_name == "lLegHeight") m_lLegHeight = p_value;
+	else if (p_name == "footHeight") m_footHeight = p_value;
+	else if (p_name == "footLen") m_footLen = p_value;
+	else if (p_name == "quadrupedLLegHeight") m_quadrupedLLegHeight = p_value;
+	else if (p_name == "quadrupedFootLen") m_quadrupedFootLen = p_value;
+	else if (p_name == "lfDist") m_lfDist = p_value;
+	else if (p_name == "spineParts") m_spineParts = (int)p_value;
+	else return false;
+	return true;
+}
+
+CharacterFactory::CharacterFactory(artemis::EntityManager* p_entityManager, Toolbar* p_toolBar/* = NULL*/)
+{
+	m_entityManager = p_entityManager;
+	m_toolBar = p_toolBar;
+	m_lockPos = true;
+	m_lockLFY = false;
+}
+
+void CharacterFactory::setLockPos(bool p_lockPos, bool p_lockLFY)
+{
+	m_lockPos = p_lockPos;
+	m_lockLFY = p_lockLFY;
+}
+
+CharacterFactory::Dimensions& CharacterFactory::getDimensions()
+{
+	return m_dimensions;
+}
+
+float CharacterFactory::getStartHeight(bool p_quadruped) const
+{
+	float lLegHeight = p_quadruped ? m_dimensions.m_quadrupedLLegHeight : m_dimensions.m_lLegHeight;
+	return m_dimensions.m_lfHeight*0.5f + m_dimensions.m_uLegHeight + lLegHeight + m_dimensions.m_footHeight;
+}
+
+CharacterFactory::Character CharacterFactory::createBiped(int p_idx, float p_charOffsetX, bool p_render)
+{
+	return createBipedAt(p_idx, glm::vec3(p_idx*p_charOffsetX, 0.0f, 0.0f), p_render);
+}
+
+CharacterFactory::Character CharacterFactory::createQuadruped(int p_idx, float p_charOffsetX, bool p_render)
+{
+	return createQuadrupedAt(p_idx, glm::vec3(p_idx*p_charOffsetX, 0.0f, 0.0f), p_render);
+}
+
+bool CharacterFactory::createCrowd(const CrowdScenario& p_scenario, bool p_render, std::vector<Character>& p_outCharacters)
+{
+	// Everything shared is set up per template first, so spawning is only the entities
+	const std::vector<CrowdScenario::Template>& templates = p_scenario.getTemplates();
+	std::vector<Dimensions> dimensions(templates.size(), m_dimensions);
+	std::vector<std::vector<float> > gaits(templates.size());
+	ParamSchema layouts[2];
+	ControllerComponent::describeLayout(false, layouts[CrowdScenario::BIPED]);
+	ControllerComponent::describeLayout(true, layouts[CrowdScenario::QUADRUPED]);
+	for (unsigned int i = 0; i < templates.size(); i++)
+	{
+		const CrowdScenario::Template& characterTemplate = templates[i];
+		for (unsigned int n = 0; n < characterTemplate.m_dimensions.size(); n++)
+		{
+			if (!dimensions[i].set(characterTemplate.m_dimensions[n].first, characterTemplate.m_dimensions[n].second))
+			{
+				DEBUGPRINT(((characterTemplate.m_name + ": unknown dimension " + characterTemplate.m_dimensions[n].first + "\n").c_str()));
+				return false;
+			}
+		}
+		const ParamSchema& layout = layouts[characterTemplate.m_pod];
+		if (characterTemplate.m_gaitFile != "" && !GaitFile::load("../output/sav/" + characterTemplate.m_gaitFile, &gaits[i],
+			characterTemplate.m_pod == CrowdScenario::BIPED ? GaitFile::BIPED : GaitFile::QUADRUPED,
+			layout.getSize(), layout.getLayoutHash()))
+		{
+			DEBUGPRINT(((characterTemplate.m_name + ": could not load gait " + characterTemplate.m_gaitFile + "\n").c_str()));
+			return false;
+		}
+	}
+
+	Dimensions defaultDimensions = m_dimensions;
+	const std::vector<CrowdScenario::Instance>& instances = p_scenario.getInstances();
+	p_outCharacters.reserve(p_outCharacters.size() + instances.size());
+	for (unsigned int i = 0; i < instances.size(); i++)
+	{
+		const CrowdScenario::Instance& instance = instances[i];
+		m_dimensions = dimensions[instance.m_template];
+		Character character = templates[instance.m_template].m_pod == CrowdScenario::QUADRUPED ?
+			createQuadrupedAt((int)i, instance.m_position, p_render) : createBipedAt((int)i, instance.m_position, p_render);
+		if (!gaits[instance.m_template].empty())
+			character.m_controller->setInitParams(gaits[instance.m_template]);
+		character.m_controller->m_goalVelocity = instance.m_goalVelocity;
+		p_outCharacters.push_back(character);
+	}
+	m_dimensions = defaultDimensions;
+	return true;
+}
+
+CharacterFactory::Character CharacterFactory::createQuadrupedAt(int p_idx, const glm::vec3& p_offset, bool p_render)
+{
+	Character res;
+	float scale = m_dimensions.m_scale;
+	float hipCoronalOffset = m_dimensions.m_hipCoronalOffset;
+	glm::vec3 bodOffset = m_dimensions.m_bodyOffset;
+	float lfHeight = m_dimensions.m_lfHeight;
+	float uLegHeight = m_dimensions.m_uLegHeight;
+	float lLegHeight = m_dimensions.m_quadrupedLLegHeight;
+	float footHeight = m_dimensions.m_footHeight;
+	float footLen = m_dimensions.m_quadrupedFootLen;
+	float lfDist = m_dimensions.m_lfDist;
+	int spineParts = m_dimensions.m_spineParts;
+	float charPosY = getStartHeight(true);
+	bool lockPos = m_lockPos;
+	bool lockLFY_onRestart = m_lockLFY;
+
+	vector<artemis::Entity*> charLFs;
+	vector<artemis::Entity*> hipJoints;
+
+	int legFrames = 2;
+	artemis::Entity* prevlegFrame = NULL;
+	for (int y = 0; y < legFrames; y++) // number of leg frames
+	{
+		artemis::Entity& legFrame = m_entityManager->create();
+		glm::vec3 pos = bodOffset + glm::vec3(/*x*charOffsetX*/0.0f, charPosY, (float)-y*lfDist);
+
+		// if locked, we move down a tiny bit to get traction
+		//if (lockLFY_onRestart) pos.y -= 0.5f*footHeight;
+
+		//(float(i) - 50, 10.0f+float(i)*4.0f, float(i)*0.2f-50.0f);
+		glm::vec3 lfSize = glm::vec3(hipCoronalOffset*2.0f, lfHeight, (float)(2 - y)*hipCoronalOffset);
+		float characterMass = /*scale**/10.0f;
+		RigidBodyComponent* lfRB = new RigidBodyComponent(new btBoxShape(btVector3(lfSize.x, lfSize.y, lfSize.z)*0.5f), characterMass,
+			CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT);
+		legFrame.addComponent(lfRB);
+		if (p_render || p_idx == 0) legFrame.addComponent(new RenderComponent());
+		MaterialComponent* matlf = new MaterialComponent(dawnBringerPalRGB[(p_idx * 2) % 31]);
+		legFrame.addComponent(matlf);
+		TransformComponent* tc = new TransformComponent(pos,
+			glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+			lfSize);
+		tc->setPositionOffset(p_offset);
+		legFrame.addComponent(tc);
+
+		if (lockPos)
+		{
+			float lck = lockLFY_onRestart ? 0.0f : 1.0f;
+			lfRB->setLinearFactor(glm::vec3(lck, 1, 1));
+			lfRB->setAngularFactor(glm::vec3(1, lck, lck));
+		}
+
+
+		//legFrame.addComponent(new ConstantForceComponent(glm::vec3(0, characterMass*12.0f, 0)));
+		legFrame.refresh();
+		string legFrameName = "LegFrame";
+		/*m_toolBar->addLabel(Toolbar::CHARACTER, legFrameName.c_str(), (" label='" + legFrameName + "'").c_str());*/
+		if (p_idx == 0 && m_toolBar) m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + legFrameName + "'").c_str());
+		//
+		// Number of leg frames per character
+		for (int n = 0; n < 2; n++) // number of legs per frame
+		{
+			string sideName = ToString(y) + (string(n == 0 ? "Left" : "Right") + "Leg");
+			if (p_idx == 0 && m_toolBar)
+			{
+				m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + sideName + "' ").c_str());
+				m_toolBar->defineBarParams(Toolbar::CHARACTER, ("/" + sideName + " opened=false").c_str());
+			}
+			//m_toolBar->addLabel(Toolbar::CHARACTER, sideName.c_str(),"");
+			artemis::Entity* prev = &legFrame;
+			artemis::Entity* upperLegSegment = NULL;
+			float currentHipJointCoronalOffset = (float)(n * 2 - 1)*hipCoronalOffset;
+			glm::vec3 legpos = pos + glm::vec3(currentHipJointCoronalOffset, 0.0f, 0.0f);
+			glm::vec3 boxSize = glm::vec3(0.25f, uLegHeight, 0.25f);
+			glm::vec3 parentSz = glm::vec3(boxSize.x, lfHeight, boxSize.z);
+			for (int i = 0; i < 3; i++) // number of segments per leg
+			{
+				artemis::Entity & childJoint = m_entityManager->create();
+				float jointXOffsetFromParent = 0.0f; // for coronal displacement for hip joints
+				float jointYOffsetInChild = 0.0f; // for sagittal displacement for feet
+				float jointZOffsetInChild = 0.0f; // for sagittal displacment for feet
+				if (i != 0) parentSz = boxSize;//glm::vec3(boxSize.x, uLegHeight, boxSize.z);
+				//boxSize = glm::vec3(0.25f, uLegHeight, 0.25f); // set new size for current box
+				// segment specific constraint params
+				glm::vec3 lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.5f);
+				glm::vec3 upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.5f);
+				string partName;
+				float segmentMass = 5.0f;
+				bool foot = false;
+				float thisFootHeight = footHeight;
+				float thisFootLen = footLen;
+				/*if (y == 0) // digitigrade front feet
+					thisFootHeight = footHeight * 4;*/
+				if (i == 0) // if hip joint (upper leg)
+				{
+					partName = " upper";
+					upperLegSegment = &childJoint;
+					jointXOffsetFromParent = currentHipJointCoronalOffset;
+					//lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.0f);
+					//upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.0f);
+					lowerAngleLim = glm::vec3(-HALFPI*0.2f, -HALFPI*0.5f*0.0f, -HALFPI*0.1f*0.0f);
+					upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f*0.0f, HALFPI*0.1f*0.0f);
+					segmentMass = /*scale**/5.0f;
+					float height = uLegHeight;
+					/*if (y == 0) // front legs
+						height = height*0.8f;*/
+					boxSize = glm::vec3(scale*0.1f, height, scale*0.1f);
+					if (n == 0) res.m_uLegLens.push_back(height);
+					//lowerAngleLim = glm::vec3(1, 1, 1);
+					//upperAngleLim = glm::vec3(0,0,0);
+				}
+				else if (i == 1) // if knee (lower leg)
+				{
+					partName = " lower";
+					if (y == 0) // front legs have "flipped" knees, for digitigrade anatomy
+					{
+						lowerAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+						upperAngleLim = glm::vec3(PI*0.5f, 0.0f, 0.0f);
+					}
+					else
+					{
+						lowerAngleLim = glm::vec3(-PI*0.7f/*-HALFPI*/, 0.0f, 0.0f);
+						upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+					}
+					segmentMass = /*scale**/4.0f;
+					float kneeheight = lLegHeight;
+					/*if (y == 0) // front legs
+						height = height*0.8f;*/
+					boxSize = glm::vec3(scale*0.1f, lLegHeight, scale*0.1f);
+					if (n == 0)
+					{
+						res.m_lLegLens.push_back(kneeheight + thisFootHeight);
+						res.m_kneeFlip.push_back(y == 1 ? 1 : -1);
+					}
+				}
+				else if (i == 2) // if foot
+				{
+					partName = " foot";
+					//boxSize = glm::vec3(scale*0.08f, footHeight, scale*0.2f);
+					if (y == 0) // digitigrade front feet
+					{
+						lowerAngleLim = glm::vec3(HALFPI*0.3f, 0.0f, 0.0f);
+						upperAngleLim = glm::vec3(HALFPI*1.01f, 0.0f, 0.0f);
+						thisFootLen = 1.5f*footLen;
+						//thisFootLen = footLen*0.5f;
+					}
+					else // digitigrade back feet
+					{
+						thisFootLen = 1.5f*footLen;
+						lowerAngleLim = glm::vec3(HALFPI, 0.0f, 0.0f);
+						upperAngleLim = glm::vec3(HALFPI*1.2f, 0.0f, 0.0f);
+						//lowerAngleLim = glm::vec3(HALFPI*0.5f, -HALFPI*0.1f*0.0f, -HALFPI*0.1f);
+						//upperAngleLim = glm::vec3(HALFPI*1.2f, HALFPI*0.1f*0.0f, HALFPI*0.1f);
+					}
+					jointYOffsetInChild = thisFootLen*0.2f;
+					//jointYOffsetInChild = footLen*0.5f;
+					jointZOffsetInChild = -thisFootHeight*0.5f;
+					//lowerAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+					//upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+					//lowerAngleLim = glm::vec3(HALFPI*0.6f, -HALFPI*0.1f, -HALFPI*0.1f);
+					//upperAngleLim = glm::vec3(HALFPI*1.8f, HALFPI*0.1f, HALFPI*0.1f);
+					segmentMass = /*scale**/1.0f;
+					foot = true;
+					boxSize = glm::vec3(scale*0.2f, thisFootLen, thisFootHeight);
+				}
+				string dbgGrp = (" group='" + sideName + "'");
+				if (p_idx == 0 && m_toolBar) m_toolBar->addLabel(Toolbar::CHARACTER, (ToString(p_idx) + sideName.substr(0, 2) + partName).c_str(), dbgGrp.c_str());
+				legpos += glm::vec3(glm::vec3(0.0f, -parentSz.y*0.5f - boxSize.y*0.5f, 0.0f/*jointZOffsetInChild*/));
+				if (foot == true)
+				{
+					// foot need collision callback properties
+					childJoint.addComponent(new RigidBodyComponent(RigidBodyComponent::REGISTER_COLLISIONS,
+						new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
+						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
+				}
+				else
+				{
+					// ordinary joint does not need collision callback
+					childJoint.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
+						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
+				}
+				if (p_render || p_idx == 0) childJoint.addComponent(new RenderComponent());
+				if (i != 2)
+				{			
+					tc = new TransformComponent(legpos,
+						glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+						boxSize);// note scale, so full lengths
+					tc->setPositionOffset(p_offset);
+					childJoint.addComponent(tc);
+				}
+				else // foot
+				{
+					// TODO! digitigrade feet
+					//if (y == 0)// digitigrade front feet
+					//{
+					//	glm::quat rot = glm::quat(glm::vec3(-HALFPI, 0.0f, 0.0f));
+					//	childJoint.addComponent(new TransformComponent(legpos + glm::vec3(0.0f, footLen*0.5f + jointZOffsetInChild, footLen*0.5f - jointYOffsetInChild),
+					//		rot,
+					//		boxSize));					// note scale, so full lengths
+					//}
+					//else// digitigrade back feet
+					{
+						glm::quat rot = glm::quat(glm::vec3(-HALFPI, 0.0f, 0.0f));
+						// feet fly up for quadrupeds, optimize this for more correct: glm::vec3(0.0f, footLen*0.5f + jointZOffsetInChild, boxSize.y*0.5f - jointYOffsetInChild),
+
+						tc = new TransformComponent(legpos + glm::vec3(0.0f, thisFootLen*0.5f + jointZOffsetInChild, thisFootLen*0.5f - jointYOffsetInChild),
+							rot,
+							boxSize);					// note scale, so full lengths
+						tc->setPositionOffset(p_offset);
+						childJoint.addComponent(tc);
+					}
+				}
+				MaterialComponent* mat = new MaterialComponent(colarr[(y + n) * 3 + i]);
+				childJoint.addComponent(mat);
+				if (p_idx == 0 && m_toolBar) m_toolBar->addReadWriteVariable(Toolbar::CHARACTER, (sideName.substr(0, 2) + ToString(partName[1]) + " Color").c_str(), Toolbar::COL_RGBA, (void*)&mat->getColorRGBA(), dbgGrp.c_str());
+				ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, boxSize.y*0.5f - jointYOffsetInChild, -jointZOffsetInChild),	  // child (this)
+					glm::vec3(jointXOffsetFromParent, -parentSz.y*0.5f, 0.0f),													  // parent
+					{ lowerAngleLim, upperAngleLim },
+					false };
+				childJoint.addComponent(new ConstraintComponent(prev, constraintDesc));
+				childJoint.refresh();
+				prev = &childJoint;
+			}
+			hipJoints.push_back(upperLegSegment);
+		}
+		charLFs.push_back(&legFrame);
+		prevlegFrame = &legFrame;
+	} // leg frames
+	//
+	glm::vec3 pos = bodOffset + glm::vec3(/*x*charOffsetX*/0.0f, charPosY, -hipCoronalOffset*0.5f);
+	artemis::Entity* prev = charLFs[0]; // the first parent is the first leg frame
+	// The length of a spine (the height of its rotated segment) is the same as=
+	// The distance between the LFs minus the h-length of a LFs, times two; divided 
+	// by number of wanted spines:
+	float boxHeight = (lfDist - (hipCoronalOffset*0.5f * 2)) / (float)spineParts;
+	float spineHeight = lfHeight*0.75f;
+	glm::vec3 boxSize = glm::vec3(hipCoronalOffset, boxHeight, spineHeight); // note, we rotate it
+	glm::vec3 spinepos = pos + glm::vec3(0.0f, (lfHeight - spineHeight)*0.5f, -boxHeight*0.5f);
+	// first spine joint is child to leg frame
+	glm::vec3 parentSz = glm::vec3(boxSize.x, lfHeight, hipCoronalOffset);
+	float jointYOffsetInParent = lfHeight*0.5f; // for sagittal displacement
+	float jointZOffsetInParent = -parentSz.z*0.5f; // for sagittal displacment
+	glm::vec3 lowerAngleLim = glm::vec3(-HALFPI*0.1f, -HALFPI*0.1f, -HALFPI*0.1f);
+	glm::vec3 upperAngleLim = glm::vec3(HALFPI*0.1f, HALFPI*0.1f, HALFPI*0.1f);
+	glm::vec3 lowerAngleLimBase = glm::vec3(-HALFPI, 0, 0);
+	glm::vec3 upperAngleLimBase = glm::vec3(-HALFPI, 0, 0);
+	std::vector<artemis::Entity*> spines;
+	for (int s = 0; s < spineParts; s++)
+	{
+		// Create the spine
+		// ----------------------------
+		// SPINE
+		// ----------------------------
+		artemis::Entity & spineJoint = m_entityManager->create();
+		if (s != 0) parentSz = boxSize;//glm::vec3(boxSize.x, uLegHeight, boxSize.z);
+		float segmentMass = 1.0f;
+
+		if (s > 0)
+		{
+			// as the non-root spines are children to the root spine, which is rotated,
+			// we're working from another coordinate system for joint offsets and angle limits:
+			spinepos += glm::vec3(glm::vec3(0.0f, 0.0f, -boxHeight));
+			lowerAngleLimBase = glm::vec3(0.0f, 0, 0);
+			upperAngleLimBase = glm::vec3(0.0f, 0, 0);
+			jointYOffsetInParent = -parentSz.y*0.5f; // for sagittal displacement
+			jointZOffsetInParent = -spineHeight*0.5f; // for sagittal displacment
+		}
+
+		// no need collision callback
+		spineJoint.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
+			CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
+
+		if (p_render || p_idx == 0) spineJoint.addComponent(new RenderComponent());
+
+
+		TransformComponent* tc = new TransformComponent(spinepos,
+			glm::quat(glm::vec3(HALFPI, 0.0f, 0.0f)),
+			boxSize);
+		tc->setPositionOffset(p_offset);
+		spineJoint.addComponent(tc);
+
+		MaterialComponent* mat = new MaterialComponent(colarr[s + 3]);
+		spineJoint.addComponent(mat);
+
+		ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, boxSize.y*0.5f, -spineHeight*0.5f),	  // child (this)
+			glm::vec3(0.0f, jointYOffsetInParent, jointZOffsetInParent),							  // parent
+			{ lowerAngleLimBase + lowerAngleLim, upperAngleLimBase + upperAngleLim },
+			false };
+		spineJoint.addComponent(new ConstraintComponent(prev, constraintDesc));
+		spineJoint.refresh();
+		spines.push_back(&spineJoint);
+		prev = &spineJoint;
+	}
+	// finish by constraint the back LF to the last spine
+	// the back LF become the child of the last spine joint
+	jointYOffsetInParent = -boxSize.y*0.5f; // for sagittal displacement
+	jointZOffsetInParent = -spineHeight*0.5f; // for sagittal displacment
+	lowerAngleLim = glm::vec3(HALFPI, 0, 0);
+	upperAngleLim = glm::vec3(HALFPI, 0, 0);
+	ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, lfHeight*0.5f, hipCoronalOffset*0.5f),	  // child (this) ie. the LF
+		glm::vec3(0.0f, jointYOffsetInParent, jointZOffsetInParent),							 // parent ie. the last spine joint
+		{ lowerAngleLim, upperAngleLim },
+		false };
+	// parent to the last leg frame that was added
+	prevlegFrame->addComponent(new ConstraintComponent(prev, constraintDesc));
+	prevlegFrame->refresh();
+
+	// Controller
+	artemis::Entity & controller = m_entityManager->create();
+	ControllerComponent* controllerComp = new ControllerComponent(charLFs, hipJoints, &spines);
+	controller.addComponent(controllerComp);
+	res.m_controllerEntity = &controller;
+	res.m_controller = controllerComp;
+	return res;
+}
+
+CharacterFactory::Character CharacterFactory::createBipedAt(int p_idx, const glm::vec3& p_offset, bool p_render)
+{
+	Character res;
+	float scale = m_dimensions.m_scale;
+	float hipCoronalOffset = m_dimensions.m_hipCoronalOffset;
+	glm::vec3 bodOffset = m_dimensions.m_bodyOffset;
+	float lfHeight = m_dimensions.m_lfHeight;
+	float uLegHeight = m_dimensions.m_uLegHeight;
+	float lLegHeight = m_dimensions.m_lLegHeight;
+	float footHeight = m_dimensions.m_footHeight;
+	float footLen = m_dimensions.m_footLen;
+	float charPosY = getStartHeight(false);
+	bool lockPos = m_lockPos;
+	bool lockLFY_onRestart = m_lockLFY;
+
+	vector<artemis::Entity*> charLFs;
+	vector<artemis::Entity*> hipJoints;
+
+	for (int y = 0; y < 1; y++) // number of leg frames
+	{
+		artemis::Entity& legFrame = m_entityManager->create();
+		glm::vec3 pos = bodOffset + glm::vec3(/*x*charOffsetX*/0.0f, charPosY, (float)-y);
+
+		// if locked, we move down a tiny bit to get traction
+		//if (lockLFY_onRestart) pos.y -= 0.5f*footHeight;
+
+		//(float(i) - 50, 10.0f+float(i)*4.0f, float(i)*0.2f-50.0f);
+		glm::vec3 lfSize = glm::vec3(hipCoronalOffset*2.0f, lfHeight, hipCoronalOffset);
+		float characterMass = /*scale**/10.0f;
+		RigidBodyComponent* lfRB = new RigidBodyComponent(new btBoxShape(btVector3(lfSize.x, lfSize.y, lfSize.z)*0.5f), characterMass,
+			CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT);
+		legFrame.addComponent(lfRB);
+		if (p_render || p_idx == 0) legFrame.addComponent(new RenderComponent());
+		MaterialComponent* matlf = new MaterialComponent(dawnBringerPalRGB[(p_idx * 2) % 31]);
+		legFrame.addComponent(matlf);
+		TransformComponent* tc = new TransformComponent(pos,
+			glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+			lfSize);
+		tc->setPositionOffset(p_offset);
+		legFrame.addComponent(tc);
+
+		if (lockPos)
+		{
+			float lck = lockLFY_onRestart ? 0.0f : 1.0f;
+			lfRB->setLinearFactor(glm::vec3(lck, 1, 1));
+			lfRB->setAngularFactor(glm::vec3(1, lck, lck));
+		}
+
+
+		//legFrame.addComponent(new ConstantForceComponent(glm::vec3(0, characterMass*12.0f, 0)));
+		legFrame.refresh();
+		string legFrameName = "LegFrame";
+		/*m_toolBar->addLabel(Toolbar::CHARACTER, legFrameName.c_str(), (" label='" + legFrameName + "'").c_str());*/
+		if (p_idx == 0 && m_toolBar) m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + legFrameName + "'").c_str());
+		//
+		// Number of leg frames per character
+		for (int n = 0; n < 2; n++) // number of legs per frame
+		{
+			string sideName = (string(n == 0 ? "Left" : "Right") + "Leg");
+			if (p_idx == 0 && m_toolBar)
+			{
+				m_toolBar->addSeparator(Toolbar::CHARACTER, NULL, (" group='" + sideName + "' ").c_str());
+				m_toolBar->defineBarParams(Toolbar::CHARACTER, ("/" + sideName + " opened=false").c_str());
+			}
+			//m_toolBar->addLabel(Toolbar::CHARACTER, sideName.c_str(),"");
+			artemis::Entity* prev = &legFrame;
+			artemis::Entity* upperLegSegment = NULL;
+			float currentHipJointCoronalOffset = (float)(n * 2 - 1)*hipCoronalOffset;
+			glm::vec3 legpos = pos + glm::vec3(currentHipJointCoronalOffset, 0.0f, 0.0f);
+			glm::vec3 boxSize = glm::vec3(0.25f, uLegHeight, 0.25f);
+			glm::vec3 parentSz = glm::vec3(boxSize.x, lfHeight, boxSize.z);
+			for (int i = 0; i < 3; i++) // number of segments per leg
+			{
+				artemis::Entity & childJoint = m_entityManager->create();
+				float jointXOffsetFromParent = 0.0f; // for coronal displacement for hip joints
+				float jointYOffsetInChild = 0.0f; // for sagittal displacement for feet
+				float jointZOffsetInChild = 0.0f; // for sagittal displacment for feet
+				if (i != 0) parentSz = boxSize;//glm::vec3(boxSize.x, uLegHeight, boxSize.z);
+				//boxSize = glm::vec3(0.25f, uLegHeight, 0.25f); // set new size for current box
+				// segment specific constraint params
+				glm::vec3 lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.5f);
+				glm::vec3 upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.5f);
+				string partName;
+				float segmentMass = 5.0f;
+				bool foot = false;
+				if (i == 0) // if hip joint (upper leg)
+				{
+					partName = " upper";
+					upperLegSegment = &childJoint;
+					jointXOffsetFromParent = currentHipJointCoronalOffset;
+					//lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f, -HALFPI*0.0f);
+					//upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f, HALFPI*0.0f);
+					lowerAngleLim = glm::vec3(-HALFPI, -HALFPI*0.5f*0.0f, -HALFPI*0.1f*0.0f);
+					upperAngleLim = glm::vec3(HALFPI, HALFPI*0.5f*0.0f, HALFPI*0.1f*0.0f);
+					segmentMass = /*scale**/5.0f;
+					boxSize = glm::vec3(scale*0.1f, uLegHeight, scale*0.1f);
+					if (n == 0) res.m_uLegLens.push_back(uLegHeight);
+					//lowerAngleLim = glm::vec3(1, 1, 1);
+					//upperAngleLim = glm::vec3(0,0,0);
+				}
+				else if (i == 1) // if knee (lower leg)
+				{
+					partName = " lower";
+					lowerAngleLim = glm::vec3(-PI*0.7f/*-HALFPI*/, 0.0f, 0.0f);
+					upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+					segmentMass = /*scale**/4.0f;
+					boxSize = glm::vec3(scale*0.1f, lLegHeight, scale*0.1f);
+					if (n == 0)
+					{
+						res.m_lLegLens.push_back(lLegHeight + footHeight);
+						res.m_kneeFlip.push_back(1);
+					}
+				}
+				else if (i == 2) // if foot
+				{
+					partName = " foot";
+					//boxSize = glm::vec3(scale*0.08f, footHeight, scale*0.2f);
+					boxSize = glm::vec3(scale*0.2f, footLen, footHeight);
+					jointYOffsetInChild = footLen*0.2f;
+					jointZOffsetInChild = 0.0f*-footHeight*0.5f;
+					//jointZOffsetInChild = (boxSize.z - parentSz.z)*0.5f;
+					lowerAngleLim = glm::vec3(HALFPI*0.8f, -HALFPI*0.1f*0.0f, -HALFPI*0.1f);
+					upperAngleLim = glm::vec3(HALFPI*1.2f, HALFPI*0.1f*0.0f, HALFPI*0.1f);
+					//lowerAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+					//upperAngleLim = glm::vec3(0.0f, 0.0f, 0.0f);
+					//lowerAngleLim = glm::vec3(HALFPI*0.6f, -HALFPI*0.1f, -HALFPI*0.1f);
+					//upperAngleLim = glm::vec3(HALFPI*1.8f, HALFPI*0.1f, HALFPI*0.1f);
+					segmentMass = /*scale**/1.0f;
+					foot = true;
+				}
+				string dbgGrp = (" group='" + sideName + "'");
+				if (p_idx == 0 && m_toolBar) m_toolBar->addLabel(Toolbar::CHARACTER, (ToString(p_idx) + sideName[0] + partName).c_str(), dbgGrp.c_str());
+				legpos += glm::vec3(glm::vec3(0.0f, -parentSz.y*0.5f - boxSize.y*0.5f, 0.0f/*jointZOffsetInChild*/));
+				if (foot == true)
+				{
+					// foot need collision callback properties
+					childJoint.addComponent(new RigidBodyComponent(RigidBodyComponent::REGISTER_COLLISIONS,
+						new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
+						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
+				}
+				else
+				{
+					// ordinary joint does not need collision callback
+					childJoint.addComponent(new RigidBodyComponent(new btBoxShape(btVector3(boxSize.x, boxSize.y, boxSize.z)*0.5f), segmentMass, // note, h-lengths
+						CollisionLayer::COL_CHARACTER, CollisionLayer::COL_GROUND | CollisionLayer::COL_DEFAULT));
+				}
+				if (p_render || p_idx == 0) childJoint.addComponent(new RenderComponent());
+				if (i != 2)
+				{
+					tc = new TransformComponent(legpos,
+						glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+						boxSize);// note scale, so full lengths
+					tc->setPositionOffset(p_offset);
+					childJoint.addComponent(tc);
+				}
+				else // foot
+				{
+					glm::quat rot = glm::quat(glm::vec3(-HALFPI, 0.0f, 0.0f));
+					tc = new TransformComponent(legpos + glm::vec3(0.0f, footLen*0.5f + jointZOffsetInChild, footLen*0.5f - jointYOffsetInChild),
+						rot,
+						boxSize);					// note scale, so full lengths
+					tc->setPositionOffset(p_offset);
+					childJoint.addComponent(tc);
+				}
+				MaterialComponent* mat = new MaterialComponent(colarr[n * 3 + i]);
+				childJoint.addComponent(mat);
+				if (p_idx == 0 && m_toolBar) m_toolBar->addReadWriteVariable(Toolbar::CHARACTER, (ToString(p_idx) + sideName[1] + ToString(partName[1]) + " Color").c_str(), Toolbar::COL_RGBA, (void*)&mat->getColorRGBA(), dbgGrp.c_str());
+				ConstraintComponent::ConstraintDesc constraintDesc{ glm::vec3(0.0f, boxSize.y*0.5f - jointYOffsetInChild, -jointZOffsetInChild),	  // child (this)
+					glm::vec3(jointXOffsetFromParent, -parentSz.y*0.5f, 0.0f),													  // parent
+					{ lowerAngleLim, upperAngleLim },
+					false };
+				childJoint.addComponent(new ConstraintComponent(prev, constraintDesc));
+				childJoint.refresh();
+				prev = &childJoint;
+			}
+			hipJoints.push_back(upperLegSegment);
+		}
+		charLFs.push_back(&legFrame);
+	} // leg frames
+	// Controller
+	artemis::Entity & controller = m_entityManager->create();
+	ControllerComponent* controllerComp = new ControllerComponent(charLFs, hipJoints);
+	controller.addComponent(controllerComp);
+	res.m_controllerEntity = &controller;
+	res.m_controller = controllerComp;
+	return res;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <Artemis.h>
+#include <vector>
+#include <string>
+#include <glm\gtc\type_ptr.hpp>
+
+class ControllerComponent;
+class Toolbar;
+class CrowdScenario;
+
+// =======================================================================================
+//                                      CharacterFactory
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Creates the entities for the biped and quadruped characters; leg frames,
+///			leg segments, spine and constraints, along with their controller.
+///			The controller entity is returned unrefreshed, so that the caller can
+///			add its own components (recorders, params) before refreshing it.
+///			Does not need a window, the toolbar and rendering are optional.
+///			Mixed crowds are spawned from a CrowdScenario with createCrowd.
+///
+/// # CharacterFactory
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class CharacterFactory
+{
+public:
+	// Body part sizes, the defaults are the ones the app has always used
+	struct Dimensions
+	{
+		Dimensions();
+		// By member name without m_, scale also scales the lengths derived from it.
+		// False for an unknown name.
+		bool set(const std::string& p_name, float p_value);
+		float m_scale;
+		float m_hipCoronalOffset; // coronal distance between hip joints and center
+		glm::vec3 m_bodyOffset;
+		float m_lfHeight;
+		float m_uLegHeight;
+		float m_lLegHeight;
+		float m_footHeight;
+		float m_footLen;
+		float m_quadrupedLLegHeight;
+		float m_quadrupedFootLen;
+		float m_lfDist; // sagittal distance between quadruped leg frames
+		int m_spineParts;
+	};
+
+	struct Character
+	{
+		artemis::Entity* m_controllerEntity; // not yet refreshed
+		ControllerComponent* m_controller;
+		// per leg frame, used by the optimization reference
+		std::vector<float> m_uLegLens, m_lLegLens;
+		std::vector<int> m_kneeFlip;
+	};
+
+	CharacterFactory(artemis::EntityManager* p_entityManager, Toolbar* p_toolBar = NULL);
+	virtual ~CharacterFactory() {}
+
+	void setLockPos(bool p_lockPos, bool p_lockLFY);
+	Dimensions& getDimensions();
+	// Height of the leg frame center when standing
+	float getStartHeight(bool p_quadruped) const;
+
+	// p_idx is the character index, used for the x-offset, colors and debug ui (index 0)
+	Character createBiped(int p_idx, float p_charOffsetX, bool p_render);
+	Character createQuadruped(int p_idx, float p_charOffsetX, bool p_render);
+	// At a position offset instead of in a row
+	Character createBipedAt(int p_idx, const glm::vec3& p_offset, bool p_render);
+	Character createQuadrupedAt(int p_idx, const glm::vec3& p_offset, bool p_render);
+	// Every instance of the scenario, in its order and unrefreshed, with its template's
+	// dimensions, gait and its goal velocity. A gait file is loaded once per template.
+	// False, with nothing created, if a gait file or a dimension name is bad.
+	bool createCrowd(const CrowdScenario& p_scenario, bool p_render, std::vector<Character>& p_outCharacters);
+private:
+	artemis::EntityManager* m_entityManager;
+	Toolbar* m_toolBar;
+	Dimensions m_dimensions;
+	bool m_lockPos;
+	bool m_lockLFY;
+};
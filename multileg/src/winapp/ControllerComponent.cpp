@@ -1,6 +1,7 @@
 #include "ControllerComponent.h"
 #include <OptimizableHelper.h>
 #include <DebugPrint.h>
+#include <ToString.h>
 
 unsigned int ControllerComponent::VFChain::s_maxJacobiRowsAll=0;
 
@@ -8,6 +9,7 @@ ControllerComponent::ControllerComponent(artemis::Entity* p_legFrame,
 	std::vector<artemis::Entity*>& p_hipJoints)
 {
 	m_enabled = true;
+	m_goalVelocity = glm::vec3(0.0f, 0.0f, 0.5f);
 	m_player = GaitPlayer(2.0f);
 	//
 	m_buildComplete = false;
@@ -29,6 +31,8 @@ ControllerComponent::ControllerComponent(artemis::Entity* p_legFrame,
 	// Allocate it according to number of leg entities that was inputted
 	LegFrame legFrame;
 	legFrame.m_stepCycles.resize(legFrameEntityConstruct.m_upperLegEntities.size());
+	legFrame.m_toeOffTime.resize(legFrame.m_stepCycles.size(), 0.0f);
+	legFrame.m_tuneFootStrikeTime.resize(legFrame.m_stepCycles.size(), 0.0f);
 	legFrame.m_stepCycles[1].m_tuneStepTrigger = 0.5f;
 	//legFrame.m_stepCycles[0].m_tuneDutyFactor=1.0f;
 	//legFrame.m_stepCycles[1].m_tuneDutyFactor=1.0f;
@@ -39,6 +43,7 @@ ControllerComponent::ControllerComponent(std::vector<artemis::Entity*>& p_legFra
 	std::vector<artemis::Entity*>& p_hipJoints, std::vector<artemis::Entity*>* p_spineJoints/*=NULL*/)
 {
 	m_enabled = true;
+	m_goalVelocity = glm::vec3(0.0f, 0.0f, 0.5f);
 	m_player = GaitPlayer(2.0f);
 	//
 	m_buildComplete = false;
@@ -71,6 +76,8 @@ ControllerComponent::ControllerComponent(std::vector<artemis::Entity*>& p_legFra
 		// Allocate it according to number of leg entities that was inputted
 		LegFrame legFrame;
 		legFrame.m_stepCycles.resize(legFrameEntityConstruct.m_upperLegEntities.size());
+		legFrame.m_toeOffTime.resize(legFrame.m_stepCycles.size(), 0.0f);
+		legFrame.m_tuneFootStrikeTime.resize(legFrame.m_stepCycles.size(), 0.0f);
 		legFrame.m_stepCycles[0].m_tuneStepTrigger = (i==0?0.0f:0.5f); // flip offset, on step trigger based on whether
 		legFrame.m_stepCycles[1].m_tuneStepTrigger = (i==0?0.5f:0.0f); // it is a front- or back LF
 		//legFrame.m_stepCycles[0].m_tuneDutyFactor=1.0f;
@@ -79,48 +86,64 @@ ControllerComponent::ControllerComponent(std::vector<artemis::Entity*>& p_legFra
 	}
 }
 
-std::vector<float> ControllerComponent::getParams()
+void ControllerComponent::writeParams(ParamCursor& p_cursor)
 {
-	//DEBUGPRINT(("\nCONTROLLER COMP GETPARAMS\n"));
-	std::vector<float> params;
-	OptimizableHelper::addRange(params,m_player.getParams());
+	m_player.writeParams(p_cursor);
 	for (int i = 0; i < m_legFrames.size(); i++)
 	{
-		OptimizableHelper::addRange(params,m_legFrames[i].getParams());
+		m_legFrames[i].writeParams(p_cursor);
 	}
-	return params;
 }
 
 
-void ControllerComponent::consumeParams(std::vector<float>& p_other)
+void ControllerComponent::readParams(ParamCursor& p_cursor)
 {
-	m_player.consumeParams(p_other);
+	m_player.readParams(p_cursor);
 	for (int i = 0; i < m_legFrames.size(); i++)
 	{
-		m_legFrames[i].consumeParams(p_other);
+		m_legFrames[i].readParams(p_cursor);
 	}
 }
-
-std::vector<float> ControllerComponent::getParamsMax()
-{
-	std::vector<float> paramsmax;
-	OptimizableHelper::addRange(paramsmax, m_player.getParamsMax());
+
+void ControllerComponent::writeParamsMax(ParamCursor& p_cursor)
+{
+	m_player.writeParamsMax(p_cursor);
 	for (int i = 0; i < m_legFrames.size(); i++)
 	{
-		OptimizableHelper::addRange(paramsmax, m_legFrames[i].getParamsMax());
-	}
-	return paramsmax;
-}
+		m_legFrames[i].writeParamsMax(p_cursor);
+	}
+}
+
+void ControllerComponent::writeParamsMin(ParamCursor& p_cursor)
+{
+	m_player.writeParamsMin(p_cursor);
+	for (int i = 0; i < m_legFrames.size(); i++)
+	{
+		m_legFrames[i].writeParamsMin(p_cursor);
+	}
+}
 
-std::vector<float> ControllerComponent::getParamsMin()
+void ControllerComponent::describeParams(ParamSchema& p_schema)
 {
-	std::vector<float> paramsmin;
-	OptimizableHelper::addRange(paramsmin, m_player.getParamsMin());
+	p_schema.pushScope("player");
+	m_player.describeParams(p_schema);
+	p_schema.popScope();
 	for (int i = 0; i < m_legFrames.size(); i++)
 	{
-		OptimizableHelper::addRange(paramsmin, m_legFrames[i].getParamsMin());
+		p_schema.pushScope("legFrame" + ToString(i));
+		m_legFrames[i].describeParams(p_schema);
+		p_schema.popScope();
 	}
-	return paramsmin;
+}
+
+bool ControllerComponent::describeLayout(bool p_quadruped, ParamSchema& p_outSchema)
+{
+	// The layout only depends on the leg frame and leg counts, so an unbuilt
+	// controller without entities describes the same layout as a built one
+	std::vector<artemis::Entity*> legFrames(p_quadruped ? 2 : 1, (artemis::Entity*)NULL);
+	std::vector<artemis::Entity*> hipJoints(legFrames.size() * 2, (artemis::Entity*)NULL);
+	ControllerComponent controller(legFrames, hipJoints);
+	return p_outSchema.build(&controller);
 }
 
 unsigned int ControllerComponent::getHeadJointId()
@@ -138,7 +161,8 @@ void ControllerComponent::handleInternalInitParamsConsume()
 	if (m_initConsumableParamList.size()>0)
 	{
 		DEBUGPRINT(("Init using internal params\n"));
-		consumeParams(m_initConsumableParamList);
+		if (!setParams(m_initConsumableParamList))
+			DEBUGPRINT(("Internal params do not match the parameter layout!\n"));
 		m_initConsumableParamList.clear();
 	}
 }
@@ -169,117 +193,138 @@ void ControllerComponent::LegFrame::createFootPlacementModelVarsForNewLeg(const
 	m_footIsColliding.push_back(false);
 }
 
-std::vector<float> ControllerComponent::LegFrame::getParams()
+void ControllerComponent::LegFrame::writeParams(ParamCursor& p_cursor)
 {
-	//DEBUGPRINT(("LEG FRAME GETPARAMS\n"));
-	std::vector<float> params;
 	// All per leg frame data
 	for (int i = 0; i < 3; i++)
-		OptimizableHelper::addRange(params,m_orientationLFTraj[i].getParams());	//
-	OptimizableHelper::addRange(params,m_heightLFTraj.getParams());			//
-	OptimizableHelper::addRange(params,m_footTrackingGainKp.getParams());	//
-	OptimizableHelper::addRange(params,m_stepHeighTraj.getParams());			//
-	OptimizableHelper::addRange(params,m_footTransitionEase.getParams());	//
-	/*OptimizableHelper::addRange(params,m_desiredLFTorquePD;		//*/
-	OptimizableHelper::addRange(params,m_FhPD.getParams());					// optimizable height force pd
-	/*OptimizableHelper::addRange(params,m_lateStrikeOffsetDeltaH);*/
-	params.push_back(m_velocityRegulatorKv);
-	OptimizableHelper::addRange(params,OptimizableHelper::ExtractParamsListFrom(m_FDHVComponents));
-	params.push_back(m_footPlacementVelocityScale);			// per leg frame
+		m_orientationLFTraj[i].writeParams(p_cursor);	//
+	m_heightLFTraj.writeParams(p_cursor);			//
+	m_footTrackingGainKp.writeParams(p_cursor);	//
+	m_stepHeighTraj.writeParams(p_cursor);			//
+	m_footTransitionEase.writeParams(p_cursor);	//
+	/*m_desiredLFTorquePD.writeParams(p_cursor);		//*/
+	m_FhPD.writeParams(p_cursor);					// optimizable height force pd
+	/*p_cursor.write(m_lateStrikeOffsetDeltaH);*/
+	p_cursor.write(m_velocityRegulatorKv);
+	OptimizableHelper::WriteParamsFrom(p_cursor, m_FDHVComponents);
+	p_cursor.write(m_footPlacementVelocityScale);			// per leg frame
 	/*float			 m_height;*/
-	OptimizableHelper::addRange(params,OptimizableHelper::ExtractParamsListFrom(m_stepLength));
-	params.push_back(m_tuneToeOffAngle);
-	params.push_back(m_tuneFootStrikeAngle);
+	OptimizableHelper::WriteParamsFrom(p_cursor, m_stepLength);
+	p_cursor.write(m_tuneToeOffAngle);
+	p_cursor.write(m_tuneFootStrikeAngle);
 	// All per leg data
-	for (int i = 0; i < m_legs.size(); i++)
+	for (int i = 0; i < m_stepCycles.size(); i++)
 	{
-		OptimizableHelper::addRange(params,m_stepCycles[i].getParams());
-		params.push_back(m_toeOffTime[i]);
-		params.push_back(m_tuneFootStrikeTime[i]);
+		m_stepCycles[i].writeParams(p_cursor);
+		p_cursor.write(m_toeOffTime[i]);
+		p_cursor.write(m_tuneFootStrikeTime[i]);
 	}
-	return params;
 }
 
-void ControllerComponent::LegFrame::consumeParams(std::vector<float>& p_other)
+void ControllerComponent::LegFrame::readParams(ParamCursor& p_cursor)
 {
 	for (int i = 0; i < 3; i++)
-		m_orientationLFTraj[i].consumeParams(p_other);	//
-	m_heightLFTraj.consumeParams(p_other);			//
-	m_footTrackingGainKp.consumeParams(p_other);	//
-	m_stepHeighTraj.consumeParams(p_other);			//
-	m_footTransitionEase.consumeParams(p_other);	//
-	m_FhPD.consumeParams(p_other);					// optimizable height force pd
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_velocityRegulatorKv);
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_FDHVComponents);
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_footPlacementVelocityScale);	
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_stepLength);
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_tuneToeOffAngle);
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_tuneFootStrikeAngle);
+		m_orientationLFTraj[i].readParams(p_cursor);	//
+	m_heightLFTraj.readParams(p_cursor);			//
+	m_footTrackingGainKp.readParams(p_cursor);	//
+	m_stepHeighTraj.readParams(p_cursor);			//
+	m_footTransitionEase.readParams(p_cursor);	//
+	m_FhPD.readParams(p_cursor);					// optimizable height force pd
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_velocityRegulatorKv);
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_FDHVComponents);
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_footPlacementVelocityScale);	
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_stepLength);
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_tuneToeOffAngle);
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_tuneFootStrikeAngle);
+	// All per leg data
+	for (int i = 0; i < m_stepCycles.size(); i++)
+	{
+		m_stepCycles[i].readParams(p_cursor);
+		OptimizableHelper::ConsumeParamsTo(p_cursor,&m_toeOffTime[i]);
+		OptimizableHelper::ConsumeParamsTo(p_cursor,&m_tuneFootStrikeTime[i]);
+	}
+}
+
+void ControllerComponent::LegFrame::describeParams(ParamSchema& p_schema)
+{
+	const char* orientationNames[3] = { "orientationTrajYaw", "orientationTrajPitch", "orientationTrajRoll" };
+	// All per leg frame data
+	for (int i = 0; i < 3; i++)
+	{
+		p_schema.pushScope(orientationNames[i]); m_orientationLFTraj[i].describeParams(p_schema); p_schema.popScope();
+	}
+	p_schema.pushScope("heightTraj");			m_heightLFTraj.describeParams(p_schema);		p_schema.popScope();
+	p_schema.pushScope("footTrackingGainKp");	m_footTrackingGainKp.describeParams(p_schema);	p_schema.popScope();
+	p_schema.pushScope("stepHeightTraj");		m_stepHeighTraj.describeParams(p_schema);		p_schema.popScope();
+	p_schema.pushScope("footTransitionEase");	m_footTransitionEase.describeParams(p_schema);	p_schema.popScope();
+	p_schema.pushScope("FhPD");					m_FhPD.describeParams(p_schema);				p_schema.popScope();
+	p_schema.add("velocityRegulatorKv");
+	p_schema.add("FDHVComponents", 4);
+	p_schema.add("footPlacementVelocityScale");
+	p_schema.add("stepLength", 2);
+	p_schema.add("toeOffAngle");
+	p_schema.add("footStrikeAngle");
 	// All per leg data
-	for (int i = 0; i < m_legs.size(); i++)
+	for (int i = 0; i < m_stepCycles.size(); i++)
 	{
-		m_stepCycles[i].consumeParams(p_other);
-		OptimizableHelper::ConsumeParamsTo(p_other,&m_toeOffTime[i]);
-		OptimizableHelper::ConsumeParamsTo(p_other,&m_tuneFootStrikeTime[i]);
+		p_schema.pushScope("leg" + ToString(i));
+		p_schema.pushScope("stepCycle"); m_stepCycles[i].describeParams(p_schema); p_schema.popScope();
+		p_schema.add("toeOffTime");
+		p_schema.add("footStrikeTime");
+		p_schema.popScope();
 	}
 }
 
-std::vector<float> ControllerComponent::LegFrame::getParamsMax()
+void ControllerComponent::LegFrame::writeParamsMax(ParamCursor& p_cursor)
 {
-	std::vector<float> paramsmax;
 	// All per leg frame data
 	for (int i = 0; i < 3; i++)
-	for (int x = 0; x < m_orientationLFTraj[i].getSize(); x++)
-		paramsmax.push_back(TWOPI);		// m_orientationLFTraj
-	for (int i = 0; i < m_heightLFTraj.getSize(); i++)			paramsmax.push_back(1.0f);		// heightLFTraj
-	for (int i = 0; i < m_footTrackingGainKp.getSize(); i++)	paramsmax.push_back(1.0f);		// footTrackingGainKp
-	for (int i = 0; i < m_stepHeighTraj.getSize(); i++)			paramsmax.push_back(1.5f);		// stepHeighTraj
-	for (int i = 0; i < m_footTransitionEase.getSize(); i++)	paramsmax.push_back(1.0f);		// footTransitionEase
-	/*OptimizableHelper::addRange(params,m_desiredLFTorquePD;		//*/
-	paramsmax.push_back(100.0f); paramsmax.push_back(10.0f); // FhPD (kp, kd), optimizable height force pd
-	/*paramsmax.push_back(m_lateStrikeOffsetDeltaH);*/
-	paramsmax.push_back(3.0f); // velocityRegulatorKv
-	for (int i=0;i<4;i++) paramsmax.push_back(2.0f);	// FDHVComponents;
-	paramsmax.push_back(2.0f);	// footPlacementVelocityScale
-	paramsmax.push_back(0.2f); paramsmax.push_back(3.3f);// step length
-	paramsmax.push_back(TWOPI); // toe off angle
-	paramsmax.push_back(TWOPI); // foot strike angle
+		OptimizableHelper::WriteParamsRepeated(p_cursor, TWOPI, m_orientationLFTraj[i].getSize());	// m_orientationLFTraj
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 1.0f, m_heightLFTraj.getSize());		// heightLFTraj
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 1.0f, m_footTrackingGainKp.getSize());	// footTrackingGainKp
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 1.5f, m_stepHeighTraj.getSize());		// stepHeighTraj
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 1.0f, m_footTransitionEase.getSize());	// footTransitionEase
+	/*m_desiredLFTorquePD		//*/
+	p_cursor.write(100.0f); p_cursor.write(10.0f); // FhPD (kp, kd), optimizable height force pd
+	/*p_cursor.write(m_lateStrikeOffsetDeltaH);*/
+	p_cursor.write(3.0f); // velocityRegulatorKv
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 2.0f, 4);	// FDHVComponents;
+	p_cursor.write(2.0f);	// footPlacementVelocityScale
+	p_cursor.write(0.2f); p_cursor.write(3.3f);// step length
+	p_cursor.write(TWOPI); // toe off angle
+	p_cursor.write(TWOPI); // foot strike angle
 	// All per leg data
-	for (int i = 0; i < m_legs.size(); i++)
+	for (int i = 0; i < m_stepCycles.size(); i++)
 	{
-		OptimizableHelper::addRange(paramsmax, m_stepCycles[i].getParamsMax());
-		paramsmax.push_back(0.5f); // toe off time
-		paramsmax.push_back(0.5f); // foot strike time
+		m_stepCycles[i].writeParamsMax(p_cursor);
+		p_cursor.write(0.5f); // toe off time
+		p_cursor.write(0.5f); // foot strike time
 	}
-	return paramsmax;
 }
 
-std::vector<float> ControllerComponent::LegFrame::getParamsMin()
+void ControllerComponent::LegFrame::writeParamsMin(ParamCursor& p_cursor)
 {
-	std::vector<float> paramsmin;
 	// All per leg frame data
 	for (int i = 0; i < 3; i++)
-		for (int x = 0; x < m_orientationLFTraj[i].getSize(); x++)
-			paramsmin.push_back(0.0f);		// m_orientationLFTraj
-	for (int i = 0; i < m_heightLFTraj.getSize(); i++)			paramsmin.push_back(0.0f);		// heightLFTraj
-	for (int i = 0; i < m_footTrackingGainKp.getSize(); i++)	paramsmin.push_back(0.0f);		// footTrackingGainKp
-	for (int i = 0; i < m_stepHeighTraj.getSize(); i++)			paramsmin.push_back(0.0f);		// stepHeighTraj
-	for (int i = 0; i < m_footTransitionEase.getSize(); i++)	paramsmin.push_back(0.0f);		// footTransitionEase
-	/*OptimizableHelper::addRange(params,m_desiredLFTorquePD;		//*/
-	paramsmin.push_back(0.0f); paramsmin.push_back(0.0f); // FhPD (kp, kd), optimizable height force pd
-	/*paramsmax.push_back(m_lateStrikeOffsetDeltaH);*/
-	paramsmin.push_back(0.0f); // velocityRegulatorKv
-	for (int i = 0; i<4; i++) paramsmin.push_back(-2.0f);	// FDHVComponents;
-	paramsmin.push_back(0.0f);	// footPlacementVelocityScale
-	paramsmin.push_back(0.0f); paramsmin.push_back(0.0f);// step length
-	paramsmin.push_back(0.0f); // toe off angle
-	paramsmin.push_back(0.0f); // foot strike angle
+		OptimizableHelper::WriteParamsRepeated(p_cursor, 0.0f, m_orientationLFTraj[i].getSize());	// m_orientationLFTraj
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 0.0f, m_heightLFTraj.getSize());		// heightLFTraj
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 0.0f, m_footTrackingGainKp.getSize());	// footTrackingGainKp
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 0.0f, m_stepHeighTraj.getSize());		// stepHeighTraj
+	OptimizableHelper::WriteParamsRepeated(p_cursor, 0.0f, m_footTransitionEase.getSize());	// footTransitionEase
+	/*m_desiredLFTorquePD		//*/
+	p_cursor.write(0.0f); p_cursor.write(0.0f); // FhPD (kp, kd), optimizable height force pd
+	/*p_cursor.write(m_lateStrikeOffsetDeltaH);*/
+	p_cursor.write(0.0f); // velocityRegulatorKv
+	OptimizableHelper::WriteParamsRepeated(p_cursor, -2.0f, 4);	// FDHVComponents;
+	p_cursor.write(0.0f);	// footPlacementVelocityScale
+	p_cursor.write(0.0f); p_cursor.write(0.0f);// step length
+	p_cursor.write(0.0f); // toe off angle
+	p_cursor.write(0.0f); // foot strike angle
 	// All per leg data
-	for (int i = 0; i < m_legs.size(); i++)
+	for (int i = 0; i < m_stepCycles.size(); i++)
 	{
-		OptimizableHelper::addRange(paramsmin, m_stepCycles[i].getParamsMin());
-		paramsmin.push_back(0.0f); // toe off time
-		paramsmin.push_back(0.0f); // foot strike time
+		m_stepCycles[i].writeParamsMin(p_cursor);
+		p_cursor.write(0.0f); // toe off time
+		p_cursor.write(0.0f); // foot strike time
 	}
-	return paramsmin;
 }
@@ -345,10 +345,11 @@ public:
 		void createFootPlacementModelVarsForNewLeg(const glm::vec3& p_startPos);
 
 		// Optimization
-		virtual std::vector<float> getParams();
-		virtual void consumeParams(std::vector<float>& p_other);
-		virtual std::vector<float> getParamsMax();
-		virtual std::vector<float> getParamsMin();
+		virtual void writeParams(ParamCursor& p_cursor);
+		virtual void readParams(ParamCursor& p_cursor);
+		virtual void writeParamsMax(ParamCursor& p_cursor);
+		virtual void writeParamsMin(ParamCursor& p_cursor);
+		virtual void describeParams(ParamSchema& p_schema);
 		glm::vec3 m_startPosOffset;
 	};
 
@@ -379,10 +380,13 @@ public:
 	void setTorqueListProperties(unsigned int p_offset, unsigned int p_size) { m_torqueListOffset = p_offset; m_torqueListChunkSize = p_size; }
 
 	// Optimization
-	virtual std::vector<float> getParams();
-	virtual void consumeParams(std::vector<float>& p_other);
-	virtual std::vector<float> getParamsMax();
-	virtual std::vector<float> getParamsMin();
+	virtual void writeParams(ParamCursor& p_cursor);
+	virtual void readParams(ParamCursor& p_cursor);
+	virtual void writeParamsMax(ParamCursor& p_cursor);
+	virtual void writeParamsMin(ParamCursor& p_cursor);
+	virtual void describeParams(ParamSchema& p_schema);
+	// Parameter layout of a biped or quadruped controller, available before any world is built
+	static bool describeLayout(bool p_quadruped, ParamSchema& p_outSchema);
 	unsigned int getHeadJointId();
 
 	// in run-time mode we can set a param list 
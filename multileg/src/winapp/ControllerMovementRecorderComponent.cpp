@@ -3,6 +3,7 @@
 #include "ControllerSystem.h"
 #include <assert.h>
 #include <ToString.h>
+#include <AsyncLog.h>
 
 
 ControllerMovementRecorderComponent::ControllerMovementRecorderComponent()
@@ -12,24 +13,47 @@ ControllerMovementRecorderComponent::ControllerMovementRecorderComponent()
 	m_fhWeight = 0.5f;	 // acceleration of head
 	m_frWeight = 5.0f;	 // whole body rotation
 	m_fpWeight = 0.0f;	 // movement distance
+	m_fpMovementDist = glm::vec3(0.0f);
+	m_temp_currentStrideVelocitySum = glm::vec3(0.0f);
+	m_temp_currentStrideDesiredVelocitySum = glm::vec3(0.0f);
+	m_temp_currentStrideSamples = 0;
 }
 
 
-double ControllerMovementRecorderComponent::evaluate( bool p_dbgPrint )
+double ControllerMovementRecorderComponent::evaluate( bool p_dbgPrint, EvaluationCache::Entry* p_outBreakdown/*=NULL*/ )
 {
-	double fv = evaluateFV();
-	double fr = evaluateFR();
-	double fh = evaluateFH();
-	double fp = evaluateFP();
-	double fd = evaluateFD();
+	EvaluationCache::Entry breakdown;
+	breakdown.m_fv = evaluateFV();
+	breakdown.m_fr = evaluateFR();
+	breakdown.m_fh = evaluateFH();
+	breakdown.m_fp = evaluateFP();
+	breakdown.m_fd = evaluateFD();
+	double fobj = score(breakdown, p_dbgPrint);
+	if (p_outBreakdown != NULL) *p_outBreakdown = breakdown;
+	return fobj;
+}
+
+double ControllerMovementRecorderComponent::score( EvaluationCache::Entry& p_breakdown, bool p_dbgPrint )
+{
+	double fv = p_breakdown.m_fv, fr = p_breakdown.m_fr, fh = p_breakdown.m_fh, 
+		fp = p_breakdown.m_fp, fd = p_breakdown.m_fd;
 	double fobj = (double)m_fdWeight*fd + (double)m_fvWeight*fv + (double)m_frWeight*fr + (double)m_fhWeight*fh - (double)m_fpWeight*fp;
 	if (p_dbgPrint)
 	{
 		DEBUGPRINT(((ToString(fobj) + " = fd" + ToString((double)m_fdWeight*fd) +" = fv" + ToString((double)m_fvWeight*fv) + " + fr" + ToString((double)m_frWeight*fr) + " + fh" + ToString((double)m_fhWeight*fh) + " - fp" + ToString((double)m_fpWeight*fp)+"\n").c_str()));
 	}
+	p_breakdown.m_score = fobj;
 	return fobj;
 }
 
+unsigned long long ControllerMovementRecorderComponent::hashObjective(unsigned long long p_contextKey) const
+{
+	unsigned int version = OBJECTIVE_VERSION;
+	float weights[5] = { m_fdWeight, m_fvWeight, m_fhWeight, m_frWeight, m_fpWeight };
+	unsigned long long h = EvaluationCache::hash(&version, sizeof(version), p_contextKey);
+	return EvaluationCache::hash(weights, sizeof(weights), h);
+}
+
 void ControllerMovementRecorderComponent::fv_calcStrideMeanVelocity(ControllerComponent* p_controller,
 	ControllerSystem* p_system, bool p_forceStore /*= false*/)
 {
@@ -38,33 +62,31 @@ void ControllerMovementRecorderComponent::fv_calcStrideMeanVelocity(ControllerCo
 	ControllerSystem::VelocityStat& velocities = p_system->getControllerVelocityStat(p_controller);
 	if (!restarted && !p_forceStore)
 	{
-		m_temp_currentStrideVelocities.push_back(-velocities.m_currentVelocity);
+		m_temp_currentStrideVelocitySum += -velocities.m_currentVelocity;
 		// DESIRED 
-		m_temp_currentStrideDesiredVelocities.push_back(velocities.m_desiredVelocity);
+		// force straight movement behavior from tests, set desired coronal velocity to constant zero:
+		m_temp_currentStrideDesiredVelocitySum += glm::vec3(0.0f, 0.0f, velocities.m_desiredVelocity.z);
 		// GOAL 
-		//m_temp_currentStrideDesiredVelocities.push_back(velocities.getGoalVelocity());
+		//m_temp_currentStrideDesiredVelocitySum += velocities.getGoalVelocity();
+		m_temp_currentStrideSamples++;
 	}
 	else
 	{
-		glm::vec3 totalVelocities(0.0f), totalDesiredVelocities(0.0f), totalGoalVelocities(0.0f);
-		for (int i = 0; i < m_temp_currentStrideVelocities.size(); i++)
-		{
-			totalVelocities += m_temp_currentStrideVelocities[i];
-			// force straight movement behavior from tests, set desired coronal velocity to constant zero:
-			totalDesiredVelocities += glm::vec3(0.0f, 0.0f, m_temp_currentStrideDesiredVelocities[i].z);
-		}
+		glm::vec3 totalVelocities = m_temp_currentStrideVelocitySum, 
+			totalDesiredVelocities = m_temp_currentStrideDesiredVelocitySum, totalGoalVelocities(0.0f);
 		totalGoalVelocities = velocities.getGoalVelocity();
 		if (glm::length(totalGoalVelocities) <= 0.1f)
-			DEBUGPRINT(("zero\n"));
-		totalVelocities /= max(1.0f, (float)m_temp_currentStrideVelocities.size());
-		totalDesiredVelocities /= max(1.0f, (float)m_temp_currentStrideDesiredVelocities.size());
-		// add to lists
+			LOG_DEBUG("zero\n");
+		totalVelocities /= max(1.0f, (float)m_temp_currentStrideSamples);
+		totalDesiredVelocities /= max(1.0f, (float)m_temp_currentStrideSamples);
+		// add to accumulator
 		double desiredDiff = (double)glm::length(totalVelocities - totalDesiredVelocities),
 			goalDiff = (double)glm::length(totalVelocities - totalGoalVelocities);
-		m_fvVelocityDeviations.push_back(0.0f*desiredDiff+goalDiff);
+		m_fvVelocityDeviations.add(0.0f*desiredDiff+goalDiff);
 		//
-		m_temp_currentStrideVelocities.clear();
-		m_temp_currentStrideDesiredVelocities.clear();
+		m_temp_currentStrideVelocitySum = glm::vec3(0.0f);
+		m_temp_currentStrideDesiredVelocitySum = glm::vec3(0.0f);
+		m_temp_currentStrideSamples = 0;
 	}
 }
 
@@ -81,7 +103,8 @@ void ControllerMovementRecorderComponent::fr_calcRotationDeviations(ControllerCo
 		glm::quat diff = glm::inverse(currentOrientation) * currentDesiredOrientation;
 		glm::vec3 axis; float angle;
 		MathHelp::quatToAngleAxis(diff, angle, axis);
-		m_frBodyRotationDeviations[i].push_back(TODEG*angle);
+		float angleDeg = TODEG*angle;
+		m_frBodyRotationDeviations[i].add((double)angleDeg);
 	}
 }
 
@@ -89,7 +112,7 @@ void ControllerMovementRecorderComponent::fh_calcHeadAccelerations( ControllerCo
 {
 	unsigned int headJointId = p_controller->getHeadJointId();
 	glm::vec3 acceleration = p_system->getJointAcceleration(headJointId);
-	m_fhHeadAcceleration.push_back((double)glm::length(acceleration));
+	m_fhHeadAcceleration.add((double)glm::length(acceleration));
 }
 
 void ControllerMovementRecorderComponent::fd_calcReferenceMotion( ControllerComponent* p_controller, ControllerSystem* p_system, 
@@ -105,7 +128,6 @@ void ControllerMovementRecorderComponent::fd_calcReferenceMotion( ControllerComp
 
 	// Calc global distance deviation
 	double ghostDist = (double)(velstat.getGoalVelocity().z)*p_time;
-	glm::vec3 ghostDistVec(0.0f, 0.0f, ghostDist);
 	double controllerDist = (double)(p_system->getControllerPosition(p_controller).z - controllerstart.z);
 	movDistDeviation = ghostDist - controllerDist;
 	//if (controllerDist < 0.0) movDistDeviation *= 10.0; // penalty for falling or walking backwards
@@ -126,7 +148,6 @@ void ControllerMovementRecorderComponent::fd_calcReferenceMotion( ControllerComp
 	for (unsigned int i = 0; i < legFrames; i++)
 	{
 		ControllerComponent::LegFrame* lf = p_controller->getLegFrame(i);
-		glm::vec3 lfOffset = lf->m_startPosOffset - controllerstart;
 		glm::vec3 lfPos = p_system->getLegFramePosition(lf);
 		double tlenBod = (double)lfPos.y - (double)lf->m_height; // assuming ground is 0!!
 		//if (tlenBod < lf->m_height*0.5f) tlenBod *= 10.0; // penalty for falling down
@@ -141,13 +162,19 @@ void ControllerMovementRecorderComponent::fd_calcReferenceMotion( ControllerComp
 		// Legs
 		//Vector3 wantedWPos = new Vector3(m_myController.transform.position.x, m_origBodyHeight, m_ghostController.position.z - m_ghostStart.z + m_mycontrollerStart.z);
 		//glm::vec3 wantedWPos(lfPos.x, lf->m_height, lfPos.z);
-		glm::vec3 wantedWPos(0.0f, lf->m_height, ghostDistVec.z + lfOffset.z);
 		glm::vec3 lfPosOptHeight(lfPos.x, lf->m_height, lfPos.z);
 		unsigned int numLegs = lf->m_legs.size();
 		ReferenceLegMovementController* refLegMovement = &m_referenceControllers[i];
+		// The reference only depends on its inputs, so it is looked up from a shared table
+		if (m_referenceTables[i] == NULL)
+			m_referenceTables[i] = ReferenceMotionTable::acquire(*refLegMovement, numLegs, lf->m_height, 
+				m_upperLegsLen[i], m_lowerLegsLen[i], velstat.getGoalVelocity().z, p_dt);
+		const ReferenceMotionTable* refTable = m_referenceTables[i];
 		for (unsigned int n = 0; n < numLegs; n++)
 		{
-			refLegMovement->updateRefPositions(n, wantedWPos, lf->m_height, m_upperLegsLen[i], m_lowerLegsLen[i], p_dt, p_drawer);
+			// Advance the player once per leg, the same way updateRefPositions does
+			refLegMovement->m_player.updatePhase(p_dt);
+			ReferenceMotionTable::Sample ref = refTable->sample(n, refLegMovement->m_player.getPhase());
 
 			glm::vec3 charFootPos = p_system->getFootPos(lf, n);
 			glm::vec3 charHipPos = p_system->getJointInnerPos(lf->m_hipJointId[n]);
@@ -155,9 +182,9 @@ void ControllerMovementRecorderComponent::fd_calcReferenceMotion( ControllerComp
 
 			// Take the local(in lf space) limb pos of the controller and subtract
 			// with the local limb pos of the ghost.
-			glm::vec3 footRefToFoot =	(charFootPos - lfPosOptHeight)	-	(refLegMovement->m_feet[n]		  - wantedWPos);
-			glm::vec3 hipRefToHip =		(charHipPos  - lfPosOptHeight)	-	(refLegMovement->m_IK.getHipPos() - wantedWPos);
-			glm::vec3 kneeRefToKnee =	(charKneePos - lfPosOptHeight)	-	(refLegMovement->m_knees[n]		  - wantedWPos);
+			glm::vec3 footRefToFoot =	(charFootPos - lfPosOptHeight)	-	ref.m_foot;
+			glm::vec3 hipRefToHip =		(charHipPos  - lfPosOptHeight)	-	ref.m_hip;
+			glm::vec3 kneeRefToKnee =	(charKneePos - lfPosOptHeight)	-	ref.m_knee;
 			
 			// Draw dists
 			if (p_drawer!=NULL)
@@ -180,93 +207,47 @@ void ControllerMovementRecorderComponent::fd_calcReferenceMotion( ControllerComp
 	lenDist *= lenDist; // sqr
 	*/
 
-	m_fdBodyHeightSqrDiffs.push_back(lenFt * 0.4 + lenKnees + lenHips + lenBod + lenHd + 0.4f*movDistDeviation);
+	m_fdBodyHeightSqrDiffs.add(lenFt * 0.4 + lenKnees + lenHips + lenBod + lenHd + 0.4f*movDistDeviation);
 }
 
 void ControllerMovementRecorderComponent::fp_calcMovementDistance(ControllerComponent* p_controller, ControllerSystem* p_system)
 {
-	m_fpMovementDist.push_back(p_system->getControllerVelocityStat(p_controller).m_currentVelocity);
+	m_fpMovementDist += p_system->getControllerVelocityStat(p_controller).m_currentVelocity;
 	m_fvVelocityGoal = p_system->getControllerVelocityStat(p_controller).getGoalVelocity();
 }
 
 double ControllerMovementRecorderComponent::evaluateFV()
 {
-	double total = 0.0f;
-	// mean
-	for (auto n : m_fvVelocityDeviations)
-	{
-		total += n;
-	}
-	double avg = total /= max(1.0, ((double)(m_fvVelocityDeviations.size())));
-	double totmeandiffsqr = 0.0f;
-	// std
-	for (auto n : m_fvVelocityDeviations)
-	{
-		double mdiff = n - avg;
-		totmeandiffsqr += mdiff * mdiff;
-	}
-	double sdeviation = sqrt(totmeandiffsqr / max(1.0, ((double)m_fvVelocityDeviations.size())));
-	return avg;
+	return m_fvVelocityDeviations.getMean();
 }
 
 double ControllerMovementRecorderComponent::evaluateFR()
 {
-	double total = 0.0f;
-	int sz = 0;
-	// mean
-	for (int x = 0; x < m_frBodyRotationDeviations.size();x++)
-	for (int y = 0; y < m_frBodyRotationDeviations[x].size(); y++)
+	double total = 0.0;
+	unsigned int sz = 0;
+	// mean over all leg frames
+	for (unsigned int x = 0; x < m_frBodyRotationDeviations.size(); x++)
 	{
-		total += (double)m_frBodyRotationDeviations[x][y];
-		sz++;
+		total += m_frBodyRotationDeviations[x].getSum();
+		sz += m_frBodyRotationDeviations[x].getCount();
 	}
-	double avg = total /= max(1.0, (double)(sz));
+	double avg = total / max(1.0, (double)(sz));
 	return avg;
 }
 
 double ControllerMovementRecorderComponent::evaluateFH()
 {
-	double total = 0.0f;
-	int sz = 0;
-	// mean
-	for(auto n : m_fhHeadAcceleration)
-	{
-		total += n;
-		sz++;
-	}
-
-	double avg = total /= max(1.0, (double)(sz));
-	return avg;
+	return m_fhHeadAcceleration.getMean();
 }
 
 double ControllerMovementRecorderComponent::evaluateFD()
 {
-	double total = 0.0f;
-	// mean
-	for (auto n : m_fdBodyHeightSqrDiffs)
-	{
-		total += n;
-	}
-	double avg = total /= max(1.0, (double)(m_fdBodyHeightSqrDiffs.size()));
-	double totmeandiffsqr = 0.0f;
-	// std
-	for (auto n : m_fdBodyHeightSqrDiffs)
-	{
-		double mdiff = n - avg;
-		totmeandiffsqr += mdiff * mdiff;
-	}
-	double sdeviation = sqrt(totmeandiffsqr / max(1.0, (double)m_fdBodyHeightSqrDiffs.size()));
-	return avg;
+	return m_fdBodyHeightSqrDiffs.getMean();
 }
 
 double ControllerMovementRecorderComponent::evaluateFP()
 {
-	glm::vec3 total;
-	// mean
-	for (auto n : m_fpMovementDist)
-	{
-		total += n;
-	}
+	glm::vec3 total = m_fpMovementDist;
 	float movementSign = max(0.1f, m_fvVelocityGoal.z) / abs(max(0.1f, m_fvVelocityGoal.z));
 	if (movementSign == 0.0) movementSign = 1.0f;
 	double scoreInRightDir = max(0.0f, total.z * movementSign);
@@ -276,4 +257,5 @@ double ControllerMovementRecorderComponent::evaluateFP()
 void ControllerMovementRecorderComponent::addLegReferenceController(ReferenceLegMovementController& p_refController)
 {
 	m_referenceControllers.push_back(p_refController);
+	m_referenceTables.push_back(NULL);
 }
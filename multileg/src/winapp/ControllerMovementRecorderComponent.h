@@ -4,6 +4,9 @@
 #include <vector>
 #include <glm\gtc\type_ptr.hpp>
 #include "ReferenceLegMovementController.h"
+#include "ReferenceMotionTable.h"
+#include <EvaluationCache.h>
+#include <RunningStat.h>
 
 class ControllerComponent;
 class ControllerSystem;
@@ -48,13 +51,25 @@ fobj(P) = +wvfv +(whfh) +wrfr
 class ControllerMovementRecorderComponent : public artemis::Component
 {
 public:
+	// Bump when an objective term is computed differently, cached breakdowns
+	// of an older version are then never hit
+	static const unsigned int OBJECTIVE_VERSION = 1;
+
 	ControllerMovementRecorderComponent();
 
 	~ControllerMovementRecorderComponent()
 	{
+		for (unsigned int i = 0; i < m_referenceTables.size(); i++)
+			ReferenceMotionTable::release(m_referenceTables[i]);
 	}
 
-	double evaluate(bool p_dbgPrint);
+	double evaluate(bool p_dbgPrint, EvaluationCache::Entry* p_outBreakdown = NULL);
+
+	// Weighted objective and debug print of an already evaluated breakdown
+	double score(EvaluationCache::Entry& p_breakdown, bool p_dbgPrint);
+
+	// Folds the objective version and term weights into an evaluation cache context key
+	unsigned long long hashObjective(unsigned long long p_contextKey) const;
 
 	void fv_calcStrideMeanVelocity(ControllerComponent* p_controller, ControllerSystem* p_system,
 		bool p_forceStore = false);
@@ -94,13 +109,15 @@ protected:
 
 private:
 	std::vector<float> m_upperLegsLen, m_lowerLegsLen;
-	std::vector<double> m_fvVelocityDeviations; // (current, mean)-desired
+	// Objective terms are accumulated as they are recorded, constant memory per candidate
+	RunningStat m_fvVelocityDeviations; // (current, mean)-desired, per stride
 	glm::vec3 m_fvVelocityGoal;
-	std::vector<glm::vec3> m_fpMovementDist; // travel distance
-	std::vector<double> m_fhHeadAcceleration;
-	std::vector<double> m_fdBodyHeightSqrDiffs;
-	std::vector<std::vector<float>> m_frBodyRotationDeviations; //per-leg frame, arcos(current,desired)
+	glm::vec3 m_fpMovementDist; // travel distance, sum of velocities
+	RunningStat m_fhHeadAcceleration;
+	RunningStat m_fdBodyHeightSqrDiffs;
+	std::vector<RunningStat> m_frBodyRotationDeviations; //per-leg frame, arcos(current,desired)
 	std::vector<ReferenceLegMovementController> m_referenceControllers; // per leg-frame (references for leg segments)
+	std::vector<const ReferenceMotionTable*> m_referenceTables; // per leg-frame, shared, sampled from the above
 	float m_fdWeight;
 	float m_fvWeight;
 	float m_fhWeight;
@@ -109,8 +126,9 @@ private:
 	/*float m_origBodyHeight = 0.0f;
 	float m_origHeadHeight = 0.0f;
 */
-	 std::vector<glm::vec3> m_temp_currentStrideVelocities; // used to calculate mean stride velocity
-	 std::vector<glm::vec3> m_temp_currentStrideDesiredVelocities;
+	 glm::vec3 m_temp_currentStrideVelocitySum; // used to calculate mean stride velocity
+	 glm::vec3 m_temp_currentStrideDesiredVelocitySum;
+	 unsigned int m_temp_currentStrideSamples;
 	
 };
 
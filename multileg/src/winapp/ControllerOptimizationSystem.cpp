@@ -22,6 +22,11 @@ ControllerOptimizationSystem::ControllerOptimizationSystem( int p_maxTicks )
 	m_inited = false;
 	//
 	m_controllerSystemRef = NULL;
+	m_evaluationCache = NULL;
+	m_cacheRetries = 8;
+	m_paramSchema = NULL;
+	m_candidateParams = NULL;
+	m_candidateError = false;
 };
 
 void ControllerOptimizationSystem::added(artemis::Entity &e)
@@ -31,6 +36,8 @@ void ControllerOptimizationSystem::added(artemis::Entity &e)
 	m_optimizableControllers.push_back(controller);
 	m_controllerRecorders.push_back(recorder);
 	m_controllerScores.push_back(0.0);
+	m_controllerBreakdowns.push_back(EvaluationCache::Entry());
+	m_cachedSlots.push_back(false);
 }
 
 void ControllerOptimizationSystem::resetTestCount()
@@ -79,8 +86,23 @@ void ControllerOptimizationSystem::findCurrentBestCandidate()
 			foundBetter = true;
 		}
 	}
+	// Candidates scored from the cache compete as well, but have no slot
+	int bestCachedIdx = -1;
+	for (int i = 0; i < m_cachedCandidates.size(); i++)
+	{
+		if (m_cachedCandidates[i].m_breakdown.m_score < bestScore)
+		{
+			bestCachedIdx = i;
+			bestScore = m_cachedCandidates[i].m_breakdown.m_score;
+		}
+	}
 	m_lastBestScore = bestScore;
-	if (foundBetter) m_lastBestParams = m_currentParams[m_currentBestCandidateIdx];
+	if (bestCachedIdx > -1)
+	{
+		voidBestCandidate();
+		m_lastBestParams = m_cachedCandidates[bestCachedIdx].m_params;
+	}
+	else if (foundBetter) m_lastBestParams = m_currentParams[m_currentBestCandidateIdx];
 	/*if (m_currentBestCandidateIdx > -1)
 		m_drawBestCandidate = m_currentBestCandidate;*/
 }
@@ -92,15 +114,21 @@ void ControllerOptimizationSystem::voidBestCandidate()
 
 void ControllerOptimizationSystem::storeParams( std::vector<float>* p_initParams/*=NULL*/ )
 {
-	if (p_initParams==NULL)
+	m_currentParams.resize(m_optimizableControllers.size());
+	if (p_initParams==NULL)
 	{
 		for (int i = 0; i < m_optimizableControllers.size(); i++)
-			m_currentParams.push_back(m_optimizableControllers[i]->getParams());
+		{
+			std::vector<float>& params = m_currentParams[i];
+			params.resize(m_optimizableControllers[i]->getParamCount());
+			ParamCursor cursor(params.data(), (unsigned int)params.size());
+			m_optimizableControllers[i]->writeParams(cursor);
+		}
 	}
 	else
 	{
 		for (int i = 0; i < m_optimizableControllers.size(); i++)
-			m_currentParams.push_back(*p_initParams);
+			m_currentParams[i] = *p_initParams;
 	}
 }
 
@@ -115,12 +143,53 @@ void ControllerOptimizationSystem::resetScores()
 void ControllerOptimizationSystem::perturbParams(int p_offset /*= 0*/)
 {
 	// Perturb and assign to candidates
+	m_cachedCandidates.clear();
 	for (int i = p_offset; i < m_optimizableControllers.size(); i++)
 	{
-		m_currentParams[i] = m_changer.change(m_lastBestParams, m_paramsMin, m_paramsMax, m_testCount); // different perturbation to each
+		m_currentParams[i] = getPerturbedCandidate(); // different perturbation to each
+		m_cachedSlots[i] = false;
+		// Don't spend a simulation slot on an already evaluated candidate, it is
+		// scored from the cache right away and the slot gets a new one
+		if (m_evaluationCache != NULL)
+		{
+			CachedCandidate hit;
+			int hits = 0;
+			while (m_evaluationCache->lookup(m_evaluationCache->makeKey(m_currentParams[i]), hit.m_breakdown))
+			{
+				m_controllerRecorders[i]->score(hit.m_breakdown, false);
+				if (++hits >= m_cacheRetries)
+				{
+					// Little left to find around the best, the slot is left idle and
+					// reports the last hit
+					m_cachedSlots[i] = true;
+					m_controllerBreakdowns[i] = hit.m_breakdown;
+					break;
+				}
+				hit.m_params = m_currentParams[i];
+				m_cachedCandidates.push_back(hit);
+				m_currentParams[i] = getPerturbedCandidate();
+			}
+		}
 	}
 }
 
+std::vector<float> ControllerOptimizationSystem::getPerturbedCandidate()
+{
+	if (m_paramSchema != NULL && m_paramSchema->getSize() == m_lastBestParams.size())
+	{
+		// Only search the free subspace, frozen values are kept from the best candidate
+		std::vector<float> candidate = m_lastBestParams;
+		if (m_paramSchema->getFreeCount() > 0)
+		{
+			std::vector<float> freeParams;
+			m_paramSchema->gatherFree(m_lastBestParams, freeParams);
+			m_paramSchema->scatterFree(m_changer.change(freeParams, m_freeParamsMin, m_freeParamsMax, m_testCount), candidate);
+		}
+		return candidate;
+	}
+	return m_changer.change(m_lastBestParams, m_paramsMin, m_paramsMax, m_testCount);
+}
+
 void ControllerOptimizationSystem::evaluateAll()
 {
 	DEBUGPRINT(("\n\n CURRENT SCORE PARTS:\n"));
@@ -134,8 +203,21 @@ void ControllerOptimizationSystem::evaluateAll()
 
 double ControllerOptimizationSystem::evaluateCandidateFitness(int p_idx)
 {
-	ControllerMovementRecorderComponent* record = m_controllerRecorders[p_idx];
-	double score = record->evaluate(true);
+	ControllerMovementRecorderComponent* record = m_controllerRecorders[p_idx];
+	double score = 0.0;
+	EvaluationCache::Entry& breakdown = m_controllerBreakdowns[p_idx];
+	if (m_cachedSlots[p_idx])
+	{
+		// Looked up when the candidate was made, it was never simulated
+		DEBUGPRINT(("(cached) "));
+		score = record->score(breakdown, true);
+	}
+	else
+	{
+		score = record->evaluate(true, &breakdown);
+		if (m_evaluationCache != NULL)
+			m_evaluationCache->insert(m_evaluationCache->makeKey(m_currentParams[p_idx]), breakdown);
+	}
 	return score;
 }
 
@@ -147,6 +229,27 @@ void ControllerOptimizationSystem::initSim( double p_hiscore, std::vector<float>
 	m_lastBestScore = p_hiscore;
 }
 
+void ControllerOptimizationSystem::setEvaluationCache(EvaluationCache* p_cache)
+{
+	m_evaluationCache = p_cache;
+}
+
+void ControllerOptimizationSystem::setParamSchema(ParamSchema* p_schema)
+{
+	m_paramSchema = p_schema;
+}
+
+void ControllerOptimizationSystem::setCandidateParams(const std::vector<std::vector<float> >* p_params)
+{
+	m_candidateParams = p_params;
+	m_candidateError = false;
+}
+
+bool ControllerOptimizationSystem::hasCandidateError()
+{
+	return m_candidateError;
+}
+
 void ControllerOptimizationSystem::processEntity(artemis::Entity &e)
 {
 	populateControllerInitParams(); // only done once
@@ -154,6 +257,8 @@ void ControllerOptimizationSystem::processEntity(artemis::Entity &e)
 
 	ControllerComponent* controller = controllerComponentMapper.get(e);
 	ControllerMovementRecorderComponent* recorder = controllerRecorderComponentMapper.get(e);
+	int idx = getControllerIdx(controller);
+	if (idx > -1 && m_cachedSlots[idx]) return; // idle, already scored
 
 	// record:
 	recorder->fv_calcStrideMeanVelocity(controller, m_controllerSystemRef);
@@ -165,6 +270,15 @@ void ControllerOptimizationSystem::processEntity(artemis::Entity &e)
 	recorder->fp_calcMovementDistance(controller, m_controllerSystemRef);
 }
 
+int ControllerOptimizationSystem::getControllerIdx(ControllerComponent* p_controller)
+{
+	for (int i = 0; i < m_optimizableControllers.size(); i++)
+	{
+		if (m_optimizableControllers[i] == p_controller) return i;
+	}
+	return -1;
+}
+
 // Call after eval
 std::vector<float>& ControllerOptimizationSystem::getWinnerParams()
 {
@@ -176,31 +290,64 @@ void ControllerOptimizationSystem::populateControllerInitParams()
 	unsigned int sz = m_optimizableControllers.size();
 	if (sz > 0 && !m_inited)
 	{
+		// Bounds of this world's controller layout
 		m_paramsMax = m_optimizableControllers[0]->getParamsMax();
-		m_paramsMin = m_optimizableControllers[0]->getParamsMin();
+		m_paramsMin = m_optimizableControllers[0]->getParamsMin();
+		if (m_paramSchema != NULL)
+		{
+			if (m_paramSchema->getSize() != m_paramsMax.size() && 
+				!m_paramSchema->build(m_optimizableControllers[0]))
+				DEBUGPRINT(("\nParameter schema does not match parameter layout!\n"));
+			m_paramSchema->gatherFree(m_paramsMax, m_freeParamsMax);
+			m_paramSchema->gatherFree(m_paramsMin, m_freeParamsMin);
+		}
 
 		//
 		bool first = false;
 		m_currentParams.clear();
 		m_controllerScores.resize(sz); // All scores for one round
+		m_controllerBreakdowns.resize(sz);
+		m_cachedSlots.assign(sz, false);
 		//
-		if (m_lastBestParams.size()>0)
-			storeParams(&m_lastBestParams);
+		if (m_candidateParams != NULL)
+		{
+			// fixed, nothing to perturb
+			if (m_candidateParams->size() == sz)
+				m_currentParams = *m_candidateParams;
+			else
+			{
+				DEBUGPRINT((("\n" + ToString(m_candidateParams->size()) + " candidates for " + ToString(sz) + " controllers!\n").c_str()));
+				m_candidateError = true;
+				storeParams();
+			}
+		}
 		else
 		{
-			first = true;
-			storeParams();
-			m_lastBestParams = m_currentParams[0];
+			if (m_lastBestParams.size()>0)
+				storeParams(&m_lastBestParams);
+			else
+			{
+				first = true;
+				storeParams();
+				m_lastBestParams = m_currentParams[0];
+			}
+
+			perturbParams(1);
 		}
 
-		perturbParams(1);
-
 		for (int i = 0; i < m_optimizableControllers.size(); i++)
 		{
 			IOptimizable* opt = static_cast<IOptimizable*>(m_optimizableControllers[i]);
-			std::vector<float> paramslist = m_currentParams[i];
-			std::vector<float> paramslistcopy = paramslist;
-			opt->consumeParams(paramslist); // consume it to controller
+			std::vector<float>& paramslist = m_currentParams[i];
+			// the layout length is known, so a wrong candidate isn't read at all
+			if (paramslist.size() != m_paramsMax.size() || !opt->setParams(paramslist)) // consume it to controller
+			{
+				DEBUGPRINT((("\nCandidate " + ToString(i) + " does not match the parameter layout, runs its own params!\n").c_str()));
+				paramslist = opt->getParams(); // so it is scored as what it runs
+				if (m_candidateParams != NULL) m_candidateError = true;
+			}
+			// an idle slot's controller isn't run, its character only stands by
+			if (m_cachedSlots[i]) m_optimizableControllers[i]->m_enabled = false;
 		}
 		restartSim();
 		m_inited = true;
@@ -227,6 +374,16 @@ double ControllerOptimizationSystem::getScoreOf(unsigned int p_idx)
 	return score;
 }
 
+const EvaluationCache::Entry* ControllerOptimizationSystem::getBreakdownOf(unsigned int p_idx)
+{
+	const EvaluationCache::Entry* res = NULL;
+	if (p_idx < m_controllerBreakdowns.size())
+	{
+		res = &m_controllerBreakdowns[p_idx];
+	}
+	return res;
+}
+
 std::vector<float>* ControllerOptimizationSystem::getCurrentParamsOf(unsigned int p_idx)
 {
 	std::vector<float>* res = NULL;
@@ -3,6 +3,8 @@
 #include "ControllerComponent.h"
 #include "ControllerMovementRecorderComponent.h"
 #include <ParamChanger.h>
+#include <EvaluationCache.h>
+#include <ParamSchema.h>
 #include "ControllerSystem.h"
 
 // =======================================================================================
@@ -40,13 +42,31 @@ private:
 	std::vector<double> m_controllerScores; // All scores for one round
 	std::vector<float> m_lastBestParams; // saved params needed for a controller to get the hiscore
 	std::vector<float> m_paramsMax; // Prefetch of controller parameter
-	std::vector<float> m_paramsMin; // bounds in the current sim
+	std::vector<float> m_paramsMin; // bounds
 	std::vector<std::vector<float> > m_currentParams; // all params for the current controllers
 	std::vector<ControllerComponent*> m_optimizableControllers;
 	std::vector<ControllerMovementRecorderComponent*> m_controllerRecorders;
 
 	static int m_testCount; // global amount of executed tests
 
+	EvaluationCache* m_evaluationCache; // optional, shared across restarts
+	int m_cacheRetries; // max cached candidates scored per slot before it is left idle
+	struct CachedCandidate
+	{
+		std::vector<float> m_params;
+		EvaluationCache::Entry m_breakdown;
+	};
+	std::vector<CachedCandidate> m_cachedCandidates; // cache hits of this round, scored without a slot
+	std::vector<bool> m_cachedSlots; // slots left idle with a cached candidate, not simulated
+
+	ParamSchema* m_paramSchema; // optional, only free parameters are perturbed when set
+	std::vector<float> m_freeParamsMax; // bounds of the free
+	std::vector<float> m_freeParamsMin; // parameter subset
+
+	const std::vector<std::vector<float> >* m_candidateParams; // optional, fixed candidates
+	bool m_candidateError; // the candidates didn't fit the controllers, they run their own params
+	std::vector<EvaluationCache::Entry> m_controllerBreakdowns; // All objective terms for one round
+
 	ControllerSystem* m_controllerSystemRef;
 public:
 
@@ -75,6 +95,12 @@ public:
 	}
 
 	void initSim(double p_hiscore, std::vector<float>* p_initParams=NULL);
+	void setEvaluationCache(EvaluationCache* p_cache);
+	void setParamSchema(ParamSchema* p_schema);
+	// One parameter list per controller, evaluated as they are instead of perturbed
+	void setCandidateParams(const std::vector<std::vector<float> >* p_params);
+	// After the first tick, whether a candidate could not be run as given
+	bool hasCandidateError();
 	static void resetTestCount();
 	int getCurrentSimTicks();
 	void incSimTick();
@@ -86,6 +112,8 @@ public:
 	double getWinnerScore();
 	void findCurrentBestCandidate();
 	double getScoreOf(unsigned int p_idx);
+	// Objective terms of the last evaluation
+	const EvaluationCache::Entry* getBreakdownOf(unsigned int p_idx);
 	std::vector<float>* getCurrentParamsOf(unsigned int p_idx);
 	std::vector<float> getParamsOf(unsigned int p_idx);
 protected:
@@ -98,6 +126,8 @@ private:
 	void storeParams(std::vector<float>* p_initParams=NULL);
 	void resetScores();
 	void perturbParams(int p_offset = 0);
+	std::vector<float> getPerturbedCandidate();
+	int getControllerIdx(ControllerComponent* p_controller);
 
 	double evaluateCandidateFitness(int p_idx);
 
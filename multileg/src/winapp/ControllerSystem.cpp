@@ -13,6 +13,11 @@
 #include "PhysWorldDefines.h"
 #include "RenderComponent.h"
 #include "PositionRefComponent.h"
+#include <TickTrace.h>
+#include <MotionRecorder.h>
+#include <TelemetryFeed.h>
+#include <AsyncLog.h>
+#include <SimCheckpoint.h>
 
 bool ControllerSystem::m_useVFTorque=true;
 bool ControllerSystem::m_useGCVFTorque=true;
@@ -80,6 +85,7 @@ void ControllerSystem::processEntity(artemis::Entity &e)
 
 void ControllerSystem::fixedUpdate(float p_dt)
 {
+	TRACE_ZONE("fixedUpdate");
 	m_runTime += p_dt;
 
 
@@ -90,36 +96,53 @@ void ControllerSystem::fixedUpdate(float p_dt)
 	if (dbgDrawer()) dbgDrawer()->clearDrawCalls();
 
 	// Update all transforms
-	for (unsigned int i = 0; i < m_jointRigidBodies.size(); i++)
 	{
-		saveJointMatrix(i);
-		m_oldJointTorques[i] = m_jointTorques[i];
-		m_jointTorques[i] = glm::vec3(0.0f);
+		TRACE_ZONE("saveJointMatrices");
+		for (unsigned int i = 0; i < m_jointRigidBodies.size(); i++)
+		{
+			saveJointMatrix(i);
+			m_oldJointTorques[i] = m_jointTorques[i];
+			m_jointTorques[i] = glm::vec3(0.0f);
+		}
 	}
 
 	//DEBUGPRINT(("\n==========\n"));
 	double startTiming = 0.0;
-	int controllerCount = (int)m_controllers.size();
+	int controllerCount = (int)min((unsigned int)m_controllers.size(), m_activeControllerCount);
 	if (controllerCount>0)
 	{
 		// First, we have to read collision status for all feet. SILLY
-		for (int n = 0; n < controllerCount; n++)
 		{
-			ControllerComponent* controller = m_controllers[n];
-			writeFeetCollisionStatus(controller);
+			TRACE_ZONE("writeFeetCollisionStatus");
+			for (int n = 0; n < controllerCount; n++)
+			{
+				ControllerComponent* controller = m_controllers[n];
+				writeFeetCollisionStatus(controller);
+			}
 		}
 		startTiming = Time::getTimeSeconds();
+		TRACE_ZONE("controllers");
+		bool readCounters = PerfCounters::isEnabled();
+		for (unsigned int i = 0; i < m_workerCounters.size(); i++)
+			m_workerCounters[i].clear();
 		if (m_executionSetup==SERIAL)
 		{
 			// =====================================
 			// Single threaded implementation
 			// =====================================
+			PerfCounters::Sample counterStart, counterEnd;
+			if (readCounters) PerfCounters::read(counterStart);
 			for (int n = 0; n < controllerCount; n++)
 			{
 				ControllerComponent* controller = m_controllers[(unsigned int)n];
 				// Run controller code here
 				controllerUpdate((unsigned int)n, p_dt);
 			}
+			if (readCounters)
+			{
+				PerfCounters::read(counterEnd);
+				m_workerCounters[0] = counterEnd.delta(counterStart);
+			}
 		}
 		else
 		{
@@ -153,7 +176,11 @@ void ControllerSystem::fixedUpdate(float p_dt)
 			int remainingRest = rest;
 			#pragma omp parallel num_threads(loopInvoc)
 			{
+				TRACE_ZONE("controllerChunk");
 				int n = omp_get_thread_num();
+				// Each worker reads its own counters
+				PerfCounters::Sample counterStart, counterEnd;
+				if (readCounters) PerfCounters::read(counterStart);
 				int start = 0;
 				int maxCount = serialChars;
 				// The last thread must take on the rest as well
@@ -180,19 +207,32 @@ void ControllerSystem::fixedUpdate(float p_dt)
 						controllerUpdate(id, p_dt);
 					}
 				}
+				if (readCounters && n < (int)m_workerCounters.size())
+				{
+					PerfCounters::read(counterEnd);
+					m_workerCounters[n] = counterEnd.delta(counterStart);
+				}
 			}
 		}
 
 	}
 	else
 	{
-		DEBUGPRINT(("\nNO CONTROLLERS YET\n"));
+		LOG_DEBUG("\nNO CONTROLLERS YET\n");
 	}
 	//double endTimingOmp = omp_get_wtime();
 	m_timing = Time::getTimeSeconds() - startTiming;
 	//m_timing = endTimingOmp - startTimingOmp;
 	if (m_perfRecorder != NULL)
 		m_perfRecorder->accumulateMeasurementAt((double)(m_timing*1000.0), m_steps);
+	if (PerfCounters::isEnabled())
+	{
+		m_counters.clear();
+		for (unsigned int i = 0; i < m_workerCounters.size(); i++)
+			m_counters.add(m_workerCounters[i]);
+		if (m_counterRecorder != NULL)
+			m_counterRecorder->accumulateAt(m_counters, m_steps);
+	}
 	m_steps++;
 }
 
@@ -232,8 +272,8 @@ void ControllerSystem::buildCheck()
 {
 	for (unsigned int i = 0; i < m_controllersToBuild.size(); i++) // controllers
 	{
-		glm::vec3 startGaitVelocity(0.0f, 0.0f, 0.5f);
 		ControllerComponent* controller = m_controllersToBuild[i];
+		glm::vec3 startGaitVelocity = controller->m_goalVelocity;
 		// start by storing the current torque list size as offset, this'll be where we'll begin this
 		// controller's chunk of the torque list
 		unsigned int torqueListOffset = (unsigned int)m_jointTorques.size();
@@ -359,8 +399,8 @@ void ControllerSystem::buildCheck()
 				// Add an IK handler for leg
 				legFrame->m_legIK.push_back(IK2Handler(kneeFlip));
 				// add entry for foot rotation timing params in struct
-				legFrame->m_toeOffTime.push_back(0.0f);
-				legFrame->m_tuneFootStrikeTime.push_back(0.0f);
+				legFrame->m_toeOffTime[x] = 0.0f;
+				legFrame->m_tuneFootStrikeTime[x] = 0.0f;
 			}
 #pragma endregion legs
 			legFrame->m_height = legFramePos.y - (footPos.y - legFrame->m_footHeight*0.5f/*m_jointLengths[footJointId]*0.5f*/);
@@ -637,6 +677,7 @@ void ControllerSystem::controllerUpdate(unsigned int p_controllerId, float p_dt)
 	ControllerComponent* controller = m_controllers[p_controllerId];
 	if (controller->m_enabled)
 	{
+		TRACE_ZONE("controllerUpdate");
 		// get a copy of this controller's torques
 		unsigned int torqueIdxStart = controller->getTorqueListOffset();
 		unsigned int torqueIdxEnd = controller->getTorqueListChunkSize() + torqueIdxStart;
@@ -667,6 +708,7 @@ void ControllerSystem::controllerUpdate(unsigned int p_controllerId, float p_dt)
 }
 void ControllerSystem::updateLocationAndVelocityStats(int p_controllerId, ControllerComponent* p_controller, float p_dt)
 {
+	TRACE_ZONE("updateLocationAndVelocityStats");
 	glm::vec3 pos = getControllerPosition(p_controller);
 	if (pos.y < getControllerStartPos(p_controller).y*0.5f) p_controller->m_enabled = false;
 	// Update the current velocity
@@ -706,7 +748,7 @@ void ControllerSystem::updateLocationAndVelocityStats(int p_controllerId, Contro
 			desiredV -= glm::normalize(currentV) * stepSz*p_dt;
 	}
 	if (glm::length(desiredV) < 0.0f)
-		DEBUGPRINT(( (string("dv: ")+ToString(desiredV.z)+"\n").c_str() ));
+		LOG_DEBUG("dv: %g\n", desiredV.z);
 	m_controllerVelocityStats[p_controllerId].m_desiredVelocity = desiredV;
 	// Location
 	m_controllerLocationStats[p_controllerId].m_worldPos = pos;
@@ -754,6 +796,7 @@ glm::vec3 ControllerSystem::DOFAxisByVecCompId(unsigned int p_id)
 
 void ControllerSystem::updateFeet( unsigned int p_controllerId, ControllerComponent* p_controller )
 {
+	TRACE_ZONE("updateFeet");
 	for (unsigned int i = 0; i < p_controller->getLegFrameCount(); i++)
 	{
 		ControllerComponent::LegFrame* lf = p_controller->getLegFrame(i);
@@ -774,6 +817,7 @@ void ControllerSystem::updateFeet( unsigned int p_controllerId, ControllerCompon
 
 void ControllerSystem::updateSpine(std::vector<glm::vec3>* p_outTVF, int p_controllerId, ControllerComponent* p_controller, float p_dt)
 {
+	TRACE_ZONE("updateSpine");
 	ControllerComponent::Spine* spine = &p_controller->m_spine;
 	if (spine->getPDChain()->getSize()>0 && p_controller->getLegFrameCount()>1)
 	{
@@ -1051,6 +1095,7 @@ void ControllerSystem::calculateLegFrameNetLegVF(unsigned int p_controllerIdx, C
 void ControllerSystem::computeAllVFTorques(std::vector<glm::vec3>* p_outTVF, ControllerComponent* p_controller, 
 	unsigned int p_controllerIdx, unsigned int p_torqueIdxOffset, float p_phi, float p_dt)
 {
+	TRACE_ZONE("computeAllVFTorques");
 	int spineCount = (int)p_controller->m_spine.m_joints;
 	CMatrix J(3, ControllerComponent::VFChain::getAbsoluteMaxJacobiRows());
 	for (unsigned int i = 0; i < p_controller->getLegFrameCount(); i++)
@@ -1310,6 +1355,7 @@ glm::vec3 ControllerSystem::calculateStanceLegVF(unsigned int p_stanceLegCount,
 glm::vec3 ControllerSystem::applyNetLegFrameTorque(std::vector<glm::vec3>* p_inoutTVF, unsigned int p_controllerId, ControllerComponent* p_controller, unsigned int p_legFrameIdx, unsigned int p_torqueIdxOffset, 
 	glm::vec3& p_tspine, glm::vec3& p_tospine, float p_phi, float p_dt)
 {
+	TRACE_ZONE("applyNetLegFrameTorque");
 	// Preparations, get a hold of all legs in stance,
 	// all legs in swing. And get a hold of their and the 
 	// closest spine's torques.
@@ -1440,6 +1486,7 @@ glm::vec3 ControllerSystem::applyNetLegFrameTorque(std::vector<glm::vec3>* p_ino
 void ControllerSystem::computePDTorques(std::vector<glm::vec3>* p_inoutTVF, ControllerComponent* p_controller, 
 	unsigned int p_controllerIdx, unsigned int p_torqueIdxOffset, float p_phi, float p_dt)
 {
+	TRACE_ZONE("computePDTorques");
 	glm::mat4 desiredOrientation = getDesiredWorldOrientation(p_controllerIdx);
 	glm::mat4 invDesiredOrientation = glm::inverse(desiredOrientation);
 	int lfCount = p_controller->getLegFrameCount();
@@ -1645,6 +1692,233 @@ double ControllerSystem::getLatestTiming()
 	return m_timing;
 }
 
+void ControllerSystem::setActiveControllerCount(unsigned int p_count)
+{
+	unsigned int oldCount = getActiveControllerCount();
+	m_activeControllerCount = p_count;
+	unsigned int newCount = getActiveControllerCount();
+	// Controllers own a contiguous range of joint bodies
+	for (unsigned int i = min(oldCount, newCount); i < max(oldCount, newCount); i++)
+	{
+		ControllerComponent* controller = m_controllers[i];
+		unsigned int start = controller->getTorqueListOffset();
+		unsigned int end = start + controller->getTorqueListChunkSize();
+		for (unsigned int n = start; n < end && n < m_jointRigidBodies.size(); n++)
+		{
+			if (i < newCount)
+				m_jointRigidBodies[n]->forceActivationState(DISABLE_DEACTIVATION);
+			else
+				m_jointRigidBodies[n]->forceActivationState(DISABLE_SIMULATION);
+		}
+	}
+}
+
+unsigned int ControllerSystem::getActiveControllerCount()
+{
+	return min((unsigned int)m_controllers.size(), m_activeControllerCount);
+}
+
+unsigned int ControllerSystem::getControllerCount()
+{
+	return (unsigned int)m_controllers.size();
+}
+
+unsigned int ControllerSystem::getJointCount()
+{
+	return (unsigned int)m_jointWorldTransforms.size();
+}
+
+TransformComponent* ControllerSystem::getJointTransform(unsigned int p_jointIdx)
+{
+	return (TransformComponent*)m_dbgJointEntities[p_jointIdx]->getComponent<TransformComponent>();
+}
+
+const std::vector<glm::vec3>& ControllerSystem::getJointTorques() const
+{
+	return m_jointTorques;
+}
+
+void ControllerSystem::recordMotion(MotionRecorder* p_recorder, unsigned int p_tick)
+{
+	unsigned int jointCount = (unsigned int)m_jointWorldTransforms.size();
+	p_recorder->beginTick(p_tick, jointCount);
+	for (unsigned int i = 0; i < jointCount; i++)
+		p_recorder->addJoint(m_jointWorldTransforms[i], m_jointTorques[i], m_rigidBodyRefs[i]->isColliding());
+	p_recorder->endTick();
+}
+
+void ControllerSystem::publishTelemetry(TelemetryFeed* p_feed, unsigned int p_tick, double p_tickTiming, float p_dt)
+{
+	double controllerMs = m_timing * 1000.0;
+	p_feed->beginTick(p_tick, controllerMs, max(0.0, p_tickTiming * 1000.0 - controllerMs));
+	for (unsigned int i = 0; i < m_controllers.size() && i < m_controllerVelocityStats.size(); i++)
+	{
+		// The stat is the position change over one controller update
+		glm::vec3 velocity = p_dt > 0.0f ? m_controllerVelocityStats[i].m_currentVelocity / p_dt : glm::vec3(0.0f);
+		p_feed->addCharacter(getControllerPosition(i), velocity, m_controllers[i]->m_enabled);
+	}
+	p_feed->endTick();
+}
+
+void ControllerSystem::writeCheckpoint(SimCheckpoint& p_checkpoint)
+{
+	p_checkpoint.beginSection(SimCheckpoint::CONTROLLERS);
+	p_checkpoint.write((unsigned int)m_controllers.size());
+	p_checkpoint.write((unsigned int)m_jointRigidBodies.size());
+	p_checkpoint.write(m_activeControllerCount);
+	p_checkpoint.write(m_runTime);
+	// m_steps only indexes the measurements, a restored run measures from its own start
+	p_checkpoint.writeVector(m_VFs);
+	p_checkpoint.writeVector(m_jointTorques);
+	p_checkpoint.writeVector(m_oldJointTorques);
+	p_checkpoint.writeVector(m_jointWorldTransforms);
+	p_checkpoint.writeVector(m_jointWorldInnerEndpoints);
+	p_checkpoint.writeVector(m_jointWorldOuterEndpoints);
+	p_checkpoint.writeVector(m_controllerVelocityStats);
+	p_checkpoint.writeVector(m_controllerLocationStats);
+	for (unsigned int i = 0; i < m_controllers.size(); i++)
+		writeControllerCheckpoint(p_checkpoint, m_controllers[i]);
+	p_checkpoint.endSection();
+}
+
+bool ControllerSystem::readCheckpoint(SimCheckpoint& p_checkpoint, bool p_apply)
+{
+	// Not built yet, or another crowd
+	if (!p_checkpoint.seekSection(SimCheckpoint::CONTROLLERS) || !p_checkpoint.readCount((unsigned int)m_controllers.size()) ||
+		!p_checkpoint.readCount((unsigned int)m_jointRigidBodies.size()))
+		return false;
+	// The bodies' activation is part of their own state
+	unsigned int activeControllerCount = 0;
+	float runTime = 0.0f;
+	p_checkpoint.read(activeControllerCount);
+	p_checkpoint.read(runTime);
+	if (activeControllerCount > m_controllers.size())
+		return false;
+	if (p_apply)
+	{
+		m_activeControllerCount = activeControllerCount;
+		m_runTime = runTime;
+	}
+	p_checkpoint.readVector(m_VFs, p_apply);
+	p_checkpoint.readVector(m_jointTorques, p_apply);
+	p_checkpoint.readVector(m_oldJointTorques, p_apply);
+	p_checkpoint.readVector(m_jointWorldTransforms, p_apply);
+	p_checkpoint.readVector(m_jointWorldInnerEndpoints, p_apply);
+	p_checkpoint.readVector(m_jointWorldOuterEndpoints, p_apply);
+	p_checkpoint.readVector(m_controllerVelocityStats, p_apply);
+	p_checkpoint.readVector(m_controllerLocationStats, p_apply);
+	for (unsigned int i = 0; i < m_controllers.size() && p_checkpoint.isReadValid(); i++)
+		readControllerCheckpoint(p_checkpoint, m_controllers[i], p_apply);
+	return p_checkpoint.isSectionRead();
+}
+
+void ControllerSystem::writeControllerCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent* p_controller)
+{
+	p_checkpoint.write(p_controller->m_enabled);
+	p_checkpoint.write(p_controller->m_goalVelocity);
+	p_checkpoint.write(p_controller->m_player.getPhase());
+	p_checkpoint.write(p_controller->m_player.getRestartedFlag());
+	writePDChainCheckpoint(p_checkpoint, p_controller->m_spine.getPDChain());
+	p_checkpoint.write(p_controller->getLegFrameCount());
+	for (unsigned int i = 0; i < p_controller->getLegFrameCount(); i++)
+	{
+		ControllerComponent::LegFrame* lf = p_controller->getLegFrame(i);
+		p_checkpoint.write(lf->m_desiredLFTorquePD.getP());
+		p_checkpoint.write(lf->m_desiredLFTorquePD.getD());
+		p_checkpoint.write(lf->m_FhPD.getP());
+		p_checkpoint.write(lf->m_FhPD.getD());
+		p_checkpoint.write(lf->m_footTrackingSpringDamper.getP());
+		p_checkpoint.write(lf->m_footTrackingSpringDamper.getD());
+		p_checkpoint.writeVector(lf->m_footStrikePlacement);
+		p_checkpoint.writeVector(lf->m_footLiftPlacement);
+		p_checkpoint.writeBools(lf->m_footLiftPlacementPerformed);
+		p_checkpoint.writeVector(lf->m_footTarget);
+		p_checkpoint.writeBools(lf->m_footIsColliding);
+		p_checkpoint.write((unsigned int)lf->m_legs.size());
+		for (unsigned int n = 0; n < lf->m_legs.size(); n++)
+			writePDChainCheckpoint(p_checkpoint, lf->m_legs[n].getPDChain());
+	}
+}
+
+bool ControllerSystem::readControllerCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent* p_controller, bool p_apply)
+{
+	bool enabled = false;
+	glm::vec3 goalVelocity;
+	float phase = 0.0f;
+	bool restarted = false;
+	p_checkpoint.read(enabled);
+	p_checkpoint.read(goalVelocity);
+	p_checkpoint.read(phase);
+	p_checkpoint.read(restarted);
+	if (p_apply)
+	{
+		p_controller->m_enabled = enabled;
+		p_controller->m_goalVelocity = goalVelocity;
+		p_controller->m_player.setState(phase, restarted);
+	}
+	readPDChainCheckpoint(p_checkpoint, p_controller->m_spine.getPDChain(), p_apply);
+	if (!p_checkpoint.readCount(p_controller->getLegFrameCount()))
+		return false;
+	for (unsigned int i = 0; i < p_controller->getLegFrameCount(); i++)
+	{
+		ControllerComponent::LegFrame* lf = p_controller->getLegFrame(i);
+		glm::vec3 P, D;
+		float Fhp = 0.0f, Fhd = 0.0f, trackingP = 0.0f, trackingD = 0.0f;
+		p_checkpoint.read(P); p_checkpoint.read(D);
+		p_checkpoint.read(Fhp); p_checkpoint.read(Fhd);
+		p_checkpoint.read(trackingP); p_checkpoint.read(trackingD);
+		if (p_apply)
+		{
+			lf->m_desiredLFTorquePD.setErrors(P, D);
+			lf->m_FhPD.setErrors(Fhp, Fhd);
+			lf->m_footTrackingSpringDamper.setErrors(trackingP, trackingD);
+		}
+		p_checkpoint.readVector(lf->m_footStrikePlacement, p_apply);
+		p_checkpoint.readVector(lf->m_footLiftPlacement, p_apply);
+		p_checkpoint.readBools(lf->m_footLiftPlacementPerformed, p_apply);
+		p_checkpoint.readVector(lf->m_footTarget, p_apply);
+		p_checkpoint.readBools(lf->m_footIsColliding, p_apply);
+		if (!p_checkpoint.readCount((unsigned int)lf->m_legs.size()))
+			return false;
+		for (unsigned int n = 0; n < lf->m_legs.size(); n++)
+			readPDChainCheckpoint(p_checkpoint, lf->m_legs[n].getPDChain(), p_apply);
+	}
+	return p_checkpoint.isReadValid();
+}
+
+void ControllerSystem::writePDChainCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent::PDChain* p_chain)
+{
+	p_checkpoint.write(p_chain->getSize());
+	for (unsigned int i = 0; i < p_chain->getSize(); i++)
+	{
+		p_checkpoint.write(p_chain->m_PDChain[i].getP());
+		p_checkpoint.write(p_chain->m_PDChain[i].getD());
+	}
+}
+
+bool ControllerSystem::readPDChainCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent::PDChain* p_chain, bool p_apply)
+{
+	if (!p_checkpoint.readCount(p_chain->getSize()))
+		return false;
+	for (unsigned int i = 0; i < p_chain->getSize(); i++)
+	{
+		glm::vec3 P, D;
+		p_checkpoint.read(P); p_checkpoint.read(D);
+		if (p_apply) p_chain->m_PDChain[i].setErrors(P, D);
+	}
+	return p_checkpoint.isReadValid();
+}
+
+const PerfCounters::Sample& ControllerSystem::getLatestCounters()
+{
+	return m_counters;
+}
+
+void ControllerSystem::setPerfCounterRecorder(PerfCounterRecorder* p_counterRecorder)
+{
+	m_counterRecorder = p_counterRecorder;
+}
+
 glm::vec3 ControllerSystem::getJointPos(unsigned int p_jointIdx)
 {
 	return MathHelp::getMatrixTranslation(m_jointWorldTransforms[p_jointIdx]);
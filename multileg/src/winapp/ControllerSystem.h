@@ -6,6 +6,11 @@
 #include "ControllerComponent.h"
 #include "AdvancedEntitySystem.h"
 #include <MeasurementBin.h>
+#include <PerfCounters.h>
+#include <climits>
+
+class MotionRecorder;
+class TelemetryFeed;
 
 // =======================================================================================
 //                                 ControllerSystem
@@ -65,6 +70,8 @@ public:
 	static bool m_dbgShowGCVFVectors;
 	static bool m_dbgShowTAxes;
 
+	// The kernel benchmark times the private update steps in isolation
+	friend class ControllerBenchmark;
 private:
 	artemis::ComponentMapper<ControllerComponent> controllerComponentMapper;
 	// Controller run-time data
@@ -104,6 +111,9 @@ public:
 		m_perfRecorder = p_perfMeasurer;
 		m_timing = 0;
 		m_loopInvocs = p_loopInvocs;
+		m_activeControllerCount = UINT_MAX;
+		m_counterRecorder = NULL;
+		m_workerCounters.resize(p_loopInvocs > 1 ? p_loopInvocs : 1);
 	}
 
 	virtual ~ControllerSystem();
@@ -135,6 +145,28 @@ public:
 	VelocityStat& getControllerVelocityStat(const ControllerComponent* p_controller);
 	glm::vec3 getJointAcceleration(unsigned int p_jointId);
 	double getLatestTiming();
+	const std::vector<glm::vec3>& getJointTorques() const;
+	// Adds a tick of every joint's world transform, torque and contact to the recording
+	void recordMotion(MotionRecorder* p_recorder, unsigned int p_tick);
+	// Root position, velocity and enabled flag of every controller, with the timings of the tick
+	void publishTelemetry(TelemetryFeed* p_feed, unsigned int p_tick, double p_tickTiming, float p_dt);
+	// Controller run-time state: the joint and stat arrays, gait phases, foot placements
+	// and PD error history. Restoring needs the same controllers, built.
+	virtual void writeCheckpoint(SimCheckpoint& p_checkpoint);
+	virtual bool readCheckpoint(SimCheckpoint& p_checkpoint, bool p_apply);
+	// Only the first p_count controllers are updated, the bodies of the others
+	// are taken out of the simulation. Lets the crowd size change without a rebuild.
+	// Reactivated characters resume from the state they were stopped in, restore a
+	// checkpoint first when every run has to start from the same state.
+	void setActiveControllerCount(unsigned int p_count);
+	unsigned int getActiveControllerCount();
+	unsigned int getControllerCount();
+	unsigned int getJointCount();
+	// Transform of a joint's entity, in the joint order of the torque and transform lists
+	TransformComponent* getJointTransform(unsigned int p_jointIdx);
+	// Hardware counters of the last controller phase, summed over the workers
+	const PerfCounters::Sample& getLatestCounters();
+	void setPerfCounterRecorder(PerfCounterRecorder* p_counterRecorder);
 	glm::vec3 getControllerPosition(unsigned int p_controllerId);
 	glm::vec3 getControllerPosition(ControllerComponent* p_controller);
 	glm::vec3 getControllerStartPos(ControllerComponent* p_controller);
@@ -207,6 +239,10 @@ private:
 	glm::mat4 getDesiredWorldOrientation(unsigned int p_controllerId) const;
 	bool isFootStrike(ControllerComponent::LegFrame* p_lf, unsigned int p_legIdx);
 	void writeFeetCollisionStatus(ControllerComponent* p_controller);
+	void writeControllerCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent* p_controller);
+	bool readControllerCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent* p_controller, bool p_apply);
+	void writePDChainCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent::PDChain* p_chain);
+	bool readPDChainCheckpoint(SimCheckpoint& p_checkpoint, ControllerComponent::PDChain* p_chain, bool p_apply);
 	float getDesiredFootAngle(unsigned int p_legIdx, ControllerComponent::LegFrame* p_lf, float p_phi);
 
 	// global variables
@@ -214,8 +250,12 @@ private:
 	int m_steps;
 	ExecutionLayout m_executionSetup;
 	int m_loopInvocs;
+	unsigned int m_activeControllerCount;
 
 	// Dbg
 	MeasurementBin<std::vector<float>>* m_perfRecorder;
 	double m_timing;
+	PerfCounterRecorder* m_counterRecorder;
+	PerfCounters::Sample m_counters;
+	std::vector<PerfCounters::Sample> m_workerCounters;
 };
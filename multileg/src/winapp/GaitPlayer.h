@@ -23,12 +23,14 @@ public:
 	{
 		m_gaitPhase = 0.0f;
 		m_tuneGaitPeriod = 1.0f;
+		m_hasRestarted_oneCheck = false;
 	}
 
 	GaitPlayer(float p_gaitPeriod)
 	{
 		m_gaitPhase = 0.0f;
 		m_tuneGaitPeriod = p_gaitPeriod;
+		m_hasRestarted_oneCheck = false;
 	}
 
 	// IOptimizable
@@ -85,29 +87,38 @@ public:
 		return &m_gaitPhase;
 	}
 
+	// Run-time state, for checkpoints
+	bool getRestartedFlag() const
+	{
+		return m_hasRestarted_oneCheck;
+	}
+
+	void setState(float p_phase, bool p_hasRestarted)
+	{
+		m_gaitPhase = p_phase;
+		m_hasRestarted_oneCheck = p_hasRestarted;
+	}
+
 	// Optimization
-	virtual std::vector<float> getParams()
+	virtual void writeParams(ParamCursor& p_cursor)
 	{
-		//DEBUGPRINT(("GAIT PLAYER GETPARAMS\n"));
-		std::vector<float> params;
-		params.push_back(m_tuneGaitPeriod);
-		return params;
+		p_cursor.write(m_tuneGaitPeriod);
 	}
-	virtual void consumeParams(std::vector<float>& p_other)
-	{
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_tuneGaitPeriod);
+	virtual void readParams(ParamCursor& p_cursor)
+	{
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_tuneGaitPeriod);
+	}
+	virtual void writeParamsMax(ParamCursor& p_cursor)
+	{
+		p_cursor.write(5.0f);
 	}
-	virtual std::vector<float> getParamsMax()
+	virtual void describeParams(ParamSchema& p_schema)
 	{
-		std::vector<float> paramsmax;
-		paramsmax.push_back(5.0f);
-		return paramsmax;
+		p_schema.add("gaitPeriod");
 	}
-	virtual std::vector<float> getParamsMin()
+	virtual void writeParamsMin(ParamCursor& p_cursor)
 	{
-		std::vector<float> paramsmin;
-		paramsmin.push_back(0.01f);
-		return paramsmin;
+		p_cursor.write(0.01f);
 	}
 
 private:
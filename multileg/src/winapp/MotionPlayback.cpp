@@ -0,0 +1,235 @@
+#include "MotionPlayback.h"
+#include <cmath>
+
+MotionPlayback::MotionPlayback()
+{
+	for (unsigned int i = 0; i < CACHED_CHUNKS; i++)
+	{
+		m_cache[i].m_state = EMPTY;
+		m_cache[i].m_chunkIdx = -1;
+	}
+	m_currentChunk = 0;
+	m_direction = 1;
+	m_stopDecoder = false;
+	m_tickLength = 1.0 / 120.0;
+	m_playhead = 0.0;
+	m_speed = 1.0f;
+	m_paused = false;
+}
+
+MotionPlayback::~MotionPlayback()
+{
+	close();
+}
+
+bool MotionPlayback::open(const std::string& p_fileName, double p_tickLength)
+{
+	close();
+	if (!m_reader.open(p_fileName) || m_reader.getChunkCount() == 0)
+	{
+		m_reader.close();
+		return false;
+	}
+	m_tickLength = p_tickLength;
+	m_playhead = (double)m_reader.getFirstTick();
+	m_currentChunk = 0;
+	m_direction = m_speed < 0.0f ? -1 : 1;
+	m_stopDecoder = false;
+	m_decoder = std::thread(&MotionPlayback::decoderLoop, this);
+	return true;
+}
+
+void MotionPlayback::close()
+{
+	if (m_decoder.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopDecoder = true;
+		}
+		m_windowChanged.notify_one();
+		m_decoder.join();
+	}
+	for (unsigned int i = 0; i < CACHED_CHUNKS; i++)
+	{
+		m_cache[i].m_state = EMPTY;
+		m_cache[i].m_chunkIdx = -1;
+	}
+	m_reader.close();
+}
+
+bool MotionPlayback::isOpen() const
+{
+	return m_reader.isOpen();
+}
+
+void MotionPlayback::setJointTransforms(const std::vector<TransformComponent*>& p_joints)
+{
+	m_joints = p_joints;
+}
+
+void MotionPlayback::update(double p_dt)
+{
+	if (!isOpen() || m_paused) return;
+	seek(m_playhead + p_dt * (double)m_speed / m_tickLength);
+}
+
+void MotionPlayback::seek(double p_tick)
+{
+	if (!isOpen()) return;
+	// Loop within the recorded ticks, the last tick has nothing to interpolate towards
+	double first = (double)getFirstTick();
+	double length = (double)(getEndTick() - getFirstTick());
+	if (length > 1.0)
+	{
+		length -= 1.0;
+		p_tick = first + fmod(p_tick - first, length);
+		if (p_tick < first) p_tick += length;
+	}
+	else
+		p_tick = first;
+	m_playhead = p_tick;
+	int chunk = m_reader.findChunk((unsigned int)m_playhead);
+	if (chunk >= 0) setCurrentChunk(chunk);
+}
+
+void MotionPlayback::setSpeed(float p_speed)
+{
+	m_speed = p_speed;
+	setCurrentChunk(m_currentChunk);
+}
+
+void MotionPlayback::setPaused(bool p_paused)
+{
+	m_paused = p_paused;
+}
+
+double MotionPlayback::getPlayhead() const
+{
+	return m_playhead;
+}
+
+unsigned int MotionPlayback::getFirstTick() const
+{
+	return m_reader.getFirstTick();
+}
+
+unsigned int MotionPlayback::getEndTick() const
+{
+	return m_reader.getEndTick();
+}
+
+bool MotionPlayback::apply()
+{
+	if (!isOpen()) return false;
+	unsigned int tick = (unsigned int)m_playhead;
+	float t = (float)(m_playhead - (double)tick);
+	int chunkIdx = m_reader.findChunk(tick);
+	const MotionReader::Chunk* chunk = getReadyChunk(chunkIdx);
+	if (chunk == NULL)
+		return false; // hold the last frame
+	// The next tick to interpolate towards, in this chunk or the next
+	const MotionReader::Chunk* nextChunk = chunk;
+	unsigned int nextTick = tick + 1;
+	if (nextTick >= chunk->m_firstTick + chunk->m_tickCount)
+	{
+		// only within the window, outside of it the decoder may be reusing the slot
+		int nextIdx = m_reader.findChunk(nextTick);
+		nextChunk = isInWindow(nextIdx) ? getReadyChunk(nextIdx) : NULL;
+		if (nextChunk == NULL || nextChunk->m_jointCount != chunk->m_jointCount)
+		{
+			nextChunk = chunk;
+			nextTick = tick;
+		}
+	}
+	unsigned int base = (tick - chunk->m_firstTick) * chunk->m_jointCount;
+	unsigned int nextBase = (nextTick - nextChunk->m_firstTick) * nextChunk->m_jointCount;
+	unsigned int jointCount = chunk->m_jointCount < m_joints.size() ? chunk->m_jointCount : (unsigned int)m_joints.size();
+	for (unsigned int i = 0; i < jointCount; i++)
+	{
+		glm::vec3 pos = glm::mix(chunk->m_positions[base + i], nextChunk->m_positions[nextBase + i], t);
+		const glm::quat& a = chunk->m_rotations[base + i];
+		glm::quat b = nextChunk->m_rotations[nextBase + i];
+		if (glm::dot(a, b) < 0.0f) b = glm::quat(-b.w, -b.x, -b.y, -b.z); // shortest way
+		m_joints[i]->setPosRotToMatrix(pos, glm::normalize(glm::mix(a, b, t)));
+	}
+	return true;
+}
+
+int MotionPlayback::getWindowChunk(unsigned int p_offset) const
+{
+	int count = (int)m_reader.getChunkCount();
+	int idx = (m_currentChunk + m_direction * (int)p_offset) % count;
+	return idx < 0 ? idx + count : idx;
+}
+
+bool MotionPlayback::isInWindow(int p_chunkIdx) const
+{
+	for (unsigned int i = 0; i < CACHED_CHUNKS; i++)
+	{
+		if (getWindowChunk(i) == p_chunkIdx) return true;
+	}
+	return false;
+}
+
+const MotionReader::Chunk* MotionPlayback::getReadyChunk(int p_chunkIdx)
+{
+	if (p_chunkIdx < 0) return NULL;
+	// A ready slot in the window isn't touched by the decoder, and only this thread moves the window
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (unsigned int i = 0; i < CACHED_CHUNKS; i++)
+	{
+		if (m_cache[i].m_state == READY && m_cache[i].m_chunkIdx == p_chunkIdx)
+			return &m_cache[i].m_chunk;
+	}
+	return NULL;
+}
+
+void MotionPlayback::setCurrentChunk(int p_chunkIdx)
+{
+	int direction = m_speed < 0.0f ? -1 : 1;
+	if (p_chunkIdx == m_currentChunk && direction == m_direction) return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_currentChunk = p_chunkIdx;
+		m_direction = direction;
+	}
+	m_windowChanged.notify_one();
+}
+
+void MotionPlayback::decoderLoop()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stopDecoder)
+	{
+		// Nearest chunk of the window that isn't cached
+		int wanted = -1;
+		for (unsigned int i = 0; i < CACHED_CHUNKS && wanted == -1; i++)
+		{
+			int chunkIdx = getWindowChunk(i);
+			bool cached = false;
+			for (unsigned int n = 0; n < CACHED_CHUNKS; n++)
+				cached = cached || (m_cache[n].m_state != EMPTY && m_cache[n].m_chunkIdx == chunkIdx);
+			if (!cached) wanted = chunkIdx;
+		}
+		if (wanted == -1)
+		{
+			m_windowChanged.wait(lock);
+			continue;
+		}
+		// Evict a chunk that has left the window
+		CacheSlot* slot = NULL;
+		for (unsigned int n = 0; n < CACHED_CHUNKS && slot == NULL; n++)
+		{
+			if (m_cache[n].m_state == EMPTY || !isInWindow(m_cache[n].m_chunkIdx))
+				slot = &m_cache[n];
+		}
+		slot->m_state = DECODING;
+		slot->m_chunkIdx = wanted;
+		lock.unlock();
+		bool decoded = m_reader.decodeChunk((unsigned int)wanted, slot->m_chunk);
+		lock.lock();
+		// a broken chunk stays marked as cached so it isn't retried every loop
+		slot->m_state = decoded ? READY : DECODING;
+	}
+}
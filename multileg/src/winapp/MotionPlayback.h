@@ -0,0 +1,92 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <MotionReader.h>
+#include "TransformComponent.h"
+
+// =======================================================================================
+//                                      MotionPlayback
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Plays a MotionRecorder recording back onto the joint TransformComponents,
+///			without physics or controllers. The playhead is in (fractional) ticks and
+///			advances with the frame time times the speed, a negative speed plays
+///			backwards and the playback loops at both ends. Seeking moves the
+///			playhead directly, for scrubbing.
+///
+///			A background thread decodes the chunk under the playhead and the
+///			following ones in the play direction into a small cache, so the frame
+///			only interpolates decoded joints. If the playhead gets ahead of the
+///			decoder (a far seek) the last frame is held until the chunk is ready.
+///
+/// # MotionPlayback
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class MotionPlayback
+{
+public:
+	static const unsigned int CACHED_CHUNKS = 4;	// the current chunk and those decoded ahead
+
+	MotionPlayback();
+	~MotionPlayback();
+
+	// p_tickLength is the recorded physics step in seconds
+	bool open(const std::string& p_fileName, double p_tickLength);
+	void close();
+	bool isOpen() const;
+
+	// The transforms to drive, in the joint order of the ControllerSystem that recorded
+	void setJointTransforms(const std::vector<TransformComponent*>& p_joints);
+
+	void update(double p_dt);
+	void seek(double p_tick);
+	void setSpeed(float p_speed);
+	void setPaused(bool p_paused);
+	double getPlayhead() const;
+	unsigned int getFirstTick() const;
+	unsigned int getEndTick() const;
+
+	// Sets the joints to the playhead, returns false if its chunk isn't decoded yet
+	bool apply();
+private:
+	enum SlotState
+	{
+		EMPTY, DECODING, READY
+	};
+
+	struct CacheSlot
+	{
+		SlotState m_state;
+		int m_chunkIdx;
+		MotionReader::Chunk m_chunk;
+	};
+
+	// The chunks that should be cached, the current one first
+	int getWindowChunk(unsigned int p_offset) const;
+	bool isInWindow(int p_chunkIdx) const;
+	const MotionReader::Chunk* getReadyChunk(int p_chunkIdx);
+	void setCurrentChunk(int p_chunkIdx);
+	void decoderLoop();
+
+	MotionReader m_reader;
+	CacheSlot m_cache[CACHED_CHUNKS];
+	// decoding window, written by the main thread under the mutex
+	int m_currentChunk;
+	int m_direction;
+	std::mutex m_mutex;
+	std::condition_variable m_windowChanged;
+	bool m_stopDecoder;
+	std::thread m_decoder;
+
+	std::vector<TransformComponent*> m_joints;
+	double m_tickLength;
+	double m_playhead;
+	float m_speed;
+	bool m_paused;
+};
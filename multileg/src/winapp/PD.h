@@ -52,6 +52,8 @@ public:
 
 	float getP() { return m_P; }
 	float getD() { return m_D; }
+	// Error history, for restoring a checkpoint
+	void setErrors(float p_P, float p_D) { m_P = p_P; m_D = p_D; }
 
 	// Drive the controller and get new value
 	// p_error This is the current error
@@ -66,32 +68,28 @@ public:
 	}
 
 	// Optimization
-	virtual std::vector<float> getParams()
+	virtual void writeParams(ParamCursor& p_cursor)
 	{
-		//DEBUGPRINT(("PD GETPARAMS\n"));
-		std::vector<float> params;
-		params.push_back(m_Kp);
-		params.push_back(m_Kd);
-		return params;
+		p_cursor.write(m_Kp);
+		p_cursor.write(m_Kd);
 	}
-	virtual void consumeParams(std::vector<float>& p_other)
-	{
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Kp);
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Kd);
+	virtual void readParams(ParamCursor& p_cursor)
+	{
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Kp);
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Kd);
+	}
+	virtual void writeParamsMax(ParamCursor& p_cursor)
+	{
+		OptimizableHelper::WriteParamsRepeated(p_cursor, 1000.0f, 2);
 	}
-	virtual std::vector<float> getParamsMax()
+	virtual void writeParamsMin(ParamCursor& p_cursor)
 	{
-		std::vector<float> paramsmax;
-		paramsmax.push_back(1000.0f);
-		paramsmax.push_back(1000.0f);
-		return paramsmax;
+		OptimizableHelper::WriteParamsRepeated(p_cursor, -1000.0f, 2);
 	}
-	virtual std::vector<float> getParamsMin()
+	virtual void describeParams(ParamSchema& p_schema)
 	{
-		std::vector<float> paramsmin;
-		paramsmin.push_back(-1000.0f);
-		paramsmin.push_back(-1000.0f);
-		return paramsmin;
+		p_schema.add("Kp");
+		p_schema.add("Kd");
 	}
 
 protected:
@@ -60,6 +60,14 @@ public:
 
 	glm::vec3 getP() const { return glm::vec3(m_P[0], m_P[1], m_P[2]); }
 	glm::vec3 getD() const { return glm::vec3(m_D[0], m_D[1], m_D[2]); }
+	// Error history, for restoring a checkpoint
+	void setErrors(const glm::vec3& p_P, const glm::vec3& p_D)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			m_P[i] = p_P[i]; m_D[i] = p_D[i];
+		}
+	}
 
 	// Drive the controller and get new value
 	// p_error This is the current error
@@ -119,32 +127,28 @@ public:
 	}
 
 	// Optimization
-	virtual std::vector<float> getParams()
+	virtual void writeParams(ParamCursor& p_cursor)
+	{
+		p_cursor.write(m_Kp);
+		p_cursor.write(m_Kd);
+	}
+	virtual void readParams(ParamCursor& p_cursor)
 	{
-		//DEBUGPRINT(("PDn GETPARAMS\n"));
-		std::vector<float> params;
-		params.push_back(m_Kp);
-		params.push_back(m_Kd);
-		return params;
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Kp);
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Kd);
 	}
-	virtual void consumeParams(std::vector<float>& p_other)
-	{
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Kp);
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Kd);
+	virtual void writeParamsMax(ParamCursor& p_cursor)
+	{
+		OptimizableHelper::WriteParamsRepeated(p_cursor, 1000.0f, 2);
 	}
-	virtual std::vector<float> getParamsMax()
+	virtual void writeParamsMin(ParamCursor& p_cursor)
 	{
-		std::vector<float> paramsmax;
-		paramsmax.push_back(1000.0f);
-		paramsmax.push_back(1000.0f);
-		return paramsmax;
+		OptimizableHelper::WriteParamsRepeated(p_cursor, -1000.0f, 2);
 	}
-	virtual std::vector<float> getParamsMin()
+	virtual void describeParams(ParamSchema& p_schema)
 	{
-		std::vector<float> paramsmin;
-		paramsmin.push_back(-1000.0f);
-		paramsmin.push_back(-1000.0f);
-		return paramsmin;
+		p_schema.add("Kp");
+		p_schema.add("Kd");
 	}
 
 protected:
@@ -65,36 +65,31 @@ public:
 	}
 
 	// Optimization
-	virtual std::vector<float> getParams()
+	virtual void writeParams(ParamCursor& p_cursor)
 	{
-		//DEBUGPRINT(("PID GETPARAMS\n"));
-		std::vector<float> params;
-		params.push_back(m_Kp);
-		params.push_back(m_Ki);
-		params.push_back(m_Kd);
-		return params;
+		p_cursor.write(m_Kp);
+		p_cursor.write(m_Ki);
+		p_cursor.write(m_Kd);
 	}
-	virtual void consumeParams(std::vector<float>& p_other)
-	{
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Kp);
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Ki);
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_Kd);
+	virtual void readParams(ParamCursor& p_cursor)
+	{
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Kp);
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Ki);
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_Kd);
+	}
+	virtual void writeParamsMax(ParamCursor& p_cursor)
+	{
+		OptimizableHelper::WriteParamsRepeated(p_cursor, 1000.0f, 3);
 	}
-	virtual std::vector<float> getParamsMax()
+	virtual void writeParamsMin(ParamCursor& p_cursor)
 	{
-		std::vector<float> paramsmax;
-		paramsmax.push_back(1000.0f);
-		paramsmax.push_back(1000.0f);
-		paramsmax.push_back(1000.0f);
-		return paramsmax;
+		OptimizableHelper::WriteParamsRepeated(p_cursor, -1000.0f, 3);
 	}
-	virtual std::vector<float> getParamsMin()
+	virtual void describeParams(ParamSchema& p_schema)
 	{
-		std::vector<float> paramsmin;
-		paramsmin.push_back(-1000.0f);
-		paramsmin.push_back(-1000.0f);
-		paramsmin.push_back(-1000.0f);
-		return paramsmin;
+		p_schema.add("Kp");
+		p_schema.add("Ki");
+		p_schema.add("Kd");
 	}
 
 protected:
@@ -2,8 +2,13 @@
 #include <btBulletDynamicsCommon.h>
 #include "AdvancedEntitySystem.h"
 #include "ControllerSystem.h"
+#include "Time.h"
 #include <DebugPrint.h>
 #include <ToString.h>
+#include <TickTrace.h>
+#include <SimCheckpoint.h>
+#include <TelemetryFeed.h>
+#include <glm\gtc\type_ptr.hpp>
 
 
 void physicsSimulationTickCallback(btDynamicsWorld *world, btScalar timeStep) {
@@ -11,34 +16,278 @@ void physicsSimulationTickCallback(btDynamicsWorld *world, btScalar timeStep) {
 	w->physProcessCallback(timeStep);
 }
 
+void physicsSimulationPostTickCallback(btDynamicsWorld *world, btScalar timeStep) {
+	PhysicsWorldHandler *w = static_cast<PhysicsWorldHandler *>(world->getWorldUserInfo());
+	w->physPostProcessCallback(timeStep);
+}
+
 PhysicsWorldHandler::PhysicsWorldHandler(btDynamicsWorld* p_world, ControllerSystem* p_controllerSystem)
 {
 	m_world = p_world;
 	m_controllerSystem = p_controllerSystem;
 	m_world->setInternalTickCallback(physicsSimulationTickCallback, static_cast<void *>(this), true);
+	m_world->setInternalTickCallback(physicsSimulationPostTickCallback, static_cast<void *>(this), false);
 	m_internalStepCounter = 0;
+	m_tickStartTime = 0.0;
+	m_tickTiming = 0.0;
+	m_tickBudgetMs = 0.0;
+	m_overBudgetCount = 0;
+	m_counterRecorder = NULL;
+	m_stateHashRecorder = NULL;
+	m_motionRecorder = NULL;
+	m_motionRecordTiming = 0.0;
+	m_telemetryFeed = NULL;
 }
 
 void PhysicsWorldHandler::physProcessCallback(btScalar timeStep)
 {
+	TRACE_ZONE("physProcessCallback");
+	m_tickStartTime = Time::getTimeSeconds();
 	m_internalStepCounter++;
-	processPreprocessSystemCollection((float)timeStep);
+	{
+		TRACE_ZONE("preprocessSystems");
+		processPreprocessSystemCollection((float)timeStep);
+	}
 	// Collisions readback for rigidbodies that has it enabled
-	handleCollisions();
+	{
+		TRACE_ZONE("handleCollisions");
+		handleCollisions();
+	}
 	//// Character controller
 	m_controllerSystem->fixedUpdate((float)timeStep); // might want this in post tick instead? Have it here for now
 	//// Controller
 	m_controllerSystem->finish();
-	m_controllerSystem->applyTorques((float)timeStep);
+	{
+		TRACE_ZONE("applyTorques");
+		m_controllerSystem->applyTorques((float)timeStep);
+	}
+	if (m_motionRecorder != NULL && m_motionRecorder->isOpen())
+	{
+		TRACE_ZONE("recordMotion");
+		double recordStartTime = Time::getTimeSeconds();
+		m_controllerSystem->recordMotion(m_motionRecorder, m_internalStepCounter - 1);
+		m_motionRecordTiming = Time::getTimeSeconds() - recordStartTime;
+	}
 	// Other systems
-	processOrderIndependentSystemCollection((float)timeStep);
+	{
+		TRACE_ZONE("orderIndependentSystems");
+		processOrderIndependentSystemCollection((float)timeStep);
+	}
+	// The physics step is measured from here to the post tick
+	if (PerfCounters::isEnabled())
+		PerfCounters::read(m_stepCounterStart);
 	return;
 }
+
+void PhysicsWorldHandler::physPostProcessCallback(btScalar timeStep)
+{
+	m_tickTiming = Time::getTimeSeconds() - m_tickStartTime;
+	if (m_tickBudgetMs > 0.0 && m_tickTiming * 1000.0 > m_tickBudgetMs)
+		m_overBudgetCount++;
+	if (PerfCounters::isEnabled())
+	{
+		PerfCounters::Sample stepCounterEnd;
+		PerfCounters::read(stepCounterEnd);
+		m_physicsCounters = stepCounterEnd.delta(m_stepCounterStart);
+		if (m_counterRecorder != NULL)
+			m_counterRecorder->accumulateAt(m_physicsCounters, (int)m_internalStepCounter - 1);
+	}
+	if (m_stateHashRecorder != NULL && m_stateHashRecorder->isActive())
+	{
+		TRACE_ZONE("recordStateHash");
+		recordStateHash();
+	}
+	if (m_telemetryFeed != NULL && m_telemetryFeed->isWriter())
+	{
+		TRACE_ZONE("publishTelemetry");
+		m_controllerSystem->publishTelemetry(m_telemetryFeed, m_internalStepCounter - 1, m_tickTiming, (float)timeStep);
+	}
+	// Allocations of the tick, per zone
+	if (AllocTracker::isEnabled())
+		AllocTracker::endTick(m_internalStepCounter - 1);
+}
+
+void PhysicsWorldHandler::recordStateHash()
+{
+	// One entry per body in world order, then one for the joint torques
+	m_stateHashRecorder->beginTick(m_internalStepCounter - 1);
+	const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		StateHash hash;
+		const btTransform& transform = objects[i]->getWorldTransform();
+		const btVector3& origin = transform.getOrigin();
+		hash.add((float)origin.x()); hash.add((float)origin.y()); hash.add((float)origin.z());
+		for (int row = 0; row < 3; row++)
+		{
+			const btVector3& basisRow = transform.getBasis()[row];
+			hash.add((float)basisRow.x()); hash.add((float)basisRow.y()); hash.add((float)basisRow.z());
+		}
+		const btRigidBody* body = btRigidBody::upcast(objects[i]);
+		if (body != NULL)
+		{
+			const btVector3& linVel = body->getLinearVelocity();
+			const btVector3& angVel = body->getAngularVelocity();
+			hash.add((float)linVel.x()); hash.add((float)linVel.y()); hash.add((float)linVel.z());
+			hash.add((float)angVel.x()); hash.add((float)angVel.y()); hash.add((float)angVel.z());
+		}
+		m_stateHashRecorder->addEntry(hash.get());
+	}
+	StateHash torqueHash;
+	if (m_controllerSystem != NULL)
+	{
+		const std::vector<glm::vec3>& torques = m_controllerSystem->getJointTorques();
+		for (unsigned int i = 0; i < torques.size(); i++)
+			torqueHash.add(glm::value_ptr(torques[i]), 3);
+	}
+	m_stateHashRecorder->addEntry(torqueHash.get());
+	m_stateHashRecorder->endTick();
+}
+
 unsigned int PhysicsWorldHandler::getNumberOfInternalSteps()
 {
 	return m_internalStepCounter;
 }
 
+double PhysicsWorldHandler::getLatestTickTiming()
+{
+	return m_tickTiming;
+}
+
+void PhysicsWorldHandler::setTickBudget(double p_budgetMs)
+{
+	m_tickBudgetMs = p_budgetMs;
+}
+
+unsigned int PhysicsWorldHandler::getOverBudgetCount()
+{
+	return m_overBudgetCount;
+}
+
+void PhysicsWorldHandler::resetOverBudgetCount()
+{
+	m_overBudgetCount = 0;
+}
+
+const PerfCounters::Sample& PhysicsWorldHandler::getLatestPhysicsCounters()
+{
+	return m_physicsCounters;
+}
+
+void PhysicsWorldHandler::setPerfCounterRecorder(PerfCounterRecorder* p_counterRecorder)
+{
+	m_counterRecorder = p_counterRecorder;
+}
+
+void PhysicsWorldHandler::setStateHashRecorder(StateHashRecorder* p_stateHashRecorder)
+{
+	m_stateHashRecorder = p_stateHashRecorder;
+}
+
+std::string PhysicsWorldHandler::getStateHashEntryName(int p_entry)
+{
+	int bodies = m_world->getNumCollisionObjects();
+	if (p_entry < 0)
+		return "unknown entry";
+	if (p_entry >= bodies)
+		return "joint torques";
+	std::string name = "body " + ToString(p_entry);
+	RigidBodyComponent* rigidBody = (RigidBodyComponent*)m_world->getCollisionObjectArray()[p_entry]->getUserPointer();
+	if (rigidBody != NULL)
+		name += " (rigidbody uid " + ToString(rigidBody->getUID()) + ")";
+	return name;
+}
+
+void PhysicsWorldHandler::setMotionRecorder(MotionRecorder* p_motionRecorder)
+{
+	m_motionRecorder = p_motionRecorder;
+}
+
+double PhysicsWorldHandler::getLatestMotionRecordTiming()
+{
+	return m_motionRecordTiming;
+}
+
+void PhysicsWorldHandler::setTelemetryFeed(TelemetryFeed* p_telemetryFeed)
+{
+	m_telemetryFeed = p_telemetryFeed;
+}
+
+void PhysicsWorldHandler::saveCheckpoint(SimCheckpoint& p_checkpoint)
+{
+	p_checkpoint.clear();
+	p_checkpoint.setTick(m_internalStepCounter);
+	p_checkpoint.beginSection(SimCheckpoint::PHYSICS);
+	p_checkpoint.write(m_internalStepCounter);
+	p_checkpoint.write(m_world->getNumCollisionObjects());
+	// The joints' frames are solved from their bodies every step, only their switch is state
+	p_checkpoint.write(m_world->getNumConstraints());
+	for (int i = 0; i < m_world->getNumConstraints(); i++)
+		p_checkpoint.write(m_world->getConstraint(i)->isEnabled());
+	p_checkpoint.endSection();
+	for (unsigned int i = 0; i < m_preprocessSystems.size(); i++)
+		m_preprocessSystems[i]->writeCheckpoint(p_checkpoint);
+	for (unsigned int i = 0; i < m_orderIndependentSystems.size(); i++)
+		m_orderIndependentSystems[i]->writeCheckpoint(p_checkpoint);
+	if (m_controllerSystem != NULL)
+		m_controllerSystem->writeCheckpoint(p_checkpoint);
+}
+
+bool PhysicsWorldHandler::readSystemCheckpoints(SimCheckpoint& p_checkpoint, bool p_apply)
+{
+	// The controllers are read first, they are not there until built
+	if (m_controllerSystem != NULL && !m_controllerSystem->readCheckpoint(p_checkpoint, p_apply))
+		return false;
+	for (unsigned int i = 0; i < m_preprocessSystems.size(); i++)
+	{
+		if (!m_preprocessSystems[i]->readCheckpoint(p_checkpoint, p_apply))
+			return false;
+	}
+	for (unsigned int i = 0; i < m_orderIndependentSystems.size(); i++)
+	{
+		if (!m_orderIndependentSystems[i]->readCheckpoint(p_checkpoint, p_apply))
+			return false;
+	}
+	return true;
+}
+
+bool PhysicsWorldHandler::restoreCheckpoint(SimCheckpoint& p_checkpoint)
+{
+	unsigned int internalStepCounter = 0;
+	if (!p_checkpoint.seekSection(SimCheckpoint::PHYSICS) || !p_checkpoint.read(internalStepCounter) ||
+		!p_checkpoint.readCount((unsigned int)m_world->getNumCollisionObjects()) ||
+		!p_checkpoint.readCount((unsigned int)m_world->getNumConstraints()))
+		return false;
+	std::vector<bool> constraintsEnabled(m_world->getNumConstraints());
+	for (unsigned int i = 0; i < constraintsEnabled.size(); i++)
+	{
+		bool enabled = true;
+		p_checkpoint.read(enabled);
+		constraintsEnabled[i] = enabled;
+	}
+	if (!p_checkpoint.isSectionRead())
+		return false;
+	// Every section is checked before any of them is applied, so a checkpoint
+	// that does not fit leaves the world untouched. The apply pass can not fail then.
+	if (!readSystemCheckpoints(p_checkpoint, false))
+		return false;
+	readSystemCheckpoints(p_checkpoint, true);
+	m_internalStepCounter = internalStepCounter;
+	for (unsigned int i = 0; i < constraintsEnabled.size(); i++)
+		m_world->getConstraint((int)i)->setEnabled(constraintsEnabled[i]);
+	// Contacts cached for warm starting belong to the state before the restore.
+	// They are not part of a checkpoint, every restore starts them over the same way.
+	const btCollisionObjectArray& objects = m_world->getCollisionObjectArray();
+	btOverlappingPairCache* pairCache = m_world->getBroadphase()->getOverlappingPairCache();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (objects[i]->getBroadphaseHandle() != NULL)
+			pairCache->cleanProxyFromPairs(objects[i]->getBroadphaseHandle(), m_world->getDispatcher());
+	}
+	m_world->getConstraintSolver()->reset();
+	return true;
+}
+
 void PhysicsWorldHandler::addOrderIndependentSystem(AdvancedEntitySystem* p_system)
 {
 	m_orderIndependentSystems.push_back(p_system);
@@ -1,11 +1,17 @@
 #pragma once
 #include <LinearMath/btScalar.h>
 #include <vector>
+#include <PerfCounters.h>
+#include <StateHash.h>
+#include <MotionRecorder.h>
+#include <string>
 
 class btDynamicsWorld;
 class btCollisionObject;
 class AdvancedEntitySystem;
 class ControllerSystem;
+class SimCheckpoint;
+class TelemetryFeed;
 
 // =======================================================================================
 //                                      PhysicsWorldHandler
@@ -21,14 +27,40 @@ class ControllerSystem;
 ///---------------------------------------------------------------------------------------
 
 static void physicsSimulationTickCallback(btDynamicsWorld *world, btScalar timeStep);
+static void physicsSimulationPostTickCallback(btDynamicsWorld *world, btScalar timeStep);
 
 class PhysicsWorldHandler {
 public:
 	PhysicsWorldHandler(btDynamicsWorld* p_world, ControllerSystem* p_controllerSystem);
 
 	void physProcessCallback(btScalar timeStep);
+	// After bullet's internal step, only used for measuring the step
+	void physPostProcessCallback(btScalar timeStep);
 
 	unsigned int getNumberOfInternalSteps();
+	// Time of the last internal step, controllers and physics
+	double getLatestTickTiming();
+	// Ticks over the budget are counted, for spotting when the crowd is too big for real time
+	void setTickBudget(double p_budgetMs);
+	unsigned int getOverBudgetCount();
+	void resetOverBudgetCount();
+	// Hardware counters of the last bullet internal step, excluding the controllers
+	const PerfCounters::Sample& getLatestPhysicsCounters();
+	void setPerfCounterRecorder(PerfCounterRecorder* p_counterRecorder);
+	// Determinism check, hashes every body and the joint torques after each internal step
+	void setStateHashRecorder(StateHashRecorder* p_stateHashRecorder);
+	// Body index or joint torques, for a divergent entry of the state hash stream
+	std::string getStateHashEntryName(int p_entry);
+	// Records the joints of every internal step, as the controllers saw them
+	void setMotionRecorder(MotionRecorder* p_motionRecorder);
+	double getLatestMotionRecordTiming();
+	// Publishes a snapshot of the characters and timings after every internal step
+	void setTelemetryFeed(TelemetryFeed* p_telemetryFeed);
+	// Complete run-time state after the last internal step: the world's, the systems'
+	// and the controllers'. Restoring needs a world built the same way with its
+	// controllers built, and returns false if the checkpoint does not fit it.
+	void saveCheckpoint(SimCheckpoint& p_checkpoint);
+	bool restoreCheckpoint(SimCheckpoint& p_checkpoint);
 
 	void addPreprocessSystem(AdvancedEntitySystem* p_system);
 	void addOrderIndependentSystem(AdvancedEntitySystem* p_system);
@@ -37,6 +69,9 @@ public:
 	void processOrderIndependentSystemCollection(float p_dt);
 
 protected:
+	// Every system's section, the check pass (not p_apply) changes nothing
+	bool readSystemCheckpoints(SimCheckpoint& p_checkpoint, bool p_apply);
+
 	// Might want to change this to generic list of a common base class
 	ControllerSystem* m_controllerSystem; // But right now, we only need it for the controllers
 
@@ -46,6 +81,18 @@ protected:
 	// Physics world
 	btDynamicsWorld* m_world;
 	unsigned int m_internalStepCounter;
+	double m_tickStartTime;
+	double m_tickTiming;
+	double m_tickBudgetMs;
+	unsigned int m_overBudgetCount;
+	PerfCounterRecorder* m_counterRecorder;
+	PerfCounters::Sample m_stepCounterStart;
+	PerfCounters::Sample m_physicsCounters;
+	StateHashRecorder* m_stateHashRecorder;
+	MotionRecorder* m_motionRecorder;
+	double m_motionRecordTiming;
+	TelemetryFeed* m_telemetryFeed;
+	void recordStateHash();
 	void handleCollisions();
 	bool checkMaskedCollision(const btCollisionObject* p_colObj0, const btCollisionObject* p_colObj1);
 };
@@ -132,33 +132,29 @@ float PieceWiseLinear::get(unsigned int p_idx) const
 	return m_dataPoints[p_idx];
 }
 
-std::vector<float> PieceWiseLinear::getParams()
+void PieceWiseLinear::writeParams(ParamCursor& p_cursor)
 {
-	//DEBUGPRINT(("PIECEWISE LINEAR GETPARAMS\n"));
-	std::vector<float> params;
-	for (int i = 0; i < getSize(); i++)
-		params.push_back(get(i));	//
-	return params;
+	for (int i = 0; i < getSize(); i++)
+		p_cursor.write(get(i));	//
 }
 
-void PieceWiseLinear::consumeParams(std::vector<float>& p_other)
-{
-	for (int i = 0; i < getSize(); i++)
-		OptimizableHelper::ConsumeParamsTo(p_other, &m_dataPoints[i]);
+void PieceWiseLinear::readParams(ParamCursor& p_cursor)
+{
+	for (int i = 0; i < getSize(); i++)
+		OptimizableHelper::ConsumeParamsTo(p_cursor, &m_dataPoints[i]);
+}
+
+void PieceWiseLinear::writeParamsMax(ParamCursor& p_cursor)
+{
+	OptimizableHelper::WriteParamsRepeated(p_cursor, m_scale*2.0f, getSize());
 }
 
-std::vector<float> PieceWiseLinear::getParamsMax( )
+void PieceWiseLinear::writeParamsMin(ParamCursor& p_cursor)
 {
-	std::vector<float> paramsmax;
-	for (int i = 0; i < getSize(); i++)
-		paramsmax.push_back(m_scale*2.0f);
-	return paramsmax;
+	OptimizableHelper::WriteParamsRepeated(p_cursor, -m_scale*2.0f, getSize());
 }
 
-std::vector<float> PieceWiseLinear::getParamsMin( )
+void PieceWiseLinear::describeParams(ParamSchema& p_schema)
 {
-	std::vector<float> paramsmin;
-	for (int i = 0; i < getSize(); i++)
-		paramsmin.push_back(-m_scale*2.0f);
-	return paramsmin;
+	p_schema.add("point", getSize());
 }
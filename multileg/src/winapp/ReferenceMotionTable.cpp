@@ -0,0 +1,160 @@
+#include "ReferenceMotionTable.h"
+#include "ReferenceLegMovementController.h"
+#include <EvaluationCache.h>
+#include <Util.h>
+#include <cmath>
+
+std::map<unsigned long long, ReferenceMotionTable::SharedTable> ReferenceMotionTable::m_sharedTables;
+
+ReferenceMotionTable::ReferenceMotionTable()
+{
+	m_legCount = 0;
+}
+
+void ReferenceMotionTable::build(const ReferenceLegMovementController& p_reference, unsigned int p_legCount,
+	float p_lfHeight, float p_uLegLen, float p_lLegLen, float p_goalVelocityZ, float p_dt)
+{
+	m_legCount = p_legCount;
+	m_samples.assign(SAMPLES * p_legCount, Sample());
+	GaitPlayer player = p_reference.m_player;
+	float period = player.getParams()[0];
+	// The reference keeps state between steps (the lift position is the last stance
+	// foot), so it is stepped at the simulation step. In the recorder the shared player
+	// is advanced once per leg and tick, so the ghost moves a leg count fraction of that.
+	float stepTime = p_dt > 0.0f ? p_dt : period / (float)SAMPLES;
+	float stepDist = p_goalVelocityZ * stepTime / (float)p_legCount;
+	unsigned int strideSteps = (unsigned int)ceil(period / stepTime);
+	std::vector<bool> filled(SAMPLES);
+	for (unsigned int n = 0; n < p_legCount; n++)
+	{
+		ReferenceLegMovementController legRef(p_reference);
+		glm::vec3 wantedWPos(0.0f, p_lfHeight, 0.0f);
+		filled.assign(SAMPLES, false);
+		for (unsigned int i = 0; i < (WARMUP_STRIDES + 1) * strideSteps; i++)
+		{
+			wantedWPos.z += stepDist;
+			legRef.updateRefPositions(n, wantedWPos, p_lfHeight, p_uLegLen, p_lLegLen, stepTime, NULL);
+			if (i < WARMUP_STRIDES * strideSteps) continue;
+			// slot from the phase itself, so round-off in the player can not shift the table
+			unsigned int slot = (unsigned int)floor(legRef.m_player.getPhase() * (float)SAMPLES + 0.5f) % SAMPLES;
+			Sample& s = m_samples[n * SAMPLES + slot];
+			s.m_foot = legRef.m_feet[n] - wantedWPos;
+			s.m_knee = legRef.m_knees[n] - wantedWPos;
+			s.m_hip = legRef.m_IK.getHipPos() - wantedWPos;
+			filled[slot] = true;
+		}
+		fillGaps(n, filled);
+	}
+}
+
+void ReferenceMotionTable::fillGaps(unsigned int p_legIdx, const std::vector<bool>& p_filled)
+{
+	// Steps longer than a slot leave gaps, lerp them from the recorded neighbours (wrapping)
+	int first = -1;
+	for (unsigned int i = 0; i < SAMPLES && first < 0; i++)
+		if (p_filled[i]) first = (int)i;
+	if (first < 0) return;
+	Sample* samples = &m_samples[p_legIdx * SAMPLES];
+	unsigned int prev = (unsigned int)first;
+	for (unsigned int i = 1; i <= SAMPLES; i++)
+	{
+		unsigned int idx = (first + i) % SAMPLES;
+		if (!p_filled[idx]) continue;
+		unsigned int gap = (idx + SAMPLES - prev) % SAMPLES;
+		if (gap == 0) gap = SAMPLES; // only one recorded slot
+		for (unsigned int k = 1; k < gap; k++)
+		{
+			float t = (float)k / (float)gap;
+			Sample& s = samples[(prev + k) % SAMPLES];
+			s.m_foot = glm::lerp(samples[prev].m_foot, samples[idx].m_foot, t);
+			s.m_knee = glm::lerp(samples[prev].m_knee, samples[idx].m_knee, t);
+			s.m_hip = glm::lerp(samples[prev].m_hip, samples[idx].m_hip, t);
+		}
+		prev = idx;
+	}
+}
+
+ReferenceMotionTable::Sample ReferenceMotionTable::sample(unsigned int p_legIdx, float p_phi) const
+{
+	float u = p_phi * (float)SAMPLES;
+	float lowIdx = floor(u);
+	float t = u - lowIdx;
+	unsigned int i0 = (unsigned int)lowIdx % SAMPLES;
+	unsigned int i1 = (i0 + 1) % SAMPLES;
+	const Sample& a = m_samples[p_legIdx * SAMPLES + i0];
+	const Sample& b = m_samples[p_legIdx * SAMPLES + i1];
+	Sample res;
+	res.m_foot = glm::lerp(a.m_foot, b.m_foot, t);
+	res.m_knee = glm::lerp(a.m_knee, b.m_knee, t);
+	res.m_hip = glm::lerp(a.m_hip, b.m_hip, t);
+	return res;
+}
+
+unsigned int ReferenceMotionTable::getLegCount() const
+{
+	return m_legCount;
+}
+
+unsigned long long ReferenceMotionTable::makeKey(const ReferenceLegMovementController& p_reference, unsigned int p_legCount,
+	float p_lfHeight, float p_uLegLen, float p_lLegLen, float p_goalVelocityZ, float p_dt)
+{
+	float dims[5] = { p_lfHeight, p_uLegLen, p_lLegLen, p_goalVelocityZ, p_dt };
+	int kneeFlip = p_reference.m_IK.getKneeFlip();
+	unsigned long long h = EvaluationCache::hash(&p_legCount, sizeof(p_legCount));
+	h = EvaluationCache::hash(dims, sizeof(dims), h);
+	h = EvaluationCache::hash(&kneeFlip, sizeof(kneeFlip), h);
+	h = EvaluationCache::hash(&p_reference.m_stepLength, sizeof(glm::vec2), h);
+	// the rest is optimizable, so hash through its parameter lists
+	GaitPlayer player = p_reference.m_player;
+	PieceWiseLinear stepHeightTraj = p_reference.m_stepHeightTraj;
+	std::vector<float> params = player.getParams();
+	std::vector<float> trajParams = stepHeightTraj.getParams();
+	params.insert(params.end(), trajParams.begin(), trajParams.end());
+	for (unsigned int i = 0; i < p_reference.m_stepCycles.size(); i++)
+	{
+		StepCycle stepCycle = p_reference.m_stepCycles[i];
+		std::vector<float> cycleParams = stepCycle.getParams();
+		params.insert(params.end(), cycleParams.begin(), cycleParams.end());
+	}
+	if (!params.empty())
+		h = EvaluationCache::hash(&params[0], params.size() * sizeof(float), h);
+	return h;
+}
+
+const ReferenceMotionTable* ReferenceMotionTable::acquire(const ReferenceLegMovementController& p_reference, unsigned int p_legCount,
+	float p_lfHeight, float p_uLegLen, float p_lLegLen, float p_goalVelocityZ, float p_dt)
+{
+	unsigned long long key = makeKey(p_reference, p_legCount, p_lfHeight, p_uLegLen, p_lLegLen, p_goalVelocityZ, p_dt);
+	auto it = m_sharedTables.find(key);
+	if (it != m_sharedTables.end())
+	{
+		it->second.m_users++;
+		return it->second.m_table;
+	}
+	SharedTable shared;
+	shared.m_table = new ReferenceMotionTable();
+	shared.m_table->build(p_reference, p_legCount, p_lfHeight, p_uLegLen, p_lLegLen, p_goalVelocityZ, p_dt);
+	shared.m_users = 1;
+	m_sharedTables[key] = shared;
+	return shared.m_table;
+}
+
+void ReferenceMotionTable::release(const ReferenceMotionTable* p_table)
+{
+	if (p_table == NULL) return;
+	for (auto it = m_sharedTables.begin(); it != m_sharedTables.end(); ++it)
+	{
+		if (it->second.m_table != p_table) continue;
+		if (--it->second.m_users == 0)
+		{
+			SAFE_DELETE(it->second.m_table);
+			m_sharedTables.erase(it);
+		}
+		return;
+	}
+}
+
+unsigned int ReferenceMotionTable::getSharedCount()
+{
+	return (unsigned int)m_sharedTables.size();
+}
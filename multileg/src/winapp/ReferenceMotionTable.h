@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <glm\gtc\type_ptr.hpp>
+
+class ReferenceLegMovementController;
+
+// =======================================================================================
+//                                      ReferenceMotionTable
+// =======================================================================================
+
+///---------------------------------------------------------------------------------------
+/// \brief	Phase indexed table of the reference leg motion, relative to the ghost
+///			leg frame position. Sampled once from a ReferenceLegMovementController
+///			so recorders can interpolate the reference instead of running the
+///			reference IK for every candidate. Tables are shared between everyone
+///			with the same reference inputs and freed when the last user releases them.
+///
+/// # ReferenceMotionTable
+///
+/// 18-10-2026
+///---------------------------------------------------------------------------------------
+
+class ReferenceMotionTable
+{
+public:
+	static const unsigned int SAMPLES = 256; // per stride
+	static const unsigned int WARMUP_STRIDES = 2;
+
+	struct Sample
+	{
+		glm::vec3 m_foot, m_knee, m_hip; // relative to the wanted leg frame position
+	};
+
+	ReferenceMotionTable();
+	virtual ~ReferenceMotionTable() {}
+
+	// Steps a copy of the reference at the simulation step p_dt through warm-up
+	// strides, then records one stride for each leg. p_goalVelocityZ is the ghost speed.
+	void build(const ReferenceLegMovementController& p_reference, unsigned int p_legCount,
+		float p_lfHeight, float p_uLegLen, float p_lLegLen, float p_goalVelocityZ, float p_dt);
+
+	// Linear interpolation between the two samples around the phase
+	Sample sample(unsigned int p_legIdx, float p_phi) const;
+	unsigned int getLegCount() const;
+
+	// Hash of everything the reference motion depends on
+	static unsigned long long makeKey(const ReferenceLegMovementController& p_reference, unsigned int p_legCount,
+		float p_lfHeight, float p_uLegLen, float p_lLegLen, float p_goalVelocityZ, float p_dt);
+
+	// Shared tables, built on first request for a key. Every acquire
+	// is paired with a release, the last release deletes the table.
+	static const ReferenceMotionTable* acquire(const ReferenceLegMovementController& p_reference, unsigned int p_legCount,
+		float p_lfHeight, float p_uLegLen, float p_lLegLen, float p_goalVelocityZ, float p_dt);
+	static void release(const ReferenceMotionTable* p_table);
+	static unsigned int getSharedCount();
+private:
+	void fillGaps(unsigned int p_legIdx, const std::vector<bool>& p_filled);
+
+	struct SharedTable
+	{
+		ReferenceMotionTable* m_table;
+		unsigned int m_users;
+	};
+
+	unsigned int m_legCount;
+	std::vector<Sample> m_samples; // SAMPLES per leg, leg major
+
+	static std::map<unsigned long long, SharedTable> m_sharedTables;
+};
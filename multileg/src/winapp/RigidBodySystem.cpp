@@ -1,6 +1,7 @@
 #include "RigidBodySystem.h"
 #include <ToString.h>
 #include <DebugPrint.h>
+#include <SimCheckpoint.h>
 
 
 void RigidBodySystem::removed(artemis::Entity &e)
@@ -131,12 +132,6 @@ void RigidBodySystem::processEntity(artemis::Entity &e)
 					dbgDrawer()->drawLine(hitPos - glm::vec3(0.0f, 0.0f, 0.5f), hitPos + glm::vec3(0.0f, 0.0f, 0.5f), dawnBringerPalRGB[COL_RED], dawnBringerPalRGB[COL_RED]);
 				}
 			}
-			//
-			if (m_stateDbgRecorder != NULL && m_stateDbgRecorder->isActive())
-			{
-				btTransform* btt = &physTransform;
-				m_stateString += string("\n,") +ToString(e.getUniqueId())+string(" x: ") + ToString(btt->getOrigin().x()) + ",y: " + ToString(btt->getOrigin().y()) + ",z: " + ToString(btt->getOrigin().z());
-			}
 		}
 	}
 }
@@ -230,15 +225,6 @@ void RigidBodySystem::setupConstraints(artemis::Entity *e)
 	}
 }
 
-void RigidBodySystem::lateUpdate()
-{
-	if (m_stateDbgRecorder!=NULL && m_stateDbgRecorder->isActive())
-	{
-		m_stateDbgRecorder->saveMeasurementRelTStamp(m_stateString+"\n", world->getDelta());
-		m_stateString.clear();
-	}
-}
-
 void RigidBodySystem::fixedUpdate(float p_dt)
 {
 	//DEBUGPRINT(("\n "));
@@ -264,3 +250,101 @@ void RigidBodySystem::fixedUpdate(float p_dt)
 	//DEBUGPRINT(("\n"));
 }
 
+void RigidBodySystem::writeCheckpoint(SimCheckpoint& p_checkpoint)
+{
+	p_checkpoint.beginSection(SimCheckpoint::BODIES);
+	p_checkpoint.write(m_rigidBodyEntities.getSize());
+	for (unsigned int i = 0; i < m_rigidBodyEntities.getSize(); i++)
+	{
+		bool hasBody = m_rigidBodyEntities.hasValue(i);
+		p_checkpoint.write(hasBody);
+		if (!hasBody) continue;
+		artemis::Entity* e = m_rigidBodyEntities[i];
+		RigidBodyComponent* rigidBody = rigidBodyMapper.get(*e);
+		TransformComponent* transform = transformMapper.get(*e);
+		btRigidBody* body = rigidBody->getRigidBody();
+		// Bullet body, also the interpolation state the motion state is synced from
+		btTransform motionTransform;
+		body->getMotionState()->getWorldTransform(motionTransform);
+		btTransformFloatData transforms[3];
+		body->getWorldTransform().serializeFloat(transforms[0]);
+		body->getInterpolationWorldTransform().serializeFloat(transforms[1]);
+		motionTransform.serializeFloat(transforms[2]);
+		p_checkpoint.write(transforms, (unsigned int)sizeof(transforms));
+		btVector3FloatData velocities[4];
+		body->getLinearVelocity().serializeFloat(velocities[0]);
+		body->getAngularVelocity().serializeFloat(velocities[1]);
+		body->getInterpolationLinearVelocity().serializeFloat(velocities[2]);
+		body->getInterpolationAngularVelocity().serializeFloat(velocities[3]);
+		p_checkpoint.write(velocities, (unsigned int)sizeof(velocities));
+		p_checkpoint.write(body->getActivationState());
+		p_checkpoint.write((float)body->getDeactivationTime());
+		// Components
+		p_checkpoint.write(rigidBody->getVelocity());
+		p_checkpoint.write(rigidBody->getAcceleration());
+		p_checkpoint.write(rigidBody->isColliding());
+		p_checkpoint.write(rigidBody->getCollisionPoint());
+		p_checkpoint.write(transform->getMatrix());
+	}
+	p_checkpoint.endSection();
+}
+
+bool RigidBodySystem::readCheckpoint(SimCheckpoint& p_checkpoint, bool p_apply)
+{
+	if (!p_checkpoint.seekSection(SimCheckpoint::BODIES) || !p_checkpoint.readCount(m_rigidBodyEntities.getSize()))
+		return false;
+	for (unsigned int i = 0; i < m_rigidBodyEntities.getSize() && p_checkpoint.isReadValid(); i++)
+	{
+		bool hasBody = false;
+		p_checkpoint.read(hasBody);
+		if (hasBody != m_rigidBodyEntities.hasValue(i))
+			return false;
+		if (!hasBody) continue;
+		artemis::Entity* e = m_rigidBodyEntities[i];
+		RigidBodyComponent* rigidBody = rigidBodyMapper.get(*e);
+		TransformComponent* transform = transformMapper.get(*e);
+		btRigidBody* body = rigidBody->getRigidBody();
+		btTransformFloatData transforms[3];
+		btVector3FloatData velocities[4];
+		int activationState = 0;
+		float deactivationTime = 0.0f;
+		bool colliding = false;
+		glm::vec3 velocity, acceleration, collisionPoint;
+		glm::mat4 matrix;
+		p_checkpoint.read(transforms, (unsigned int)sizeof(transforms));
+		p_checkpoint.read(velocities, (unsigned int)sizeof(velocities));
+		p_checkpoint.read(activationState);
+		p_checkpoint.read(deactivationTime);
+		p_checkpoint.read(velocity);
+		p_checkpoint.read(acceleration);
+		p_checkpoint.read(colliding);
+		p_checkpoint.read(collisionPoint);
+		if (!p_checkpoint.read(matrix))
+			return false;
+		if (!p_apply) continue;
+		btTransform worldTransform, interpolationTransform, motionTransform;
+		worldTransform.deSerializeFloat(transforms[0]);
+		interpolationTransform.deSerializeFloat(transforms[1]);
+		motionTransform.deSerializeFloat(transforms[2]);
+		btVector3 linearVelocity, angularVelocity, interpolationLinearVelocity, interpolationAngularVelocity;
+		linearVelocity.deSerializeFloat(velocities[0]);
+		angularVelocity.deSerializeFloat(velocities[1]);
+		interpolationLinearVelocity.deSerializeFloat(velocities[2]);
+		interpolationAngularVelocity.deSerializeFloat(velocities[3]);
+		body->setWorldTransform(worldTransform);
+		body->setInterpolationWorldTransform(interpolationTransform);
+		body->getMotionState()->setWorldTransform(motionTransform);
+		body->setLinearVelocity(linearVelocity);
+		body->setAngularVelocity(angularVelocity);
+		body->setInterpolationLinearVelocity(interpolationLinearVelocity);
+		body->setInterpolationAngularVelocity(interpolationAngularVelocity);
+		body->forceActivationState(activationState);
+		body->setDeactivationTime((btScalar)deactivationTime);
+		body->clearForces();
+		rigidBody->setVelocityStat(velocity);
+		rigidBody->setAccelerationStat(acceleration);
+		rigidBody->setCollidingStat(colliding, collisionPoint);
+		transform->setMatrix(matrix);
+	}
+	return p_checkpoint.isSectionRead();
+}
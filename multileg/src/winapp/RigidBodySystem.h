@@ -37,13 +37,11 @@ private:
 public:
 
 
-	RigidBodySystem(btDiscreteDynamicsWorld* p_dynamicsWorld, MeasurementBin<string>* p_stateDbgRecorder=NULL,
-		bool p_measureVelocityAndAcceleration=false)
+	RigidBodySystem(btDiscreteDynamicsWorld* p_dynamicsWorld, bool p_measureVelocityAndAcceleration=false)
 	{
 		addComponentType<TransformComponent>();
 		addComponentType<RigidBodyComponent>();
 		m_dynamicsWorldPtr = p_dynamicsWorld;
-		m_stateDbgRecorder = p_stateDbgRecorder;
 		m_measureVelocityAndAcceleration = p_measureVelocityAndAcceleration;
 	};
 
@@ -64,11 +62,12 @@ public:
 	// ie. after all entity adds. I can't control the order of adds, unlike processing.
 	void executeDeferredConstraintInits();
 
-	// Other deferred updates
-	void lateUpdate();
-
 	virtual void fixedUpdate(float p_dt);
 
+	// Bullet state of every body, with the rigidbody and transform components
+	virtual void writeCheckpoint(SimCheckpoint& p_checkpoint);
+	virtual bool readCheckpoint(SimCheckpoint& p_checkpoint, bool p_apply);
+
 
 	// Contact point callback
 	struct OnCollisionCallback : public btCollisionWorld::ContactResultCallback
@@ -135,6 +134,4 @@ private:
 	void checkForNewConstraints(artemis::Entity &e);
 	//void checkForConstraintsToRemove(artemis::Entity &e, RigidBodyComponent* p_rigidBody);
 	void setupConstraints(artemis::Entity *e);
-	MeasurementBin<string>* m_stateDbgRecorder;
-	std::string m_stateString;
 };
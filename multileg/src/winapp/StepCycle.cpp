@@ -79,33 +79,32 @@ void StepCycle::sanitize()
 		m_tuneStepTrigger = 0.0f;
 }
 
-std::vector<float> StepCycle::getParams()
+void StepCycle::writeParams(ParamCursor& p_cursor)
 {
-	//DEBUGPRINT(("STEP CYCLE GETPARAMS\n"));
-	std::vector<float> params;
-	params.push_back(m_tuneDutyFactor);
-	params.push_back(m_tuneStepTrigger);
-	return params;
+	p_cursor.write(m_tuneDutyFactor);
+	p_cursor.write(m_tuneStepTrigger);
 }
 
-void StepCycle::consumeParams(std::vector<float>& p_other)
+void StepCycle::readParams(ParamCursor& p_cursor)
 {
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_tuneDutyFactor);
-	OptimizableHelper::ConsumeParamsTo(p_other, &m_tuneStepTrigger);
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_tuneDutyFactor);
+	OptimizableHelper::ConsumeParamsTo(p_cursor, &m_tuneStepTrigger);
 }
 
-std::vector<float> StepCycle::getParamsMax()
+void StepCycle::writeParamsMax(ParamCursor& p_cursor)
 {
-	std::vector<float> paramsmax;
-	paramsmax.push_back(0.999f); // DF
-	paramsmax.push_back(0.999f); // ST
-	return paramsmax;
+	p_cursor.write(0.999f); // DF
+	p_cursor.write(0.999f); // ST
 }
 
-std::vector<float> StepCycle::getParamsMin()
+void StepCycle::writeParamsMin(ParamCursor& p_cursor)
 {
-	std::vector<float> paramsmin;
-	paramsmin.push_back(0.0f); // DF
-	paramsmin.push_back(0.0f); // ST
-	return paramsmin;
+	p_cursor.write(0.0f); // DF
+	p_cursor.write(0.0f); // ST
+}
+
+void StepCycle::describeParams(ParamSchema& p_schema)
+{
+	p_schema.add("dutyFactor");
+	p_schema.add("stepTrigger");
 }
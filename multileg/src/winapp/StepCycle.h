@@ -42,10 +42,11 @@ public:
 	float getStancePhase(float p_phi);
 
 	// Optimization
-	virtual std::vector<float> getParams();
-	virtual void consumeParams(std::vector<float>& p_other);
-	virtual std::vector<float> getParamsMax();
-	virtual std::vector<float> getParamsMin();
+	virtual void writeParams(ParamCursor& p_cursor);
+	virtual void readParams(ParamCursor& p_cursor);
+	virtual void writeParamsMax(ParamCursor& p_cursor);
+	virtual void writeParamsMin(ParamCursor& p_cursor);
+	virtual void describeParams(ParamSchema& p_schema);
 
 private:
 	void sanitize();